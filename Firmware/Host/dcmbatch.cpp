@@ -0,0 +1,269 @@
+//============================================================================+
+//
+// $RCSfile: dcmbatch.cpp,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief Batched DCM filters on the host, SIMD kernel
+///
+/// \file
+/// The DCM_MatrixUpdate(), DCM_CompensateDrift() and DCM_Normalize() of
+/// DCM.cpp, written on the vec3.h types with a pack of floats as element
+/// type: the state is kept as structure of arrays, one filter per lane,
+/// and every operation advances all the lanes with one instruction.
+///
+/// The pack is a GCC vector type, so that the same source gives:
+/// \code
+///     compiled with   pack          function            lanes
+///     -mavx512f       16 floats     Batch_Run_Avx512()  16
+///     -mavx2          8 floats      Batch_Run_Avx2()    8
+///     (none)          float         Batch_Run_Scalar()  1
+/// \endcode
+/// Operations are carried out in the same order as in DCM.cpp, so that
+/// every lane gives the result of STRUCT_DCM on the same inputs.
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include "stdafx.h"
+
+#include <string.h>
+#include <math.h>
+
+#include "inc/hw_types.h"
+#include "config.h"
+#include "DCM.h"
+#include "dcmbatch.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#if (GYRO_SUBSTEPS > 1)
+#  error "Batch kernels do not integrate gyro substeps"
+#endif
+
+#if defined(__AVX512F__)
+#  define BATCH_LANES   BATCH_LANES_AVX512
+#  define BATCH_RUN     Batch_Run_Avx512
+typedef float PACK __attribute__((vector_size(BATCH_LANES * sizeof(float))));
+#elif defined(__AVX2__)
+#  define BATCH_LANES   BATCH_LANES_AVX2
+#  define BATCH_RUN     Batch_Run_Avx2
+typedef float PACK __attribute__((vector_size(BATCH_LANES * sizeof(float))));
+#else
+#  define BATCH_LANES   BATCH_LANES_SCALAR
+#  define BATCH_RUN     Batch_Run_Scalar
+typedef float PACK;
+#endif
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Lane of a pack
+/// \return  reference to the lane
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static inline float &
+Lane(PACK &Pack, int iLane)
+{
+    return ((float *)&Pack)[iLane];
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Same value in all lanes
+/// \return  pack
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static inline PACK
+Splat(float fValue)
+{
+    PACK Pack;
+    int l;
+
+    for (l = 0; l < BATCH_LANES; l++) {
+        Lane(Pack, l) = fValue;
+    }
+    return Pack;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Load consecutive floats
+/// \return  pack
+/// \remarks pfValue need not be aligned
+///
+///----------------------------------------------------------------------------
+static inline PACK
+Load(const float *pfValue)
+{
+    PACK Pack;
+
+    memcpy(&Pack, pfValue, sizeof(Pack));
+    return Pack;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Run BATCH_LANES filters on the whole log
+/// \return  -
+/// \remarks Runs pstFilter[ulFirst] ... pstFilter[ulFirst + BATCH_LANES - 1],
+///          ulFirst must be a multiple of BATCH_LANES. The error is the
+///          angle of the rotation between the attitude and the reference,
+///          from the trace of their product.
+///
+///----------------------------------------------------------------------------
+void
+BATCH_RUN(const STRUCT_BATCH_LOG *pstLog, STRUCT_BATCH_FILTER *pstFilter,
+          unsigned long ulFirst)
+{
+    Rot3<PACK> DCM;
+    Vec3<PACK> Bias, Accel, Gyro, Omega, Omega_Vector, Omega_P, Omega_I;
+    Vec3<PACK> errorRollPitch, errorYaw, X, Y, Z;
+    Skew3<PACK> Update;
+    PACK PitchRoll_Kp, PitchRoll_Ki, Yaw_Kp, Yaw_Ki;
+    PACK Speed, errorCourse, error, Dot_Row[3];
+    Vec3<PACK> Reference;
+    const STRUCT_DCM_INPUT *pstInput;
+    const STRUCT_BATCH_REFERENCE *pstReference = pstLog->pstReference;
+    const STRUCT_BATCH_REFERENCE *pstLast = &pstLog->pstReference[pstLog->ulReferences];
+    const float (*pfRow)[BATCH_NOISE_COLUMNS];
+    unsigned int uiColumn = ulFirst % BATCH_NOISE_COLUMNS;
+    unsigned long ulOffset = (ulFirst / BATCH_NOISE_COLUMNS) * BATCH_NOISE_STRIDE;
+    unsigned long ulTick;
+    double pdSquare[BATCH_LANES], pdMax[BATCH_LANES];
+    double dTrace, dAngle;
+    int l, x, y;
+
+    pstFilter = &pstFilter[ulFirst];
+
+    //
+    // Level, facing north, no correction, gains and bias of each filter
+    //
+    for (x = 0; x < 3; x++) {
+        for (y = 0; y < 3; y++) {
+            DCM[x][y] = Splat((x == y) ? 1.0f : 0.0f);
+        }
+        Omega_P[x] = Splat(0.0f);
+        Omega_I[x] = Splat(0.0f);
+    }
+    for (l = 0; l < BATCH_LANES; l++) {
+        Lane(PitchRoll_Kp, l) = pstFilter[l].pfGain[0];
+        Lane(PitchRoll_Ki, l) = pstFilter[l].pfGain[1];
+        Lane(Yaw_Kp, l) = pstFilter[l].pfGain[2];
+        Lane(Yaw_Ki, l) = pstFilter[l].pfGain[3];
+        for (x = 0; x < 3; x++) {
+            Lane(Bias[x], l) = pstFilter[l].pfBias[x];
+        }
+        pdSquare[l] = 0.0;
+        pdMax[l] = 0.0;
+    }
+
+    for (ulTick = 0; ulTick < pstLog->ulTicks; ulTick++) {
+        pstInput = &pstLog->pstInput[ulTick];
+
+        //
+        // Inputs, as Batch_Input()
+        //
+        for (x = 0; x < 3; x++) {
+            Accel[x] = Splat(pstInput->Accel[x]);
+            Gyro[x] = Splat(pstInput->Gyro[x]) + Bias[x];
+        }
+        if (pstLog->pfNoise != NULL) {
+            pfRow = pstLog->pfNoise[(ulTick + ulOffset) % BATCH_NOISE_TICKS];
+            for (x = 0; x < 3; x++) {
+                Accel[x] = Accel[x] + Load(&pfRow[x][uiColumn]);
+                Gyro[x] = Gyro[x] + Load(&pfRow[x + 3][uiColumn]);
+            }
+        }
+
+        //
+        // DCM_MatrixUpdate()
+        //
+        Omega = Gyro + Omega_I;
+        Omega_Vector = Omega + Omega_P;
+        Speed = Splat(pstInput->fSpeed);
+        Accel[1] += ((Speed * Omega[2] * 9.81f) / GRAVITY);
+        Accel[2] -= ((Speed * Omega[1] * 9.81f) / GRAVITY);
+        Update.w = Omega_Vector * Splat(pstInput->fDeltaT);
+        DCM += DCM * Update;
+
+        //
+        // DCM_CompensateDrift()
+        //
+        errorRollPitch = Cross(Accel, DCM[2]);
+        Omega_P = errorRollPitch * PitchRoll_Kp;
+        Omega_I += errorRollPitch * PitchRoll_Ki;
+        errorCourse = (DCM[0][0] * Splat(pstLog->pfCOG[ulTick][1])) -
+                      (DCM[1][0] * Splat(pstLog->pfCOG[ulTick][0]));
+        errorYaw = DCM[2] * errorCourse;
+        Omega_P += errorYaw * Yaw_Kp;
+        Omega_I += errorYaw * Yaw_Ki;
+
+        //
+        // DCM_Normalize()
+        //
+        error = -Dot(DCM[0], DCM[1]) * 0.5f;
+        X = (DCM[1] * error) + DCM[0];
+        Y = (DCM[0] * error) + DCM[1];
+        Z = Cross(X, Y);
+        DCM[0] = X * (0.5f * (3.0f - Dot(X, X)));
+        DCM[1] = Y * (0.5f * (3.0f - Dot(Y, Y)));
+        DCM[2] = Z * (0.5f * (3.0f - Dot(Z, Z)));
+
+        //
+        // Error from the reference attitudes of this tick
+        //
+        for (; (pstReference != pstLast) && (pstReference->ulTick == ulTick); pstReference++) {
+            for (x = 0; x < 3; x++) {
+                for (y = 0; y < 3; y++) {
+                    Reference[y] = Splat(pstReference->DCM[x][y]);
+                }
+                Dot_Row[x] = Dot(Reference, DCM[x]);
+            }
+            for (l = 0; l < BATCH_LANES; l++) {
+                dTrace = 0.0;
+                for (x = 0; x < 3; x++) {
+                    dTrace += Lane(Dot_Row[x], l);
+                }
+                dTrace = (dTrace - 1.0) * 0.5;
+                if (dTrace > 1.0) {
+                    dTrace = 1.0;
+                } else if (dTrace < -1.0) {
+                    dTrace = -1.0;
+                }
+                dAngle = acos(dTrace) * 180.0 / M_PI;
+                if (!(dAngle <= pdMax[l])) {    // also catches NaN
+                    pdMax[l] = dAngle;
+                }
+                pdSquare[l] += dAngle * dAngle;
+            }
+        }
+    }
+
+    for (l = 0; l < BATCH_LANES; l++) {
+        for (x = 0; x < 3; x++) {
+            for (y = 0; y < 3; y++) {
+                pstFilter[l].fDCM[x][y] = Lane(DCM[x][y], l);
+            }
+        }
+        pstFilter[l].dRms = sqrt(pdSquare[l] / (double)pstLog->ulReferences);
+        pstFilter[l].dMax = pdMax[l];
+    }
+}
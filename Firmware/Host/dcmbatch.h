@@ -0,0 +1,108 @@
+//============================================================================
+//
+// $RCSfile: dcmbatch.h,v $ (HEADER FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief Batched DCM filters on the host
+///
+/// \file
+/// Runs several DCM filters (DCM_FLOAT) side by side, one per SIMD lane,
+/// on the inputs of a log. Every filter has its own gains and can have its
+/// own gyro bias and noise, for gain sweeps and Monte Carlo runs.
+///
+/// dcmbatch.cpp is compiled once per instruction set, each version giving
+/// a Batch_Run_xxx() function that runs BATCH_LANES_xxx filters at a time.
+///
+//  CHANGES
+//
+//============================================================================
+
+#ifndef __DCMBATCH_H__
+#define __DCMBATCH_H__
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#define BATCH_LANES_SCALAR  1       ///< Filters per call, no SIMD
+#define BATCH_LANES_AVX2    8       ///< Filters per call, AVX2
+#define BATCH_LANES_AVX512  16      ///< Filters per call, AVX-512
+
+#define BATCH_NOISE_TICKS   1024    ///< Ticks in the noise table
+#define BATCH_NOISE_COLUMNS 16      ///< Filters with distinct noise per tick
+#define BATCH_NOISE_STRIDE  97      ///< Tick offset between noise column groups
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+typedef struct {                // reference attitude ("*" record)
+    unsigned long ulTick;       // index of the preceding control tick
+    Rot3<float> DCM;            // logged DCM_Matrix
+} STRUCT_BATCH_REFERENCE;
+
+typedef struct {                // inputs shared by all the filters
+    const STRUCT_DCM_INPUT *pstInput;   // sensor inputs of every tick
+    const float (*pfCOG)[2];    // cos, sin of the course of every tick
+    unsigned long ulTicks;      // number of ticks
+    const STRUCT_BATCH_REFERENCE *pstReference; // reference attitudes
+    unsigned long ulReferences; // number of references
+    const float (*pfNoise)[6][BATCH_NOISE_COLUMNS]; // accel, gyro noise or NULL
+} STRUCT_BATCH_LOG;
+
+typedef struct {                // one filter
+    float pfGain[4];            // PitchRoll_Kp, PitchRoll_Ki, Yaw_Kp, Yaw_Ki
+    float pfBias[3];            // gyro bias [rad/s]
+    float fDCM[3][3];           // attitude at the end of the log
+    double dRms;                // rms attitude error [deg]
+    double dMax;                // max attitude error [deg]
+} STRUCT_BATCH_FILTER;
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*---------------------------------- Interface -------------------------------*/
+
+void Batch_Run_Scalar ( const STRUCT_BATCH_LOG *pstLog, STRUCT_BATCH_FILTER *pstFilter, unsigned long ulFirst );
+void Batch_Run_Avx2 ( const STRUCT_BATCH_LOG *pstLog, STRUCT_BATCH_FILTER *pstFilter, unsigned long ulFirst );
+void Batch_Run_Avx512 ( const STRUCT_BATCH_LOG *pstLog, STRUCT_BATCH_FILTER *pstFilter, unsigned long ulFirst );
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Inputs of one filter at one tick
+/// \return  -
+/// \remarks Log inputs plus the gyro bias of the filter plus the noise of
+///          its column, at a tick offset depending on the filter, so that
+///          the noise of filter ulFilter does not repeat for the first
+///          BATCH_NOISE_COLUMNS * BATCH_NOISE_TICKS / BATCH_NOISE_STRIDE
+///          filters. The batch kernels add in the same order.
+///
+///----------------------------------------------------------------------------
+static inline void
+Batch_Input(STRUCT_DCM_INPUT *pstOutput, const STRUCT_BATCH_LOG *pstLog,
+            const STRUCT_BATCH_FILTER *pstFilter, unsigned long ulFilter,
+            unsigned long ulTick)
+{
+    const STRUCT_DCM_INPUT *pstInput = &pstLog->pstInput[ulTick];
+    const float (*pfRow)[BATCH_NOISE_COLUMNS];
+    unsigned int uiColumn = ulFilter % BATCH_NOISE_COLUMNS;
+    int x;
+
+    *pstOutput = *pstInput;
+    for (x = 0; x < 3; x++) {
+        pstOutput->Gyro[x] = pstInput->Gyro[x] + pstFilter->pfBias[x];
+    }
+    if (pstLog->pfNoise != NULL) {
+        pfRow = pstLog->pfNoise[(ulTick + (ulFilter / BATCH_NOISE_COLUMNS) * BATCH_NOISE_STRIDE) %
+                                BATCH_NOISE_TICKS];
+        for (x = 0; x < 3; x++) {
+            pstOutput->Accel[x] = pstOutput->Accel[x] + pfRow[x][uiColumn];
+            pstOutput->Gyro[x] = pstOutput->Gyro[x] + pfRow[x + 3][uiColumn];
+        }
+    }
+}
+
+#endif // __DCMBATCH_H__
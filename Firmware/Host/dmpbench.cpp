@@ -0,0 +1,401 @@
+//============================================================================+
+//
+// $RCSfile: dmpbench.cpp,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief Throughput of the DMP packet batch decoder
+///
+/// \file
+/// Decodes the same synthetic DMP FIFO stream, for several feature masks,
+/// with:
+/// - "packet": one packet at a time, the feature mask tested and the big
+///   endian words assembled byte by byte, as dmp_read_fifo() does;
+/// - "scalar": dmp_decode_batch_scalar(), layout cached, word loads;
+/// - "batch": dmp_decode_batch(), SIMD on the host.
+///
+/// The stream is decoded one full FIFO (1024 bytes) at a time, the batch
+/// a read of dmp_read_fifo_batch() would get. Both decoders must give the
+/// same structure of arrays as "packet": the tool exits with status 1 if
+/// not.
+///
+/// Usage:
+/// \code
+///     dmpbench [-n iterations]
+/// \endcode
+/// Times are host ns and TSC cycles per packet, and MB/s of FIFO data:
+/// they show the ratio between the versions, not the Cortex-M3 figures.
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h>
+#endif
+
+#include "inv_mpu.h"
+#include "inv_mpu_dmp_motion_driver.h"
+#include "inv_mpu_dmp_batch.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#define PACKETS         4096        ///< Packets in the stream
+#define FIFO_BYTES      1024        ///< Size of the MPU-6050 FIFO
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+typedef enum {          // decoders
+    D_PACKET,           // one packet at a time, as dmp_read_fifo()
+    D_SCALAR,           // dmp_decode_batch_scalar()
+    D_BATCH,            // dmp_decode_batch()
+    D_NUMBER
+} ENUM_DECODER;
+
+/*----------------------------------- Types ----------------------------------*/
+
+typedef struct {            // one feature mask
+    const char *pszName;    // name
+    unsigned short usMask;  // DMP_FEATURE_xxx
+} STRUCT_FEATURES;
+
+typedef struct {            // decoded stream, structure of arrays
+    int32_t plQuat[4][PACKETS];
+    int16_t psAccel[3][PACKETS];
+    int16_t psGyro[3][PACKETS];
+} STRUCT_OUTPUT;
+
+/*---------------------------------- Constants -------------------------------*/
+
+static const STRUCT_FEATURES s_pstFeatures[] = {
+    { "quat accel gyro tap", DMP_FEATURE_LP_QUAT | DMP_FEATURE_SEND_RAW_ACCEL |
+                             DMP_FEATURE_SEND_CAL_GYRO | DMP_FEATURE_TAP },
+    { "quat accel gyro",     DMP_FEATURE_6X_LP_QUAT | DMP_FEATURE_SEND_RAW_ACCEL |
+                             DMP_FEATURE_SEND_CAL_GYRO },
+    { "quat",                DMP_FEATURE_6X_LP_QUAT },
+    { "accel gyro",          DMP_FEATURE_SEND_RAW_ACCEL | DMP_FEATURE_SEND_RAW_GYRO }
+};
+
+static const char * const s_ppszDecoder[D_NUMBER] = { "packet", "scalar", "batch" };
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+static unsigned char s_pucStream[PACKETS * DMP_PACKET_MAX];    // FIFO data
+static STRUCT_OUTPUT s_pstOutput[D_NUMBER];                     // decoded
+static volatile int32_t s_lSink;    // keeps the results alive
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Monotonic time
+/// \return  time in ns
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static inline unsigned long long
+Now(void)
+{
+    struct timespec stTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &stTime);
+    return ((unsigned long long)stTime.tv_sec * 1000000000ULL) +
+            (unsigned long long)stTime.tv_nsec;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Time stamp counter
+/// \return  cycles, 0 if not available
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static inline unsigned long long
+Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Put a big endian word in the stream
+/// \return  -
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static void
+PutBE(unsigned char *pucData, unsigned long ulValue, int iBytes)
+{
+    int j;
+
+    for (j = 0; j < iBytes; j++) {
+        pucData[j] = (unsigned char)(ulValue >> (8 * (iBytes - 1 - j)));
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Fill the stream
+/// \return  -
+/// \remarks Unit quaternions in q30, random accel and gyro over the whole
+///          range, random gesture bytes.
+///
+///----------------------------------------------------------------------------
+static void
+Init(const struct dmp_layout_s *pstLayout)
+{
+    unsigned char *pucPacket;
+    double pdQuat[4], dNorm;
+    int j, c;
+
+    srand(1);
+    for (j = 0; j < PACKETS; j++) {
+        pucPacket = &s_pucStream[j * pstLayout->length];
+        if (pstLayout->quat != DMP_LAYOUT_NONE) {
+            dNorm = 0.0;
+            for (c = 0; c < 4; c++) {
+                pdQuat[c] = ((double)rand() / (double)RAND_MAX) - 0.5;
+                dNorm += pdQuat[c] * pdQuat[c];
+            }
+            dNorm = sqrt(dNorm);
+            for (c = 0; c < 4; c++) {
+                PutBE(pucPacket + pstLayout->quat + (4 * c),
+                      (unsigned long)(long)((pdQuat[c] / dNorm) * 1073741823.0), 4);
+            }
+        }
+        for (c = 0; c < 3; c++) {
+            if (pstLayout->accel != DMP_LAYOUT_NONE) {
+                PutBE(pucPacket + pstLayout->accel + (2 * c), rand() & 0xFFFF, 2);
+            }
+            if (pstLayout->gyro != DMP_LAYOUT_NONE) {
+                PutBE(pucPacket + pstLayout->gyro + (2 * c), rand() & 0xFFFF, 2);
+            }
+        }
+        if (pstLayout->gesture != DMP_LAYOUT_NONE) {
+            PutBE(pucPacket + pstLayout->gesture, (unsigned long)rand(), 4);
+        }
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Decode packets one at a time
+/// \return  -
+/// \remarks Body of dmp_read_fifo(), without the I2C read.
+///
+///----------------------------------------------------------------------------
+static void
+DecodePacket(unsigned short usMask, const unsigned char *pucData,
+             unsigned short usPackets, unsigned short usFirst,
+             STRUCT_OUTPUT *pstOut)
+{
+    const unsigned char *fifo_data;
+    unsigned char ii;
+    unsigned char ucLength = 0;
+    unsigned short n;
+
+    if (usMask & (DMP_FEATURE_LP_QUAT | DMP_FEATURE_6X_LP_QUAT))
+        ucLength += 16;
+    if (usMask & DMP_FEATURE_SEND_RAW_ACCEL)
+        ucLength += 6;
+    if (usMask & (DMP_FEATURE_SEND_RAW_GYRO | DMP_FEATURE_SEND_CAL_GYRO))
+        ucLength += 6;
+    if (usMask & (DMP_FEATURE_TAP | DMP_FEATURE_ANDROID_ORIENT))
+        ucLength += 4;
+
+    for (n = usFirst; n < usFirst + usPackets; n++) {
+        fifo_data = pucData + ((n - usFirst) * ucLength);
+        ii = 0;
+        if (usMask & (DMP_FEATURE_LP_QUAT | DMP_FEATURE_6X_LP_QUAT)) {
+            pstOut->plQuat[0][n] = ((long)fifo_data[0] << 24) | ((long)fifo_data[1] << 16) |
+                ((long)fifo_data[2] << 8) | fifo_data[3];
+            pstOut->plQuat[1][n] = ((long)fifo_data[4] << 24) | ((long)fifo_data[5] << 16) |
+                ((long)fifo_data[6] << 8) | fifo_data[7];
+            pstOut->plQuat[2][n] = ((long)fifo_data[8] << 24) | ((long)fifo_data[9] << 16) |
+                ((long)fifo_data[10] << 8) | fifo_data[11];
+            pstOut->plQuat[3][n] = ((long)fifo_data[12] << 24) | ((long)fifo_data[13] << 16) |
+                ((long)fifo_data[14] << 8) | fifo_data[15];
+            ii += 16;
+        }
+        if (usMask & DMP_FEATURE_SEND_RAW_ACCEL) {
+            pstOut->psAccel[0][n] = ((short)fifo_data[ii+0] << 8) | fifo_data[ii+1];
+            pstOut->psAccel[1][n] = ((short)fifo_data[ii+2] << 8) | fifo_data[ii+3];
+            pstOut->psAccel[2][n] = ((short)fifo_data[ii+4] << 8) | fifo_data[ii+5];
+            ii += 6;
+        }
+        if (usMask & (DMP_FEATURE_SEND_RAW_GYRO | DMP_FEATURE_SEND_CAL_GYRO)) {
+            pstOut->psGyro[0][n] = ((short)fifo_data[ii+0] << 8) | fifo_data[ii+1];
+            pstOut->psGyro[1][n] = ((short)fifo_data[ii+2] << 8) | fifo_data[ii+3];
+            pstOut->psGyro[2][n] = ((short)fifo_data[ii+4] << 8) | fifo_data[ii+5];
+            ii += 6;
+        }
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Decode the whole stream, one FIFO at a time
+/// \return  -
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static void
+Decode(ENUM_DECODER eDecoder, const STRUCT_FEATURES *pstFeatures,
+       const struct dmp_layout_s *pstLayout, STRUCT_OUTPUT *pstOut)
+{
+    struct dmp_batch_s stBatch;
+    unsigned short usFifo = FIFO_BYTES / pstLayout->length;
+    unsigned short usFirst, usPackets;
+    int c;
+
+    for (usFirst = 0; usFirst < PACKETS; usFirst += usFifo) {
+        usPackets = (PACKETS - usFirst < usFifo) ? (PACKETS - usFirst) : usFifo;
+        if (eDecoder == D_PACKET) {
+            DecodePacket(pstFeatures->usMask,
+                         &s_pucStream[usFirst * pstLayout->length],
+                         usPackets, usFirst, pstOut);
+            continue;
+        }
+        for (c = 0; c < 4; c++) {
+            stBatch.quat[c] = &pstOut->plQuat[c][usFirst];
+        }
+        for (c = 0; c < 3; c++) {
+            stBatch.accel[c] = &pstOut->psAccel[c][usFirst];
+            stBatch.gyro[c] = &pstOut->psGyro[c][usFirst];
+        }
+        if (eDecoder == D_SCALAR) {
+            dmp_decode_batch_scalar(pstLayout, &s_pucStream[usFirst * pstLayout->length],
+                                    usPackets, &stBatch);
+        } else {
+            dmp_decode_batch(pstLayout, &s_pucStream[usFirst * pstLayout->length],
+                             usPackets, &stBatch);
+        }
+    }
+    s_lSink = pstOut->plQuat[0][PACKETS - 1] + pstOut->psGyro[2][PACKETS - 1];
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Time a decoder
+/// \return  ns per packet
+/// \remarks Best of the iterations.
+///
+///----------------------------------------------------------------------------
+static double
+Time(ENUM_DECODER eDecoder, const STRUCT_FEATURES *pstFeatures,
+     const struct dmp_layout_s *pstLayout, unsigned long ulIterations,
+     double *pdCycles)
+{
+    unsigned long long ullStart, ullCycles, ullBest = ~0ULL, ullBestCycles = 0;
+    unsigned long j;
+
+    for (j = 0; j < ulIterations; j++) {
+        ullStart = Now();
+        ullCycles = Cycles();
+        Decode(eDecoder, pstFeatures, pstLayout, &s_pstOutput[eDecoder]);
+        ullCycles = Cycles() - ullCycles;
+        ullStart = Now() - ullStart;
+        if (ullStart < ullBest) {
+            ullBest = ullStart;
+            ullBestCycles = ullCycles;
+        }
+    }
+    *pdCycles = (double)ullBestCycles / PACKETS;
+    return (double)ullBest / PACKETS;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Compare a decoder with the packet decoder
+/// \return  true if the fields of the layout are the same
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static bool
+Same(ENUM_DECODER eDecoder, const struct dmp_layout_s *pstLayout)
+{
+    const STRUCT_OUTPUT *pstRef = &s_pstOutput[D_PACKET];
+    const STRUCT_OUTPUT *pstOut = &s_pstOutput[eDecoder];
+
+    if ((pstLayout->quat != DMP_LAYOUT_NONE) &&
+        (memcmp(pstRef->plQuat, pstOut->plQuat, sizeof(pstRef->plQuat)) != 0)) {
+        return false;
+    }
+    if ((pstLayout->accel != DMP_LAYOUT_NONE) &&
+        (memcmp(pstRef->psAccel, pstOut->psAccel, sizeof(pstRef->psAccel)) != 0)) {
+        return false;
+    }
+    if ((pstLayout->gyro != DMP_LAYOUT_NONE) &&
+        (memcmp(pstRef->psGyro, pstOut->psGyro, sizeof(pstRef->psGyro)) != 0)) {
+        return false;
+    }
+    return true;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Main
+/// \return  0 if the decoders agree, 1 if not, 2 on usage error
+/// \remarks
+///
+///----------------------------------------------------------------------------
+int
+main(int argc, char *argv[])
+{
+    unsigned long ulIterations = 2000;
+    struct dmp_layout_s stLayout;
+    double pdTime[D_NUMBER], pdCycles[D_NUMBER];
+    bool bSame;
+    int iResult = 0;
+    int j, d;
+
+    for (j = 1; j < argc; j++) {
+        if ((strcmp(argv[j], "-n") == 0) && (j + 1 < argc)) {
+            ulIterations = strtoul(argv[++j], NULL, 10);
+        } else {
+            ulIterations = 0;
+            break;
+        }
+    }
+    if (ulIterations == 0) {
+        fprintf(stderr, "usage: %s [-n iterations]\n", argv[0]);
+        return 2;
+    }
+
+    printf("%-20s   %5s %-7s %9s %9s %9s %7s\n", "features", "bytes", "decoder",
+           "[ns]", "[cy]", "[MB/s]", "ratio");
+    for (j = 0; j < (int)(sizeof(s_pstFeatures) / sizeof(s_pstFeatures[0])); j++) {
+        dmp_layout_from_mask(s_pstFeatures[j].usMask, &stLayout);
+        Init(&stLayout);
+        memset(s_pstOutput, 0, sizeof(s_pstOutput));
+        for (d = 0; d < D_NUMBER; d++) {
+            pdTime[d] = Time((ENUM_DECODER)d, &s_pstFeatures[j], &stLayout,
+                             ulIterations, &pdCycles[d]);
+        }
+        for (d = 0; d < D_NUMBER; d++) {
+            bSame = (d == D_PACKET) || Same((ENUM_DECODER)d, &stLayout);
+            printf("%-20s : %5u %-7s %9.2f %9.1f %9.0f %7.2f%s\n",
+                   s_pstFeatures[j].pszName, stLayout.length, s_ppszDecoder[d],
+                   pdTime[d], pdCycles[d], (double)stLayout.length * 1.0e3 / pdTime[d],
+                   pdTime[D_PACKET] / pdTime[d], bSame ? "" : "  MISMATCH");
+            if (!bSame) {
+                iResult = 1;
+            }
+        }
+    }
+    return iResult;
+}
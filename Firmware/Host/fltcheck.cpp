@@ -0,0 +1,421 @@
+//============================================================================+
+//
+// $RCSfile: fltcheck.cpp,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief Check of filter.c against a double precision reference
+///
+/// \file
+/// Runs sensor-like signals (offset, sines, steps and noise, clipped to the
+/// 10 bit ADC range) through fixed point filter chains and through the same
+/// chains in double precision, designed with the textbook coefficients:
+/// - max and rms difference of the outputs, in ADC steps;
+/// - DC: a steady input must come out unchanged;
+/// - notch: residual amplitude of a sine at the notch frequency;
+/// - range: the state of the fixed point chains must fit in 32 bits, as on
+///   the target (long is 64 bit on the host).
+///
+/// Usage:
+/// \code
+///     fltcheck [-n samples]
+/// \endcode
+/// The tool exits with status 1 if a check fails.
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "inc/hw_types.h"
+#include "filter.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#define ERROR_MAX       1.0         ///< Max difference from the reference [steps]
+#define DC_VALUE        777         ///< Steady input [steps]
+#define NOTCH_MAX       0.02        ///< Max residual of the notched sine
+#define STATE_MAX       2147483647.0    ///< Max state magnitude, 32 bit
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+typedef struct {                    // biquad in double precision
+    double pdB[3], pdA[2];
+    double pdX[2], pdY[2];
+} STRUCT_REF_BIQUAD;
+
+typedef struct {                    // chain in double precision
+    const STRUCT_FILTER_STAGE *pstTable;
+    double pdAcc[FILTER_STAGES_MAX];
+    int piCount[FILTER_STAGES_MAX];
+    STRUCT_REF_BIQUAD pstBiquad[FILTER_STAGES_MAX];
+    tBoolean pbBypass[FILTER_STAGES_MAX];
+} STRUCT_REF;
+
+typedef struct {                    // test case
+    const char *pszName;            // name
+    const STRUCT_FILTER_STAGE *pstTable;    // chain
+    double dSampleHz;               // input rate [Hz]
+    double dNotchHz;                // notch to check, 0 = none
+} STRUCT_CASE;
+
+/*---------------------------------- Constants -------------------------------*/
+
+//
+// Chains as in adcdriver.c, with the gyro stages enabled
+//
+static const STRUCT_FILTER_STAGE s_pstAccel[] = {
+    { FILTER_BOXCAR,  4, 0.0f,  0.0f },
+    { FILTER_SHIFT,   1, 0.0f,  0.0f },
+    { FILTER_LOWPASS, 0, 10.0f, FILTER_Q_BUTTERWORTH },
+    { FILTER_END,     0, 0.0f,  0.0f }
+};
+
+static const STRUCT_FILTER_STAGE s_pstGyro[] = {
+    { FILTER_BOXCAR,  4, 0.0f,  0.0f },
+    { FILTER_LOWPASS, 0, 60.0f, FILTER_Q_BUTTERWORTH },
+    { FILTER_NOTCH,   0, 80.0f, 2.0f },
+    { FILTER_END,     0, 0.0f,  0.0f }
+};
+
+static const STRUCT_FILTER_STAGE s_pstSlow[] = {
+    { FILTER_SHIFT,   3, 0.0f,  0.0f },
+    { FILTER_LOWPASS, 0, 5.0f,  FILTER_Q_BUTTERWORTH },
+    { FILTER_NOTCH,   0, 20.0f, 5.0f },
+    { FILTER_END,     0, 0.0f,  0.0f }
+};
+
+static const STRUCT_FILTER_STAGE s_pstIrq[] = {
+    { FILTER_BOXCAR,  0, 0.0f,  0.0f },
+    { FILTER_SHIFT,   1, 0.0f,  0.0f },
+    { FILTER_LOWPASS, 0, 10.0f, FILTER_Q_BUTTERWORTH },
+    { FILTER_END,     0, 0.0f,  0.0f }
+};
+
+static const STRUCT_CASE s_pstCase[] = {
+    { "accel 400 Hz DMA", s_pstAccel, 6400.0,  0.0 },
+    { "accel 50 Hz DMA",  s_pstAccel, 800.0,   0.0 },
+    { "accel 50 Hz IRQ",  s_pstIrq,   50.0,    0.0 },
+    { "gyro 400 Hz DMA",  s_pstGyro,  6400.0,  80.0 },
+    { "slow 12.8 kHz",    s_pstSlow,  12800.0, 20.0 }
+};
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Random value
+/// \return  uniform in [dMin, dMax]
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static double
+Random(double dMin, double dMax)
+{
+    return dMin + (((double)rand() / (double)RAND_MAX) * (dMax - dMin));
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Initialize a reference chain
+/// \return  -
+/// \remarks Audio EQ Cookbook coefficients, bypass rule of Filter_Design()
+///
+///----------------------------------------------------------------------------
+static void
+Ref_Init(STRUCT_REF *pstRef, const STRUCT_FILTER_STAGE *pstTable, double dSampleHz)
+{
+    const STRUCT_FILTER_STAGE *pstStage;
+    STRUCT_REF_BIQUAD *pstBiquad;
+    double dW0, dAlpha, dA0, dCos;
+    int n;
+
+    memset(pstRef, 0, sizeof(*pstRef));
+    pstRef->pstTable = pstTable;
+    for (n = 0; pstTable[n].eType != FILTER_END; n++) {
+        pstStage = &pstTable[n];
+        pstBiquad = &pstRef->pstBiquad[n];
+        switch (pstStage->eType) {
+        case FILTER_BOXCAR:
+            dSampleHz /= (double)(1 << pstStage->ucShift);
+            break;
+        case FILTER_LOWPASS:
+        case FILTER_NOTCH:
+            if ((pstStage->fHz <= 0.0f) || (pstStage->fHz >= (0.45 * dSampleHz))) {
+                pstRef->pbBypass[n] = true;
+                break;
+            }
+            dW0 = (2.0 * M_PI * pstStage->fHz) / dSampleHz;
+            dCos = cos(dW0);
+            dAlpha = sin(dW0) / (2.0 * pstStage->fQ);
+            dA0 = 1.0 + dAlpha;
+            if (pstStage->eType == FILTER_LOWPASS) {
+                pstBiquad->pdB[0] = ((1.0 - dCos) / 2.0) / dA0;
+                pstBiquad->pdB[1] = (1.0 - dCos) / dA0;
+                pstBiquad->pdB[2] = pstBiquad->pdB[0];
+            } else {
+                pstBiquad->pdB[0] = 1.0 / dA0;
+                pstBiquad->pdB[1] = (-2.0 * dCos) / dA0;
+                pstBiquad->pdB[2] = pstBiquad->pdB[0];
+            }
+            pstBiquad->pdA[0] = (-2.0 * dCos) / dA0;
+            pstBiquad->pdA[1] = (1.0 - dAlpha) / dA0;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Run a reference chain
+/// \return  true if an output is available
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static tBoolean
+Ref_Run(STRUCT_REF *pstRef, double x, double *pdOutput)
+{
+    const STRUCT_FILTER_STAGE *pstStage;
+    STRUCT_REF_BIQUAD *pstBiquad;
+    double y;
+    int n;
+
+    for (n = 0; pstRef->pstTable[n].eType != FILTER_END; n++) {
+        pstStage = &pstRef->pstTable[n];
+        pstBiquad = &pstRef->pstBiquad[n];
+        switch (pstStage->eType) {
+        case FILTER_BOXCAR:
+            pstRef->pdAcc[n] += x;
+            if (++pstRef->piCount[n] < (1 << pstStage->ucShift)) {
+                return false;
+            }
+            x = pstRef->pdAcc[n] / (double)(1 << pstStage->ucShift);
+            pstRef->pdAcc[n] = 0.0;
+            pstRef->piCount[n] = 0;
+            break;
+        case FILTER_SHIFT:
+            pstRef->pdAcc[n] += (x - pstRef->pdAcc[n]) / (double)(1 << pstStage->ucShift);
+            x = pstRef->pdAcc[n];
+            break;
+        default:
+            if (pstRef->pbBypass[n]) {
+                break;
+            }
+            y = (pstBiquad->pdB[0] * x) + (pstBiquad->pdB[1] * pstBiquad->pdX[0]) +
+                (pstBiquad->pdB[2] * pstBiquad->pdX[1]) -
+                (pstBiquad->pdA[0] * pstBiquad->pdY[0]) -
+                (pstBiquad->pdA[1] * pstBiquad->pdY[1]);
+            pstBiquad->pdX[1] = pstBiquad->pdX[0];
+            pstBiquad->pdX[0] = x;
+            pstBiquad->pdY[1] = pstBiquad->pdY[0];
+            pstBiquad->pdY[0] = y;
+            x = y;
+            break;
+        }
+    }
+    *pdOutput = x;
+    return true;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Largest state of a fixed point chain
+/// \return  max magnitude of the accumulators and of the biquad history
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static double
+StateMax(const STRUCT_FILTER *pstFilter)
+{
+    const STRUCT_FILTER_STATE *pstState;
+    double dMax = 0.0;
+    int n, j;
+
+    for (n = 0; n < FILTER_STAGES_MAX; n++) {
+        pstState = &pstFilter->pstState[n];
+        dMax = fmax(dMax, fabs((double)pstState->lAcc));
+        for (j = 0; j < 2; j++) {
+            dMax = fmax(dMax, fabs((double)pstState->plX[j]));
+            dMax = fmax(dMax, fabs((double)pstState->plY[j]));
+        }
+    }
+    return dMax;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Sensor-like input
+/// \return  ADC steps, 0 .. 1023
+/// \remarks Offset with slow steps, two sines, optional sine at dToneHz,
+///          uniform noise.
+///
+///----------------------------------------------------------------------------
+static long
+Input(unsigned long n, double dSampleHz, double dToneHz)
+{
+    static double s_dStep = 0.0;
+    double t = (double)n / dSampleHz;
+    double x;
+
+    if ((n % (unsigned long)dSampleHz) == 0) {
+        s_dStep = Random(-200.0, 200.0);
+    }
+    x = 512.0 + s_dStep + (150.0 * sin(2.0 * M_PI * 1.3 * t)) +
+        (60.0 * sin(2.0 * M_PI * 37.0 * t)) + Random(-40.0, 40.0);
+    if (dToneHz > 0.0) {
+        x += 100.0 * sin(2.0 * M_PI * dToneHz * t);
+    }
+    if (x < 0.0) {
+        x = 0.0;
+    } else if (x > 1023.0) {
+        x = 1023.0;
+    }
+    return (long)floor(x);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Check one case
+/// \return  true if all the checks pass
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static tBoolean
+Check(const STRUCT_CASE *pstCase, unsigned long ulSamples)
+{
+    STRUCT_FILTER_DESIGN stDesign;
+    STRUCT_FILTER stFilter;
+    STRUCT_REF stRef;
+    double dRef = 0.0, dError, dMax = 0.0, dSum = 0.0, dState = 0.0;
+    double dPeak = 0.0, dNotch = 0.0;
+    unsigned long n, ulOutputs = 0, ulSettle;
+    long lOutput, lDC = 0;
+    tBoolean bFixed, bRef, bPass = true;
+
+    Filter_Design(&stDesign, pstCase->pstTable, (float)pstCase->dSampleHz);
+    ulSettle = ulSamples / 10;
+
+    //
+    // Random signal: difference from the reference
+    //
+    srand(1);
+    Filter_Init(&stFilter, &stDesign);
+    Ref_Init(&stRef, pstCase->pstTable, pstCase->dSampleHz);
+    for (n = 0; n < ulSamples; n++) {
+        long lInput = Input(n, pstCase->dSampleHz, 0.0);
+        bFixed = Filter_Run(&stFilter, lInput, &lOutput);
+        bRef = Ref_Run(&stRef, (double)lInput, &dRef);
+        if (bFixed != bRef) {
+            printf("%-18s : decimation out of step at sample %lu\n", pstCase->pszName, n);
+            return false;
+        }
+        dState = fmax(dState, StateMax(&stFilter));
+        if (bFixed && (n >= ulSettle)) {
+            dError = fabs((double)lOutput - dRef);
+            dMax = fmax(dMax, dError);
+            dSum += dError * dError;
+            ulOutputs++;
+        }
+    }
+
+    //
+    // Steady input
+    //
+    Filter_Init(&stFilter, &stDesign);
+    for (n = 0; n < ulSamples; n++) {
+        if (Filter_Run(&stFilter, DC_VALUE, &lOutput)) {
+            lDC = lOutput;
+        }
+    }
+
+    //
+    // Sine at the notch frequency, residual peak after settling
+    //
+    if (pstCase->dNotchHz > 0.0) {
+        Filter_Init(&stFilter, &stDesign);
+        for (n = 0; n < ulSamples; n++) {
+            double t = (double)n / pstCase->dSampleHz;
+            long lInput = 512 + (long)floor(300.0 * sin(2.0 * M_PI * pstCase->dNotchHz * t));
+            if (Filter_Run(&stFilter, lInput, &lOutput) && (n >= ulSettle)) {
+                dPeak = fmax(dPeak, fabs((double)(lOutput - 512)));
+            }
+        }
+        dNotch = dPeak / 300.0;
+    }
+
+    printf("%-18s : %8.1f %7lu %7d %9.3f %9.4f %6ld %9.4f %12.0f",
+           pstCase->pszName, pstCase->dSampleHz, ulOutputs, stDesign.ucStages,
+           dMax, sqrt(dSum / (double)ulOutputs), lDC, dNotch, dState);
+    if (!(dMax <= ERROR_MAX)) {
+        printf("  ERROR EXCEEDED");
+        bPass = false;
+    }
+    if (lDC != DC_VALUE) {
+        printf("  DC");
+        bPass = false;
+    }
+    if (dNotch > NOTCH_MAX) {
+        printf("  NOTCH");
+        bPass = false;
+    }
+    if (dState > STATE_MAX) {
+        printf("  RANGE");
+        bPass = false;
+    }
+    printf("\n");
+    return bPass;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Main
+/// \return  0 if all the checks pass, 1 otherwise, 2 on bad arguments
+/// \remarks
+///
+///----------------------------------------------------------------------------
+int
+main(int argc, char *argv[])
+{
+    unsigned long ulSamples = 200000;
+    int iResult = 0;
+    unsigned int j;
+
+    for (j = 1; j < (unsigned int)argc; j++) {
+        if ((strcmp(argv[j], "-n") == 0) && (j + 1 < (unsigned int)argc)) {
+            ulSamples = strtoul(argv[++j], NULL, 10);
+        } else {
+            ulSamples = 0;
+            break;
+        }
+    }
+    if (ulSamples == 0) {
+        fprintf(stderr, "usage: %s [-n samples]\n", argv[0]);
+        return 2;
+    }
+
+    printf("%-18s   %8s %7s %7s %9s %9s %6s %9s %12s\n", "chain", "rate [Hz]",
+           "outputs", "stages", "max err", "rms err", "DC", "notch", "max state");
+    for (j = 0; j < sizeof(s_pstCase) / sizeof(s_pstCase[0]); j++) {
+        if (!Check(&s_pstCase[j], ulSamples)) {
+            iResult = 1;
+        }
+    }
+    printf("bounds: error %.2f steps, DC %d, notch %.2f, state 2^31\n",
+           ERROR_MAX, DC_VALUE, NOTCH_MAX);
+    return iResult;
+}
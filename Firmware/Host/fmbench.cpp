@@ -0,0 +1,442 @@
+//============================================================================+
+//
+// $RCSfile: fmbench.cpp,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief Micro-benchmark of fastmath.c against libm
+///
+/// \file
+/// Times each function of fastmath.h and the libm function it replaces on
+/// the same table of arguments, and measures its max error against libm in
+/// double precision over the whole table:
+/// - float functions: absolute error, in radians for the inverse functions,
+///   relative for the square root;
+/// - fixed point functions: error of the Q30 result, or in degrees for the
+///   angles.
+///
+/// Usage:
+/// \code
+///     fmbench [-n iterations]
+/// \endcode
+/// Times are host ns and TSC cycles per call: they show the ratio between
+/// the versions, not the Cortex-M3 cycle count, where libm is soft-float
+/// and the ratio is larger. The tool exits with status 1 if an error
+/// exceeds the bound written in fastmath.h.
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h>
+#endif
+
+#include "fastmath.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#define SETS            4096        ///< Arguments in the table
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+typedef enum {          // benchmarked functions
+    F_SIN,              // FastSin
+    F_COS,              // FastCos
+    F_SINCOS,           // FastSinCos
+    F_ATAN2,            // FastAtan2
+    F_ASIN,             // FastAsin
+    F_ACOS,             // FastAcos
+    F_SQRT,             // FastSqrt
+    F_CEIL,             // FastCeil
+    F_QSINCOS,          // QSinCos
+    F_QATAN2,           // QAtan2
+    F_QASIN,            // QAsin
+    F_QACOS,            // QAcos
+    F_QSQRT,            // QSqrt
+    F_NUMBER
+} ENUM_FUNCTION;
+
+/*----------------------------------- Types ----------------------------------*/
+
+typedef struct {            // one function
+    const char *pszName;    // name
+    double dBound;          // max error, as in fastmath.h
+} STRUCT_FUNCTION;
+
+/*---------------------------------- Constants -------------------------------*/
+
+static const STRUCT_FUNCTION s_pstFunction[F_NUMBER] = {
+    { "FastSin",    1.2e-7 },
+    { "FastCos",    1.2e-7 },
+    { "FastSinCos", 1.2e-7 },
+    { "FastAtan2",  1.2e-5 },
+    { "FastAsin",   5.0e-7 },
+    { "FastAcos",   5.0e-7 },
+    { "FastSqrt",   1.5e-7 },
+    { "FastCeil",   0.0    },
+    { "QSinCos",    6.0e-7 },
+    { "QAtan2",     5.5e-4 },
+    { "QAsin",      5.5e-4 },
+    { "QAcos",      5.5e-4 },
+    { "QSqrt",      0.0    }
+};
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+static float s_pfX[SETS];           // angle [rad] or value
+static float s_pfY[SETS];           // second argument of atan2
+static long s_plX[SETS];            // fixed point arguments
+static long s_plY[SETS];
+static volatile float s_fSink;      // keeps the results alive
+static volatile long s_lSink;
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Monotonic time
+/// \return  time in ns
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static inline unsigned long long
+Now(void)
+{
+    struct timespec stTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &stTime);
+    return ((unsigned long long)stTime.tv_sec * 1000000000ULL) +
+            (unsigned long long)stTime.tv_nsec;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Time stamp counter
+/// \return  cycles, 0 if not available
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static inline unsigned long long
+Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Random value
+/// \return  uniform in [fMin, fMax]
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static float
+Random(float fMin, float fMax)
+{
+    return fMin + (((float)rand() / (float)RAND_MAX) * (fMax - fMin));
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Fill the table of arguments
+/// \return  -
+/// \remarks Domain of the function, with the end points where they matter
+///
+///----------------------------------------------------------------------------
+static void
+Init(ENUM_FUNCTION eFunction)
+{
+    int j;
+
+    srand(1);
+    for (j = 0; j < SETS; j++) {
+        switch (eFunction) {
+        case F_SIN:
+        case F_COS:
+        case F_SINCOS:
+            s_pfX[j] = Random(-1000.0f, 1000.0f);
+            if (j < SETS / 2) {
+                s_pfX[j] = Random(-2.0f * 3.14159265f, 2.0f * 3.14159265f);
+            }
+            break;
+        case F_ATAN2:
+            s_pfX[j] = Random(-100.0f, 100.0f);
+            s_pfY[j] = Random(-100.0f, 100.0f);
+            break;
+        case F_ASIN:
+        case F_ACOS:
+            s_pfX[j] = (j < 2) ? ((j == 0) ? 1.0f : -1.0f) : Random(-1.0f, 1.0f);
+            break;
+        case F_SQRT:
+            s_pfX[j] = powf(10.0f, Random(-6.0f, 6.0f));
+            break;
+        case F_CEIL:
+            s_pfX[j] = Random(-40000.0f, 40000.0f);
+            if (j < 16) {
+                s_pfX[j] = (float)(j - 8);
+            }
+            break;
+        case F_QSINCOS:
+            s_plX[j] = (long)Random(-720000.0f, 720000.0f);
+            break;
+        case F_QATAN2:
+            s_plX[j] = (long)Random(-1.0e6f, 1.0e6f);
+            s_plY[j] = (long)Random(-1.0e6f, 1.0e6f);
+            break;
+        case F_QASIN:
+        case F_QACOS:
+            s_plX[j] = (long)Random(-1073741824.0f, 1073741824.0f);
+            break;
+        default:
+            s_plX[j] = (long)Random(0.0f, 4294967040.0f);
+            break;
+        }
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Run a function on the whole table
+/// \return  -
+/// \remarks bFast selects fastmath.c or libm
+///
+///----------------------------------------------------------------------------
+static void
+Run(ENUM_FUNCTION eFunction, bool bFast)
+{
+    float s, c;
+    long ls, lc;
+    int j;
+
+    for (j = 0; j < SETS; j++) {
+        switch (eFunction) {
+        case F_SIN:
+            s_fSink = bFast ? FastSin(s_pfX[j]) : sinf(s_pfX[j]);
+            break;
+        case F_COS:
+            s_fSink = bFast ? FastCos(s_pfX[j]) : cosf(s_pfX[j]);
+            break;
+        case F_SINCOS:
+            if (bFast) {
+                FastSinCos(s_pfX[j], &s, &c);
+            } else {
+                s = sinf(s_pfX[j]);
+                c = cosf(s_pfX[j]);
+            }
+            s_fSink = s + c;
+            break;
+        case F_ATAN2:
+            s_fSink = bFast ? FastAtan2(s_pfY[j], s_pfX[j]) : atan2f(s_pfY[j], s_pfX[j]);
+            break;
+        case F_ASIN:
+            s_fSink = bFast ? FastAsin(s_pfX[j]) : asinf(s_pfX[j]);
+            break;
+        case F_ACOS:
+            s_fSink = bFast ? FastAcos(s_pfX[j]) : acosf(s_pfX[j]);
+            break;
+        case F_SQRT:
+            s_fSink = bFast ? FastSqrt(s_pfX[j]) : sqrtf(s_pfX[j]);
+            break;
+        case F_CEIL:
+            s_lSink = bFast ? FastCeil(s_pfX[j]) : (long)ceil(s_pfX[j]);
+            break;
+        case F_QSINCOS:
+            if (bFast) {
+                QSinCos(s_plX[j], &ls, &lc);
+                s_lSink = ls + lc;
+            } else {
+                s_fSink = sinf((float)s_plX[j] * 1.745329e-5f) +
+                          cosf((float)s_plX[j] * 1.745329e-5f);
+            }
+            break;
+        case F_QATAN2:
+            if (bFast) {
+                s_lSink = QAtan2(s_plY[j], s_plX[j]);
+            } else {
+                s_fSink = atan2f((float)s_plY[j], (float)s_plX[j]);
+            }
+            break;
+        case F_QASIN:
+            if (bFast) {
+                s_lSink = QAsin(s_plX[j]);
+            } else {
+                s_fSink = asinf((float)s_plX[j] * 9.313226e-10f);
+            }
+            break;
+        case F_QACOS:
+            if (bFast) {
+                s_lSink = QAcos(s_plX[j]);
+            } else {
+                s_fSink = acosf((float)s_plX[j] * 9.313226e-10f);
+            }
+            break;
+        default:
+            if (bFast) {
+                s_lSink = (long)QSqrt((unsigned long)s_plX[j]);
+            } else {
+                s_fSink = sqrtf((float)s_plX[j]);
+            }
+            break;
+        }
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Max error on the whole table
+/// \return  max error
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static double
+Error(ENUM_FUNCTION eFunction)
+{
+    double dError, dMax = 0.0, dX, dY, dDeg = 180.0 / M_PI;
+    float s, c;
+    long ls, lc;
+    int j;
+
+    for (j = 0; j < SETS; j++) {
+        dX = s_pfX[j];
+        dY = s_pfY[j];
+        switch (eFunction) {
+        case F_SIN:
+            dError = fabs(FastSin(s_pfX[j]) - sin(dX));
+            break;
+        case F_COS:
+            dError = fabs(FastCos(s_pfX[j]) - cos(dX));
+            break;
+        case F_SINCOS:
+            FastSinCos(s_pfX[j], &s, &c);
+            dError = fmax(fabs(s - sin(dX)), fabs(c - cos(dX)));
+            break;
+        case F_ATAN2:
+            dError = fabs(FastAtan2(s_pfY[j], s_pfX[j]) - atan2(dY, dX));
+            break;
+        case F_ASIN:
+            dError = fabs(FastAsin(s_pfX[j]) - asin(dX));
+            break;
+        case F_ACOS:
+            dError = fabs(FastAcos(s_pfX[j]) - acos(dX));
+            break;
+        case F_SQRT:
+            dError = fabs(FastSqrt(s_pfX[j]) - sqrt(dX)) / sqrt(dX);
+            break;
+        case F_CEIL:
+            dError = fabs((double)FastCeil(s_pfX[j]) - ceil(dX));
+            break;
+        case F_QSINCOS:
+            QSinCos(s_plX[j], &ls, &lc);
+            dX = (double)s_plX[j] / (1000.0 * dDeg);
+            dError = fmax(fabs(ldexp((double)ls, -30) - sin(dX)),
+                          fabs(ldexp((double)lc, -30) - cos(dX)));
+            break;
+        case F_QATAN2:
+            dError = fabs(((double)QAtan2(s_plY[j], s_plX[j]) / 1000.0) -
+                          (atan2((double)s_plY[j], (double)s_plX[j]) * dDeg));
+            if (dError > 180.0) {       // +/-180 deg
+                dError = fabs(dError - 360.0);
+            }
+            break;
+        case F_QASIN:
+            dError = fabs(((double)QAsin(s_plX[j]) / 1000.0) -
+                          (asin(ldexp((double)s_plX[j], -30)) * dDeg));
+            break;
+        case F_QACOS:
+            dError = fabs(((double)QAcos(s_plX[j]) / 1000.0) -
+                          (acos(ldexp((double)s_plX[j], -30)) * dDeg));
+            break;
+        default:
+            dError = fabs((double)QSqrt((unsigned long)s_plX[j]) -
+                          floor(sqrt((double)s_plX[j])));
+            break;
+        }
+        if (!(dError <= dMax)) {        // also catches NaN
+            dMax = dError;
+        }
+    }
+    return dMax;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Time a function
+/// \return  ns per call on the table, cycles per call in *pdCycles
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static double
+Time(ENUM_FUNCTION eFunction, bool bFast, unsigned long ulIterations,
+     double *pdCycles)
+{
+    unsigned long long ullStart, ullCycles;
+    unsigned long j;
+
+    ullStart = Now();
+    ullCycles = Cycles();
+    for (j = 0; j < ulIterations; j++) {
+        Run(eFunction, bFast);
+    }
+    *pdCycles = (double)(Cycles() - ullCycles) / ((double)ulIterations * SETS);
+    return (double)(Now() - ullStart) / ((double)ulIterations * SETS);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   main program
+/// \return  0 if all errors are within bounds, 1 otherwise
+/// \remarks
+///
+///----------------------------------------------------------------------------
+int
+main(int argc, char *argv[])
+{
+    unsigned long ulIterations = 2000;
+    double dLibm, dFast, dLibmCycles, dFastCycles, dError;
+    int iResult = 0;
+    int j;
+
+    for (j = 1; j < argc; j++) {
+        if ((strcmp(argv[j], "-n") == 0) && (j + 1 < argc)) {
+            ulIterations = strtoul(argv[++j], NULL, 10);
+        } else {
+            ulIterations = 0;
+            break;
+        }
+    }
+    if (ulIterations == 0) {
+        fprintf(stderr, "usage: %s [-n iterations]\n", argv[0]);
+        return 2;
+    }
+
+    printf("%-12s   %9s %9s %9s %9s %7s %10s %10s\n", "function", "libm [ns]",
+           "fast [ns]", "libm [cy]", "fast [cy]", "ratio", "max error", "bound");
+    for (j = 0; j < F_NUMBER; j++) {
+        Init((ENUM_FUNCTION)j);
+        dLibm = Time((ENUM_FUNCTION)j, false, ulIterations, &dLibmCycles);
+        dFast = Time((ENUM_FUNCTION)j, true, ulIterations, &dFastCycles);
+        dError = Error((ENUM_FUNCTION)j);
+        printf("%-12s : %9.2f %9.2f %9.1f %9.1f %7.2f %10.3g %10.3g%s\n",
+               s_pstFunction[j].pszName, dLibm, dFast, dLibmCycles, dFastCycles,
+               dLibm / dFast, dError, s_pstFunction[j].dBound,
+               (dError <= s_pstFunction[j].dBound) ? "" : "  EXCEEDED");
+        if (!(dError <= s_pstFunction[j].dBound)) {
+            iResult = 1;
+        }
+    }
+    return iResult;
+}
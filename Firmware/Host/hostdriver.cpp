@@ -0,0 +1,513 @@
+//============================================================================+
+//
+// $RCSfile: hostdriver.cpp,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief Host stand-ins for ADC, PPM, GPS UART and navigation drivers
+///
+/// \file
+/// Replaces adcdriver.c, ppmdriver.cpp, uartdriver.c, nav.cpp and log.c in
+/// the host build. Sensor values are returned exactly as they were logged by
+/// Log_Sensors(), i.e. already offset- and sign-corrected. GPS characters
+/// are queued in the same 256 byte ring used by UART1IntHandler() so that
+/// GPSParse() runs unmodified. The sample and sentence times are the ones
+/// set by Host_SetTime(), i.e. the logged time stamps. Queued characters
+/// post EVENT_UART1, as the receive interrupt does.
+///
+/// The same values make the sensor backend "replay" (sensor.c), the only
+/// one of the host build, selected by Host_Init().
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include "stdafx.h"
+
+#include "inc/hw_types.h"
+#include "config.h"
+#include "adcdriver.h"
+#include "ppmdriver.h"
+#include "uartdriver.h"
+#include "nav.h"
+#include "log.h"
+#include "event.h"
+#include "timing.h"
+#include "sensor.h"
+#include "hostdriver.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_STATIC
+#undef VAR_STATIC
+#endif
+#define VAR_STATIC static
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL
+
+#define PPM_NEUTRAL     1500    ///< Neutral stick position [us]
+#define PPM_AUTO        1900    ///< Channel 4 position selecting autopilot [us]
+#define GYRO_QUEUE      64      ///< Queued gyro samples
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+VAR_STATIC float pfSensorData[6];               // Logged sensor values
+VAR_STATIC unsigned long pulChannel[RC_CHANNELS];   // RC channels [us]
+VAR_STATIC int iBearing;                        // Commanded bearing [deg]
+VAR_STATIC unsigned char s_ucBuffWrite1;        // GPS ring write index
+VAR_STATIC unsigned char s_ucBuffRead1;         // GPS ring read index
+VAR_STATIC char s_pcBuffer1[256];               // GPS ring buffer
+VAR_STATIC long s_plGyroQueue[GYRO_QUEUE][3];   // Gyro samples
+VAR_STATIC unsigned int s_uiGyroWrite;          // Gyro queue write index
+VAR_STATIC unsigned int s_uiGyroRead;           // Gyro queue read index
+VAR_STATIC unsigned long s_ulGyroOverflow;      // Dropped gyro samples
+VAR_STATIC unsigned int s_uiSubsteps = 1;       // Samples per DELTA_T
+VAR_STATIC unsigned long s_ulTime;              // Logged time [us]
+VAR_STATIC const STRUCT_SENSOR_BACKEND * const s_ppstSensors[] = {
+    &g_stSensorReplay                           // Sensor backends
+};
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+static tBoolean Host_SensorInit( void );
+static tBoolean Host_SensorSettled( void );
+static unsigned int Host_SensorRead( STRUCT_SENSOR_BATCH *pstBatch );
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Reset all stand-in drivers
+/// \return  -
+/// \remarks Sensors at zero, sticks at neutral with autopilot engaged,
+///          bearing north, GPS buffer empty. Selects the sensor backend
+///          "replay", which sets Accel_Gain and Gyro_Gain to the nominal
+///          values.
+///
+///----------------------------------------------------------------------------
+void
+Host_Init(void)
+{
+    int c;
+
+    for (c = 0; c < 6; c++) {
+        pfSensorData[c] = 0.0f;
+    }
+    for (c = 0; c < RC_CHANNELS; c++) {
+        pulChannel[c] = PPM_NEUTRAL;
+    }
+    pulChannel[4] = PPM_AUTO;
+    iBearing = 0;
+    s_ucBuffWrite1 = 0;
+    s_ucBuffRead1 = 0;
+    s_uiGyroWrite = 0;
+    s_uiGyroRead = 0;
+    s_ulGyroOverflow = 0;
+    s_ulTime = 0;
+    Sensor_Init(s_ppstSensors, sizeof(s_ppstSensors) / sizeof(s_ppstSensors[0]));
+    Sensor_Select(0);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Set the time returned by ADCTime() and UART1SentenceTime()
+/// \return  -
+/// \remarks ulTime in us, as logged by Log_Stamp()
+///
+///----------------------------------------------------------------------------
+void
+Host_SetTime(unsigned long ulTime)
+{
+    s_ulTime = ulTime;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Set the value returned by ADCGetData(n)
+/// \return  -
+/// \remarks
+///
+///----------------------------------------------------------------------------
+void
+Host_SetSensor(int n, float fValue)
+{
+    if ((n >= 0) && (n < 6)) {
+        pfSensorData[n] = fValue;
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Queue a gyro sample, as ADCS0IntHandler() would
+/// \return  false if the queue is full
+/// \remarks plSteps in ADC steps, offset- and sign-corrected
+///
+///----------------------------------------------------------------------------
+tBoolean
+Host_PutGyro(const long plSteps[3])
+{
+    unsigned int uiNext = (s_uiGyroWrite + 1) % GYRO_QUEUE;
+
+    if (uiNext == s_uiGyroRead) {
+        s_ulGyroOverflow++;
+        return false;
+    }
+    s_plGyroQueue[s_uiGyroWrite][0] = plSteps[0];
+    s_plGyroQueue[s_uiGyroWrite][1] = plSteps[1];
+    s_plGyroQueue[s_uiGyroWrite][2] = plSteps[2];
+    s_uiGyroWrite = uiNext;
+    return true;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Set the value returned by PPMGetChannel(ucChannel)
+/// \return  -
+/// \remarks
+///
+///----------------------------------------------------------------------------
+void
+Host_SetChannel(unsigned char ucChannel, unsigned long ulValue)
+{
+    if (ucChannel < RC_CHANNELS) {
+        pulChannel[ucChannel] = ulValue;
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Set the value returned by Nav_Bearing()
+/// \return  -
+/// \remarks
+///
+///----------------------------------------------------------------------------
+void
+Host_SetBearing(int iValue)
+{
+    iBearing = iValue;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Queue a GPS character, as UART1IntHandler() would
+/// \return  false if the ring buffer is full
+/// \remarks
+///
+///----------------------------------------------------------------------------
+tBoolean
+Host_GpsPutChar(char c)
+{
+    if ((unsigned char)(s_ucBuffWrite1 + 1) == s_ucBuffRead1) {
+        return false;
+    }
+    s_pcBuffer1[s_ucBuffWrite1++] = c;
+    Event_Post(EVENT_UART1);
+    return true;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Interface to sensor data.
+/// \return  value of n-th sensor, as logged
+/// \remarks
+///
+///----------------------------------------------------------------------------
+float
+ADCGetData(int n)
+{
+    if ((n >= 0) && (n < 6)) {
+        return pfSensorData[n];
+    } else {
+        return 0.0f;
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Interface to sensor data, integer.
+/// \return  value of n-th sensor in ADC steps, as logged
+/// \remarks
+///
+///----------------------------------------------------------------------------
+long
+ADCGetSteps(int n)
+{
+    return (long)ADCGetData(n);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Interface to unfiltered gyro data.
+/// \return  number of samples copied
+/// \remarks Samples queued by Host_PutGyro(), oldest first
+///
+///----------------------------------------------------------------------------
+int
+ADCGetGyroSamples(long plSample[][3], int iMax)
+{
+    int n = 0;
+
+    while ((s_uiGyroRead != s_uiGyroWrite) && (n < iMax)) {
+        plSample[n][0] = s_plGyroQueue[s_uiGyroRead][0];
+        plSample[n][1] = s_plGyroQueue[s_uiGyroRead][1];
+        plSample[n][2] = s_plGyroQueue[s_uiGyroRead][2];
+        s_uiGyroRead = (s_uiGyroRead + 1) % GYRO_QUEUE;
+        n++;
+    }
+    return n;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Set the number of ADC samples per DELTA_T.
+/// \return  -
+/// \remarks No limit on the host, the replayed log sets the rate
+///
+///----------------------------------------------------------------------------
+void
+ADCSetSubsteps(unsigned int uiValue)
+{
+    s_uiSubsteps = (uiValue < 1) ? 1 : uiValue;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Interface to the number of ADC samples per DELTA_T.
+/// \return  samples per DELTA_T
+/// \remarks
+///
+///----------------------------------------------------------------------------
+unsigned int
+ADCSubsteps(void)
+{
+    return s_uiSubsteps;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Interface to the gyro queue overflow counter.
+/// \return  number of gyro samples dropped
+/// \remarks
+///
+///----------------------------------------------------------------------------
+unsigned long
+ADCGyroOverflow(void)
+{
+    return s_ulGyroOverflow;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Get value of radio channels
+/// \return  Value of n-th channel between 1000 and 2000
+/// \remarks
+///
+///----------------------------------------------------------------------------
+unsigned long
+PPMGetChannel(unsigned char ucChannel)
+{
+    if (ucChannel < RC_CHANNELS) {
+        return pulChannel[ucChannel];
+    } else {
+        return PPM_NEUTRAL;
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Returns status of radio signal.
+/// \return  always PPM_SIGNAL_OK
+/// \remarks
+///
+///----------------------------------------------------------------------------
+unsigned char
+PPMSignalStatus(void)
+{
+    return PPM_SIGNAL_OK;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Interface to the time of the last sample sequence.
+/// \return  time set by Host_SetTime() [us]
+/// \remarks
+///
+///----------------------------------------------------------------------------
+unsigned long
+ADCTime(void)
+{
+    return s_ulTime;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   get the start time of the last GPS sentence
+/// \returns time set by Host_SetTime() [us]
+/// \remarks
+///
+//----------------------------------------------------------------------------
+unsigned long
+UART1SentenceTime(void)
+{
+    return s_ulTime;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   get a character from GPS buffer
+/// \returns true if a character was available
+/// \remarks
+///
+//----------------------------------------------------------------------------
+tBoolean
+UART1GetChar(char *ch)
+{
+    if (s_ucBuffWrite1 == s_ucBuffRead1) {
+        return false;
+    } else {
+        *ch = s_pcBuffer1[s_ucBuffRead1++];
+        return true;
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   check GPS buffer
+/// \returns true if characters are waiting in the buffer
+/// \remarks
+///
+//----------------------------------------------------------------------------
+tBoolean
+UART1Pending(void)
+{
+    return (s_ucBuffWrite1 != s_ucBuffRead1);
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Get computed bearing
+/// \returns bearing angle in degrees
+/// \remarks
+///
+//----------------------------------------------------------------------------
+int
+Nav_Bearing(void)
+{
+    return iBearing;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Put characters to log file
+/// \remarks Logging is discarded on the host
+///
+//----------------------------------------------------------------------------
+void
+Log_PutChar(char c)
+{
+    (void)c;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Put a time stamp to log file
+/// \remarks Logging is discarded on the host
+///
+//----------------------------------------------------------------------------
+void
+Log_Stamp(unsigned long ulTime)
+{
+    (void)ulTime;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Sensor backend "replay": start.
+/// \return  true
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static tBoolean
+Host_SensorInit(void)
+{
+    return true;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Sensor backend "replay": input settling.
+/// \return  true
+/// \remarks Logged values are already offset-corrected.
+///
+///----------------------------------------------------------------------------
+static tBoolean
+Host_SensorSettled(void)
+{
+    return true;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Sensor backend "replay": samples since the last read.
+/// \return  number of samples
+/// \remarks As the "adc" backend: with GYRO_SUBSTEPS > 1 one sample for
+///          each gyro sample queued by Host_PutGyro(), spaced by one
+///          substep up to the logged time, otherwise one sample with the
+///          values set by Host_SetSensor().
+///
+///----------------------------------------------------------------------------
+static unsigned int
+Host_SensorRead(STRUCT_SENSOR_BATCH *pstBatch)
+{
+    STRUCT_SENSOR_SAMPLE *pstSample;
+    unsigned int n = 1, j;
+    int c;
+#if (GYRO_SUBSTEPS > 1)
+    long plSample[SENSOR_BATCH][3];
+    unsigned long ulStep;
+
+    n = (unsigned int)ADCGetGyroSamples(plSample, SENSOR_BATCH);
+    ulStep = 1000000UL / (Timing_Get()->uiLoopHz * s_uiSubsteps);
+#endif
+
+    for (j = 0; j < n; j++) {
+        pstSample = &pstBatch->pstSample[j];
+#if (GYRO_SUBSTEPS > 1)
+        pstSample->ulTime = s_ulTime - ((n - 1 - j) * ulStep);
+        for (c = 0; c < 3; c++) {
+            pstSample->pfAccel[c] = pfSensorData[c];
+            pstSample->pfGyro[c] = (float)plSample[j][c];
+        }
+#else
+        pstSample->ulTime = s_ulTime;
+        for (c = 0; c < 3; c++) {
+            pstSample->pfAccel[c] = pfSensorData[c];
+            pstSample->pfGyro[c] = pfSensorData[c + 3];
+        }
+#endif
+    }
+    pstBatch->uiSubsteps = s_uiSubsteps;
+#if (GYRO_SUBSTEPS > 1)
+    pstBatch->ulPeriod = ulStep;
+#endif
+    return n;
+}
+
+//
+// Sensor backend "replay", see sensor.c
+//
+VAR_GLOBAL const STRUCT_SENSOR_BACKEND g_stSensorReplay = {
+    "replay", ACCEL_GAIN, GYRO_GAIN, GRAVITY, true,
+    Host_SensorInit, Host_SensorSettled, Host_SensorRead
+};
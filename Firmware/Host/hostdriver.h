@@ -0,0 +1,46 @@
+//============================================================================
+//
+// $RCSfile: hostdriver.h,v $ (HEADER FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief Host stand-ins for ADC, PPM, GPS UART and navigation drivers
+///
+/// \file
+/// The host build links the estimator and control modules against these
+/// functions instead of the LM3S drivers. The replay driver pushes logged
+/// data in through the Host_xxx() setters, the firmware modules read them
+/// back through the usual ADCGetData(), PPMGetChannel(), UART1GetChar() and
+/// Nav_Bearing() interfaces.
+///
+//  CHANGES
+//
+//============================================================================
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL extern
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*---------------------------------- Interface -------------------------------*/
+
+void Host_Init ( void );
+void Host_SetTime ( unsigned long ulTime );
+void Host_SetSensor ( int n, float fValue );
+void Host_SetChannel ( unsigned char ucChannel, unsigned long ulValue );
+void Host_SetBearing ( int iBearing );
+tBoolean Host_GpsPutChar ( char c );
+tBoolean Host_PutGyro ( const long plSteps[3] );
@@ -0,0 +1,272 @@
+//============================================================================+
+//
+// $RCSfile: i2cbench.cpp,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief Control task time with the MPU-6050 FIFO read over I2C
+///
+/// \file
+/// Runs the sensor backend "mpu6050" (mpu6050.c) and the InvenSense driver
+/// (inv_mpu.c) on the stand-in bus (i2cbus.cpp), under the estimator, at
+/// the loop rate: every tick calls MatrixUpdate(), which reads the FIFO
+/// through Sensor_Read(), then CompensateDrift() and Normalize(), then
+/// spins the time the estimator takes on the target (-c), which the host
+/// does in a few us. Built twice, on the GYRO_SUBSTEPS=32 core:
+/// - i2cbench: MPU_FIFO_ASYNC, the read of each tick runs on the bus
+///   thread while the estimator computes;
+/// - i2cbench_blocking: MPU_FIFO_BLOCKING, the task waits for the read.
+///
+/// The difference of the task times is the overlap gain; the time of the
+/// FIFO read in the task and the age of the newest sample when the
+/// estimator gets it are reported too, the latter being one tick more with
+/// MPU_FIFO_ASYNC. Sample times are those of the driver, the newest packet
+/// stamped at the FIFO count read. The gyro samples of the simulated chip
+/// count up, so that every sample lost or repeated between the FIFO and
+/// the estimator is counted: the tool exits with status 1 if any, or on
+/// FIFO overflows or bus errors.
+///
+/// Usage:
+/// \code
+///     i2cbench [-r loop Hz] [-c estimator us] [-k bus kHz] [-s setup us]
+///              [-t seconds]
+/// \endcode
+/// Defaults: 200 Hz (5 packets per tick at 1 kHz), 500 us, 400 kHz, 20 us
+/// per transfer, 5 s.
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include "stdafx.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "inc/hw_types.h"
+#include "config.h"
+#include "DCM.h"
+#include "sensor.h"
+#include "timing.h"
+#include "timebase.h"
+#include "i2cdriver.h"
+#include "hostdriver.h"
+#include "i2cbus.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_STATIC
+#undef VAR_STATIC
+#endif
+#define VAR_STATIC static
+
+#define BENCH_SPIN      100     ///< Busy wait at the end of a sleep [us]
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+typedef struct {                        // totals of the run
+    unsigned long ulTicks;              // ticks
+    unsigned long ulSamples;            // samples read
+    unsigned long ulLost;               // samples lost or repeated
+    unsigned long long ullTask;         // task time [us]
+    unsigned long ulTaskMax;            // max task time [us]
+    unsigned long long ullRead;         // FIFO read time in the task [us]
+    unsigned long ulReadMax;            // max FIFO read time [us]
+    long long llAge;                    // age of the newest sample read [us]
+    unsigned long ulAged;               // ticks with a newest sample
+} STRUCT_BENCH;
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+VAR_STATIC STRUCT_SENSOR_BACKEND s_stCheck;     // "mpu6050", checked
+VAR_STATIC const STRUCT_SENSOR_BACKEND * const s_ppstSensors[] = {
+    &s_stCheck                                  // Sensor backends
+};
+VAR_STATIC STRUCT_BENCH s_stBench;              // Totals
+VAR_STATIC tBoolean s_bFirst;                   // No sample read yet
+VAR_STATIC float s_fLastGyro;                   // Last gyro X [steps]
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+static unsigned int Bench_Read( STRUCT_SENSOR_BATCH *pstBatch );
+static void Bench_WaitUntil( unsigned long ulTime );
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Backend "mpu6050", timed and checked
+/// \return  number of samples
+/// \remarks Gyro X of the stand-in MPU-6050 counts up modulo 256: offset
+///          subtracted, consecutive samples differ by 1 or -255.
+///
+///----------------------------------------------------------------------------
+static unsigned int
+Bench_Read(STRUCT_SENSOR_BATCH *pstBatch)
+{
+    unsigned long ulStart, ulTime;
+    unsigned int uiCount, n;
+    float fStep;
+
+    ulStart = Timebase_Us();
+    uiCount = g_stSensorMpu.pfnRead(pstBatch);
+    ulTime = Timebase_Us() - ulStart;
+
+    s_stBench.ullRead += ulTime;
+    if (ulTime > s_stBench.ulReadMax) {
+        s_stBench.ulReadMax = ulTime;
+    }
+    for (n = 0; n < uiCount; n++) {
+        if (!s_bFirst) {
+            fStep = pstBatch->pstSample[n].pfGyro[0] - s_fLastGyro;
+            if ((fabsf(fStep - 1.0f) > 0.01f) && (fabsf(fStep + 255.0f) > 0.01f)) {
+                s_stBench.ulLost++;
+            }
+        }
+        s_fLastGyro = pstBatch->pstSample[n].pfGyro[0];
+        s_bFirst = false;
+    }
+    if (uiCount != 0) {
+        s_stBench.llAge += (long)(ulStart + ulTime -
+                                  pstBatch->pstSample[uiCount - 1].ulTime);
+        s_stBench.ulAged++;
+    }
+    s_stBench.ulSamples += uiCount;
+    return uiCount;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Wait until a time
+/// \return  -
+/// \remarks Sleeps, then spins the last BENCH_SPIN us.
+///
+///----------------------------------------------------------------------------
+static void
+Bench_WaitUntil(unsigned long ulTime)
+{
+    struct timespec stSleep;
+    long lLeft = (long)(ulTime - Timebase_Us());
+
+    if (lLeft > BENCH_SPIN) {
+        stSleep.tv_sec = (lLeft - BENCH_SPIN) / 1000000L;
+        stSleep.tv_nsec = ((lLeft - BENCH_SPIN) % 1000000L) * 1000L;
+        nanosleep(&stSleep, NULL);
+    }
+    while ((long)(ulTime - Timebase_Us()) > 0) {
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    unsigned long ulHz = 200, ulCompute = 500, ulClock = 400, ulSetup = 20;
+    unsigned long ulSeconds = 5, ulTicks, ulTick, ulNext, ulPeriod;
+    unsigned long ulStart, ulTask;
+    STRUCT_I2C_LOAD stLoad;
+    tBoolean bUsage = false;
+    int iResult = 0;
+    int j;
+
+    for (j = 1; j < argc; j++) {
+        if ((strcmp(argv[j], "-r") == 0) && (j + 1 < argc)) {
+            ulHz = strtoul(argv[++j], NULL, 10);
+        } else if ((strcmp(argv[j], "-c") == 0) && (j + 1 < argc)) {
+            ulCompute = strtoul(argv[++j], NULL, 10);
+        } else if ((strcmp(argv[j], "-k") == 0) && (j + 1 < argc)) {
+            ulClock = strtoul(argv[++j], NULL, 10);
+        } else if ((strcmp(argv[j], "-s") == 0) && (j + 1 < argc)) {
+            ulSetup = strtoul(argv[++j], NULL, 10);
+        } else if ((strcmp(argv[j], "-t") == 0) && (j + 1 < argc)) {
+            ulSeconds = strtoul(argv[++j], NULL, 10);
+        } else {
+            bUsage = true;
+        }
+    }
+    if (bUsage || (ulClock == 0) || (ulSeconds == 0)) {
+        fprintf(stderr, "usage: %s [-r loop Hz] [-c estimator us] [-k bus kHz] "
+                "[-s setup us] [-t seconds]\n", argv[0]);
+        return 2;
+    }
+
+    Timebase_Init();
+    Host_Init();
+    if (!Timing_Init((unsigned int)ulHz)) {
+        fprintf(stderr, "%s: invalid loop rate %lu Hz\n", argv[0], ulHz);
+        return 2;
+    }
+    Host_I2CSetBus(ulClock * 1000UL, ulSetup);
+
+    //
+    // Backend "mpu6050" with the checks, offsets taken at boot
+    //
+    s_stCheck = g_stSensorMpu;
+    s_stCheck.pfnRead = Bench_Read;
+    Sensor_Init(s_ppstSensors, sizeof(s_ppstSensors) / sizeof(s_ppstSensors[0]));
+    if (!Sensor_Select("mpu6050")) {
+        fprintf(stderr, "%s: MPU-6050 not started\n", argv[0]);
+        return 1;
+    }
+    while (Sensor_Settled() == false) {
+    }
+
+    memset(&s_stBench, 0, sizeof(s_stBench));
+    s_bFirst = true;
+    Host_I2CSetBus(ulClock * 1000UL, ulSetup);
+    ulPeriod = 1000000UL / Timing_Get()->uiLoopHz;
+    ulTicks = ulSeconds * Timing_Get()->uiLoopHz;
+    ulNext = Timebase_Us();
+    for (ulTick = 0; ulTick < ulTicks; ulTick++) {
+        Bench_WaitUntil(ulNext);
+        ulStart = Timebase_Us();
+        ulNext = ulStart + ulPeriod;
+
+        MatrixUpdate();
+        CompensateDrift();
+        Normalize();
+        Bench_WaitUntil(Timebase_Us() + ulCompute);
+
+        ulTask = Timebase_Us() - ulStart;
+        s_stBench.ullTask += ulTask;
+        if (ulTask > s_stBench.ulTaskMax) {
+            s_stBench.ulTaskMax = ulTask;
+        }
+        s_stBench.ulTicks++;
+    }
+    Host_I2CGetLoad(&stLoad);
+
+    printf("FIFO read         : %s\n", (MPU_FIFO_READ == MPU_FIFO_ASYNC) ?
+           "MPU_FIFO_ASYNC" : "MPU_FIFO_BLOCKING");
+    printf("loop              : %lu Hz, %.2f samples per tick, estimator %lu us\n",
+           (unsigned long)Timing_Get()->uiLoopHz,
+           (double)s_stBench.ulSamples / (double)s_stBench.ulTicks, ulCompute);
+    printf("bus               : %lu kHz, %lu us per transfer, %.1f%% busy, "
+           "%.2f transfers per tick\n", ulClock, ulSetup,
+           100.0 * (double)stLoad.ullBusy / ((double)ulTicks * (double)ulPeriod),
+           (double)stLoad.ulTransfers / (double)s_stBench.ulTicks);
+    printf("task [us]         : mean %8.1f   max %6lu\n",
+           (double)s_stBench.ullTask / (double)s_stBench.ulTicks,
+           s_stBench.ulTaskMax);
+    printf("FIFO read [us]    : mean %8.1f   max %6lu\n",
+           (double)s_stBench.ullRead / (double)s_stBench.ulTicks,
+           s_stBench.ulReadMax);
+    printf("sample age [us]   : mean %8.1f\n", (s_stBench.ulAged != 0) ?
+           (double)s_stBench.llAge / (double)s_stBench.ulAged : 0.0);
+    printf("errors            : %lu samples lost, %lu FIFO overflows, "
+           "%lu bus errors\n", s_stBench.ulLost, stLoad.ulOverflows,
+           I2CErrors());
+
+    if ((s_stBench.ulLost != 0) || (stLoad.ulOverflows != 0) ||
+        (I2CErrors() != 0) || (s_stBench.ulSamples == 0)) {
+        iResult = 1;
+    }
+    return iResult;
+}
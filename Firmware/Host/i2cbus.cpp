@@ -0,0 +1,638 @@
+//============================================================================+
+//
+// $RCSfile: i2cbus.cpp,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief Host stand-in for the I2C driver and the MPU-6050
+///
+/// \file
+/// Replaces i2cdriver.c in the host build, with the same queue of
+/// transfers and the same callbacks: a thread plays the I2C 0 controller
+/// and its interrupt. Each transfer takes the bus for
+/// \code
+///     setup + 9 bits * (slave address + register address [+ slave
+///     address] + data bytes) / clock
+/// \endcode
+/// set by Host_I2CSetBus() (default 400 kHz, 20 us), back to back with the
+/// one before; at its end the thread accesses the registers and calls the
+/// callback, holding the lock of I2CLock(). I2CWrite() and I2CRead() wait
+/// for their transfer as on the target, so that the time of a blocking
+/// read can be compared with that of an asynchronous one (i2cbench.cpp).
+///
+/// The only slave is an MPU-6050 at 0x68, registers only (no DMP memory),
+/// others do not acknowledge:
+/// - the FIFO is filled at 1 kHz / (1 + SMPLRT_DIV) (8 kHz without low
+///   pass), from the time of the last FIFO reset, while USER_CTRL.FIFO_EN
+///   is set, with the sensors of FIFO_EN; 1024 bytes, the oldest packets
+///   are dropped on overflow and INT_STATUS.FIFO_OFLOW is set;
+/// - accelerometers read 0, 0, 1 g at the ACCEL_CONFIG full scale; gyro X,
+///   Y and Z read n, 2n and 3n modulo 256 at packet number n, so that
+///   lost or repeated packets show in the samples;
+/// - FIFO_COUNT and FIFO_R_W follow the FIFO, every other register reads
+///   back what was written, WHO_AM_I 0x68.
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include "stdafx.h"
+
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "inc/hw_types.h"
+#include "timebase.h"
+#include "i2cdriver.h"
+#include "i2cbus.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_STATIC
+#undef VAR_STATIC
+#endif
+#define VAR_STATIC static
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL
+
+#define I2C_BUSY        1       // Result of a transfer not ended yet
+#define I2C_SPIN        100     // Busy wait at the end of a transfer [us]
+
+#define MPU_ADDRESS     0x68    // 7 bit slave address
+#define MPU_FIFO_SIZE   1024    // FIFO [bytes]
+#define MPU_SMPLRT_DIV  0x19
+#define MPU_CONFIG      0x1A
+#define MPU_ACCEL_CONFIG 0x1C
+#define MPU_FIFO_EN     0x23
+#define MPU_INT_STATUS  0x3A
+#define MPU_USER_CTRL   0x6A
+#define MPU_FIFO_COUNTH 0x72
+#define MPU_FIFO_COUNTL 0x73
+#define MPU_FIFO_R_W    0x74
+#define MPU_WHO_AM_I    0x75
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+typedef struct {                // Queued transfer, as in i2cdriver.c
+    unsigned char ucSlave;      // 7 bit slave address
+    unsigned char ucReg;        // first register
+    unsigned char ucLength;     // data bytes
+    tBoolean bRead;             // read, else write
+    unsigned char *pucData;     // data
+    I2C_DONE pfnDone;           // callback, 0 if none
+    void *pvArg;                // callback argument
+} STRUCT_I2C_XFER;
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+VAR_STATIC pthread_mutex_t s_stQueueMutex = PTHREAD_MUTEX_INITIALIZER;
+VAR_STATIC pthread_cond_t s_stQueueCond = PTHREAD_COND_INITIALIZER;
+VAR_STATIC pthread_cond_t s_stDoneCond = PTHREAD_COND_INITIALIZER;
+VAR_STATIC pthread_mutex_t s_stIrqMutex = PTHREAD_MUTEX_INITIALIZER;
+VAR_STATIC pthread_once_t s_stOnce = PTHREAD_ONCE_INIT;
+VAR_STATIC STRUCT_I2C_XFER s_pstQueue[I2C_QUEUE];   // Transfers, head first
+VAR_STATIC unsigned char s_ucHead = 0;          // Transfer on the bus
+VAR_STATIC unsigned char s_ucTail = 0;          // Next free entry
+VAR_STATIC unsigned long s_ulErrors = 0;        // Failed transfers
+VAR_STATIC unsigned long s_ulClock = 400000;    // Bus clock [Hz]
+VAR_STATIC unsigned long s_ulSetup = 20;        // Time per transfer [us]
+VAR_STATIC STRUCT_I2C_LOAD s_stLoad;            // Bus load
+
+VAR_STATIC unsigned char s_pucReg[128];         // MPU-6050 registers
+VAR_STATIC unsigned char s_pucFifo[MPU_FIFO_SIZE];  // MPU-6050 FIFO ring
+VAR_STATIC unsigned int s_uiFifoRead = 0;       // FIFO ring read index
+VAR_STATIC unsigned int s_uiFifoCount = 0;      // Bytes in the FIFO
+VAR_STATIC unsigned long long s_ullNext = 0;    // Time of the next sample
+VAR_STATIC unsigned long s_ulPacket = 0;        // Packets sampled
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+static void I2CStartThread( void );
+static void *I2CThread( void *pvArg );
+static int I2CQueue( const STRUCT_I2C_XFER *pstXfer );
+static int I2CWait( STRUCT_I2C_XFER *pstXfer );
+static void I2CBlockingDone( int iResult, void *pvArg );
+static void Mpu_Reset( void );
+static void Mpu_Sample( unsigned long long ullNow );
+static void Mpu_Write( unsigned char ucReg, unsigned char ucValue,
+                       unsigned long long ullNow );
+static unsigned char Mpu_Read( unsigned char ucReg );
+
+///----------------------------------------------------------------------------
+///
+/// \brief   I2C initialization
+/// \return  -
+/// \remarks Starts the bus thread, resets the MPU-6050. Call after
+///          Timebase_Init().
+///
+///----------------------------------------------------------------------------
+void
+I2CInit(void)
+{
+    pthread_once(&s_stOnce, I2CStartThread);
+    pthread_mutex_lock(&s_stIrqMutex);
+    Mpu_Reset();
+    pthread_mutex_unlock(&s_stIrqMutex);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Write registers
+/// \return  0 on success, -1 on error
+/// \remarks Waits for the transfer, as i2cdriver.c.
+///
+///----------------------------------------------------------------------------
+int
+I2CWrite(unsigned char ucSlave, unsigned char ucReg,
+         unsigned char ucLength, const unsigned char *pucData)
+{
+    STRUCT_I2C_XFER stXfer;
+
+    stXfer.ucSlave = ucSlave;
+    stXfer.ucReg = ucReg;
+    stXfer.ucLength = ucLength;
+    stXfer.bRead = false;
+    stXfer.pucData = (unsigned char *)pucData;
+    return I2CWait(&stXfer);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Read registers
+/// \return  0 on success, -1 on error
+/// \remarks Waits for the transfer, as i2cdriver.c.
+///
+///----------------------------------------------------------------------------
+int
+I2CRead(unsigned char ucSlave, unsigned char ucReg,
+        unsigned char ucLength, unsigned char *pucData)
+{
+    STRUCT_I2C_XFER stXfer;
+
+    if (ucLength == 0) {
+        return 0;
+    }
+    stXfer.ucSlave = ucSlave;
+    stXfer.ucReg = ucReg;
+    stXfer.ucLength = ucLength;
+    stXfer.bRead = true;
+    stXfer.pucData = pucData;
+    return I2CWait(&stXfer);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Queue a register write
+/// \return  0 if queued, -1 if the queue is full
+/// \remarks pfnDone() is called by the bus thread.
+///
+///----------------------------------------------------------------------------
+int
+I2CWriteAsync(unsigned char ucSlave, unsigned char ucReg,
+              unsigned char ucLength, const unsigned char *pucData,
+              I2C_DONE pfnDone, void *pvArg)
+{
+    STRUCT_I2C_XFER stXfer;
+
+    stXfer.ucSlave = ucSlave;
+    stXfer.ucReg = ucReg;
+    stXfer.ucLength = ucLength;
+    stXfer.bRead = false;
+    stXfer.pucData = (unsigned char *)pucData;
+    stXfer.pfnDone = pfnDone;
+    stXfer.pvArg = pvArg;
+    return I2CQueue(&stXfer);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Queue a register read
+/// \return  0 if queued, -1 if the queue is full or ucLength is 0
+/// \remarks pfnDone() is called by the bus thread.
+///
+///----------------------------------------------------------------------------
+int
+I2CReadAsync(unsigned char ucSlave, unsigned char ucReg,
+             unsigned char ucLength, unsigned char *pucData,
+             I2C_DONE pfnDone, void *pvArg)
+{
+    STRUCT_I2C_XFER stXfer;
+
+    if (ucLength == 0) {
+        return -1;
+    }
+    stXfer.ucSlave = ucSlave;
+    stXfer.ucReg = ucReg;
+    stXfer.ucLength = ucLength;
+    stXfer.bRead = true;
+    stXfer.pucData = pucData;
+    stXfer.pfnDone = pfnDone;
+    stXfer.pvArg = pvArg;
+    return I2CQueue(&stXfer);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Transfers not ended yet
+/// \return  number of queued transfers, the one on the bus included
+/// \remarks The simulated bus does not hang: no timeout.
+///
+///----------------------------------------------------------------------------
+unsigned char
+I2CPending(void)
+{
+    unsigned char ucPending;
+
+    pthread_mutex_lock(&s_stQueueMutex);
+    ucPending = (unsigned char)((s_ucTail - s_ucHead) & (I2C_QUEUE - 1));
+    pthread_mutex_unlock(&s_stQueueMutex);
+    return ucPending;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Enter a section shared with the transfer callbacks
+/// \return  -
+/// \remarks Waits for the callback running, if any.
+///
+///----------------------------------------------------------------------------
+void
+I2CLock(void)
+{
+    pthread_mutex_lock(&s_stIrqMutex);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Leave a section shared with the transfer callbacks
+/// \return  -
+/// \remarks
+///
+///----------------------------------------------------------------------------
+void
+I2CUnlock(void)
+{
+    pthread_mutex_unlock(&s_stIrqMutex);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Interface to the error counter.
+/// \return  number of failed transfers
+/// \remarks Transfers to slaves other than the MPU-6050.
+///
+///----------------------------------------------------------------------------
+unsigned long
+I2CErrors(void)
+{
+    return s_ulErrors;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Set the bus latency
+/// \return  -
+/// \remarks ulClock bus clock [Hz], ulSetup fixed time per transfer [us].
+///          Clears the load counters.
+///
+///----------------------------------------------------------------------------
+void
+Host_I2CSetBus(unsigned long ulClock, unsigned long ulSetup)
+{
+    pthread_mutex_lock(&s_stIrqMutex);
+    s_ulClock = (ulClock != 0) ? ulClock : 1;
+    s_ulSetup = ulSetup;
+    memset(&s_stLoad, 0, sizeof(s_stLoad));
+    pthread_mutex_unlock(&s_stIrqMutex);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Get the bus load
+/// \return  -
+/// \remarks Since the last Host_I2CSetBus().
+///
+///----------------------------------------------------------------------------
+void
+Host_I2CGetLoad(STRUCT_I2C_LOAD *pstLoad)
+{
+    pthread_mutex_lock(&s_stIrqMutex);
+    *pstLoad = s_stLoad;
+    pthread_mutex_unlock(&s_stIrqMutex);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Start the bus thread
+/// \return  -
+/// \remarks Once, from I2CInit().
+///
+///----------------------------------------------------------------------------
+static void
+I2CStartThread(void)
+{
+    pthread_t stThread;
+
+    pthread_create(&stThread, NULL, I2CThread, NULL);
+    pthread_detach(stThread);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Bus thread: I2C 0 controller and interrupt
+/// \return  -
+/// \remarks Waits for the end time of the transfer at the head of the
+///          queue, sleeping then spinning the last I2C_SPIN us, then
+///          accesses the registers and calls the callback.
+///
+///----------------------------------------------------------------------------
+static void *
+I2CThread(void *pvArg)
+{
+    STRUCT_I2C_XFER stXfer;
+    unsigned long long ullStart, ullEnd, ullNow;
+    unsigned long ulBytes;
+    struct timespec stSleep;
+    unsigned char j;
+    int iResult;
+
+    ullEnd = 0;
+    for (;;) {
+        pthread_mutex_lock(&s_stQueueMutex);
+        while (s_ucHead == s_ucTail) {
+            pthread_cond_wait(&s_stQueueCond, &s_stQueueMutex);
+        }
+        stXfer = s_pstQueue[s_ucHead];
+        pthread_mutex_unlock(&s_stQueueMutex);
+
+        //
+        // Back to back with the transfer before, if still on the bus
+        //
+        ullStart = Timebase_Us64();
+        if (ullStart < ullEnd) {
+            ullStart = ullEnd;
+        }
+        ulBytes = 2UL + (stXfer.bRead ? 1UL : 0UL) + stXfer.ucLength;
+        ullEnd = ullStart + s_ulSetup +
+                 (ulBytes * 9ULL * 1000000ULL + s_ulClock - 1) / s_ulClock;
+        ullNow = Timebase_Us64();
+        if (ullEnd > ullNow + I2C_SPIN) {
+            stSleep.tv_sec = (time_t)((ullEnd - ullNow - I2C_SPIN) / 1000000ULL);
+            stSleep.tv_nsec = (long)(((ullEnd - ullNow - I2C_SPIN) % 1000000ULL) * 1000ULL);
+            nanosleep(&stSleep, NULL);
+        }
+        while (Timebase_Us64() < ullEnd) {
+        }
+
+        //
+        // End of the transfer, in "interrupt"
+        //
+        pthread_mutex_lock(&s_stIrqMutex);
+        iResult = 0;
+        if (stXfer.ucSlave != MPU_ADDRESS) {
+            s_ulErrors++;
+            iResult = -1;
+        } else {
+            Mpu_Sample(ullEnd);
+            for (j = 0; j < stXfer.ucLength; j++) {
+                if (stXfer.bRead) {
+                    stXfer.pucData[j] = Mpu_Read(stXfer.ucReg);
+                } else {
+                    Mpu_Write(stXfer.ucReg, stXfer.pucData[j], ullEnd);
+                }
+                if ((stXfer.ucReg != MPU_FIFO_R_W) && (stXfer.ucReg < 127)) {
+                    stXfer.ucReg++;
+                }
+            }
+        }
+        s_stLoad.ulTransfers++;
+        s_stLoad.ulBytes += ulBytes;
+        s_stLoad.ullBusy += ullEnd - ullStart;
+
+        pthread_mutex_lock(&s_stQueueMutex);
+        s_ucHead = (s_ucHead + 1) & (I2C_QUEUE - 1);
+        pthread_mutex_unlock(&s_stQueueMutex);
+        if (stXfer.pfnDone != 0) {
+            stXfer.pfnDone(iResult, stXfer.pvArg);
+        }
+        pthread_mutex_unlock(&s_stIrqMutex);
+    }
+    return NULL;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Queue a transfer
+/// \return  0 if queued, -1 if the queue is full
+/// \remarks From the tasks and from the callbacks.
+///
+///----------------------------------------------------------------------------
+static int
+I2CQueue(const STRUCT_I2C_XFER *pstXfer)
+{
+    int iResult = -1;
+
+    pthread_mutex_lock(&s_stQueueMutex);
+    if (((s_ucTail + 1) & (I2C_QUEUE - 1)) != s_ucHead) {
+        s_pstQueue[s_ucTail] = *pstXfer;
+        s_ucTail = (s_ucTail + 1) & (I2C_QUEUE - 1);
+        pthread_cond_signal(&s_stQueueCond);
+        iResult = 0;
+    }
+    pthread_mutex_unlock(&s_stQueueMutex);
+    return iResult;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Queue a transfer and wait for its end
+/// \return  0 on success, -1 on error
+/// \remarks Not from the callbacks.
+///
+///----------------------------------------------------------------------------
+static int
+I2CWait(STRUCT_I2C_XFER *pstXfer)
+{
+    volatile int iResult = I2C_BUSY;
+
+    pstXfer->pfnDone = I2CBlockingDone;
+    pstXfer->pvArg = (void *)&iResult;
+    if (I2CQueue(pstXfer) != 0) {
+        return -1;
+    }
+    pthread_mutex_lock(&s_stQueueMutex);
+    while (iResult == I2C_BUSY) {
+        pthread_cond_wait(&s_stDoneCond, &s_stQueueMutex);
+    }
+    pthread_mutex_unlock(&s_stQueueMutex);
+    return iResult;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Callback of the blocking transfers
+/// \return  -
+/// \remarks pvArg points to the result the caller waits on.
+///
+///----------------------------------------------------------------------------
+static void
+I2CBlockingDone(int iResult, void *pvArg)
+{
+    pthread_mutex_lock(&s_stQueueMutex);
+    *(volatile int *)pvArg = iResult;
+    pthread_cond_broadcast(&s_stDoneCond);
+    pthread_mutex_unlock(&s_stQueueMutex);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   MPU-6050 power on
+/// \return  -
+/// \remarks Registers at their reset values, FIFO empty.
+///
+///----------------------------------------------------------------------------
+static void
+Mpu_Reset(void)
+{
+    memset(s_pucReg, 0, sizeof(s_pucReg));
+    s_pucReg[0x6B] = 0x40;                      // PWR_MGMT_1, sleep
+    s_pucReg[MPU_WHO_AM_I] = MPU_ADDRESS;
+    s_uiFifoRead = 0;
+    s_uiFifoCount = 0;
+    s_ullNext = Timebase_Us64();
+    s_ulPacket = 0;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   MPU-6050 sampling up to now
+/// \return  -
+/// \remarks Pushes the packets sampled since the last call into the FIFO.
+///
+///----------------------------------------------------------------------------
+static void
+Mpu_Sample(unsigned long long ullNow)
+{
+    unsigned char pucPacket[12];
+    unsigned long ulPeriod;
+    unsigned int uiLength, i;
+    unsigned char ucEnable = s_pucReg[MPU_FIFO_EN];
+    short sGravity = (short)(16384 >> ((s_pucReg[MPU_ACCEL_CONFIG] >> 3) & 3));
+    short psValue[6];
+    int c;
+
+    ulPeriod = (((s_pucReg[MPU_CONFIG] & 7) == 0) || ((s_pucReg[MPU_CONFIG] & 7) == 7)) ?
+               125UL : 1000UL;
+    ulPeriod *= 1UL + s_pucReg[MPU_SMPLRT_DIV];
+
+    for (; s_ullNext <= ullNow; s_ullNext += ulPeriod) {
+        if (((s_pucReg[MPU_USER_CTRL] & 0x40) == 0) || ((ucEnable & 0x78) == 0)) {
+            continue;
+        }
+        psValue[0] = 0;
+        psValue[1] = 0;
+        psValue[2] = sGravity;
+        for (c = 0; c < 3; c++) {
+            psValue[3 + c] = (short)((s_ulPacket * (c + 1)) & 0xFF);
+        }
+        s_ulPacket++;
+        s_stLoad.ulPackets++;
+
+        uiLength = 0;
+        if (ucEnable & 0x08) {                  // ACCEL_FIFO_EN
+            for (c = 0; c < 3; c++) {
+                pucPacket[uiLength++] = (unsigned char)(psValue[c] >> 8);
+                pucPacket[uiLength++] = (unsigned char)psValue[c];
+            }
+        }
+        for (c = 0; c < 3; c++) {               // XG, YG, ZG_FIFO_EN
+            if (ucEnable & (0x40 >> c)) {
+                pucPacket[uiLength++] = (unsigned char)(psValue[3 + c] >> 8);
+                pucPacket[uiLength++] = (unsigned char)psValue[3 + c];
+            }
+        }
+
+        //
+        // Full: the oldest bytes are dropped
+        //
+        if (s_uiFifoCount + uiLength > MPU_FIFO_SIZE) {
+            i = s_uiFifoCount + uiLength - MPU_FIFO_SIZE;
+            s_uiFifoRead = (s_uiFifoRead + i) % MPU_FIFO_SIZE;
+            s_uiFifoCount -= i;
+            s_pucReg[MPU_INT_STATUS] |= 0x10;   // FIFO_OFLOW_INT
+            s_stLoad.ulOverflows++;
+        }
+        for (i = 0; i < uiLength; i++) {
+            s_pucFifo[(s_uiFifoRead + s_uiFifoCount) % MPU_FIFO_SIZE] = pucPacket[i];
+            s_uiFifoCount++;
+        }
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   MPU-6050 register write
+/// \return  -
+/// \remarks USER_CTRL.FIFO_RESET empties the FIFO and restarts sampling.
+///
+///----------------------------------------------------------------------------
+static void
+Mpu_Write(unsigned char ucReg, unsigned char ucValue, unsigned long long ullNow)
+{
+    if (ucReg == MPU_FIFO_R_W) {
+        return;
+    }
+    if ((ucReg == MPU_USER_CTRL) && (ucValue & 0x04)) {
+        s_uiFifoRead = 0;
+        s_uiFifoCount = 0;
+        s_ullNext = ullNow;
+        ucValue &= ~0x04;
+    }
+    s_pucReg[ucReg & 0x7F] = ucValue;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   MPU-6050 register read
+/// \return  register value
+/// \remarks FIFO_R_W pops a FIFO byte, INT_STATUS is cleared by the read.
+///
+///----------------------------------------------------------------------------
+static unsigned char
+Mpu_Read(unsigned char ucReg)
+{
+    unsigned char ucValue;
+
+    switch (ucReg) {
+    case MPU_FIFO_COUNTH:
+        return (unsigned char)(s_uiFifoCount >> 8);
+    case MPU_FIFO_COUNTL:
+        return (unsigned char)s_uiFifoCount;
+    case MPU_FIFO_R_W:
+        if (s_uiFifoCount == 0) {
+            return 0;
+        }
+        ucValue = s_pucFifo[s_uiFifoRead];
+        s_uiFifoRead = (s_uiFifoRead + 1) % MPU_FIFO_SIZE;
+        s_uiFifoCount--;
+        return ucValue;
+    case MPU_INT_STATUS:
+        ucValue = s_pucReg[MPU_INT_STATUS];
+        s_pucReg[MPU_INT_STATUS] = 0;
+        return ucValue;
+    default:
+        return s_pucReg[ucReg & 0x7F];
+    }
+}
@@ -0,0 +1,46 @@
+//============================================================================
+//
+// $RCSfile: i2cbus.h,v $ (HEADER FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief Host stand-in for the I2C driver and the MPU-6050
+///
+/// \file
+/// The host build links i2cbus.cpp instead of i2cdriver.c: same interface
+/// (i2cdriver.h), on a simulated bus with the latency set here.
+///
+//  CHANGES
+//
+//============================================================================
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL extern
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+typedef struct {                    // bus load since Host_I2CSetBus()
+    unsigned long ulTransfers;      // transfers ended
+    unsigned long ulBytes;          // bytes on the bus, addresses included
+    unsigned long long ullBusy;     // time the bus was busy [us]
+    unsigned long ulPackets;        // packets sampled by the MPU-6050
+    unsigned long ulOverflows;      // packets dropped on FIFO overflow
+} STRUCT_I2C_LOAD;
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*---------------------------------- Interface -------------------------------*/
+
+void Host_I2CSetBus ( unsigned long ulClock, unsigned long ulSetup );
+void Host_I2CGetLoad ( STRUCT_I2C_LOAD *pstLoad );
@@ -0,0 +1,78 @@
+//============================================================================
+//
+// $RCSfile: hw_types.h,v $ (HEADER FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief Host stand-in for StellarisWare inc/hw_types.h
+///
+/// \file
+/// Only the subset used by the estimator and control modules is provided.
+/// Register access macros work on plain memory: HWREGBITW() sets or reads a
+/// single bit of a variable instead of using the Cortex-M3 bit-band alias.
+///
+//  CHANGES
+//
+//============================================================================
+
+#ifndef __HW_TYPES_H__
+#define __HW_TYPES_H__
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifndef HOST_BUILD
+#define HOST_BUILD
+#endif
+
+/*----------------------------------- Types ----------------------------------*/
+
+typedef unsigned char tBoolean;
+
+#ifndef __cplusplus
+#ifndef true
+#define true 1
+#endif
+#ifndef false
+#define false 0
+#endif
+#endif
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#ifdef __cplusplus
+//
+// Reference to a single bit of a word, replaces the bit-band alias
+//
+class tBitRef {
+public:
+    tBitRef(volatile unsigned long *pulWord, unsigned long ulBit) :
+        m_pulWord(pulWord), m_ulMask(1UL << ulBit) { }
+    operator unsigned long() const {
+        return ((*m_pulWord & m_ulMask) != 0) ? 1UL : 0UL;
+    }
+    tBitRef & operator=(unsigned long ulValue) {
+        if (ulValue) { *m_pulWord |= m_ulMask; } else { *m_pulWord &= ~m_ulMask; }
+        return *this;
+    }
+private:
+    volatile unsigned long *m_pulWord;
+    unsigned long m_ulMask;
+};
+#endif
+
+/*----------------------------------- Macros ---------------------------------*/
+
+#define HWREG(x)            (*((volatile unsigned long *)(x)))
+#define HWREGH(x)           (*((volatile unsigned short *)(x)))
+#define HWREGB(x)           (*((volatile unsigned char *)(x)))
+#ifdef __cplusplus
+#define HWREGBITW(x, b)     tBitRef((volatile unsigned long *)(x), (b))
+#endif
+
+#endif // __HW_TYPES_H__
@@ -0,0 +1,254 @@
+//============================================================================+
+//
+// $RCSfile: logsynth.cpp,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief Synthetic log generator for the replay benchmark
+///
+/// \file
+/// Writes to stdout a log in the format of log.txt, for use when no flight
+/// log is at hand. The aircraft flies a slow left turn at 15 m/s while
+/// rolling +/-20 deg and pitching +/-5 deg; gyro and accelerometer data are
+/// scaled to ADC steps with GYRO_GAIN and GRAVITY, a constant gyro bias and
+/// a deterministic pseudo-random noise are added. A $GPRMC sentence is
+/// written every second and, as Log_DCM() does, the true attitude every
+/// 160 ms. Output is identical on every run.
+///
+/// With -s n the sensors are written n times per 20 ms tick, as acquired
+/// by the ADC with GYRO_SUBSTEPS = n (replay with -s n). With -c a the
+/// roll and pitch oscillations get a coning motion of amplitude a degrees
+/// at CONING_FREQUENCY, which a single gyro sample per tick cannot follow.
+///
+/// Usage:
+/// \code
+///     logsynth [-s substeps] [-c coning] [seconds] > log.txt
+/// \endcode
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include "stdafx.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "config.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_STATIC
+#undef VAR_STATIC
+#endif
+#define VAR_STATIC static
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL
+
+#define LOG_RATE        50          ///< Sensor records per second
+#define AIRSPEED        15.0        ///< Speed over ground [m/s]
+#define TURN_RATE       3.0         ///< Heading rate [deg/s]
+#define ROLL_AMPLITUDE  20.0        ///< Roll oscillation amplitude [deg]
+#define ROLL_FREQUENCY  0.2         ///< Roll oscillation frequency [Hz]
+#define PITCH_AMPLITUDE 5.0         ///< Pitch oscillation amplitude [deg]
+#define PITCH_FREQUENCY 0.13        ///< Pitch oscillation frequency [Hz]
+#define NOISE_STEPS     3           ///< Peak sensor noise [ADC steps]
+#define DCM_DIVIDER     8           ///< Ticks per DCM record
+#define CONING_FREQUENCY 10.0       ///< Coning motion frequency [Hz]
+
+/*----------------------------------- Macros ---------------------------------*/
+
+#define DEG2RAD(x)      ((x) * 3.14159265358979 / 180.0)
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+/*---------------------------------- Constants -------------------------------*/
+
+VAR_STATIC const double pdGyroBias[3] = { 2.0, -3.0, 1.0 }; // [ADC steps]
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+VAR_STATIC unsigned long s_ulSeed = 12345UL;
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Deterministic noise
+/// \return  integer noise between -NOISE_STEPS and NOISE_STEPS
+/// \remarks 32 bit linear congruential generator
+///
+///----------------------------------------------------------------------------
+static int
+Noise(void)
+{
+    s_ulSeed = (s_ulSeed * 1664525UL + 1013904223UL) & 0xFFFFFFFFUL;
+    return (int)((s_ulSeed >> 16) % (2 * NOISE_STEPS + 1)) - NOISE_STEPS;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Write a sensor value as Log_Sensors() does
+/// \return  -
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static void
+Put_Sensor(double dValue)
+{
+    long lSensor = (long)ceil(dValue);
+
+    printf(" %04lX", (unsigned long)lSensor & 0xFFFFUL);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Write the attitude as Log_DCM() does
+/// \return  -
+/// \remarks DCM from Euler angles, rotation order yaw, pitch, roll
+///
+///----------------------------------------------------------------------------
+static void
+Put_DCM(double phi, double theta, double psi)
+{
+    double pdDCM[3][3];
+    int iRow, iCol;
+
+    pdDCM[0][0] = cos(theta) * cos(psi);
+    pdDCM[0][1] = sin(phi) * sin(theta) * cos(psi) - cos(phi) * sin(psi);
+    pdDCM[0][2] = cos(phi) * sin(theta) * cos(psi) + sin(phi) * sin(psi);
+    pdDCM[1][0] = cos(theta) * sin(psi);
+    pdDCM[1][1] = sin(phi) * sin(theta) * sin(psi) + cos(phi) * cos(psi);
+    pdDCM[1][2] = cos(phi) * sin(theta) * sin(psi) - sin(phi) * cos(psi);
+    pdDCM[2][0] = -sin(theta);
+    pdDCM[2][1] = sin(phi) * cos(theta);
+    pdDCM[2][2] = cos(phi) * cos(theta);
+
+    printf("*");
+    for (iRow = 0; iRow < 3; iRow++) {
+        for (iCol = 0; iCol < 3; iCol++) {
+            printf(" %04lX", (unsigned long)(long)ceil(pdDCM[iRow][iCol] * 32767.0) & 0xFFFFUL);
+        }
+    }
+    printf("\n");
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   main program
+/// \return  0
+/// \remarks
+///
+///----------------------------------------------------------------------------
+int
+main(int argc, char *argv[])
+{
+    unsigned long ulSample, ulSamples, ulTick;
+    unsigned long ulSubsteps = 1, ulSeconds = 600;
+    double t, phi, theta, psi, dphi, dtheta, dpsi;
+    double p, q, r, ax, ay, az;
+    double dHeading, dConing = 0.0, w;
+    unsigned long ulSecond;
+    int j;
+
+    for (j = 1; j < argc; j++) {
+        if ((strcmp(argv[j], "-s") == 0) && (j + 1 < argc)) {
+            ulSubsteps = strtoul(argv[++j], NULL, 10);
+        } else if ((strcmp(argv[j], "-c") == 0) && (j + 1 < argc)) {
+            dConing = strtod(argv[++j], NULL);
+        } else if (argv[j][0] != '-') {
+            ulSeconds = strtoul(argv[j], NULL, 10);
+        } else {
+            ulSubsteps = 0;
+            break;
+        }
+    }
+    if (ulSubsteps == 0) {
+        fprintf(stderr, "usage: %s [-s substeps] [-c coning] [seconds]\n", argv[0]);
+        return 2;
+    }
+    ulSamples = LOG_RATE * ulSubsteps * ulSeconds;
+
+    for (ulSample = 0; ulSample < ulSamples; ulSample++) {
+        t = (double)ulSample / (LOG_RATE * ulSubsteps);
+
+        //
+        // Attitude and Euler angle rates
+        //
+        phi    = DEG2RAD(ROLL_AMPLITUDE) * sin(2.0 * 3.14159265358979 * ROLL_FREQUENCY * t);
+        dphi   = DEG2RAD(ROLL_AMPLITUDE) * 2.0 * 3.14159265358979 * ROLL_FREQUENCY *
+                 cos(2.0 * 3.14159265358979 * ROLL_FREQUENCY * t);
+        theta  = DEG2RAD(PITCH_AMPLITUDE) * sin(2.0 * 3.14159265358979 * PITCH_FREQUENCY * t);
+        dtheta = DEG2RAD(PITCH_AMPLITUDE) * 2.0 * 3.14159265358979 * PITCH_FREQUENCY *
+                 cos(2.0 * 3.14159265358979 * PITCH_FREQUENCY * t);
+        dpsi   = DEG2RAD(TURN_RATE);
+        psi    = dpsi * t;
+
+        if (dConing != 0.0) {
+            w = 2.0 * 3.14159265358979 * CONING_FREQUENCY;
+            phi    += DEG2RAD(dConing) * sin(w * t);
+            dphi   += DEG2RAD(dConing) * w * cos(w * t);
+            theta  += DEG2RAD(dConing) * cos(w * t);
+            dtheta -= DEG2RAD(dConing) * w * sin(w * t);
+        }
+
+        //
+        // Body rates
+        //
+        p = dphi - dpsi * sin(theta);
+        q = dtheta * cos(phi) + dpsi * sin(phi) * cos(theta);
+        r = -dtheta * sin(phi) + dpsi * cos(phi) * cos(theta);
+
+        //
+        // Gravity in body axes (last row of DCM)
+        //
+        ax = -sin(theta) * GRAVITY;
+        ay = sin(phi) * cos(theta) * GRAVITY;
+        az = cos(phi) * cos(theta) * GRAVITY;
+
+        printf("^");
+        Put_Sensor(ax + Noise());
+        Put_Sensor(ay + Noise());
+        Put_Sensor(az + Noise());
+        Put_Sensor((p / GYRO_GAIN) + pdGyroBias[0] + Noise());
+        Put_Sensor((q / GYRO_GAIN) + pdGyroBias[1] + Noise());
+        Put_Sensor((r / GYRO_GAIN) + pdGyroBias[2] + Noise());
+        printf("\n");
+
+        //
+        // Once per tick, after the last ADC sample
+        //
+        if ((ulSample % ulSubsteps) != (ulSubsteps - 1)) {
+            continue;
+        }
+        ulTick = ulSample / ulSubsteps;
+
+        //
+        // True attitude
+        //
+        if ((ulTick % DCM_DIVIDER) == (DCM_DIVIDER - 1)) {
+            Put_DCM(phi, theta, psi);
+        }
+
+        //
+        // GPS sentence once per second
+        //
+        if ((ulTick % LOG_RATE) == (LOG_RATE - 1)) {
+            ulSecond = ulTick / LOG_RATE;
+            dHeading = fmod(psi * 180.0 / 3.14159265358979, 360.0);
+            printf("$GPRMC,%02lu%02lu%02lu.00,A,4534.6714,N,01128.8559,E,%05.1f,%05.1f,091008,001.9,E,A*00\n",
+                   (ulSecond / 3600) % 24, (ulSecond / 60) % 60, ulSecond % 60,
+                   AIRSPEED * 3600.0 / 1852.0, dHeading);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,616 @@
+//============================================================================+
+//
+// $RCSfile: replay.cpp,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief Deterministic log replay benchmark for the estimator and controls
+///
+/// \file
+/// Feeds a log.txt written by the firmware through the 20 ms control tick:
+/// - "^" records (Log_Sensors) are returned by ADCGetData() and trigger
+///   MatrixUpdate(), CompensateDrift(), Normalize(), Aileron_Control() and
+///   Elevator_Control(), in the same order as main();
+/// - with -s n, the log holds n "^" records per control tick, as acquired
+///   by the ADC with GYRO_SUBSTEPS: all of them are queued as gyro samples
+///   (ADCGetGyroSamples) and every n-th triggers the control tick;
+/// - "$GPRMC" sentences (logged by GPSParse) are queued in the GPS UART
+///   stand-in and parsed character by character by GPSParse();
+/// - "*" records (Log_DCM) are kept as reference attitude of the preceding
+///   sensor record;
+/// - "@" records (GPSParse) give the time of the next GPS sentence;
+/// - every other record (PPM, ...) is ignored.
+///
+/// When the sensor records end with a time stamp (Log_Stamp) the control
+/// tick integrates over the logged interval, as Task_Control() does on
+/// board, instead of the nominal one; logs without stamps replay at the
+/// nominal rate.
+///
+/// The whole log is read before the run so that file I/O is not timed.
+/// After the run the tool reports samples per second and, from the profiler
+/// probes (profile.c), ns per stage with their log2 histogram, and
+/// optionally writes (-w) or compares against (-g) a golden output file
+/// holding, for each sensor record, DCM_Matrix, Omega_Vector, Ailerons() and
+/// Elevator() as raw floats. The comparison is bit-exact: any difference is
+/// reported with the first differing sample and the largest deviation, and
+/// the tool exits with status 1, together with the max and rms deviation
+/// of DCM entries, Omega_Vector, control surfaces and Euler angles.
+/// When the log holds "*" records the max and rms deviation of the Euler
+/// angles from them is reported as well: on a flight log this is the
+/// distance from the on-board estimator, on a logsynth log the error from
+/// the true attitude.
+///
+/// Usage:
+/// \code
+///     replay [-w golden.bin] [-g golden.bin] [-r passes] [-s substeps] log.txt
+/// \endcode
+/// With -r the log is replayed several times to stabilize timings; only
+/// the outputs of the first pass are written or compared. Timings and
+/// outputs are per control tick.
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include "stdafx.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "inc/hw_types.h"
+#include "config.h"
+#include "DCM.h"
+#include "adcdriver.h"
+#include "gps.h"
+#include "AileronCtrl.h"
+#include "elevatorctrl.h"
+#include "hostdriver.h"
+#include "profile.h"
+#include "timing.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_STATIC
+#undef VAR_STATIC
+#endif
+#define VAR_STATIC static
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL
+
+#define LINE_LENGTH     128     ///< Longest accepted log line
+#define GPS_LENGTH      80      ///< Longest GPS sentence, as in GPS.cpp
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+typedef enum {          // replayed event
+    EV_SENSOR,          // sensor record, runs a control tick
+    EV_GYRO,            // sensor record between control ticks
+    EV_GPS              // GPS sentence
+} ENUM_EVENT;
+
+/*----------------------------------- Types ----------------------------------*/
+
+typedef struct {            // replayed event
+    ENUM_EVENT eType;       // event type
+    unsigned long ulTime;   // logged time [us], 0 if not stamped
+    short psSensor[6];      // sensor values (EV_SENSOR, EV_GYRO)
+    char szGps[GPS_LENGTH + 2]; // GPS sentence with '\n' (EV_GPS)
+} STRUCT_EVENT;
+
+typedef struct {            // outputs of one control tick
+    float fDCM[3][3];       // DCM_Matrix
+    float fOmega[3];        // Omega_Vector
+    float fAileron;         // Ailerons()
+    float fElevator;        // Elevator()
+} STRUCT_OUTPUT;
+
+typedef struct {            // reference attitude ("*" record)
+    unsigned long ulSample; // index of the preceding sensor record
+    float fDCM[3][3];       // logged DCM_Matrix
+} STRUCT_REFERENCE;
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+VAR_STATIC STRUCT_EVENT *s_pstEvent = NULL;     // replayed events
+VAR_STATIC unsigned long s_ulEvents = 0;        // number of events
+VAR_STATIC tBoolean s_bStamped = false;         // sensor records have times
+VAR_STATIC unsigned long s_ulSamples = 0;       // number of control ticks
+VAR_STATIC unsigned int s_uiSubsteps = 1;       // sensor records per tick
+VAR_STATIC STRUCT_OUTPUT *s_pstOutput = NULL;   // outputs of first pass
+VAR_STATIC STRUCT_REFERENCE *s_pstReference = NULL; // reference attitudes
+VAR_STATIC unsigned long s_ulReferences = 0;    // number of references
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Monotonic time
+/// \return  time in ns
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static inline unsigned long long
+Now(void)
+{
+    struct timespec stTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &stTime);
+    return ((unsigned long long)stTime.tv_sec * 1000000000ULL) +
+            (unsigned long long)stTime.tv_nsec;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Load log file
+/// \return  true if successful
+/// \remarks Sensor records are 6 16 bit hex values, as written by
+///          Log_Sensors(); DCM records are 9 16 bit hex values scaled by
+///          32767, as written by Log_DCM(); GPS sentences are stored as
+///          logged.
+///
+///----------------------------------------------------------------------------
+static tBoolean
+Load_Log(const char *pszFile)
+{
+    FILE *pFile;
+    char szLine[LINE_LENGTH];
+    unsigned long ulSize = 1024, ulReferenceSize = 128;
+    STRUCT_EVENT *pstEvent;
+    STRUCT_REFERENCE *pstReference;
+    char *pcNext, *pcEnd;
+    unsigned long ulRecords = 0;
+    unsigned long ulGpsTime = 0;
+    int c;
+
+    pFile = fopen(pszFile, "r");
+    if (pFile == NULL) {
+        perror(pszFile);
+        return false;
+    }
+    s_pstEvent = (STRUCT_EVENT *)malloc(ulSize * sizeof(STRUCT_EVENT));
+    s_pstReference = (STRUCT_REFERENCE *)malloc(ulReferenceSize * sizeof(STRUCT_REFERENCE));
+
+    while (fgets(szLine, sizeof(szLine), pFile) != NULL) {
+        if (s_ulEvents == ulSize) {
+            ulSize *= 2;
+            s_pstEvent = (STRUCT_EVENT *)realloc(s_pstEvent, ulSize * sizeof(STRUCT_EVENT));
+        }
+        pstEvent = &s_pstEvent[s_ulEvents];
+
+        if (szLine[0] == '^') {                     // sensor data
+            pcNext = &szLine[1];
+            for (c = 0; c < 6; c++) {
+                pstEvent->psSensor[c] = (short)strtol(pcNext, &pcNext, 16);
+            }
+            pstEvent->ulTime = strtoul(pcNext, &pcEnd, 16);
+            if (pcEnd != pcNext) {
+                s_bStamped = true;
+            }
+            s_ulEvents++;
+            if ((++ulRecords % s_uiSubsteps) == 0) {
+                pstEvent->eType = EV_SENSOR;
+                s_ulSamples++;
+            } else {
+                pstEvent->eType = EV_GYRO;
+            }
+        } else if ((szLine[0] == '*') && (s_ulSamples != 0)) { // DCM
+            if (s_ulReferences == ulReferenceSize) {
+                ulReferenceSize *= 2;
+                s_pstReference = (STRUCT_REFERENCE *)realloc(s_pstReference,
+                                 ulReferenceSize * sizeof(STRUCT_REFERENCE));
+            }
+            pstReference = &s_pstReference[s_ulReferences++];
+            pstReference->ulSample = s_ulSamples - 1;
+            pcNext = &szLine[1];
+            for (c = 0; c < 9; c++) {
+                pstReference->fDCM[c / 3][c % 3] =
+                    (float)(short)strtol(pcNext, &pcNext, 16) / 32767.0f;
+            }
+        } else if (szLine[0] == '@') {              // GPS sentence time
+            ulGpsTime = strtoul(&szLine[1], NULL, 16);
+        } else if (strncmp(szLine, "$GPRMC", 6) == 0) { // GPS sentence
+            strncpy(pstEvent->szGps, szLine, GPS_LENGTH);
+            pstEvent->szGps[GPS_LENGTH] = 0;
+            pcNext = strpbrk(pstEvent->szGps, "\r\n");
+            if (pcNext != NULL) {
+                *pcNext = 0;
+            }
+            strcat(pstEvent->szGps, "\n");
+            pstEvent->eType = EV_GPS;
+            pstEvent->ulTime = ulGpsTime;
+            s_ulEvents++;
+        }
+    }
+    fclose(pFile);
+    return true;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Replay all events once
+/// \return  -
+/// \remarks Outputs are saved only if pstOutput is not NULL.
+///
+///----------------------------------------------------------------------------
+static void
+Replay(STRUCT_OUTPUT *pstOutput)
+{
+    unsigned long ulEvent, ulSample = 0;
+    unsigned long ulStart;
+    STRUCT_EVENT *pstEvent;
+    const char *pcChar;
+    long plGyro[3];
+    unsigned long ulLast = 0;
+    float fDeltaT;
+    int c;
+
+    if (s_bStamped) {
+        Delta_T = Timing_Get()->fDeltaT;
+        Sample_Rate = (float)Timing_Get()->uiLoopHz;
+    }
+
+    for (ulEvent = 0; ulEvent < s_ulEvents; ulEvent++) {
+        pstEvent = &s_pstEvent[ulEvent];
+        Host_SetTime(pstEvent->ulTime);
+
+        if (pstEvent->eType != EV_GPS) {
+            for (c = 0; c < 3; c++) {
+                plGyro[c] = pstEvent->psSensor[c + 3];
+            }
+            Host_PutGyro(plGyro);
+            if (pstEvent->eType == EV_GYRO) {
+                continue;
+            }
+        }
+
+        if (pstEvent->eType == EV_GPS) {
+            ulStart = Profile_Time();
+            for (pcChar = pstEvent->szGps; *pcChar != 0; pcChar++) {
+                Host_GpsPutChar(*pcChar);
+                GPSParse();
+            }
+            Profile_Add(PROF_GPS, Profile_Time() - ulStart);
+            continue;
+        }
+
+        for (c = 0; c < 6; c++) {
+            Host_SetSensor(c, (float)pstEvent->psSensor[c]);
+        }
+
+        //
+        // Logged interval, limited as in Task_Control()
+        //
+        if (s_bStamped && (ulSample != 0)) {
+            fDeltaT = (float)(pstEvent->ulTime - ulLast) * 1.0e-6f;
+            if (fDeltaT < 0.5f * Timing_Get()->fDeltaT) {
+                fDeltaT = 0.5f * Timing_Get()->fDeltaT;
+            } else if (fDeltaT > 4.0f * Timing_Get()->fDeltaT) {
+                fDeltaT = 4.0f * Timing_Get()->fDeltaT;
+            }
+            Delta_T = fDeltaT;
+            Sample_Rate = 1.0f / fDeltaT;
+        }
+        ulLast = pstEvent->ulTime;
+
+        PROFILE(PROF_MATRIX_UPDATE, MatrixUpdate());
+        PROFILE(PROF_COMPENSATE_DRIFT, CompensateDrift());
+        PROFILE(PROF_NORMALIZE, Normalize());
+        PROFILE(PROF_AILERON, Aileron_Control());
+        PROFILE(PROF_ELEVATOR, Elevator_Control());
+
+        if (pstOutput != NULL) {
+            DCM_Refresh();
+            memcpy(pstOutput[ulSample].fDCM, &DCM_Matrix, sizeof(DCM_Matrix));
+            memcpy(pstOutput[ulSample].fOmega, &Omega_Vector, sizeof(Omega_Vector));
+            pstOutput[ulSample].fAileron = Ailerons();
+            pstOutput[ulSample].fElevator = Elevator();
+        }
+        ulSample++;
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Euler angles from DCM
+/// \return  -
+/// \remarks roll, pitch, yaw in degrees, see Log_DCM()
+///
+///----------------------------------------------------------------------------
+static void
+Euler(const float fDCM[3][3], double pdAngle[3])
+{
+    double dSin = fDCM[2][0];
+
+    if (dSin > 1.0) {
+        dSin = 1.0;
+    } else if (dSin < -1.0) {
+        dSin = -1.0;
+    }
+    pdAngle[0] = atan2(fDCM[2][1], fDCM[2][2]) * 180.0 / M_PI;
+    pdAngle[1] = -asin(dSin) * 180.0 / M_PI;
+    pdAngle[2] = atan2(fDCM[1][0], fDCM[0][0]) * 180.0 / M_PI;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Compare outputs with golden file
+/// \return  true if bit-exact
+/// \remarks When outputs differ, prints max and rms deviation of DCM
+///          entries, Omega_Vector, control surfaces and Euler angles, so
+///          that a different implementation (e.g. DCM_FIXED) can be
+///          checked against a float golden run.
+///
+///----------------------------------------------------------------------------
+static tBoolean
+Compare_Golden(const char *pszFile)
+{
+    static const char * const pszGroup[4] = {
+        "DCM entries", "Omega [rad/s]", "surfaces", "Euler [deg]"
+    };
+    static const unsigned int puiFirst[4] = { 0, 9, 12, 0 };
+    static const unsigned int puiLast[4]  = { 9, 12, 14, 3 };
+    FILE *pFile;
+    STRUCT_OUTPUT stGolden;
+    const float *pfGolden, *pfActual;
+    unsigned long ulSample, ulDiffer = 0, ulFirst = 0, ulRead = 0;
+    double pdMax[4] = { 0.0, 0.0, 0.0, 0.0 };
+    double pdSquare[4] = { 0.0, 0.0, 0.0, 0.0 };
+    double pdGolden[3], pdActual[3];
+    double dDiff;
+    unsigned int g, j;
+
+    pFile = fopen(pszFile, "rb");
+    if (pFile == NULL) {
+        perror(pszFile);
+        return false;
+    }
+    for (ulSample = 0; ulSample < s_ulSamples; ulSample++) {
+        if (fread(&stGolden, sizeof(stGolden), 1, pFile) != 1) {
+            break;
+        }
+        ulRead++;
+        if (memcmp(&stGolden, &s_pstOutput[ulSample], sizeof(stGolden)) == 0) {
+            continue;
+        }
+        if (ulDiffer++ == 0) {
+            ulFirst = ulSample;
+        }
+        pfGolden = (const float *)&stGolden;
+        pfActual = (const float *)&s_pstOutput[ulSample];
+        Euler(stGolden.fDCM, pdGolden);
+        Euler(s_pstOutput[ulSample].fDCM, pdActual);
+        for (g = 0; g < 4; g++) {
+            for (j = puiFirst[g]; j < puiLast[g]; j++) {
+                if (g < 3) {
+                    dDiff = fabs((double)pfGolden[j] - (double)pfActual[j]);
+                } else {
+                    dDiff = fabs(fmod(pdGolden[j] - pdActual[j] + 540.0, 360.0) - 180.0);
+                }
+                if (!(dDiff <= pdMax[g])) {     // also catches NaN
+                    pdMax[g] = dDiff;
+                }
+                pdSquare[g] += dDiff * dDiff;
+            }
+        }
+    }
+    if (fread(&stGolden, sizeof(stGolden), 1, pFile) == 1) {
+        ulRead++;
+    }
+    fclose(pFile);
+
+    if (ulRead != s_ulSamples) {
+        printf("golden           : sample count differs (%lu golden, %lu replayed)\n",
+               ulRead, s_ulSamples);
+        return false;
+    } else if (ulDiffer != 0) {
+        printf("golden           : %lu of %lu samples differ, first at %lu\n",
+               ulDiffer, s_ulSamples, ulFirst);
+        printf("%-16s   %12s %12s\n", "deviation", "max", "rms");
+        for (g = 0; g < 4; g++) {
+            printf("%-16s : %12.4g %12.4g\n", pszGroup[g], pdMax[g],
+                   sqrt(pdSquare[g] / ((double)s_ulSamples * (puiLast[g] - puiFirst[g]))));
+        }
+        return false;
+    } else {
+        printf("golden           : bit-exact (%lu samples)\n", s_ulSamples);
+        return true;
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Compare outputs with the reference attitudes of the log
+/// \return  -
+/// \remarks Prints max and rms deviation of roll, pitch and yaw
+///
+///----------------------------------------------------------------------------
+static void
+Compare_Reference(void)
+{
+    static const char * const pszAngle[3] = {
+        "roll [deg]", "pitch [deg]", "yaw [deg]"
+    };
+    double pdMax[3] = { 0.0, 0.0, 0.0 };
+    double pdSquare[3] = { 0.0, 0.0, 0.0 };
+    double pdReference[3], pdActual[3];
+    double dDiff;
+    unsigned long ulReference;
+    unsigned int j;
+
+    for (ulReference = 0; ulReference < s_ulReferences; ulReference++) {
+        Euler(s_pstReference[ulReference].fDCM, pdReference);
+        Euler(s_pstOutput[s_pstReference[ulReference].ulSample].fDCM, pdActual);
+        for (j = 0; j < 3; j++) {
+            dDiff = fabs(fmod(pdReference[j] - pdActual[j] + 540.0, 360.0) - 180.0);
+            if (!(dDiff <= pdMax[j])) {
+                pdMax[j] = dDiff;
+            }
+            pdSquare[j] += dDiff * dDiff;
+        }
+    }
+    printf("reference        : %lu logged attitudes\n", s_ulReferences);
+    printf("%-16s   %12s %12s\n", "deviation", "max", "rms");
+    for (j = 0; j < 3; j++) {
+        printf("%-16s : %12.4g %12.4g\n", pszAngle[j], pdMax[j],
+               sqrt(pdSquare[j] / (double)s_ulReferences));
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Write outputs to golden file
+/// \return  true if successful
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static tBoolean
+Write_Golden(const char *pszFile)
+{
+    FILE *pFile;
+    tBoolean bResult;
+
+    pFile = fopen(pszFile, "wb");
+    if (pFile == NULL) {
+        perror(pszFile);
+        return false;
+    }
+    bResult = (fwrite(s_pstOutput, sizeof(STRUCT_OUTPUT), s_ulSamples, pFile) == s_ulSamples);
+    fclose(pFile);
+    printf("golden           : %lu samples written to %s\n", s_ulSamples, pszFile);
+    return bResult;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Print timing report
+/// \return  -
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static void
+Report(unsigned long ulPasses, unsigned long long ullTotal)
+{
+    int j, b;
+    const STRUCT_PROFILE *pstProfile;
+
+    printf("samples          : %lu x %lu passes\n", s_ulSamples, ulPasses);
+    printf("throughput       : %.0f samples/s\n",
+           ((double)s_ulSamples * ulPasses * 1e9) / (double)ullTotal);
+    printf("%-16s   %10s %10s %10s\n", "stage", "mean [ns]", "min [ns]", "max [ns]");
+    for (j = 0; j < PROF_NUMBER; j++) {
+        pstProfile = Profile_Get((ENUM_PROBE)j);
+        if (pstProfile->ulCount == 0) {
+            continue;
+        }
+        printf("%-16s : %10.1f %10lu %10lu\n", Profile_Name((ENUM_PROBE)j),
+               (double)pstProfile->ullSum / pstProfile->ulCount,
+               pstProfile->ulMin, pstProfile->ulMax);
+    }
+    printf("%-16s   %s\n", "histogram", "log2(ns):count");
+    for (j = 0; j < PROF_NUMBER; j++) {
+        pstProfile = Profile_Get((ENUM_PROBE)j);
+        if (pstProfile->ulCount == 0) {
+            continue;
+        }
+        printf("%-16s :", Profile_Name((ENUM_PROBE)j));
+        for (b = 0; b < PROFILE_BINS; b++) {
+            if (pstProfile->pulHist[b] != 0) {
+                printf(" %d:%lu", b, pstProfile->pulHist[b]);
+            }
+        }
+        printf("\n");
+    }
+    if (s_uiSubsteps > 1) {
+        pstProfile = Profile_Get(PROF_MATRIX_UPDATE);
+        printf("gyro samples     : %u per tick, MatrixUpdate %.1f ns per sample\n",
+               s_uiSubsteps, (double)pstProfile->ullSum / pstProfile->ulCount / s_uiSubsteps);
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   main program
+/// \return  0 on success, 1 on golden mismatch, 2 on error
+/// \remarks
+///
+///----------------------------------------------------------------------------
+int
+main(int argc, char *argv[])
+{
+    const char *pszWrite = NULL, *pszGolden = NULL, *pszLog = NULL;
+    unsigned long ulPass, ulPasses = 1;
+    unsigned long long ullStart, ullTotal;
+    int iResult = 0;
+    int j;
+
+    for (j = 1; j < argc; j++) {
+        if ((strcmp(argv[j], "-w") == 0) && (j + 1 < argc)) {
+            pszWrite = argv[++j];
+        } else if ((strcmp(argv[j], "-g") == 0) && (j + 1 < argc)) {
+            pszGolden = argv[++j];
+        } else if ((strcmp(argv[j], "-r") == 0) && (j + 1 < argc)) {
+            ulPasses = strtoul(argv[++j], NULL, 10);
+        } else if ((strcmp(argv[j], "-s") == 0) && (j + 1 < argc)) {
+            s_uiSubsteps = (unsigned int)strtoul(argv[++j], NULL, 10);
+        } else if (argv[j][0] != '-') {
+            pszLog = argv[j];
+        } else {
+            pszLog = NULL;
+            break;
+        }
+    }
+    if ((pszLog == NULL) || (ulPasses == 0) || (s_uiSubsteps == 0)) {
+        fprintf(stderr, "usage: %s [-w golden] [-g golden] [-r passes] [-s substeps] log.txt\n",
+                argv[0]);
+        return 2;
+    }
+    if (!Load_Log(pszLog)) {
+        return 2;
+    }
+    if (s_ulSamples == 0) {
+        fprintf(stderr, "%s: no sensor records\n", pszLog);
+        return 2;
+    }
+    s_pstOutput = (STRUCT_OUTPUT *)calloc(s_ulSamples, sizeof(STRUCT_OUTPUT));
+
+    Host_Init();
+    Timing_Init(SAMPLES_PER_SECOND);            // logs are recorded at the default rate
+    ADCSetSubsteps(s_uiSubsteps);
+    GPSInit();
+    Profile_Init();
+
+    ullStart = Now();
+    for (ulPass = 0; ulPass < ulPasses; ulPass++) {
+        Replay((ulPass == 0) ? s_pstOutput : NULL);
+    }
+    ullTotal = Now() - ullStart;
+
+    Report(ulPasses, ullTotal);
+    if (s_ulReferences != 0) {
+        Compare_Reference();
+    }
+
+    if ((pszWrite != NULL) && !Write_Golden(pszWrite)) {
+        iResult = 2;
+    }
+    if ((pszGolden != NULL) && !Compare_Golden(pszGolden)) {
+        iResult = 1;
+    }
+
+    free(s_pstOutput);
+    free(s_pstReference);
+    free(s_pstEvent);
+    return iResult;
+}
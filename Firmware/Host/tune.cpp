@@ -0,0 +1,739 @@
+//============================================================================+
+//
+// $RCSfile: tune.cpp,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief Parallel gain sweep of the DCM filter on a log
+///
+/// \file
+/// Reads a log.txt like replay does, through the same stand-in drivers,
+/// and keeps the sensor inputs of every control tick (DCM_GetInput())
+/// together with the "*" reference attitudes. Then runs DCM filters for
+/// every combination of PitchRoll_Kp, PitchRoll_Ki, Yaw_Kp and Yaw_Ki on a
+/// grid, spreading the filters on all the cores. Each filter is scored by
+/// the angle between its attitude and the reference, and the best gains
+/// are printed, after the score of the firmware defaults.
+///
+/// For Monte Carlo runs (-m) every point of the grid is run several times,
+/// each filter with its own random gyro bias and white noise on gyro and
+/// accelerometer inputs (see Batch_Input()); points are scored by the rms
+/// error of all their runs.
+///
+/// Filters are run by the kernel chosen with -k:
+/// - dcm: one STRUCT_DCM at a time, with the functions of DCM.cpp;
+/// - scalar, avx2, avx512: dcmbatch.cpp, 1, 8 or 16 filters at a time;
+/// by default the widest the CPU supports. With -v every filter is run
+/// again with the dcm kernel, and the largest difference of the final
+/// attitudes is checked against CHECK_TOLERANCE.
+///
+/// Usage:
+/// \code
+///     tune [-k kernel] [-v] [-j threads] [-n values] [-t top] [-s substeps]
+///          [-kp min:max] [-ki min:max] [-yp min:max] [-yi min:max]
+///          [-m runs] [-gb deg/s] [-gn deg/s] [-an m/s/s] log.txt
+/// \endcode
+/// Each gain takes n values spaced logarithmically between min and max,
+/// by default from 1/10 to 10 times the firmware default; min = max fixes
+/// the gain. -gb, -gn and -an are the standard deviations of gyro bias,
+/// gyro noise and accelerometer noise. The log must hold reference
+/// attitudes, as logsynth writes. Throughput is reported in filter steps
+/// (one control tick of one filter) per second per thread.
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include "stdafx.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "inc/hw_types.h"
+#include "config.h"
+#include "DCM.h"
+#include "adcdriver.h"
+#include "gps.h"
+#include "fastmath.h"
+#include "hostdriver.h"
+#include "dcmbatch.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_STATIC
+#undef VAR_STATIC
+#endif
+#define VAR_STATIC static
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL
+
+#define LINE_LENGTH     128     ///< Longest accepted log line
+#define MAX_THREADS     256     ///< Most worker threads
+#define MAX_VALUES      100     ///< Most values of one gain
+#define CHUNK           16      ///< Filters taken by a worker at a time
+#define CHECK_TOLERANCE 1e-5    ///< Largest accepted kernel difference
+
+/*----------------------------------- Macros ---------------------------------*/
+
+#define ToRad(x) (((x) * PI) / 180.0f)
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+typedef enum {          // swept gains
+    G_PITCHROLL_KP,
+    G_PITCHROLL_KI,
+    G_YAW_KP,
+    G_YAW_KI,
+    G_NUMBER
+} ENUM_GAIN;
+
+typedef enum {          // instruction sets
+    ISA_ANY,            // plain x86-64
+    ISA_AVX2,
+    ISA_AVX512
+} ENUM_ISA;
+
+typedef enum {          // Monte Carlo perturbations
+    P_GYRO_BIAS,        // gyro bias [deg/s]
+    P_GYRO_NOISE,       // gyro noise [deg/s]
+    P_ACCEL_NOISE,      // accelerometer noise [m/s/s]
+    P_NUMBER
+} ENUM_PERTURBATION;
+
+/*----------------------------------- Types ----------------------------------*/
+
+typedef void (*PFN_RUN)(const STRUCT_BATCH_LOG *pstLog, STRUCT_BATCH_FILTER *pstFilter,
+                        unsigned long ulFirst);
+
+typedef struct {            // filter kernel
+    const char *pszName;    // -k name
+    ENUM_ISA eIsa;          // required instruction set
+    unsigned int uiLanes;   // filters per call
+    PFN_RUN pfnRun;         // runs uiLanes filters
+} STRUCT_KERNEL;
+
+/*---------------------------------- Constants -------------------------------*/
+
+VAR_STATIC const char * const s_pszOption[G_NUMBER] = {
+    "-kp", "-ki", "-yp", "-yi"
+};
+
+VAR_STATIC const char * const s_pszGain[G_NUMBER] = {
+    "PitchRoll_Kp", "PitchRoll_Ki", "Yaw_Kp", "Yaw_Ki"
+};
+
+VAR_STATIC const char * const s_pszPerturbation[P_NUMBER] = {
+    "-gb", "-gn", "-an"
+};
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+static void Run_Dcm(const STRUCT_BATCH_LOG *pstLog, STRUCT_BATCH_FILTER *pstFilter,
+                    unsigned long ulFirst);
+
+VAR_STATIC const STRUCT_KERNEL s_pstKernel[] = {    // widest last
+    { "dcm",    ISA_ANY,    1,                  Run_Dcm },
+    { "scalar", ISA_ANY,    BATCH_LANES_SCALAR, Batch_Run_Scalar },
+    { "avx2",   ISA_AVX2,   BATCH_LANES_AVX2,   Batch_Run_Avx2 },
+    { "avx512", ISA_AVX512, BATCH_LANES_AVX512, Batch_Run_Avx512 }
+};
+
+#define KERNELS (sizeof(s_pstKernel) / sizeof(s_pstKernel[0]))
+
+VAR_STATIC STRUCT_DCM_INPUT *s_pstInput = NULL;     // inputs of every tick
+VAR_STATIC float (*s_pfCOG)[2] = NULL;              // cos, sin of course
+VAR_STATIC STRUCT_BATCH_REFERENCE *s_pstReference = NULL; // reference attitudes
+VAR_STATIC STRUCT_BATCH_LOG s_stLog;                // what the filters see
+VAR_STATIC unsigned int s_uiSubsteps = 1;           // sensor records per tick
+
+VAR_STATIC float s_ppfValue[G_NUMBER][MAX_VALUES];  // values of each gain
+VAR_STATIC unsigned int s_puiValues[G_NUMBER];      // number of values
+VAR_STATIC STRUCT_BATCH_FILTER *s_pstFilter = NULL; // filters, runs of point 0 first
+VAR_STATIC unsigned long s_ulFilters = 0;           // number of filters, padded
+VAR_STATIC STRUCT_BATCH_FILTER *s_pstPoint = NULL;  // results by grid point
+VAR_STATIC unsigned long s_ulPoints = 0;            // points, 0 = defaults
+
+VAR_STATIC pthread_mutex_t s_stLock = PTHREAD_MUTEX_INITIALIZER;
+VAR_STATIC unsigned long s_ulNext = 0;              // next filter to run
+VAR_STATIC const STRUCT_KERNEL *s_pstRun = NULL;    // kernel of the workers
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Monotonic time
+/// \return  time in ns
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static inline unsigned long long
+Now(void)
+{
+    struct timespec stTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &stTime);
+    return ((unsigned long long)stTime.tv_sec * 1000000000ULL) +
+            (unsigned long long)stTime.tv_nsec;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Instruction set support
+/// \return  true if the CPU supports eIsa
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static tBoolean
+Isa_Supported(ENUM_ISA eIsa)
+{
+    __builtin_cpu_init();
+    switch (eIsa) {
+    case ISA_AVX2:
+        return (__builtin_cpu_supports("avx2") != 0);
+    case ISA_AVX512:
+        return (__builtin_cpu_supports("avx512f") != 0);
+    default:
+        return true;
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Gaussian random value
+/// \return  zero mean, unit standard deviation
+/// \remarks Box - Muller on rand(), reproducible with srand()
+///
+///----------------------------------------------------------------------------
+static float
+Gauss(void)
+{
+    double dU = ((double)rand() + 1.0) / ((double)RAND_MAX + 2.0);
+    double dV = (double)rand() / (double)RAND_MAX;
+
+    return (float)(sqrt(-2.0 * log(dU)) * cos(2.0 * M_PI * dV));
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Read log file
+/// \return  true if successful
+/// \remarks Sensor records and GPS sentences go through the stand-in drivers
+///          as in replay; at every control tick DCM_GetInput() reads them.
+///
+///----------------------------------------------------------------------------
+static tBoolean
+Read_Log(const char *pszFile)
+{
+    FILE *pFile;
+    char szLine[LINE_LENGTH];
+    unsigned long ulSize = 1024, ulReferenceSize = 128;
+    unsigned long ulRecords = 0, ulTicks = 0, ulReferences = 0;
+    STRUCT_BATCH_REFERENCE *pstReference;
+    short psSensor[6];
+    long plGyro[3];
+    char *pcNext;
+    int c;
+
+    pFile = fopen(pszFile, "r");
+    if (pFile == NULL) {
+        perror(pszFile);
+        return false;
+    }
+    s_pstInput = (STRUCT_DCM_INPUT *)malloc(ulSize * sizeof(STRUCT_DCM_INPUT));
+    s_pstReference = (STRUCT_BATCH_REFERENCE *)malloc(ulReferenceSize *
+                     sizeof(STRUCT_BATCH_REFERENCE));
+
+    while (fgets(szLine, sizeof(szLine), pFile) != NULL) {
+        if (szLine[0] == '^') {                     // sensor data
+            pcNext = &szLine[1];
+            for (c = 0; c < 6; c++) {
+                psSensor[c] = (short)strtol(pcNext, &pcNext, 16);
+            }
+            for (c = 0; c < 3; c++) {
+                plGyro[c] = psSensor[c + 3];
+            }
+            Host_PutGyro(plGyro);
+            if ((++ulRecords % s_uiSubsteps) != 0) {
+                continue;
+            }
+            for (c = 0; c < 6; c++) {
+                Host_SetSensor(c, (float)psSensor[c]);
+            }
+            if (ulTicks == ulSize) {
+                ulSize *= 2;
+                s_pstInput = (STRUCT_DCM_INPUT *)realloc(s_pstInput,
+                             ulSize * sizeof(STRUCT_DCM_INPUT));
+            }
+            DCM_GetInput(&s_pstInput[ulTicks++]);
+        } else if ((szLine[0] == '*') && (ulTicks != 0)) { // DCM
+            if (ulReferences == ulReferenceSize) {
+                ulReferenceSize *= 2;
+                s_pstReference = (STRUCT_BATCH_REFERENCE *)realloc(s_pstReference,
+                                 ulReferenceSize * sizeof(STRUCT_BATCH_REFERENCE));
+            }
+            pstReference = &s_pstReference[ulReferences++];
+            pstReference->ulTick = ulTicks - 1;
+            pcNext = &szLine[1];
+            for (c = 0; c < 9; c++) {
+                pstReference->DCM[c / 3][c % 3] =
+                    (float)(short)strtol(pcNext, &pcNext, 16) / 32767.0f;
+            }
+        } else if (strncmp(szLine, "$GPRMC", 6) == 0) { // GPS sentence
+            pcNext = strpbrk(szLine, "\r\n");
+            if (pcNext != NULL) {
+                *pcNext = 0;
+            }
+            strcat(szLine, "\n");
+            for (pcNext = szLine; *pcNext != 0; pcNext++) {
+                Host_GpsPutChar(*pcNext);
+                GPSParse();
+            }
+        }
+    }
+    fclose(pFile);
+
+    //
+    // Course as DCM_CompensateDrift() uses it, for the batch kernels
+    //
+    s_pfCOG = (float (*)[2])malloc(ulTicks * sizeof(s_pfCOG[0]));
+    for (c = 0; (unsigned long)c < ulTicks; c++) {
+        FastSinCos(ToRad(s_pstInput[c].fCourse), &s_pfCOG[c][1], &s_pfCOG[c][0]);
+    }
+
+    s_stLog.pstInput = s_pstInput;
+    s_stLog.pfCOG = s_pfCOG;
+    s_stLog.ulTicks = ulTicks;
+    s_stLog.pstReference = s_pstReference;
+    s_stLog.ulReferences = ulReferences;
+    s_stLog.pfNoise = NULL;
+    return true;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Run one filter on the whole log with DCM.cpp
+/// \return  -
+/// \remarks Same interface and scoring as the batch kernels
+///
+///----------------------------------------------------------------------------
+static void
+Run_Dcm(const STRUCT_BATCH_LOG *pstLog, STRUCT_BATCH_FILTER *pstFilter,
+        unsigned long ulFirst)
+{
+    STRUCT_DCM stDCM;
+    STRUCT_DCM_INPUT stInput;
+    const STRUCT_BATCH_REFERENCE *pstReference = pstLog->pstReference;
+    const STRUCT_BATCH_REFERENCE *pstLast = &pstLog->pstReference[pstLog->ulReferences];
+    double dTrace, dAngle, dSquare = 0.0, dMax = 0.0;
+    unsigned long ulTick;
+    int j;
+
+    pstFilter = &pstFilter[ulFirst];
+    DCM_Init(&stDCM);
+    stDCM.PitchRoll_Kp = pstFilter->pfGain[G_PITCHROLL_KP];
+    stDCM.PitchRoll_Ki = pstFilter->pfGain[G_PITCHROLL_KI];
+    stDCM.Yaw_Kp = pstFilter->pfGain[G_YAW_KP];
+    stDCM.Yaw_Ki = pstFilter->pfGain[G_YAW_KI];
+
+    for (ulTick = 0; ulTick < pstLog->ulTicks; ulTick++) {
+        Batch_Input(&stInput, pstLog, pstFilter, ulFirst, ulTick);
+        DCM_MatrixUpdate(&stDCM, &stInput);
+        DCM_CompensateDrift(&stDCM, &stInput);
+        DCM_Normalize(&stDCM);
+
+        for (; (pstReference != pstLast) && (pstReference->ulTick == ulTick); pstReference++) {
+            dTrace = 0.0;
+            for (j = 0; j < 3; j++) {
+                dTrace += Dot(pstReference->DCM[j], stDCM.DCM_Matrix[j]);
+            }
+            dTrace = (dTrace - 1.0) * 0.5;
+            if (dTrace > 1.0) {
+                dTrace = 1.0;
+            } else if (dTrace < -1.0) {
+                dTrace = -1.0;
+            }
+            dAngle = acos(dTrace) * 180.0 / M_PI;
+            if (!(dAngle <= dMax)) {        // also catches NaN
+                dMax = dAngle;
+            }
+            dSquare += dAngle * dAngle;
+        }
+    }
+    memcpy(pstFilter->fDCM, &stDCM.DCM_Matrix, sizeof(pstFilter->fDCM));
+    pstFilter->dRms = sqrt(dSquare / (double)pstLog->ulReferences);
+    pstFilter->dMax = dMax;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Worker thread
+/// \return  NULL
+/// \remarks Takes CHUNK filters at a time until all have run
+///
+///----------------------------------------------------------------------------
+static void *
+Worker(void *pvArgument)
+{
+    unsigned long ulFirst, ulLast;
+
+    for (;;) {
+        pthread_mutex_lock(&s_stLock);
+        ulFirst = s_ulNext;
+        s_ulNext = (ulFirst + CHUNK < s_ulFilters) ? ulFirst + CHUNK : s_ulFilters;
+        ulLast = s_ulNext;
+        pthread_mutex_unlock(&s_stLock);
+
+        if (ulFirst == ulLast) {
+            return NULL;
+        }
+        for (; ulFirst < ulLast; ulFirst += s_pstRun->uiLanes) {
+            s_pstRun->pfnRun(&s_stLog, s_pstFilter, ulFirst);
+        }
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Run all the filters
+/// \return  elapsed time [ns]
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static unsigned long long
+Run_All(const STRUCT_KERNEL *pstKernel, unsigned int uiThreads)
+{
+    pthread_t ptThread[MAX_THREADS];
+    unsigned long long ullStart;
+    unsigned int t;
+
+    s_pstRun = pstKernel;
+    s_ulNext = 0;
+    ullStart = Now();
+    for (t = 0; t < uiThreads; t++) {
+        pthread_create(&ptThread[t], NULL, Worker, NULL);
+    }
+    for (t = 0; t < uiThreads; t++) {
+        pthread_join(ptThread[t], NULL);
+    }
+    return Now() - ullStart;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Parse a gain range
+/// \return  true if successful
+/// \remarks "min:max", or a single value
+///
+///----------------------------------------------------------------------------
+static tBoolean
+Parse_Range(const char *pszRange, float *pfMin, float *pfMax)
+{
+    char *pcNext;
+
+    *pfMin = strtof(pszRange, &pcNext);
+    if (*pcNext == ':') {
+        *pfMax = strtof(pcNext + 1, &pcNext);
+    } else {
+        *pfMax = *pfMin;
+    }
+    return (*pcNext == 0) && (*pfMin >= 0.0f) && (*pfMax >= *pfMin) &&
+           ((*pfMin > 0.0f) || (*pfMax == *pfMin));
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Sort results by rms error
+/// \return  qsort() comparison
+/// \remarks NaN (diverged filters) last
+///
+///----------------------------------------------------------------------------
+static int
+Compare_Result(const void *pvA, const void *pvB)
+{
+    double dA = ((const STRUCT_BATCH_FILTER *)pvA)->dRms;
+    double dB = ((const STRUCT_BATCH_FILTER *)pvB)->dRms;
+
+    if (dA < dB) {
+        return -1;
+    } else if (dA > dB) {
+        return 1;
+    } else if (dA == dB) {
+        return 0;
+    }
+    return isnan(dA) ? (isnan(dB) ? 0 : 1) : -1;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Print one result
+/// \return  -
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static void
+Print_Result(const char *pszRank, const STRUCT_BATCH_FILTER *pstResult)
+{
+    printf("%-8s %12.4g %12.4g %12.4g %12.4g %10.3f %10.3f\n", pszRank,
+           pstResult->pfGain[G_PITCHROLL_KP], pstResult->pfGain[G_PITCHROLL_KI],
+           pstResult->pfGain[G_YAW_KP], pstResult->pfGain[G_YAW_KI],
+           pstResult->dRms, pstResult->dMax);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Check the kernel against DCM.cpp
+/// \return  true if all the filters are within CHECK_TOLERANCE
+/// \remarks Reruns every filter with Run_Dcm() and compares the attitude
+///          at the end of the log, entry by entry.
+///
+///----------------------------------------------------------------------------
+static tBoolean
+Check(unsigned int uiThreads, unsigned long ulFilters)
+{
+    STRUCT_BATCH_FILTER *pstKernel;
+    unsigned long ulFilter, ulWorst = 0, ulExact = 0;
+    double dDiff, dMax = 0.0, dFilter;
+    int j;
+
+    pstKernel = (STRUCT_BATCH_FILTER *)malloc(s_ulFilters * sizeof(STRUCT_BATCH_FILTER));
+    memcpy(pstKernel, s_pstFilter, s_ulFilters * sizeof(STRUCT_BATCH_FILTER));
+    Run_All(&s_pstKernel[0], uiThreads);
+
+    for (ulFilter = 0; ulFilter < ulFilters; ulFilter++) {
+        dFilter = 0.0;
+        for (j = 0; j < 9; j++) {
+            dDiff = fabs((double)pstKernel[ulFilter].fDCM[j / 3][j % 3] -
+                         (double)s_pstFilter[ulFilter].fDCM[j / 3][j % 3]);
+            if (!(dDiff <= dFilter)) {
+                dFilter = dDiff;
+            }
+        }
+        if (memcmp(pstKernel[ulFilter].fDCM, s_pstFilter[ulFilter].fDCM,
+                   sizeof(pstKernel[ulFilter].fDCM)) == 0) {
+            ulExact++;
+        }
+        if (!(dFilter <= dMax)) {
+            dMax = dFilter;
+            ulWorst = ulFilter;
+        }
+    }
+    memcpy(s_pstFilter, pstKernel, s_ulFilters * sizeof(STRUCT_BATCH_FILTER));
+    free(pstKernel);
+
+    printf("check            : %lu of %lu filters bit-exact with dcm, max deviation %.3g (filter %lu)\n",
+           ulExact, ulFilters, dMax, ulWorst);
+    return (dMax <= CHECK_TOLERANCE);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   main program
+/// \return  0 on success, 1 on check failure, 2 on error
+/// \remarks
+///
+///----------------------------------------------------------------------------
+int
+main(int argc, char *argv[])
+{
+    const char *pszLog = NULL, *pszKernel = NULL;
+    const STRUCT_KERNEL *pstKernel = NULL;
+    float pfMin[G_NUMBER], pfMax[G_NUMBER], pfSigma[P_NUMBER] = { 0.0f, 0.0f, 0.0f };
+    float (*pfNoise)[6][BATCH_NOISE_COLUMNS] = NULL;
+    unsigned int uiThreads, uiValues = 10, uiTop = 10, uiRuns = 1;
+    unsigned long long ullTotal;
+    unsigned long ulFilters, ulFilter, ulPoint, ulIndex;
+    char szRank[16];
+    tBoolean bError = false, bCheck = false;
+    double dSquare;
+    unsigned int g, k, v;
+    int j, x;
+
+    uiThreads = (unsigned int)sysconf(_SC_NPROCESSORS_ONLN);
+    pfMin[G_PITCHROLL_KP] = PitchRoll_Kp;
+    pfMin[G_PITCHROLL_KI] = PitchRoll_Ki;
+    pfMin[G_YAW_KP] = Yaw_Kp;
+    pfMin[G_YAW_KI] = Yaw_Ki;
+    for (g = 0; g < G_NUMBER; g++) {
+        pfMax[g] = pfMin[g] * 10.0f;
+        pfMin[g] = pfMin[g] / 10.0f;
+    }
+
+    for (j = 1; (j < argc) && !bError; j++) {
+        for (g = 0; g < G_NUMBER; g++) {
+            if (strcmp(argv[j], s_pszOption[g]) == 0) {
+                break;
+            }
+        }
+        for (k = 0; k < P_NUMBER; k++) {
+            if (strcmp(argv[j], s_pszPerturbation[k]) == 0) {
+                break;
+            }
+        }
+        if ((g < G_NUMBER) && (j + 1 < argc)) {
+            bError = !Parse_Range(argv[++j], &pfMin[g], &pfMax[g]);
+        } else if ((k < P_NUMBER) && (j + 1 < argc)) {
+            pfSigma[k] = strtof(argv[++j], NULL);
+        } else if ((strcmp(argv[j], "-k") == 0) && (j + 1 < argc)) {
+            pszKernel = argv[++j];
+        } else if (strcmp(argv[j], "-v") == 0) {
+            bCheck = true;
+        } else if ((strcmp(argv[j], "-j") == 0) && (j + 1 < argc)) {
+            uiThreads = (unsigned int)strtoul(argv[++j], NULL, 10);
+        } else if ((strcmp(argv[j], "-n") == 0) && (j + 1 < argc)) {
+            uiValues = (unsigned int)strtoul(argv[++j], NULL, 10);
+        } else if ((strcmp(argv[j], "-t") == 0) && (j + 1 < argc)) {
+            uiTop = (unsigned int)strtoul(argv[++j], NULL, 10);
+        } else if ((strcmp(argv[j], "-m") == 0) && (j + 1 < argc)) {
+            uiRuns = (unsigned int)strtoul(argv[++j], NULL, 10);
+        } else if ((strcmp(argv[j], "-s") == 0) && (j + 1 < argc)) {
+            s_uiSubsteps = (unsigned int)strtoul(argv[++j], NULL, 10);
+        } else if (argv[j][0] != '-') {
+            pszLog = argv[j];
+        } else {
+            bError = true;
+        }
+    }
+    if (bError || (pszLog == NULL) || (uiThreads == 0) || (uiThreads > MAX_THREADS) ||
+        (uiValues == 0) || (uiValues > MAX_VALUES) || (uiRuns == 0) || (s_uiSubsteps == 0)) {
+        fprintf(stderr, "usage: %s [-k kernel] [-v] [-j threads] [-n values] [-t top] [-s substeps]\n"
+                        "       [-kp min:max] [-ki min:max] [-yp min:max] [-yi min:max]\n"
+                        "       [-m runs] [-gb deg/s] [-gn deg/s] [-an m/s/s] log.txt\n",
+                argv[0]);
+        return 2;
+    }
+
+    //
+    // Kernel, by default the widest supported
+    //
+    for (k = 0; k < KERNELS; k++) {
+        if (!Isa_Supported(s_pstKernel[k].eIsa)) {
+            continue;
+        }
+        if ((pszKernel == NULL) || (strcmp(pszKernel, s_pstKernel[k].pszName) == 0)) {
+            pstKernel = &s_pstKernel[k];
+        }
+    }
+    if (pstKernel == NULL) {
+        fprintf(stderr, "%s: kernel %s not supported by this CPU\n", argv[0], pszKernel);
+        return 2;
+    }
+
+    Host_Init();
+    ADCSetSubsteps(s_uiSubsteps);
+    GPSInit();
+    if (!Read_Log(pszLog)) {
+        return 2;
+    }
+    if (s_stLog.ulReferences == 0) {
+        fprintf(stderr, "%s: no reference attitudes\n", pszLog);
+        return 2;
+    }
+
+    //
+    // Gain grid, logarithmic, point 0 is the firmware defaults
+    //
+    s_ulPoints = 1;
+    for (g = 0; g < G_NUMBER; g++) {
+        s_puiValues[g] = (pfMin[g] == pfMax[g]) ? 1 : uiValues;
+        for (v = 0; v < s_puiValues[g]; v++) {
+            s_ppfValue[g][v] = (s_puiValues[g] == 1) ? pfMin[g] :
+                               pfMin[g] * powf(pfMax[g] / pfMin[g], (float)v / (float)(uiValues - 1));
+        }
+        s_ulPoints *= s_puiValues[g];
+    }
+    s_ulPoints++;
+    s_pstPoint = (STRUCT_BATCH_FILTER *)calloc(s_ulPoints, sizeof(STRUCT_BATCH_FILTER));
+
+    s_pstPoint[0].pfGain[G_PITCHROLL_KP] = PitchRoll_Kp;
+    s_pstPoint[0].pfGain[G_PITCHROLL_KI] = PitchRoll_Ki;
+    s_pstPoint[0].pfGain[G_YAW_KP] = Yaw_Kp;
+    s_pstPoint[0].pfGain[G_YAW_KI] = Yaw_Ki;
+    for (ulPoint = 1; ulPoint < s_ulPoints; ulPoint++) {
+        ulIndex = ulPoint - 1;
+        for (g = 0; g < G_NUMBER; g++) {
+            s_pstPoint[ulPoint].pfGain[g] = s_ppfValue[g][ulIndex % s_puiValues[g]];
+            ulIndex /= s_puiValues[g];
+        }
+    }
+
+    //
+    // Filters, uiRuns per point, padded to a whole chunk
+    //
+    srand(1);
+    ulFilters = s_ulPoints * uiRuns;
+    s_ulFilters = ((ulFilters + CHUNK - 1) / CHUNK) * CHUNK;
+    s_pstFilter = (STRUCT_BATCH_FILTER *)calloc(s_ulFilters, sizeof(STRUCT_BATCH_FILTER));
+    for (ulFilter = 0; ulFilter < s_ulFilters; ulFilter++) {
+        memcpy(s_pstFilter[ulFilter].pfGain,
+               s_pstPoint[(ulFilter < ulFilters) ? ulFilter / uiRuns : 0].pfGain,
+               sizeof(s_pstFilter[ulFilter].pfGain));
+        for (x = 0; x < 3; x++) {
+            s_pstFilter[ulFilter].pfBias[x] = ToRad(pfSigma[P_GYRO_BIAS] * Gauss());
+        }
+    }
+    if ((pfSigma[P_GYRO_NOISE] != 0.0f) || (pfSigma[P_ACCEL_NOISE] != 0.0f)) {
+        pfNoise = (float (*)[6][BATCH_NOISE_COLUMNS])malloc(BATCH_NOISE_TICKS * sizeof(pfNoise[0]));
+        for (ulIndex = 0; ulIndex < BATCH_NOISE_TICKS; ulIndex++) {
+            for (v = 0; v < BATCH_NOISE_COLUMNS; v++) {
+                for (x = 0; x < 3; x++) {
+                    pfNoise[ulIndex][x][v] = pfSigma[P_ACCEL_NOISE] * Gauss();
+                    pfNoise[ulIndex][x + 3][v] = ToRad(pfSigma[P_GYRO_NOISE] * Gauss());
+                }
+            }
+        }
+        s_stLog.pfNoise = pfNoise;
+    }
+
+    //
+    // Run all filters
+    //
+    ullTotal = Run_All(pstKernel, uiThreads);
+
+    printf("log              : %lu ticks, %lu reference attitudes\n",
+           s_stLog.ulTicks, s_stLog.ulReferences);
+    printf("filters          : %lu (%lu points x %u runs), kernel %s, %u lanes\n",
+           ulFilters, s_ulPoints, uiRuns, pstKernel->pszName, pstKernel->uiLanes);
+    printf("throughput       : %u threads in %.2f s, %.3g filter steps/s per thread\n",
+           uiThreads, (double)ullTotal * 1e-9,
+           ((double)s_ulFilters * s_stLog.ulTicks * 1e9) / ((double)ullTotal * uiThreads));
+    if (bCheck && !Check(uiThreads, ulFilters)) {
+        printf("check            : FAILED, tolerance %g\n", CHECK_TOLERANCE);
+        return 1;
+    }
+
+    //
+    // Score of each point, rms of its runs
+    //
+    for (ulPoint = 0; ulPoint < s_ulPoints; ulPoint++) {
+        dSquare = 0.0;
+        for (v = 0; v < uiRuns; v++) {
+            ulFilter = ulPoint * uiRuns + v;
+            dSquare += s_pstFilter[ulFilter].dRms * s_pstFilter[ulFilter].dRms;
+            if (!(s_pstFilter[ulFilter].dMax <= s_pstPoint[ulPoint].dMax)) {
+                s_pstPoint[ulPoint].dMax = s_pstFilter[ulFilter].dMax;
+            }
+        }
+        s_pstPoint[ulPoint].dRms = sqrt(dSquare / uiRuns);
+    }
+
+    printf("%-8s %12s %12s %12s %12s %10s %10s\n", "rank", s_pszGain[0], s_pszGain[1],
+           s_pszGain[2], s_pszGain[3], "rms [deg]", "max [deg]");
+    Print_Result("default", &s_pstPoint[0]);
+
+    qsort(&s_pstPoint[1], s_ulPoints - 1, sizeof(STRUCT_BATCH_FILTER), Compare_Result);
+    for (ulPoint = 1; (ulPoint < s_ulPoints) && (ulPoint <= uiTop); ulPoint++) {
+        snprintf(szRank, sizeof(szRank), "%lu", ulPoint);
+        Print_Result(szRank, &s_pstPoint[ulPoint]);
+    }
+    return 0;
+}
@@ -0,0 +1,236 @@
+//============================================================================+
+//
+// $RCSfile: vibcheck.cpp,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief Check of the vibration analyzer (vibe.c) on synthetic captures
+///
+/// \file
+/// Feeds vibe.c with sequences holding, on each axis, an offset, two sines
+/// of random frequency and amplitude and uniform noise, quantized to the
+/// 10 bit ADC range, then compares the two largest peaks found with the
+/// sines:
+/// - frequency error, in bins;
+/// - amplitude error, relative to the sine;
+/// - time per analysis (all the Vibe_Run() steps).
+///
+/// Built twice by the Makefile: vibcheck with the VIBE_FFT of the host
+/// (float), vibcheck_fixed with VIBE_FFT_FIXED as on the target.
+///
+/// Usage:
+/// \code
+///     vibcheck [-n captures]
+/// \endcode
+/// The tool exits with status 1 if a check fails.
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "inc/hw_types.h"
+#include "config.h"
+#include "vibe.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#define HZ_ERROR_MAX    0.05        ///< Max frequency error [bins]
+#define AMP_ERROR_MAX   0.03        ///< Max relative amplitude error
+#define NOISE           1.0         ///< Noise amplitude [steps]
+#define BIN_MIN         6           ///< Lowest bin of a sine
+#define BIN_SPACING     8           ///< Min distance of the two sines [bins]
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+typedef struct {                    // sine on an axis
+    double dHz;                     // frequency [Hz]
+    double dAmplitude;              // amplitude [steps]
+    double dPhase;                  // phase [rad]
+} STRUCT_SINE;
+
+/*---------------------------------- Constants -------------------------------*/
+
+//
+// Sequence rates: 50 Hz loop, 1 and 4 substeps, ADC_OVERSAMPLE 16 and 4;
+// 400 Hz loop, 2 substeps
+//
+static const double s_pdRate[] = { 800.0, 3200.0, 12800.0 };
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Uniform random number
+/// \return  value between dMin and dMax
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static double
+Random(double dMin, double dMax)
+{
+    return dMin + ((dMax - dMin) * (double)rand() / (double)RAND_MAX);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Time
+/// \return  monotonic time [ns]
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static double
+Now(void)
+{
+    struct timespec stTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &stTime);
+    return ((double)stTime.tv_sec * 1e9) + (double)stTime.tv_nsec;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Check the captures at a sequence rate
+/// \return  true if all the checks pass
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static tBoolean
+Check(double dSampleHz, unsigned long ulCaptures)
+{
+    STRUCT_SINE pstSine[VIBE_AXES][2];
+    unsigned long pulSequence[VIBE_AXES];
+    const STRUCT_VIBE *pstVibe;
+    const STRUCT_VIBE_PEAK *pstPeak;
+    double dBin = dSampleHz / (double)VIBE_POINTS;
+    double dHzMax = 0.0, dAmpMax = 0.0, dTime = 0.0, dStart, t, x;
+    unsigned long ulCapture, ulMissed = 0;
+    unsigned int n;
+    int c, s, p;
+    tBoolean bPass = true;
+
+    for (ulCapture = 0; ulCapture < ulCaptures; ulCapture++) {
+        for (c = 0; c < VIBE_AXES; c++) {
+            do {
+                pstSine[c][0].dHz = dBin * Random(BIN_MIN, (VIBE_POINTS / 2) - BIN_MIN);
+                pstSine[c][1].dHz = dBin * Random(BIN_MIN, (VIBE_POINTS / 2) - BIN_MIN);
+            } while (fabs(pstSine[c][0].dHz - pstSine[c][1].dHz) < (BIN_SPACING * dBin));
+            pstSine[c][0].dAmplitude = Random(50.0, 200.0);
+            pstSine[c][1].dAmplitude = Random(10.0, 40.0);
+            pstSine[c][0].dPhase = Random(0.0, 2.0 * M_PI);
+            pstSine[c][1].dPhase = Random(0.0, 2.0 * M_PI);
+        }
+
+        Vibe_Start((float)dSampleHz);
+        for (n = 0; Vibe_Status() == VIBE_CAPTURE; n++) {
+            t = (double)n / dSampleHz;
+            for (c = 0; c < VIBE_AXES; c++) {
+                x = 512.0 + Random(-NOISE, NOISE);
+                for (s = 0; s < 2; s++) {
+                    x += pstSine[c][s].dAmplitude *
+                         sin((2.0 * M_PI * pstSine[c][s].dHz * t) + pstSine[c][s].dPhase);
+                }
+                pulSequence[c] = (unsigned long)fmin(fmax(floor(x + 0.5), 0.0), 1023.0);
+            }
+            Vibe_Put(pulSequence);
+        }
+
+        dStart = Now();
+        while (Vibe_Run() != VIBE_DONE) {
+        }
+        dTime += Now() - dStart;
+
+        //
+        // Peaks in order of amplitude: the first sine, then the second one
+        //
+        pstVibe = Vibe_Get();
+        for (c = 0; c < VIBE_AXES; c++) {
+            for (s = 0; s < 2; s++) {
+                pstPeak = &pstVibe->pstPeak[c][s];
+                if (pstPeak->fHz == 0.0f) {
+                    ulMissed++;
+                    continue;
+                }
+                dHzMax = fmax(dHzMax, fabs(pstPeak->fHz - pstSine[c][s].dHz) / dBin);
+                dAmpMax = fmax(dAmpMax, fabs(pstPeak->fAmplitude - pstSine[c][s].dAmplitude) /
+                                        pstSine[c][s].dAmplitude);
+            }
+            for (p = 2; p < VIBE_PEAKS; p++) {
+                if (pstVibe->pstPeak[c][p].fAmplitude > pstVibe->pstPeak[c][1].fAmplitude) {
+                    ulMissed++;
+                }
+            }
+        }
+    }
+
+    printf("%10.1f %8.2f %8lu %10.4f %10.4f %8lu %10.2f",
+           dSampleHz, dBin, ulCaptures, dHzMax, dAmpMax, ulMissed,
+           dTime / (1e3 * (double)ulCaptures));
+    if (!(dHzMax <= HZ_ERROR_MAX) || !(dAmpMax <= AMP_ERROR_MAX)) {
+        printf("  ERROR EXCEEDED");
+        bPass = false;
+    }
+    if (ulMissed != 0) {
+        printf("  MISSED");
+        bPass = false;
+    }
+    printf("\n");
+    return bPass;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Main
+/// \return  0 if all the checks pass, 1 otherwise, 2 on bad arguments
+/// \remarks
+///
+///----------------------------------------------------------------------------
+int
+main(int argc, char *argv[])
+{
+    unsigned long ulCaptures = 200;
+    int iResult = 0;
+    unsigned int j;
+
+    for (j = 1; j < (unsigned int)argc; j++) {
+        if ((strcmp(argv[j], "-n") == 0) && (j + 1 < (unsigned int)argc)) {
+            ulCaptures = strtoul(argv[++j], NULL, 10);
+        } else {
+            ulCaptures = 0;
+            break;
+        }
+    }
+    if (ulCaptures == 0) {
+        fprintf(stderr, "usage: %s [-n captures]\n", argv[0]);
+        return 2;
+    }
+
+    Vibe_Init();
+    srand(1);
+    printf("VIBE_FFT %s, %d points\n",
+           (VIBE_FFT == VIBE_FFT_FIXED) ? "fixed" : "float", VIBE_POINTS);
+    printf("%10s %8s %8s %10s %10s %8s %10s\n", "rate [Hz]", "bin [Hz]",
+           "captures", "Hz [bins]", "amplitude", "missed", "us/run");
+    for (j = 0; j < sizeof(s_pdRate) / sizeof(s_pdRate[0]); j++) {
+        if (!Check(s_pdRate[j], ulCaptures)) {
+            iResult = 1;
+        }
+    }
+    printf("bounds: frequency %.2f bins, amplitude %.0f %%\n",
+           HZ_ERROR_MAX, 100.0 * AMP_ERROR_MAX);
+    return iResult;
+}
@@ -0,0 +1,428 @@
+//============================================================================+
+//
+// $RCSfile: vmbench.cpp,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief Micro-benchmark of vmath.cpp against vec3.h
+///
+/// \file
+/// Times the kernels of one control tick written with the vmath.cpp
+/// functions, as DCM.cpp did, and with the vec3.h types, as it does now:
+/// - update: DCM = DCM + DCM * [Theta]x, dense Update_Matrix product
+///   against the Skew3 product;
+/// - normalize: Eq. 19 - 21 of Normalize();
+/// - drift: the vector part of CompensateDrift();
+/// - tick: the three of them in sequence.
+///
+/// Both versions run on the same random attitudes and rotations and the
+/// results are compared bit by bit, since vec3.h keeps the order of the
+/// operations of vmath.cpp.
+///
+/// Usage:
+/// \code
+///     vmbench [-n iterations]
+/// \endcode
+/// Times are host ns per call: they show the ratio between the versions,
+/// not the Cortex-M3 cycle count.
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "vmath.h"
+#include "vec3.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#define SETS            256         ///< Attitudes and rotations in the data set
+#define GAIN_KP         0.0755f     ///< Proportional gain of the correction
+#define GAIN_KI         0.00002f    ///< Integral gain of the correction
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+typedef enum {          // benchmarked kernels
+    K_UPDATE,           // DCM update
+    K_NORMALIZE,        // normalization
+    K_DRIFT,            // drift correction
+    K_TICK,             // whole tick
+    K_NUMBER
+} ENUM_KERNEL;
+
+/*----------------------------------- Types ----------------------------------*/
+
+typedef struct {            // state of the estimator, vmath version
+    float fDCM[3][3];
+    float fOmegaP[3];
+    float fOmegaI[3];
+} STRUCT_STATE;
+
+typedef struct {            // state of the estimator, vec3 version
+    Rot3<float> DCM;
+    Vec3<float> OmegaP;
+    Vec3<float> OmegaI;
+} STRUCT_STATE3;
+
+/*---------------------------------- Constants -------------------------------*/
+
+static const char * const s_pszKernel[K_NUMBER] = {
+    "update", "normalize", "drift", "tick"
+};
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+static STRUCT_STATE s_pstState[SETS];
+static STRUCT_STATE3 s_pstState3[SETS];
+static float s_pfTheta[SETS][3];
+static float s_pfAccel[SETS][3];
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Monotonic time
+/// \return  time in ns
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static inline unsigned long long
+Now(void)
+{
+    struct timespec stTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &stTime);
+    return ((unsigned long long)stTime.tv_sec * 1000000000ULL) +
+            (unsigned long long)stTime.tv_nsec;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Random value
+/// \return  uniform in [-1, 1]
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static float
+Random(void)
+{
+    return ((float)rand() / (float)RAND_MAX) * 2.0f - 1.0f;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Build the data set
+/// \return  -
+/// \remarks Attitudes from random Euler angles, rotations of up to 2 mrad
+///          per call, so that repeated updates stay bounded, accelerations
+///          of about 1 g. Both states start equal.
+///
+///----------------------------------------------------------------------------
+static void
+Init(void)
+{
+    float fRoll, fPitch, fYaw;
+    float cr, sr, cp, sp, cy, sy;
+    int j, x;
+
+    srand(1);
+    for (j = 0; j < SETS; j++) {
+        fRoll = 3.14159f * Random();
+        fPitch = 1.5f * Random();
+        fYaw = 3.14159f * Random();
+        cr = cosf(fRoll);  sr = sinf(fRoll);
+        cp = cosf(fPitch); sp = sinf(fPitch);
+        cy = cosf(fYaw);   sy = sinf(fYaw);
+
+        s_pstState[j].fDCM[0][0] = cp * cy;
+        s_pstState[j].fDCM[0][1] = (sr * sp * cy) - (cr * sy);
+        s_pstState[j].fDCM[0][2] = (cr * sp * cy) + (sr * sy);
+        s_pstState[j].fDCM[1][0] = cp * sy;
+        s_pstState[j].fDCM[1][1] = (sr * sp * sy) + (cr * cy);
+        s_pstState[j].fDCM[1][2] = (cr * sp * sy) - (sr * cy);
+        s_pstState[j].fDCM[2][0] = -sp;
+        s_pstState[j].fDCM[2][1] = sr * cp;
+        s_pstState[j].fDCM[2][2] = cr * cp;
+        for (x = 0; x < 3; x++) {
+            s_pstState[j].fOmegaP[x] = 0.0f;
+            s_pstState[j].fOmegaI[x] = 0.0f;
+            s_pfTheta[j][x] = 0.002f * Random();
+            s_pfAccel[j][x] = s_pstState[j].fDCM[2][x] + 0.1f * Random();
+        }
+        memcpy(&s_pstState3[j].DCM, s_pstState[j].fDCM, sizeof(s_pstState[j].fDCM));
+        memcpy(&s_pstState3[j].OmegaP, s_pstState[j].fOmegaP, sizeof(s_pstState[j].fOmegaP));
+        memcpy(&s_pstState3[j].OmegaI, s_pstState[j].fOmegaI, sizeof(s_pstState[j].fOmegaI));
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   DCM update, vmath version
+/// \return  -
+/// \remarks As MatrixUpdate() before vec3.h
+///
+///----------------------------------------------------------------------------
+static void
+Update(STRUCT_STATE *pstState, float fTheta[3])
+{
+    float Update_Matrix[3][3];
+    float Temporary_Matrix[3][3];
+    int x, y;
+
+    Update_Matrix[0][0] = 0;
+    Update_Matrix[0][1] = -fTheta[2];
+    Update_Matrix[0][2] = fTheta[1];
+    Update_Matrix[1][0] = fTheta[2];
+    Update_Matrix[1][1] = 0;
+    Update_Matrix[1][2] = -fTheta[0];
+    Update_Matrix[2][0] = -fTheta[1];
+    Update_Matrix[2][1] = fTheta[0];
+    Update_Matrix[2][2] = 0;
+
+    MatrixMultiply(pstState->fDCM, Update_Matrix, Temporary_Matrix);
+
+    for (x = 0; x < 3; x++) {
+        for (y = 0; y < 3; y++) {
+            pstState->fDCM[x][y] += Temporary_Matrix[x][y];
+        }
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   DCM update, vec3 version
+/// \return  -
+/// \remarks As MatrixUpdate()
+///
+///----------------------------------------------------------------------------
+static void
+Update(STRUCT_STATE3 *pstState, const float fTheta[3])
+{
+    Skew3<float> Rotation = {{{ fTheta[0], fTheta[1], fTheta[2] }}};
+
+    pstState->DCM += pstState->DCM * Rotation;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Normalization, vmath version
+/// \return  -
+/// \remarks As Normalize() before vec3.h
+///
+///----------------------------------------------------------------------------
+static void
+Normalize(STRUCT_STATE *pstState)
+{
+    float error;
+    float temporary[3][3];
+    float renorm;
+
+    error = -VectorDotProduct(&pstState->fDCM[0][0], &pstState->fDCM[1][0]) * 0.5f;
+
+    VectorScale(&temporary[0][0], &pstState->fDCM[1][0], error);
+    VectorScale(&temporary[1][0], &pstState->fDCM[0][0], error);
+
+    VectorAdd(&temporary[0][0], &temporary[0][0], &pstState->fDCM[0][0]);
+    VectorAdd(&temporary[1][0], &temporary[1][0], &pstState->fDCM[1][0]);
+
+    VectorCrossProduct(&temporary[2][0], &temporary[0][0], &temporary[1][0]);
+
+    renorm = 0.5f * (3.0f - VectorDotProduct(&temporary[0][0], &temporary[0][0]));
+    VectorScale(&pstState->fDCM[0][0], &temporary[0][0], renorm);
+
+    renorm = 0.5f * (3.0f - VectorDotProduct(&temporary[1][0], &temporary[1][0]));
+    VectorScale(&pstState->fDCM[1][0], &temporary[1][0], renorm);
+
+    renorm = 0.5f * (3.0f - VectorDotProduct(&temporary[2][0], &temporary[2][0]));
+    VectorScale(&pstState->fDCM[2][0], &temporary[2][0], renorm);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Normalization, vec3 version
+/// \return  -
+/// \remarks As Normalize()
+///
+///----------------------------------------------------------------------------
+static void
+Normalize(STRUCT_STATE3 *pstState)
+{
+    Rot3<float> &DCM = pstState->DCM;
+    Vec3<float> X, Y, Z;
+    float error;
+
+    error = -Dot(DCM[0], DCM[1]) * 0.5f;
+    X = (DCM[1] * error) + DCM[0];
+    Y = (DCM[0] * error) + DCM[1];
+    Z = Cross(X, Y);
+
+    DCM[0] = X * (0.5f * (3.0f - Dot(X, X)));
+    DCM[1] = Y * (0.5f * (3.0f - Dot(Y, Y)));
+    DCM[2] = Z * (0.5f * (3.0f - Dot(Z, Z)));
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Drift correction, vmath version
+/// \return  -
+/// \remarks Roll / pitch and yaw terms of CompensateDrift() before vec3.h,
+///          with the course error taken from the DCM itself
+///
+///----------------------------------------------------------------------------
+static void
+Drift(STRUCT_STATE *pstState, float fAccel[3])
+{
+    float errorRollPitch[3];
+    float errorYaw[3];
+    float Scaled_Omega_P[3];
+    float Scaled_Omega_I[3];
+    float errorCourse;
+
+    VectorCrossProduct(&errorRollPitch[0], fAccel, &pstState->fDCM[2][0]);
+    VectorScale(&pstState->fOmegaP[0], &errorRollPitch[0], GAIN_KP);
+
+    VectorScale(&Scaled_Omega_I[0], &errorRollPitch[0], GAIN_KI);
+    VectorAdd(pstState->fOmegaI, pstState->fOmegaI, Scaled_Omega_I);
+
+    errorCourse = (pstState->fDCM[0][0] * 0.6f) - (pstState->fDCM[1][0] * 0.8f);
+    VectorScale(errorYaw, &pstState->fDCM[2][0], errorCourse);
+
+    VectorScale(&Scaled_Omega_P[0], &errorYaw[0], GAIN_KP);
+    VectorAdd(pstState->fOmegaP, pstState->fOmegaP, Scaled_Omega_P);
+
+    VectorScale(&Scaled_Omega_I[0], &errorYaw[0], GAIN_KI);
+    VectorAdd(pstState->fOmegaI, pstState->fOmegaI, Scaled_Omega_I);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Drift correction, vec3 version
+/// \return  -
+/// \remarks As CompensateDrift()
+///
+///----------------------------------------------------------------------------
+static void
+Drift(STRUCT_STATE3 *pstState, const float fAccel[3])
+{
+    const Rot3<float> &DCM = pstState->DCM;
+    Vec3<float> Accel = {{ fAccel[0], fAccel[1], fAccel[2] }};
+    Vec3<float> errorRollPitch, errorYaw;
+    float errorCourse;
+
+    errorRollPitch = Cross(Accel, DCM[2]);
+    pstState->OmegaP = errorRollPitch * GAIN_KP;
+    pstState->OmegaI += errorRollPitch * GAIN_KI;
+
+    errorCourse = (DCM[0][0] * 0.6f) - (DCM[1][0] * 0.8f);
+    errorYaw = DCM[2] * errorCourse;
+    pstState->OmegaP += errorYaw * GAIN_KP;
+    pstState->OmegaI += errorYaw * GAIN_KI;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Run a kernel on the whole data set
+/// \return  -
+/// \remarks The version is chosen by the type of the state
+///
+///----------------------------------------------------------------------------
+template <typename STATE> static void
+Run(ENUM_KERNEL eKernel, STATE *pstState)
+{
+    int j;
+
+    for (j = 0; j < SETS; j++) {
+        switch (eKernel) {
+        case K_UPDATE:
+            Update(&pstState[j], s_pfTheta[j]);
+            break;
+        case K_NORMALIZE:
+            Normalize(&pstState[j]);
+            break;
+        case K_DRIFT:
+            Drift(&pstState[j], s_pfAccel[j]);
+            break;
+        default:
+            Update(&pstState[j], s_pfTheta[j]);
+            Drift(&pstState[j], s_pfAccel[j]);
+            Normalize(&pstState[j]);
+            break;
+        }
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Time a kernel
+/// \return  ns per call on the data set
+/// \remarks
+///
+///----------------------------------------------------------------------------
+template <typename STATE> static double
+Time(ENUM_KERNEL eKernel, STATE *pstState, unsigned long ulIterations)
+{
+    unsigned long long ullStart;
+    unsigned long j;
+
+    ullStart = Now();
+    for (j = 0; j < ulIterations; j++) {
+        Run(eKernel, pstState);
+    }
+    return (double)(Now() - ullStart) / ((double)ulIterations * SETS);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   main program
+/// \return  0 if the versions give the same results, 1 otherwise
+/// \remarks
+///
+///----------------------------------------------------------------------------
+int
+main(int argc, char *argv[])
+{
+    unsigned long ulIterations = 20000;
+    double dVmath, dVec3;
+    int iResult = 0;
+    int j;
+
+    for (j = 1; j < argc; j++) {
+        if ((strcmp(argv[j], "-n") == 0) && (j + 1 < argc)) {
+            ulIterations = strtoul(argv[++j], NULL, 10);
+        } else {
+            ulIterations = 0;
+            break;
+        }
+    }
+    if (ulIterations == 0) {
+        fprintf(stderr, "usage: %s [-n iterations]\n", argv[0]);
+        return 2;
+    }
+
+    printf("%-16s   %10s %10s %8s %10s\n", "kernel", "vmath [ns]", "vec3 [ns]",
+           "ratio", "results");
+    for (j = 0; j < K_NUMBER; j++) {
+        Init();
+        dVmath = Time((ENUM_KERNEL)j, s_pstState, ulIterations);
+        dVec3 = Time((ENUM_KERNEL)j, s_pstState3, ulIterations);
+        if (memcmp(s_pstState, s_pstState3, sizeof(s_pstState)) == 0) {
+            printf("%-16s : %10.2f %10.2f %8.2f %10s\n", s_pszKernel[j],
+                   dVmath, dVec3, dVmath / dVec3, "identical");
+        } else {
+            printf("%-16s : %10.2f %10.2f %8.2f %10s\n", s_pszKernel[j],
+                   dVmath, dVec3, dVmath / dVec3, "DIFFER");
+            iResult = 1;
+        }
+    }
+    return iResult;
+}
@@ -35,15 +35,25 @@
 /// - la navigazione e' implementata con un controllo PID
 /// - la parte proporzionale e' (Dir_Kp * cross_prod) dove cross_prod e' l'errore
 ///   di direzione, cioe' il seno dell'angolo tra direzione voluta e reale.
-/// - la parte integrativa e' (Dir_Ki * (cross_prod * DELTA_T)) dove DELTA_T e'
-///   l'intervallo (fisso) di calcolo del PID.
+/// - la parte integrativa e' (Dir_Ki * (cross_prod * Delta_T)) dove Delta_T e'
+///   l'intervallo di calcolo del PID misurato dallo scheduler.
 /// - la parte derivativa e'
-///   (Dir_Kd * ((cross_prod - previous_error) * SAMPLES_PER_SECOND))
+///   (Dir_Kd * ((cross_prod - previous_error) * Sample_Rate))
 ///   dove previous_error e' l'errore di direzione al passo precedente e la
-///   moltiplicazione per SAMPLES_PER_SECOND sostituisce la divisione per
-///   DELTA_T.
+///   moltiplicazione per Sample_Rate sostituisce la divisione per
+///   Delta_T.
+///
+/// 5. Gruppi di frequenza:
+/// - Aileron_Guidance(): PID di direzione, gruppo lento (GUIDANCE_PERIOD);
+///   Delta_T e Sample_Rate sono quelli del gruppo, passati come parametri
+/// - Aileron_Attitude(): parte proporzionale del rollio, gruppo intermedio
+///   (ATTITUDE_PERIOD)
+/// - Aileron_Damping(): smorzamento Roll_Kd * Omega_Vector[0] e somma finale,
+///   a ogni ciclo di controllo insieme all'aggiornamento dei servi
+/// - Aileron_Control(): i tre gruppi in sequenza alla stessa frequenza
 ///
 //  CHANGES gains.h sostituito da config.h
+//          controllo diviso in gruppi di frequenza
 //
 //============================================================================*/
 
@@ -51,12 +61,13 @@
 
 #include "inc/hw_types.h"
 #include "math.h"
+#include "fastmath.h"
 #include "adcdriver.h"
 #include "DCM.h"
 #include "ppmdriver.h"
 #include "nav.h"
 #include "config.h"
-#include "aileronctrl.h"
+#include "AileronCtrl.h"
 
 /*--------------------------------- Definitions ------------------------------*/
 
@@ -97,18 +108,38 @@ VAR_STATIC float roll_feedback ;
 VAR_STATIC float previous_error = 0.0f ;
 VAR_STATIC float aileron = 0.0f ;
 VAR_STATIC float aileron_accum ;
+VAR_STATIC float aileron_guidance ;     // Direction PID output
+VAR_STATIC float aileron_attitude ;     // Direction and roll angle terms
 
 //----------------------------------------------------------------------------
 //
 /// \brief   Control of aircraft aileron.
 ///
 /// \remarks Computes aileron deflection to steer aircraft toward desired
-///          direction.
+///          direction. Runs the guidance, attitude and damping groups at
+///          the same rate.
 ///
 //----------------------------------------------------------------------------
 void
 Aileron_Control(void) {
 
+    Aileron_Guidance(Delta_T, Sample_Rate);
+    Aileron_Attitude();
+    Aileron_Damping();
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Aileron guidance group: direction PID.
+///
+/// \param   fDeltaT interval since the previous run [s]
+/// \param   fSampleRate 1 / fDeltaT [Hz]
+/// \remarks Low rate group.
+///
+//----------------------------------------------------------------------------
+void
+Aileron_Guidance(float fDeltaT, float fSampleRate) {
+
    float temp ;
 //   float dot_prod ;
    float cross_prod ;
@@ -119,6 +150,8 @@ Aileron_Control(void) {
    float actual_y ;
    float P = 0.0f, I = 0.0f, D = 0.0f;
 
+   DCM_Refresh();
+
 /*
     if (PPMSignalStatus() == PPM_SIGNAL_OK) {
         aileron = pwc7 + waggle ;
@@ -132,8 +165,7 @@ Aileron_Control(void) {
     if ( 1 /* AILERON_NAVIGATION && flags._.GPS_steering */ ) {
 
         // Compute X and Y components of desired direction
-        desired_x = cosf( ( desired_dir * PI ) / 180.0f ) ;
-        desired_y = sinf( ( desired_dir * PI ) / 180.0f ) ;
+        FastSinCos( ( desired_dir * PI ) / 180.0f, &desired_y, &desired_x ) ;
 
         // Get X and Y components of actual direction
         actual_x = DCM_Matrix[0][0] ;
@@ -152,12 +184,12 @@ Aileron_Control(void) {
         // Integral part.
         // Avoid windup of integral part.
         if ((I > I_LIMIT_MIN) && (I < I_LIMIT_MAX)) {
-            I += cross_prod * DELTA_T;
+            I += cross_prod * fDeltaT;
         }
 
         // Derivative part.
-        // Multiply by SAMPLES_PER_SECOND instead of dividing by DELTA_T.
-        D = (cross_prod - previous_error) * SAMPLES_PER_SECOND ;
+        // Multiply by fSampleRate instead of dividing by fDeltaT.
+        D = (cross_prod - previous_error) * fSampleRate ;
 
         // Add P + I + D terms
         temp =  Dir_Kp * P;
@@ -166,30 +198,59 @@ Aileron_Control(void) {
 
         // Saturate result
         if (temp < I_LIMIT_MIN) {
-          aileron_accum = I_LIMIT_MIN;
+          aileron_guidance = I_LIMIT_MIN;
         } else if (temp > I_LIMIT_MAX) {
-          aileron_accum = I_LIMIT_MAX;
+          aileron_guidance = I_LIMIT_MAX;
         } else {
-          aileron_accum = temp;
+          aileron_guidance = temp;
         }
 
         // Save current error
         previous_error = cross_prod;
     }
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Aileron attitude group: roll angle term.
+///
+/// \remarks Mid rate group. Uses the last output of Aileron_Guidance().
+///
+//----------------------------------------------------------------------------
+void
+Aileron_Attitude(void) {
+
+    DCM_Refresh();
+
+    if ( 1 /* ROLL_STABILIZATION && flags._.pitch_feedback */ ) {
+        // Subtract Kp * roll angle.
+        // DCM_Matrix[2][1] is roll angle.
+        aileron_attitude = aileron_guidance - (Roll_Kp * DCM_Matrix[2][1]);
+    } else {
+        aileron_attitude = aileron_guidance;
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Aileron damping group: roll rate term and output.
+///
+/// \remarks Runs at every control loop, before ServoUpdate(). Uses the last
+///          output of Aileron_Attitude().
+///
+//----------------------------------------------------------------------------
+void
+Aileron_Damping(void) {
 
     if ( 1 /* ROLL_STABILIZATION && flags._.pitch_feedback */ ) {
         // Compute feedback = Kd * roll rate.
         // Omega_Vector[0] is g-corrected roll rate.
         roll_feedback = Roll_Kd * Omega_Vector[0];
-
-        // Subtract Kp * roll angle.
-        // DCM_Matrix[2][1] is roll angle.
-        aileron_accum -= (Roll_Kp * DCM_Matrix[2][1]);
     } else {
         roll_feedback = 0.0f ;
     }
 
-    aileron_accum = aileron - aileron_accum + roll_feedback;
+    aileron_accum = aileron - aileron_attitude + roll_feedback;
 //    PDC1 = pulsesat( aileron_accum ) ;
 }
 
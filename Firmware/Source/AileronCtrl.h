@@ -39,4 +39,7 @@ VAR_GLOBAL float Roll_Kd ;
 /*---------------------------------- Interface -------------------------------*/
 
 void Aileron_Control( void );
+void Aileron_Guidance( float fDeltaT, float fSampleRate );
+void Aileron_Attitude( void );
+void Aileron_Damping( void );
 float Ailerons( void );
@@ -0,0 +1,131 @@
+//=============================================================================+
+//
+// $RCSfile: Attitude.cpp,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+///
+/// \brief
+/// Attitude outputs shared by controls, log and telemetry
+///
+/// \file
+/// The Euler angles (Z-Y-X) and their sines and cosines are computed from
+/// DCM_Matrix once per estimator update, instead of by each consumer:
+/// \code
+///     sin(pitch) = -DCM[2][0]         cos(pitch) = sqrt(DCM[2][1]^2 + DCM[2][2]^2)
+///     sin(roll)  =  DCM[2][1] / cos(pitch)
+///     cos(roll)  =  DCM[2][2] / cos(pitch)
+///     sin(yaw)   =  DCM[1][0] / cos(pitch)
+///     cos(yaw)   =  DCM[0][0] / cos(pitch)
+/// \endcode
+/// so that the sines and cosines need no trigonometry at all, and the angles
+/// three FastAtan2(). MatrixUpdate() and Normalize() of every attitude
+/// filter call Attitude_Invalidate(), the next Attitude_Get() recomputes.
+///
+/// Roll and yaw are not defined at pitch +/-90 deg: there sin(roll),
+/// sin(yaw) are 0 and cos(roll), cos(yaw) are 1.
+///
+//  CHANGES
+//
+//=============================================================================+
+
+#include "stdafx.h"
+
+#include "inc/hw_types.h"
+#include "fastmath.h"
+#include "config.h"
+#include "DCM.h"
+#include "Attitude.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_STATIC
+#undef VAR_STATIC
+#endif
+#define VAR_STATIC static
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL
+
+/*----------------------------------- Macros ---------------------------------*/
+
+#define ToDeg(x) (((x) * 180.0f) / PI)
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+//! Attitude outputs, level and facing north
+VAR_STATIC STRUCT_ATTITUDE s_stAttitude = {
+    0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f
+};
+//! s_stAttitude is up to date with DCM_Matrix
+VAR_STATIC tBoolean bAttitudeValid = FALSE;
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Attitude outputs are out of date
+/// \return  -
+/// \remarks Called by the attitude filters when DCM_Matrix changes
+///
+///----------------------------------------------------------------------------
+void
+Attitude_Invalidate(void)
+{
+    bAttitudeValid = FALSE;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Attitude outputs of the current DELTA_T
+/// \return  pointer to the outputs, valid until the next estimator update
+/// \remarks Brings DCM_Matrix up to date first, see DCM_Refresh().
+///
+///----------------------------------------------------------------------------
+const STRUCT_ATTITUDE *
+Attitude_Get(void)
+{
+    STRUCT_ATTITUDE *pstAttitude = &s_stAttitude;
+    float fCosPitch, fInverse;
+
+    if (bAttitudeValid) {
+        return pstAttitude;
+    }
+    bAttitudeValid = TRUE;
+    DCM_Refresh();
+
+    fCosPitch = FastSqrt((DCM_Matrix[2][1] * DCM_Matrix[2][1]) +
+                         (DCM_Matrix[2][2] * DCM_Matrix[2][2]));
+    pstAttitude->fSinPitch = -DCM_Matrix[2][0];
+    pstAttitude->fCosPitch = fCosPitch;
+    if (fCosPitch > 0.0f) {
+        fInverse = 1.0f / fCosPitch;
+        pstAttitude->fSinRoll = DCM_Matrix[2][1] * fInverse;
+        pstAttitude->fCosRoll = DCM_Matrix[2][2] * fInverse;
+        pstAttitude->fSinYaw = DCM_Matrix[1][0] * fInverse;
+        pstAttitude->fCosYaw = DCM_Matrix[0][0] * fInverse;
+    } else {
+        pstAttitude->fSinRoll = 0.0f;
+        pstAttitude->fCosRoll = 1.0f;
+        pstAttitude->fSinYaw = 0.0f;
+        pstAttitude->fCosYaw = 1.0f;
+    }
+
+    pstAttitude->fRoll = FastAtan2(DCM_Matrix[2][1], DCM_Matrix[2][2]);
+    pstAttitude->fPitch = FastAtan2(pstAttitude->fSinPitch, fCosPitch);
+    pstAttitude->fYaw = FastAtan2(DCM_Matrix[1][0], DCM_Matrix[0][0]);
+    pstAttitude->fHeading = ToDeg(pstAttitude->fYaw);
+    if (pstAttitude->fHeading < 0.0f) {
+        pstAttitude->fHeading += 360.0f;
+    }
+    return pstAttitude;
+}
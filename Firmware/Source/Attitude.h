@@ -0,0 +1,52 @@
+//============================================================================
+//
+// $RCSfile: Attitude.h,v $ (HEADER FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief Attitude outputs shared by controls, log and telemetry
+///
+/// \file
+/// Euler angles, heading and their sines and cosines, computed from
+/// DCM_Matrix at the first Attitude_Get() after each estimator update and
+/// then read by every consumer of the same DELTA_T.
+///
+//  CHANGES
+//
+//============================================================================
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL extern
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+typedef struct {
+    float fRoll;                // roll [rad], positive right wing down
+    float fPitch;               // pitch [rad], positive nose up
+    float fYaw;                 // yaw [rad], -PI .. PI, positive clockwise
+    float fHeading;             // yaw [deg], 0 .. 360
+    float fSinRoll;             // sines and cosines of the angles above
+    float fCosRoll;
+    float fSinPitch;
+    float fCosPitch;
+    float fSinYaw;
+    float fCosYaw;
+} STRUCT_ATTITUDE;
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*---------------------------------- Interface -------------------------------*/
+
+const STRUCT_ATTITUDE *Attitude_Get( void );
+void Attitude_Invalidate( void );
@@ -34,7 +34,7 @@
 ///   NB: prima sottrae la velocita' di rollio e poi moltiplica per il guadagno
 ///   derivativo. E' come se il guadagno proporzionale fosse Roll_Kp * Roll_Kd.
 /// - l'errore di banco  angolo di banco richiesto - angolo di rollio attuale
-/// - l'angolo di rollio  DCM_Matrix[2][1]
+/// - l'angolo di rollio  fRoll di Attitude_Get()
 /// - la velocita' angolare di rollio e' Omega_Vector[0] cioe' la velocit
 ///   di rollio corretta con il vettore gravita'.
 /// - il risultato  saturato tra -20 e 20
@@ -60,13 +60,15 @@
 
 #include "inc/hw_types.h"
 #include "math.h"
+#include "Attitude.h"
 #include "adcdriver.h"
 #include "DCM.h"
+#include "gps.h"
 #include "ppmdriver.h"
 #include "nav.h"
 #include "config.h"
-#include "telemetry.h"
-#include "autopilot.h"
+#include "Telemetry.h"
+#include "AutoPilot.h"
 
 /*--------------------------------- Definitions ------------------------------*/
 
@@ -122,14 +124,8 @@ Heading_Control(void) {
     // Get commanded heading
     khi_c = (float)Nav_Bearing();
 
-    // Compute actual heading
-    khi = acosf(DCM_Matrix[0][0]);
-
-    // Convert to degrees
-    khi = (khi * 180.0f) / PI;
-    if (DCM_Matrix[0][1] > 0.0f) {
-       khi = 360 - khi;
-    }
+    // Get actual heading, degrees
+    khi = Attitude_Get()->fHeading;
 
     // Compute heading error
     khi_err = khi - khi_c;
@@ -141,7 +137,7 @@ Heading_Control(void) {
 
     // Multiply by speed
 #ifndef _WINDOWS
-    khi_err *= ((float)GPSSpeed())
+    khi_err *= ((float)GPSSpeed());
 #elif (SIMULATOR == SIM_NONE)
     khi_err *= Sim_Speed();
 #else
@@ -170,11 +166,12 @@ Bank_Control(void) {
 
    float temp;
 
-    // Compute commanded angle between aircraft Y axis and earth Z axis
-    temp = ((phi_c + 90.0f) * PI) / 180.0f;
+    // Compute commanded bank angle
+    temp = (phi_c * PI) / 180.0f;
 
-    // Compute error
-    temp = temp - acosf(DCM_Matrix[2][1]);
+    // Compute error: (phi_c + 90) - angle between aircraft Y axis and
+    // earth Z axis, that is 90 - roll
+    temp = temp + Attitude_Get()->fRoll;
 
     // Compute commanded aileron deflection
     da_c = temp * Roll_Kp +            // Proportional term
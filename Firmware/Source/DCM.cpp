@@ -81,6 +81,7 @@
 //
 //  CHANGES #definizione di Aircraft_Speed() spostata in AccelAdjust()
 //          PITCHROLL_KP aumentata a 0.03
+//          DCM_GetInput() legge i campioni con Sensor_Read() (sensor.c)
 //
 //=============================================================================+
 
@@ -89,11 +90,15 @@
 #include "inc/hw_types.h"
 #include "math.h"
 #include "vmath.h"
+#include "fastmath.h"
+#include "vec3.h"
 #include "adcdriver.h"
 #include "gps.h"
-#include "telemetry.h"
+#include "Telemetry.h"
 #include "config.h"
 #include "DCM.h"
+#include "sensor.h"
+#include "Attitude.h"
 
 /*--------------------------------- Definitions ------------------------------*/
 
@@ -136,14 +141,14 @@
 /*---------------------------------- Globals ---------------------------------*/
 
 //! Direction Cosine Matrix
-VAR_GLOBAL float DCM_Matrix[3][3] = { { 1.0f, 0.0f, 0.0f },
-                                      { 0.0f, 1.0f, 0.0f },
-                                      { 0.0f, 0.0f, 1.0f }
-                                    };
+VAR_GLOBAL Rot3<float> DCM_Matrix = {{ {{ 1.0f, 0.0f, 0.0f }},
+                                       {{ 0.0f, 1.0f, 0.0f }},
+                                       {{ 0.0f, 0.0f, 1.0f }}
+                                    }};
 //! Raw gyroscope data
-VAR_GLOBAL float Gyro_Vector[3] = { 0.0f, 0.0f, 0.0f };
+VAR_GLOBAL Vec3<float> Gyro_Vector = {{ 0.0f, 0.0f, 0.0f }};
 //! g-corrected gyroscope data
-VAR_GLOBAL float Omega_Vector[3] = { 0.0f, 0.0f, 0.0f };
+VAR_GLOBAL Vec3<float> Omega_Vector = {{ 0.0f, 0.0f, 0.0f }};
 //! Guadagno di conversione da ADC a velocita' angolare in deg/s
 VAR_GLOBAL float Gyro_Gain = GYRO_GAIN;
 //! Guadagno di conversione da ADC ad accelerazione in m/s/s
@@ -158,41 +163,98 @@ VAR_GLOBAL float Yaw_Kp = YAW_KP;
 VAR_GLOBAL float Yaw_Ki = YAW_KI;
 //! Velocita' 3D
 VAR_GLOBAL float speed_3d = 0.0f;
+//! Intervallo di integrazione misurato [s]
+VAR_GLOBAL float Delta_T = DELTA_T;
+//! 1 / Delta_T [Hz]
+VAR_GLOBAL float Sample_Rate = SAMPLES_PER_SECOND;
 
 /*----------------------------------- Locals ---------------------------------*/
 
-float Update_Matrix[3][3] = {
-    { 1.0f, 0.0f, 0.0f },
-    { 0.0f, 1.0f, 0.0f },
-    { 0.0f, 0.0f, 1.0f }
-}; // Gyros here
+///----------------------------------------------------------------------------
+///
+/// \brief   Copy DCM_Matrix
+/// \return  -
+/// \remarks For C modules, which do not see the Rot3 type. Call
+///          DCM_Refresh() first.
+///
+///----------------------------------------------------------------------------
+void
+DCM_GetMatrix(float pfMatrix[3][3])
+{
+    int iRow, iCol;
 
-float Temporary_Matrix[3][3] = {
-    { 0.0f, 0.0f, 0.0f },
-    { 0.0f, 0.0f, 0.0f },
-    { 0.0f, 0.0f, 0.0f }
-};
+    for (iRow = 0; iRow < 3; iRow++) {
+        for (iCol = 0; iCol < 3; iCol++) {
+            pfMatrix[iRow][iCol] = DCM_Matrix[iRow][iCol];
+        }
+    }
+}
 
-//! Acceleration vector
-float Accel_Vector[3] = { 0.0f, 0.0f, 0.0f };
-//! Temporary for intermediate calculation
-float Omega[3] = { 0.0f, 0.0f, 0.0f };
-//! Omega Proportional correction
-float Omega_P[3] = { 0.0f, 0.0f, 0.0f };
-//! Omega Integral correction
-float Omega_I[3] = { 0.0f, 0.0f, 0.0f };
+#if (ATTITUDE_FILTER == ATT_DCM)
 
-float errorRollPitch[3] = { 0.0f, 0.0f, 0.0f };
-float errorYaw[3] = { 0.0f, 0.0f, 0.0f };
-float errorCourse = 180.0f;
-//! Course overground X axis
-float COGX = 1.0f;
-//! Course overground Y axis
-float COGY = 0.0f;
+///----------------------------------------------------------------------------
+///
+/// \brief   Bring DCM_Matrix up to date
+/// \return  -
+/// \remarks Nothing to do, DCM_Matrix is the state of the filter. See
+///          Quaternion.cpp
+///
+///----------------------------------------------------------------------------
+void
+DCM_Refresh(void)
+{
+}
+
+#endif // ATTITUDE_FILTER == ATT_DCM
+
+#if (ATTITUDE_FILTER == ATT_DCM) && (DCM_ARITHMETIC == DCM_FLOAT)
 
+//! The filter of the firmware
+VAR_STATIC STRUCT_DCM s_stDCM = {
+    {{ {{ 1.0f, 0.0f, 0.0f }}, {{ 0.0f, 1.0f, 0.0f }}, {{ 0.0f, 0.0f, 1.0f }} }},
+    {{ 0.0f, 0.0f, 0.0f }},
+    {{ 0.0f, 0.0f, 0.0f }},
+    {{ 0.0f, 0.0f, 0.0f }},
+    {{ 0.0f, 0.0f, 0.0f }},
+    {{ 0.0f, 0.0f, 0.0f }},
+    {{ 0.0f, 0.0f, 0.0f }},
+    PITCHROLL_KP, PITCHROLL_KI, YAW_KP, YAW_KI
+};
+//! Sensor inputs of the current DELTA_T
+VAR_STATIC STRUCT_DCM_INPUT s_stInput;
 
 /*--------------------------------- Prototypes -------------------------------*/
 
+///----------------------------------------------------------------------------
+///
+/// \brief   Initialize a filter
+/// \return  -
+/// \remarks Level, facing north, no correction; gains from PitchRoll_Kp,
+///          PitchRoll_Ki, Yaw_Kp, Yaw_Ki.
+///
+///----------------------------------------------------------------------------
+void
+DCM_Init(STRUCT_DCM *pstDCM)
+{
+    static const Vec3<float> Zero = {{ 0.0f, 0.0f, 0.0f }};
+    int x;
+
+    for (x = 0; x < 3; x++) {
+        pstDCM->DCM_Matrix[x] = Zero;
+        pstDCM->DCM_Matrix[x][x] = 1.0f;
+    }
+    pstDCM->Gyro_Vector = Zero;
+    pstDCM->Omega_Vector = Zero;
+    pstDCM->Accel_Vector = Zero;
+    pstDCM->Omega = Zero;
+    pstDCM->Omega_P = Zero;
+    pstDCM->Omega_I = Zero;
+    pstDCM->PitchRoll_Kp = PitchRoll_Kp;
+    pstDCM->PitchRoll_Ki = PitchRoll_Ki;
+    pstDCM->Yaw_Kp = Yaw_Kp;
+    pstDCM->Yaw_Ki = Yaw_Ki;
+}
+
 ///----------------------------------------------------------------------------
 ///
 /// \brief   Normalize DCM matrix
@@ -201,31 +263,25 @@ float COGY = 0.0f;
 ///
 ///----------------------------------------------------------------------------
 void
-Normalize(void)
+DCM_Normalize(STRUCT_DCM *pstDCM)
 {
+    Rot3<float> &DCM = pstDCM->DCM_Matrix;
     float error = 0.0f;
-    float renorm = 0.0f;
-    float temporary[3][3] = {
-       { 0.0f, 0.0f, 0.0f },
-       { 0.0f, 0.0f, 0.0f },
-       { 0.0f, 0.0f, 0.0f }
-    };
+    Vec3<float> X, Y, Z;
 
     //
     //                    error                         error
     // Xorthogonal = X - ------- Y , Yorthogonal = Y - ------- X        Eq. 19
     //                      2                             2
     //
-    error = -VectorDotProduct(&DCM_Matrix[0][0], &DCM_Matrix[1][0]) * 0.5f;
-    VectorScale(&temporary[0][0], &DCM_Matrix[1][0], error);
-    VectorScale(&temporary[1][0], &DCM_Matrix[0][0], error);
-    VectorAdd(&temporary[0][0], &temporary[0][0], &DCM_Matrix[0][0]);
-    VectorAdd(&temporary[1][0], &temporary[1][0], &DCM_Matrix[1][0]);
+    error = -Dot(DCM[0], DCM[1]) * 0.5f;
+    X = (DCM[1] * error) + DCM[0];
+    Y = (DCM[0] * error) + DCM[1];
 
     //
     // Zorthogonal = X orthogonal /\ Yorthogonal                        Eq. 20
     //
-    VectorCrossProduct(&temporary[2][0], &temporary[0][0], &temporary[1][0]);
+    Z = Cross(X, Y);
 
     //
     //               1
@@ -240,12 +296,9 @@ Normalize(void)
     // Znormalized = - (3 - Zorthogonal . Zorthogonal) Zorthogonal
     //               2
     //
-    renorm = 0.5f * (3.0f - VectorDotProduct(&temporary[0][0], &temporary[0][0]));
-    VectorScale(&DCM_Matrix[0][0], &temporary[0][0], renorm);
-    renorm = 0.5f * (3.0f - VectorDotProduct(&temporary[1][0], &temporary[1][0]));
-    VectorScale(&DCM_Matrix[1][0], &temporary[1][0], renorm);
-    renorm = 0.5f * (3.0f - VectorDotProduct(&temporary[2][0], &temporary[2][0]));
-    VectorScale(&DCM_Matrix[2][0], &temporary[2][0], renorm);
+    DCM[0] = X * (0.5f * (3.0f - Dot(X, X)));
+    DCM[1] = Y * (0.5f * (3.0f - Dot(Y, Y)));
+    DCM[2] = Z * (0.5f * (3.0f - Dot(Z, Z)));
 }
 
 ///----------------------------------------------------------------------------
@@ -273,16 +326,11 @@ Normalize(void)
 /// The acceleration is then scaled from ADC values to g.
 ///
 ///----------------------------------------------------------------------------
-void
-AccelAdjust(void)
+static void
+Accel_Adjust(STRUCT_DCM *pstDCM, float fSpeed)
 {
-#ifndef _WINDOWS
-    speed_3d = ((float)GPSSpeed());
-#elif (SIMULATOR == SIM_NONE)
-    speed_3d = Sim_Speed();
-#endif
-    Accel_Vector[1] += ((speed_3d * Omega[2] * 9.81f) / GRAVITY);
-    Accel_Vector[2] -= ((speed_3d * Omega[1] * 9.81f) / GRAVITY);
+    pstDCM->Accel_Vector[1] += ((fSpeed * pstDCM->Omega[2] * 9.81f) / Sensor_Gravity);
+    pstDCM->Accel_Vector[2] -= ((fSpeed * pstDCM->Omega[1] * 9.81f) / Sensor_Gravity);
 }
 
 
@@ -322,55 +370,42 @@ AccelAdjust(void)
 ///
 ///----------------------------------------------------------------------------
 void
-CompensateDrift( void )
+DCM_CompensateDrift(STRUCT_DCM *pstDCM, const STRUCT_DCM_INPUT *pstInput)
 {
-    static float Scaled_Omega_P[3];
-    static float Scaled_Omega_I[3];
-    float cog;
+    const Rot3<float> &DCM = pstDCM->DCM_Matrix;
+    Vec3<float> errorRollPitch, errorYaw;
+    float errorCourse, COGX, COGY;
 
     // RollPitch correction
-    VectorCrossProduct(&errorRollPitch[0], &Accel_Vector[0], &DCM_Matrix[2][0]);
+    errorRollPitch = Cross(pstDCM->Accel_Vector, DCM[2]);
 
-    VectorScale(&Omega_P[0], &errorRollPitch[0], PitchRoll_Kp);
-    VectorScale(&Scaled_Omega_I[0], &errorRollPitch[0], PitchRoll_Ki);
-    VectorAdd(Omega_I, Omega_I, Scaled_Omega_I);
+    pstDCM->Omega_P = errorRollPitch * pstDCM->PitchRoll_Kp;
+    pstDCM->Omega_I += errorRollPitch * pstDCM->PitchRoll_Ki;
 
     //
     // Course over ground
     //
-    cog = (float)GPSHeading();
-    COGX = cosf(ToRad(cog));
-    COGY = sinf(ToRad(cog));
+    FastSinCos(ToRad(pstInput->fCourse), &COGY, &COGX);
 
     //
     // Yaw correction (ground)
     //
-    errorCourse=(DCM_Matrix[0][0] * COGY) - (DCM_Matrix[1][0] * COGX);
+    errorCourse=(DCM[0][0] * COGY) - (DCM[1][0] * COGX);
 
     //
     // Yaw correction (aircraft)
     //
-    VectorScale(errorYaw, &DCM_Matrix[2][0], errorCourse);
+    errorYaw = DCM[2] * errorCourse;
 
     //
-    // YAW proportional gain.
+    // YAW proportional gain, adding proportional.
     //
-    VectorScale(&Scaled_Omega_P[0], &errorYaw[0], Yaw_Kp);
+    pstDCM->Omega_P += errorYaw * pstDCM->Yaw_Kp;
 
     //
-    // Adding proportional.
+    // YAW integral gain, adding integral to the Omega_I
     //
-    VectorAdd(Omega_P, Omega_P, Scaled_Omega_P);
-
-    //
-    // YAW integral gain.
-    //
-    VectorScale(&Scaled_Omega_I[0], &errorYaw[0], Yaw_Ki);
-
-    //
-    // Adding integral to the Omega_I
-    //
-    VectorAdd(Omega_I, Omega_I, Scaled_Omega_I);
+    pstDCM->Omega_I += errorYaw * pstDCM->Yaw_Ki;
 }
 
 
@@ -378,79 +413,185 @@ CompensateDrift( void )
 ///
 /// \brief   Update DCM matrix
 /// \return      -
-/// \remarks
+/// \remarks With GYRO_SUBSTEPS > 1 the rotation during DELTA_T is the one
+///          computed by DCM_GetInput() from all the gyro samples, plus the
+///          integral and proportional corrections.
 ///
 ///----------------------------------------------------------------------------
 void
-MatrixUpdate(void)
+DCM_MatrixUpdate(STRUCT_DCM *pstDCM, const STRUCT_DCM_INPUT *pstInput)
 {
     //
-    // Indexes for multiplication
+    // Rotation during DELTA_T
     //
-    int x, y;
+    Skew3<float> Update;
 
-#if (SIMULATOR == SIM_NONE)
-    //
-    // Accelerometer signals
-    //
-    Accel_Vector[0] = Accel_Gain * ADCGetData(0);   // accel x (0 LM1968, 0 LM9B90)
-    Accel_Vector[1] = Accel_Gain * ADCGetData(1);   // accel y (2 LM1968, 1 LM9B90)
-    Accel_Vector[2] = Accel_Gain * ADCGetData(2);   // accel z (1 LM1968, 2 LM9B90)
+    pstDCM->Accel_Vector = pstInput->Accel;
+    pstDCM->Gyro_Vector = pstInput->Gyro;
 
     //
-    // Gyro signals
-    //
-    Gyro_Vector[0] = Gyro_Gain * ADCGetData(3);     // omega x
-    Gyro_Vector[1] = Gyro_Gain * ADCGetData(4);     // omega y
-    Gyro_Vector[2] = Gyro_Gain * ADCGetData(5);     // omega z
-#else
-    //
-    // Accelerometer signals
+    // adding integral
     //
-    Accel_Vector[0] = Accel_Gain * Sim_GetData(0);  // accel x
-    Accel_Vector[1] = Accel_Gain * Sim_GetData(1);  // accel y
-    Accel_Vector[2] = Accel_Gain * Sim_GetData(2);  // accel z
+    pstDCM->Omega = pstDCM->Gyro_Vector + pstDCM->Omega_I;
 
     //
-    // Gyro signals
+    // adding proportional
     //
-    Gyro_Vector[0] = Gyro_Gain * Sim_GetData(3);    // gyro x roll
-    Gyro_Vector[1] = Gyro_Gain * Sim_GetData(4);    // gyro y pitch
-    Gyro_Vector[2] = Gyro_Gain * Sim_GetData(5);    // gyro z yaw
-#endif
+    pstDCM->Omega_Vector = pstDCM->Omega + pstDCM->Omega_P;
 
     //
-    // adding integral
+    // adjust centrifugal acceleration.
     //
-    VectorAdd(&Omega[0], &Gyro_Vector[0], &Omega_I[0]);
+    Accel_Adjust(pstDCM, pstInput->fSpeed);
 
-    //
-    // adding proportional
-    //
-    VectorAdd(&Omega_Vector[0], &Omega[0], &Omega_P[0]);
+    if (pstInput->bConing) {
+        //
+        // adding integral and proportional to the gyro rotation
+        //
+        Update.w = pstInput->Theta + ((pstDCM->Omega_I + pstDCM->Omega_P) * pstInput->fDeltaT);
+    } else {
+        Update.w = pstDCM->Omega_Vector * pstInput->fDeltaT;
+    }
 
     //
-    // adjust centrifugal acceleration.
+    //  Update DCM matrix: DCM_Matrix [DELTA_T * Omega_Vector]x
     //
-    AccelAdjust();
-
-    Update_Matrix[0][0] = 0.0f;
-    Update_Matrix[0][1] = -DELTA_T * Omega_Vector[2];   // -z
-    Update_Matrix[0][2] =  DELTA_T * Omega_Vector[1];   //  y
-    Update_Matrix[1][0] =  DELTA_T * Omega_Vector[2];   //  z
-    Update_Matrix[1][1] = 0.0f;
-    Update_Matrix[1][2] = -DELTA_T * Omega_Vector[0];   // -x
-    Update_Matrix[2][0] = -DELTA_T * Omega_Vector[1];   // -y
-    Update_Matrix[2][1] =  DELTA_T * Omega_Vector[0];   //  x
-    Update_Matrix[2][2] = 0.0f;
+    pstDCM->DCM_Matrix += pstDCM->DCM_Matrix * Update;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Read sensor inputs
+/// \return  -
+/// \remarks Reads the selected sensor backend (sensor.c). If its batches
+///          are gyro substeps (GYRO_SUBSTEPS > 1), Theta is the sum of all
+///          the gyro samples acquired since the last call, plus the coning
+///          term (see ConingSum()), and Gyro is their mean, held when no
+///          sample came; otherwise Gyro is the last sample. Each sample
+///          is weighted by the sample period of the backend: a late tick
+///          brings more samples, not longer ones. Updates speed_3d.
+///
+///----------------------------------------------------------------------------
+void
+DCM_GetInput(STRUCT_DCM_INPUT *pstInput)
+{
+    STRUCT_SENSOR_BATCH stBatch;
+    const STRUCT_SENSOR_SAMPLE *pstLast;
+    long Gyro_Samples[SENSOR_BATCH][3];
+    long Alpha[3], Beta[3];
+    float Step;
+    int n, x;
+
+    Sensor_Read(&stBatch);
+    pstLast = Sensor_Last();
 
     //
-    //  Update DCM matrix
+    // Accelerometer signals
     //
-    MatrixMultiply(DCM_Matrix, Update_Matrix, Temporary_Matrix);
     for ( x = 0; x < 3; x++ ) {
-        for ( y = 0; y < 3; y++ ) {
-            DCM_Matrix[x][y] += Temporary_Matrix[x][y];
+        pstInput->Accel[x] = Accel_Gain * pstLast->pfAccel[x];
+    }
+
+    pstInput->bConing = stBatch.bSubsteps;
+    if (stBatch.bSubsteps) {
+        //
+        // Gyro signals, every sample since last DELTA_T
+        //
+        n = Sensor_GyroSteps(&stBatch, Gyro_Samples);
+        ConingSum(Alpha, Beta, Gyro_Samples, n);
+        Step = Gyro_Gain * ((float)stBatch.ulPeriod * 1.0e-6f);
+        for ( x = 0; x < 3; x++ ) {
+            pstInput->Theta[x] = Step * ((float)Alpha[x] + (0.5f * Step * (float)Beta[x]));
+        }
+        if (n > 0) {
+            //
+            // Mean rate, held if no sample came since last DELTA_T
+            //
+            for ( x = 0; x < 3; x++ ) {
+                pstInput->Gyro[x] = (Gyro_Gain * (float)Alpha[x]) / (float)n;
+            }
+        }
+    } else {
+        //
+        // Gyro signals
+        //
+        for ( x = 0; x < 3; x++ ) {
+            pstInput->Gyro[x] = Gyro_Gain * pstLast->pfGyro[x];
         }
     }
+
+#ifndef _WINDOWS
+    speed_3d = ((float)GPSSpeed());
+#elif (SIMULATOR == SIM_NONE)
+    speed_3d = Sim_Speed();
+#endif
+    pstInput->fSpeed = speed_3d;
+    pstInput->fCourse = (float)GPSHeading();
+    pstInput->fDeltaT = Delta_T;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Normalize DCM matrix
+/// \return      -
+/// \remarks Publishes DCM_Matrix, invalidates the attitude outputs.
+///
+///----------------------------------------------------------------------------
+void
+Normalize(void)
+{
+    DCM_Normalize(&s_stDCM);
+    DCM_Matrix = s_stDCM.DCM_Matrix;
+    Attitude_Invalidate();
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Adjust acceleration
+/// \return  -
+/// \remarks See Accel_Adjust(). Already done by MatrixUpdate().
+///
+///----------------------------------------------------------------------------
+void
+AccelAdjust(void)
+{
+    Accel_Adjust(&s_stDCM, speed_3d);
 }
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Compensate for roll / pitch / yaw drift
+/// \return  -
+/// \remarks Gains are read at every call, as they can be changed by
+///          telemetry. Uses the GPS course read by MatrixUpdate().
+///
+///----------------------------------------------------------------------------
+void
+CompensateDrift( void )
+{
+    s_stDCM.PitchRoll_Kp = PitchRoll_Kp;
+    s_stDCM.PitchRoll_Ki = PitchRoll_Ki;
+    s_stDCM.Yaw_Kp = Yaw_Kp;
+    s_stDCM.Yaw_Ki = Yaw_Ki;
+    DCM_CompensateDrift(&s_stDCM, &s_stInput);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Update DCM matrix
+/// \return      -
+/// \remarks Reads the sensors, publishes Gyro_Vector, Omega_Vector and
+///          speed_3d, invalidates the attitude outputs.
+///
+///----------------------------------------------------------------------------
+void
+MatrixUpdate(void)
+{
+    DCM_GetInput(&s_stInput);
+    DCM_MatrixUpdate(&s_stDCM, &s_stInput);
+    Gyro_Vector = s_stDCM.Gyro_Vector;
+    Omega_Vector = s_stDCM.Omega_Vector;
+    Attitude_Invalidate();
+}
+
+#endif // ATTITUDE_FILTER == ATT_DCM && DCM_ARITHMETIC == DCM_FLOAT
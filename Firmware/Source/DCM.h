@@ -15,6 +15,10 @@
 
 /*--------------------------------- Definitions ------------------------------*/
 
+#ifdef __cplusplus
+#include "vec3.h"
+#endif
+
 #ifdef VAR_GLOBAL
 #undef VAR_GLOBAL
 #endif
@@ -26,13 +30,52 @@
 
 /*----------------------------------- Types ----------------------------------*/
 
+#ifdef __cplusplus
+//
+// State of one DCM filter (DCM_FLOAT). The firmware runs a single static
+// instance behind MatrixUpdate(), CompensateDrift() and Normalize(); the
+// host can run as many as needed with the DCM_xxx() functions.
+//
+typedef struct {
+    Rot3<float> DCM_Matrix;     // Direction Cosine Matrix
+    Vec3<float> Gyro_Vector;    // raw gyroscope data
+    Vec3<float> Omega_Vector;   // g-corrected gyroscope data
+    Vec3<float> Accel_Vector;   // acceleration, centrifugal corrected
+    Vec3<float> Omega;          // gyro + integral correction
+    Vec3<float> Omega_P;        // proportional correction
+    Vec3<float> Omega_I;        // integral correction
+    float PitchRoll_Kp;         // gains, see PitchRoll_Kp etc.
+    float PitchRoll_Ki;
+    float Yaw_Kp;
+    float Yaw_Ki;
+} STRUCT_DCM;
+
+//
+// Sensor inputs of one DELTA_T, as read by DCM_GetInput()
+//
+typedef struct {
+    Vec3<float> Accel;          // acceleration, Accel_Gain applied
+    Vec3<float> Gyro;           // angular rate, Gyro_Gain applied
+    Vec3<float> Theta;          // gyro rotation with coning, if bConing
+    tBoolean bConing;           // gyro substeps integrated (GYRO_SUBSTEPS > 1)
+    float fSpeed;               // speed for the centrifugal correction
+    float fCourse;              // GPS course over ground [deg]
+    float fDeltaT;              // integration interval, Delta_T [s]
+} STRUCT_DCM_INPUT;
+#endif
+
 /*---------------------------------- Constants -------------------------------*/
 
 /*---------------------------------- Globals ---------------------------------*/
 
-VAR_GLOBAL float DCM_Matrix[3][3] ;
-VAR_GLOBAL float Gyro_Vector[3] ;
-VAR_GLOBAL float Omega_Vector[3] ;
+#ifdef __cplusplus
+//
+// C modules read DCM_Matrix through DCM_GetMatrix()
+//
+VAR_GLOBAL Rot3<float> DCM_Matrix ;
+VAR_GLOBAL Vec3<float> Gyro_Vector ;
+VAR_GLOBAL Vec3<float> Omega_Vector ;
+#endif
 VAR_GLOBAL float Gyro_Gain ;
 VAR_GLOBAL float Accel_Gain ;
 VAR_GLOBAL float PitchRoll_Kp ;
@@ -40,6 +83,8 @@ VAR_GLOBAL float PitchRoll_Ki ;
 VAR_GLOBAL float Yaw_Kp ;
 VAR_GLOBAL float Yaw_Ki ;
 VAR_GLOBAL float speed_3d ;
+VAR_GLOBAL float Delta_T ;
+VAR_GLOBAL float Sample_Rate ;
 
 /*---------------------------------- Interface -------------------------------*/
 
@@ -47,3 +92,12 @@ void Normalize( void );
 void CompensateDrift( void );
 void AccelAdjust( void );
 void MatrixUpdate( void );
+void DCM_Refresh( void );
+void DCM_GetMatrix( float pfMatrix[3][3] );
+#ifdef __cplusplus
+void DCM_Init( STRUCT_DCM *pstDCM );
+void DCM_GetInput( STRUCT_DCM_INPUT *pstInput );
+void DCM_MatrixUpdate( STRUCT_DCM *pstDCM, const STRUCT_DCM_INPUT *pstInput );
+void DCM_CompensateDrift( STRUCT_DCM *pstDCM, const STRUCT_DCM_INPUT *pstInput );
+void DCM_Normalize( STRUCT_DCM *pstDCM );
+#endif
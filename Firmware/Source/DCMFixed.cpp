@@ -0,0 +1,481 @@
+//=============================================================================+
+//
+// $RCSfile: DCMFixed.cpp,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+///
+/// \brief
+/// Direction Cosine Matrix calculations, fixed point
+///
+/// \file
+/// Same algorithm as DCM.cpp, compiled instead of it when ATTITUDE_FILTER is
+/// ATT_DCM and DCM_ARITHMETIC is DCM_FIXED. The LM3S1968 / LM3S9B90 have no
+/// FPU: here the whole pipeline runs on 32 bit integers with 64 bit
+/// products, soft-float is used only to publish the results to the float
+/// globals read by the rest of the firmware.
+///
+/// Number formats:
+/// \code
+///     quantity                      format   range          resolution
+///     DCM entries, unit vectors     Q30      +/- 2          9.3e-10
+///     rates [rad/s]                 Q24      +/- 128        6.0e-8
+///     accelerations [m/s/s]         Q16      +/- 32768      1.5e-5
+///     Omega_I accumulator [rad/s]   Q46      (64 bit)       1.4e-14
+///     Gyro_Gain, Accel_Gain         Q24
+///     PitchRoll_Kp, Yaw_Kp          Q30      +/- 2
+///     PitchRoll_Ki, Yaw_Ki          Q40      +/- 0.00195
+/// \endcode
+///
+/// The integral terms are accumulated on 64 bits because a typical
+/// increment (PitchRoll_Ki * error, ~1e-7 rad/s) is below the Q24
+/// resolution.
+///
+/// The float gains in DCM.h may be changed at any time (Telemetry_Parse);
+/// they are converted again only when their bit pattern changes.
+///
+/// Published values:
+/// - Gyro_Vector, Omega_Vector and speed_3d by MatrixUpdate();
+/// - DCM_Matrix by Normalize().
+///
+//  CHANGES
+//
+//=============================================================================+
+
+#include "stdafx.h"
+
+#include <string.h>
+
+#include "inc/hw_types.h"
+#include "qmath.h"
+#include "vmath.h"
+#include "adcdriver.h"
+#include "gps.h"
+#include "Telemetry.h"
+#include "config.h"
+#include "DCM.h"
+#include "sensor.h"
+#include "Attitude.h"
+
+#if (ATTITUDE_FILTER == ATT_DCM) && (DCM_ARITHMETIC == DCM_FIXED)
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_STATIC
+#undef VAR_STATIC
+#endif
+#define VAR_STATIC static
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL
+
+#define Q_DCM       30          ///< DCM entries
+#define Q_RATE      24          ///< angular rates
+#define Q_ACCEL     16          ///< accelerations
+#define Q_INTEGRAL  46          ///< integral accumulator
+#define Q_GAIN      24          ///< sensor gains
+#define Q_KP        30          ///< proportional gains
+#define Q_KI        40          ///< integral gains
+#define Q_DT        34          ///< integration interval, up to 125 ms
+
+//
+// Delta_T is measured and clamped at four loop periods (DELTA_T_MAX, main.c)
+//
+#if (LOOP_RATE_MIN <= (4 << (Q_DT - 31)))
+#   error "LOOP_RATE_MIN too low for Q_DT"
+#endif
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+typedef struct {            // cached float gain
+    const float *pfGain;    // float gain (DCM.h)
+    uint32_t ulBits;        // last converted bit pattern
+    int32_t *pqGain;        // fixed point gain
+    int iShift;             // format of fixed point gain
+} STRUCT_GAIN;
+
+/*---------------------------------- Constants -------------------------------*/
+
+//! sin(x) for x = 0 .. 90 deg, Q30
+VAR_STATIC const int32_t pq30Sine[91] = {
+             0,   18739379,   37473049,   56195305,   74900443,  //  0
+      93582766,  112236583,  130856211,  149435979,  167970228,  //  5
+     186453311,  204879599,  223243478,  241539355,  259761657,  // 10
+     277904834,  295963357,  313931728,  331804471,  349576144,  // 15
+     367241333,  384794656,  402230767,  419544355,  436730145,  // 20
+     453782903,  470697435,  487468587,  504091252,  520560366,  // 25
+     536870912,  553017922,  568996477,  584801711,  600428808,  // 30
+     615873009,  631129609,  646193961,  661061475,  675727625,  // 35
+     690187940,  704438018,  718473518,  732290163,  745883746,  // 40
+     759250125,  772385229,  785285058,  797945680,  810363241,  // 45
+     822533958,  834454122,  846120104,  857528349,  868675383,  // 50
+     879557810,  890172315,  900515665,  910584710,  920376381,  // 55
+     929887697,  939115760,  948057759,  956710970,  965072759,  // 60
+     973140576,  980911966,  988384560,  995556083, 1002424350,  // 65
+    1008987269, 1015242840, 1021189159, 1026824413, 1032146887,  // 70
+    1037154959, 1041847103, 1046221891, 1050277989, 1054014162,  // 75
+    1057429273, 1060522280, 1063292242, 1065738315, 1067859754,  // 80
+    1069655912, 1071126243, 1072270298, 1073087729, 1073578288,  // 85
+    1073741824                                                   // 90
+};
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+//! Direction Cosine Matrix, Q30
+VAR_STATIC int32_t q30DCM[3][3] = {
+    { Q30_ONE, 0, 0 },
+    { 0, Q30_ONE, 0 },
+    { 0, 0, Q30_ONE }
+};
+
+VAR_STATIC int32_t q16Accel[3];         // Acceleration vector
+VAR_STATIC int32_t q24Gyro[3];          // Gyroscope data
+VAR_STATIC int32_t q24Omega[3];         // Gyro + integral correction
+VAR_STATIC int32_t q24OmegaVector[3];   // Gyro + integral + proportional
+VAR_STATIC int32_t q24OmegaP[3];        // Proportional correction
+VAR_STATIC int32_t q24OmegaI[3];        // Integral correction
+VAR_STATIC int64_t q46OmegaI[3];        // Integral correction accumulator
+VAR_STATIC unsigned int uiSpeed;        // Speed [m/s]
+
+VAR_STATIC int32_t q24GyroGain;         // Gyro_Gain
+VAR_STATIC int32_t q24AccelGain;        // Accel_Gain
+VAR_STATIC int32_t q30PitchRollKp;      // PitchRoll_Kp
+VAR_STATIC int32_t q40PitchRollKi;      // PitchRoll_Ki
+VAR_STATIC int32_t q30YawKp;            // Yaw_Kp
+VAR_STATIC int32_t q40YawKi;            // Yaw_Ki
+VAR_STATIC int32_t q34DeltaT;           // Delta_T
+VAR_STATIC int32_t q16Centrifugal;      // 9.81 / Sensor_Gravity
+VAR_STATIC uint32_t ulGravityBits = 0xFFFFFFFFUL;   // Sensor_Gravity converted
+
+VAR_STATIC STRUCT_GAIN pstGain[7] = {
+    { &Gyro_Gain,    0xFFFFFFFFUL, &q24GyroGain,    Q_GAIN },
+    { &Accel_Gain,   0xFFFFFFFFUL, &q24AccelGain,   Q_GAIN },
+    { &PitchRoll_Kp, 0xFFFFFFFFUL, &q30PitchRollKp, Q_KP },
+    { &PitchRoll_Ki, 0xFFFFFFFFUL, &q40PitchRollKi, Q_KI },
+    { &Yaw_Kp,       0xFFFFFFFFUL, &q30YawKp,       Q_KP },
+    { &Yaw_Ki,       0xFFFFFFFFUL, &q40YawKi,       Q_KI },
+    { &Delta_T,      0xFFFFFFFFUL, &q34DeltaT,      Q_DT }
+};
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Convert float gains that have changed
+/// \return  -
+/// \remarks Compares bit patterns, so it costs no float operation when the
+///          gains are unchanged. Gains out of range are saturated. Also the
+///          centrifugal factor, when another sensor backend changes
+///          Sensor_Gravity.
+///
+///----------------------------------------------------------------------------
+static void
+Gains_Update(void)
+{
+    int j;
+    uint32_t ulBits;
+    float fValue, fMax;
+    STRUCT_GAIN *pstG;
+
+    memcpy(&ulBits, &Sensor_Gravity, sizeof(float));
+    if (ulBits != ulGravityBits) {
+        ulGravityBits = ulBits;
+        q16Centrifugal = FLOAT2Q(9.81f / Sensor_Gravity, Q_ACCEL);
+    }
+
+    for (j = 0; j < (int)(sizeof(pstGain) / sizeof(STRUCT_GAIN)); j++) {
+        pstG = &pstGain[j];
+        memcpy(&ulBits, pstG->pfGain, sizeof(float));
+        if (ulBits != pstG->ulBits) {
+            pstG->ulBits = ulBits;
+            fValue = *pstG->pfGain;
+            fMax = 2147483647.0f / (float)(1LL << pstG->iShift);
+            if (fValue > fMax) {
+                fValue = fMax;
+            } else if (fValue < -fMax) {
+                fValue = -fMax;
+            }
+            *pstG->pqGain = (int32_t)(fValue * (float)(1LL << pstG->iShift));
+        }
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Sine and cosine of an integer angle
+/// \return  -
+/// \remarks angle in degrees, any value; results Q30
+///
+///----------------------------------------------------------------------------
+static void
+SinCos(int iAngle, int32_t *pq30Sin, int32_t *pq30Cos)
+{
+    int32_t q30Sin, q30Cos;
+
+    iAngle %= 360;
+    if (iAngle < 0) {
+        iAngle += 360;
+    }
+    if (iAngle <= 90) {
+        q30Sin =  pq30Sine[iAngle];
+        q30Cos =  pq30Sine[90 - iAngle];
+    } else if (iAngle <= 180) {
+        q30Sin =  pq30Sine[180 - iAngle];
+        q30Cos = -pq30Sine[iAngle - 90];
+    } else if (iAngle <= 270) {
+        q30Sin = -pq30Sine[iAngle - 180];
+        q30Cos = -pq30Sine[270 - iAngle];
+    } else {
+        q30Sin = -pq30Sine[360 - iAngle];
+        q30Cos =  pq30Sine[iAngle - 270];
+    }
+    *pq30Sin = q30Sin;
+    *pq30Cos = q30Cos;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Normalize DCM matrix
+/// \return  -
+/// \remarks See DCM.cpp, Eq. 19 - 21. Publishes DCM_Matrix.
+///
+///----------------------------------------------------------------------------
+void
+Normalize(void)
+{
+    int32_t q30Error;
+    int32_t q30Temporary[3][3];
+    int64_t q30Renorm;
+    int x, y;
+
+    //
+    // Xorthogonal = X - (error / 2) Y, Yorthogonal = Y - (error / 2) X
+    //
+    q30Error = -((QVectorDotProduct(q30DCM[0], q30DCM[1]) + 1) >> 1);
+    QVectorScale(q30Temporary[0], q30DCM[1], q30Error, Q_DCM);
+    QVectorScale(q30Temporary[1], q30DCM[0], q30Error, Q_DCM);
+    QVectorAdd(q30Temporary[0], q30Temporary[0], q30DCM[0]);
+    QVectorAdd(q30Temporary[1], q30Temporary[1], q30DCM[1]);
+
+    //
+    // Zorthogonal = Xorthogonal /\ Yorthogonal
+    //
+    QVectorCrossProduct(q30Temporary[2], q30Temporary[0], q30Temporary[1]);
+
+    //
+    // normalized = (3 - orthogonal . orthogonal) / 2 * orthogonal
+    //
+    for (x = 0; x < 3; x++) {
+        q30Renorm = ((3LL << Q_DCM) - QVectorDotProduct(q30Temporary[x], q30Temporary[x]) + 1) >> 1;
+        QVectorScale(q30DCM[x], q30Temporary[x], (int32_t)q30Renorm, Q_DCM);
+    }
+
+    //
+    // Publish
+    //
+    for (x = 0; x < 3; x++) {
+        for (y = 0; y < 3; y++) {
+            DCM_Matrix[x][y] = Q2FLOAT(q30DCM[x][y], Q_DCM);
+        }
+    }
+    Attitude_Invalidate();
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Adjust acceleration
+/// \return  -
+/// \remarks Centrifugal correction, see DCM.cpp
+///
+///----------------------------------------------------------------------------
+void
+AccelAdjust(void)
+{
+    int64_t q40Speed;
+
+    uiSpeed = GPSSpeed();
+    speed_3d = (float)uiSpeed;
+
+    q40Speed = (int64_t)uiSpeed * q16Centrifugal;
+    q16Accel[1] += (int32_t)((q40Speed * q24Omega[2]) >> Q_RATE);
+    q16Accel[2] -= (int32_t)((q40Speed * q24Omega[1]) >> Q_RATE);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Compensate for roll / pitch / yaw drift
+/// \return  -
+/// \remarks See DCM.cpp
+///
+///----------------------------------------------------------------------------
+void
+CompensateDrift(void)
+{
+    int32_t q16ErrorRollPitch[3];
+    int32_t q30ErrorYaw[3];
+    int32_t q30ErrorCourse;
+    int32_t q30COGX, q30COGY;
+    int32_t q24ScaledOmegaP[3];
+    int j;
+
+    //
+    // RollPitch correction
+    //
+    QVectorCrossProduct(q16ErrorRollPitch, q16Accel, q30DCM[2]);
+    QVectorScale(q24OmegaP, q16ErrorRollPitch, q30PitchRollKp, Q_ACCEL + Q_KP - Q_RATE);
+    for (j = 0; j < 3; j++) {
+        q46OmegaI[j] += ((int64_t)q16ErrorRollPitch[j] * q40PitchRollKi) >>
+                        (Q_ACCEL + Q_KI - Q_INTEGRAL);
+    }
+
+    //
+    // Course over ground
+    //
+    SinCos(GPSHeading(), &q30COGY, &q30COGX);
+
+    //
+    // Yaw correction (ground)
+    //
+    q30ErrorCourse = (int32_t)(((int64_t)q30DCM[0][0] * q30COGY -
+                                (int64_t)q30DCM[1][0] * q30COGX + (1LL << 29)) >> Q_DCM);
+
+    //
+    // Yaw correction (aircraft)
+    //
+    QVectorScale(q30ErrorYaw, q30DCM[2], q30ErrorCourse, Q_DCM);
+
+    //
+    // YAW proportional and integral gain
+    //
+    QVectorScale(q24ScaledOmegaP, q30ErrorYaw, q30YawKp, Q_DCM + Q_KP - Q_RATE);
+    QVectorAdd(q24OmegaP, q24OmegaP, q24ScaledOmegaP);
+    for (j = 0; j < 3; j++) {
+        q46OmegaI[j] += ((int64_t)q30ErrorYaw[j] * q40YawKi) >> (Q_DCM + Q_KI - Q_INTEGRAL);
+        q24OmegaI[j] = (int32_t)((q46OmegaI[j] + (1LL << (Q_INTEGRAL - Q_RATE - 1))) >>
+                                 (Q_INTEGRAL - Q_RATE));
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Update DCM matrix
+/// \return  -
+/// \remarks Update_Matrix is skew symmetric, so DCM * Update_Matrix is
+///          computed row by row as row /\ (Omega_Vector * DELTA_T): 18
+///          multiplications instead of 27. Publishes Gyro_Vector,
+///          Omega_Vector and speed_3d.
+///          Reads the selected sensor backend (sensor.c): if its batches
+///          are gyro substeps (GYRO_SUBSTEPS > 1) the gyro rotation is the
+///          sum of all the samples since the last call plus the coning
+///          term, as in DCM.cpp: the sample period of the backend times
+///          Gyro_Gain is Q40, its square / 2 Q50.
+///
+///----------------------------------------------------------------------------
+void
+MatrixUpdate(void)
+{
+    int32_t q30Theta[3];
+    int32_t q30Delta[3];
+    long lSensor[6];
+    int x;
+
+    int32_t q30GyroTheta[3];
+    int32_t q24Correction[3];
+    STRUCT_SENSOR_BATCH stBatch;
+    const STRUCT_SENSOR_SAMPLE *pstLast;
+    long plSample[SENSOR_BATCH][3];
+    long plAlpha[3], plBeta[3];
+    int64_t q40Step, q50HalfStep2;
+    int n;
+
+    Gains_Update();
+
+    //
+    // Sensor signals, last sample
+    //
+    Sensor_Read(&stBatch);
+    pstLast = Sensor_Last();
+    for (x = 0; x < 3; x++) {
+        lSensor[x] = (long)pstLast->pfAccel[x];
+        lSensor[x + 3] = (long)pstLast->pfGyro[x];
+    }
+
+    //
+    // Accelerometer signals
+    //
+    for (x = 0; x < 3; x++) {
+        q16Accel[x] = (int32_t)(((int64_t)lSensor[x] * q24AccelGain) >> (Q_GAIN - Q_ACCEL));
+    }
+
+    if (!stBatch.bSubsteps) {
+        //
+        // Gyro signals
+        //
+        for (x = 0; x < 3; x++) {
+            q24Gyro[x] = (int32_t)lSensor[x + 3] * q24GyroGain;
+        }
+    } else {
+        //
+        // Gyro signals, every sample since last DELTA_T
+        //
+        n = Sensor_GyroSteps(&stBatch, plSample);
+        ConingSum(plAlpha, plBeta, plSample, n);
+        q40Step = (((int64_t)q24GyroGain * (int64_t)stBatch.ulPeriod) << (40 - Q_GAIN)) / 1000000;
+        q50HalfStep2 = (q40Step * q40Step) >> (40 + 40 - 50 + 1);
+        for (x = 0; x < 3; x++) {
+            if (n > 0) {                    // else held
+                q24Gyro[x] = (int32_t)(((int64_t)plAlpha[x] * q24GyroGain) / n);
+            }
+            q30GyroTheta[x] = (int32_t)((((int64_t)plAlpha[x] * q40Step) >> (40 - Q_DCM)) +
+                                        (((int64_t)plBeta[x] * q50HalfStep2) >> (50 - Q_DCM)));
+        }
+    }
+
+    //
+    // adding integral and proportional
+    //
+    QVectorAdd(q24Omega, q24Gyro, q24OmegaI);
+    QVectorAdd(q24OmegaVector, q24Omega, q24OmegaP);
+
+    //
+    // adjust centrifugal acceleration.
+    //
+    AccelAdjust();
+
+    //
+    // Rotation during DELTA_T
+    //
+    if (stBatch.bSubsteps) {
+        QVectorAdd(q24Correction, q24OmegaI, q24OmegaP);
+        QVectorScale(q30Theta, q24Correction, q34DeltaT, Q_RATE + Q_DT - Q_DCM);
+        QVectorAdd(q30Theta, q30Theta, q30GyroTheta);
+    } else {
+        QVectorScale(q30Theta, q24OmegaVector, q34DeltaT, Q_RATE + Q_DT - Q_DCM);
+    }
+
+    //
+    // Update DCM matrix
+    //
+    for (x = 0; x < 3; x++) {
+        QVectorCrossProduct(q30Delta, q30DCM[x], q30Theta);
+        QVectorAdd(q30DCM[x], q30DCM[x], q30Delta);
+    }
+
+    //
+    // Publish
+    //
+    for (x = 0; x < 3; x++) {
+        Gyro_Vector[x] = Q2FLOAT(q24Gyro[x], Q_RATE);
+        Omega_Vector[x] = Q2FLOAT(q24OmegaVector[x], Q_RATE);
+    }
+    Attitude_Invalidate();
+}
+
+#endif // ATTITUDE_FILTER == ATT_DCM && DCM_ARITHMETIC == DCM_FIXED
@@ -12,7 +12,13 @@
 /// If the state machine selects pitch feedback, compute it from the pitch gyro
 /// and accelerometer.
 ///
+/// Rate groups: the pitch angle and roll mix terms are computed by
+/// Elevator_Attitude() (ATTITUDE_PERIOD), the pitch rate damping and the
+/// output by Elevator_Damping() at every control loop. Elevator_Control()
+/// runs both at the same rate.
+///
 //  CHANGES gains.h sostituito da config.h
+//          controllo diviso in gruppi di frequenza
 //
 //============================================================================*/
 
@@ -59,32 +65,74 @@ VAR_GLOBAL float Pitch_Altitude_Adjust = 0.0f;
 /*----------------------------------- Locals ---------------------------------*/
 
 VAR_STATIC float elev_accum ;
+VAR_STATIC float elev_attitude ;        // Pitch angle term
+VAR_STATIC float elev_mix ;             // Aileron elevator mix term
 
 //----------------------------------------------------------------------------
 //
 /// \brief   Control of aircraft elevator.
 ///
-/// \remarks Computes elevator deflection to keep aircraft level.
+/// \remarks Computes elevator deflection to keep aircraft level. Runs the
+///          attitude and damping groups at the same rate.
 ///
 //----------------------------------------------------------------------------
 void
 Elevator_Control(void) {
 
-    float ail_elv_mix;
-    float pitch_rate;
+    Elevator_Attitude();
+    Elevator_Damping();
+}
 
-    ail_elv_mix = 0;
+//----------------------------------------------------------------------------
+//
+/// \brief   Elevator attitude group: pitch angle and roll mix terms.
+///
+/// \remarks Mid rate group.
+///
+//----------------------------------------------------------------------------
+void
+Elevator_Attitude(void) {
+
+    DCM_Refresh();
+
+    //
+    // Third row of DCM: the down axis in body frame
+    //
+    const Vec3<float> &Down = DCM_Matrix[2];
 
     // ORIGINALE : navElevMix = rmat[6] * rmat[6] * rollElevMixGain ;
-    ail_elv_mix = DCM_Matrix[2][1] * DCM_Matrix[2][1] * Ail_Elv_Mix_Gain ;
+    elev_mix = Down[1] * Down[1] * Ail_Elv_Mix_Gain ;
+
+    // ORIGINALE : ((rmat[7] - rtlkick + pitchAltitudeAdjust) * Pitch_Kp ) + (Pitch_Kd * Pitch_Rate) ;
+    elev_attitude = (Down[0] + Pitch_Altitude_Adjust) * Pitch_Kp;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Elevator damping group: pitch rate term and output.
+///
+/// \remarks Runs at every control loop, before ServoUpdate(). Uses the last
+///          output of Elevator_Attitude().
+///
+//----------------------------------------------------------------------------
+void
+Elevator_Damping(void) {
+
+    float pitch_rate;
+
+    DCM_Refresh();
+
+    //
+    // Third row of DCM: the down axis in body frame
+    //
+    const Vec3<float> &Down = DCM_Matrix[2];
 
     // ORIGINALE : ((rmat[8] * omegagyro[0]) - (rmat[6] * omegagyro[2])) << 1 ;
-    pitch_rate = (DCM_Matrix[2][2] * Gyro_Vector[1]) - (DCM_Matrix[2][1] * Gyro_Vector[2]);
+    pitch_rate = Cross(Gyro_Vector, Down)[0];
 
-    // ORIGINALE : ((rmat[7] - rtlkick + pitchAltitudeAdjust) * Pitch_Kp ) + (Pitch_Kd * Pitch_Rate) ;
-    elev_accum = ((DCM_Matrix[2][0] + Pitch_Altitude_Adjust) * Pitch_Kp) + (Pitch_Kd * pitch_rate) ;
+    elev_accum = elev_attitude + (Pitch_Kd * pitch_rate) ;
 
-    elev_accum += ail_elv_mix;
+    elev_accum += elev_mix;
 }
 
 //----------------------------------------------------------------------------
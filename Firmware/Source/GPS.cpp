@@ -13,6 +13,8 @@
 ///       change sign of Lon based on E / W char ( commas == 6 )
 ///
 //  CHANGES Simulation.h sostituito da Telemetry.h
+//          tempo di inizio della sentenza, registrato nel log con record '@'
+//          GPSPending(): caratteri in attesa, per svuotare il buffer
 //
 //============================================================================*/
 
@@ -24,6 +26,7 @@
 #endif
 
 #include "log.h"
+#include "timebase.h"
 #include "gps.h"
 
 /*--------------------------------- Definitions ------------------------------*/
@@ -41,10 +44,16 @@
 
 #ifdef _WINDOWS
 #   define Gps_GetChar(c) TRUE
+#   define Gps_Pending() FALSE
+#   define Gps_Time() Timebase_Us()
 #elif (GPS_DEBUG == 0)
 #   define Gps_GetChar UART1GetChar
+#   define Gps_Pending UART1Pending
+#   define Gps_Time UART1SentenceTime
 #else
 #   define Gps_GetChar Debug_GetChar
+#   define Gps_Pending() false
+#   define Gps_Time() Timebase_Us()
 #endif
 
 /*----------------------------------- Macros ---------------------------------*/
@@ -67,6 +76,8 @@ VAR_GLOBAL unsigned char Gps_Status;    //
 VAR_STATIC int North;                 // angle to north
 VAR_STATIC unsigned int Speed;        // speed
 VAR_STATIC char pcLogGps[GPS_LENGTH]; //
+VAR_STATIC unsigned long ulSentenceTime;    // start of current sentence [us]
+VAR_STATIC unsigned long ulFixTime;         // start of last fix sentence [us]
 
 #if (GPS_DEBUG == 1)
 VAR_STATIC const char s_pcSentence[] = "008,001.9,E,A*3E\n$GPRMC,194617.04,A,4534.6714,N,01128.8559,E,000.0,287.0,091008,001.9,E,A*31\n$GPRMC,194618.04,A,4534.6714,N,01128.8559,E,000.0,287.0,091";
@@ -170,7 +181,10 @@ tBoolean GPSParse( void )
 
     if (Gps_GetChar(&c)) {                    // received another character
 
-        if ( c == '$' ) commas = 0;           // start of NMEA sentence
+        if ( c == '$' ) {                     // start of NMEA sentence
+            commas = 0;
+            ulSentenceTime = Gps_Time();
+        }
 
         if ( c == ',' ) commas++;             // count commas
 
@@ -225,6 +239,7 @@ tBoolean GPSParse( void )
                 commas = 10;
                 Heading /= 10;
                 North = 360 - Heading;
+                ulFixTime = ulSentenceTime;
                 result = true;
         }
 
@@ -232,6 +247,9 @@ tBoolean GPSParse( void )
             pcLogGps[j++] = c;                // Log GPS sentence
         }
         if (c == '\n') {                      // end of NMEA sentence
+            Log_PutChar('@');                 // Sentence start time
+            Log_Stamp(ulSentenceTime);
+            Log_PutChar('\n');
             for (i = 0; i < j; i++) {
                 Log_PutChar(pcLogGps[i]);
             }
@@ -259,6 +277,39 @@ tBoolean GPSFix ( void )
 }
 
 
+//----------------------------------------------------------------------------
+//
+/// \brief   Check for GPS characters
+///
+/// \returns true if received characters are waiting to be parsed
+///
+/// \remarks GPSParse() takes one character per call.
+///
+///
+//----------------------------------------------------------------------------
+tBoolean GPSPending ( void )
+{
+  return Gps_Pending();
+}
+
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Get time of the last fix
+///
+/// \returns Timebase_Us() at the start of the sentence of the last fix
+///
+/// \remarks Position, speed and heading are as old as this time, plus the
+///          receiver latency.
+///
+///
+//----------------------------------------------------------------------------
+unsigned long GPSTime ( void )
+{
+  return ulFixTime;
+}
+
+
 //----------------------------------------------------------------------------
 //
 /// \brief   Get current GPS heading
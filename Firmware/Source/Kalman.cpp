@@ -0,0 +1,506 @@
+//=============================================================================+
+//
+// $RCSfile: Kalman.cpp,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+///
+/// \brief
+/// Attitude estimation with three linear Kalman filters
+///
+/// \file
+/// Compiled instead of DCM.cpp / DCMFixed.cpp when ATTITUDE_FILTER is
+/// ATT_KALMAN. The attitude is kept as the Euler angles roll, pitch, yaw
+/// (Z-Y-X), each one with its own two state Kalman filter:
+/// \code
+///     state           x = | angle |       angle [rad], gyro bias [rad/s]
+///                         | bias  |
+///
+///     prediction      angle = angle + DELTA_T * rate(Gyro_Vector - bias)
+///
+///                     F = | 1  -DELTA_T |     H = | 1  0 |
+///                         | 0     1     |
+///
+///     measurement     roll  = atan2(Ay, Az)
+///                     pitch = atan2(-Ax, sqrt(Ay Ay + Az Az))
+///                     yaw   = course over ground
+/// \endcode
+/// where rate() are the Euler angle rates from the body rates and A is
+/// Accel_Vector after the centrifugal correction of DCM.cpp. The roll / pitch
+/// measurements are the angles that make the earth Z axis (row 2 of
+/// DCM_Matrix) parallel to A, the yaw measurement is the angle that brings
+/// the errorCourse of DCM.cpp to zero. The bias of each angle is referred to
+/// the body axis with the same index, which is exact for level flight: the
+/// coupling through rate() is ignored, as in the usual "angle + bias"
+/// filters for the accelerometer / gyro pair.
+///
+/// With KALMAN_GAIN set to KALMAN_STEADY the gains are the steady state
+/// solution of the Riccati equation, computed once at the first
+/// MatrixUpdate(), and the correction is two multiplications per axis.
+/// KALMAN_FULL propagates the 2 x 2 covariance each tick instead (about 10
+/// more multiplications and two divisions per axis) and converges faster
+/// after start up.
+///
+/// Cost per tick compared with DCM.cpp:
+/// \code
+///                       DCM.cpp                   Kalman.cpp
+///     MatrixUpdate()    27 mul (MatrixMultiply)   10 mul, 2 div, sin / cos
+///                                                 of roll and pitch
+///     Normalize()       33 mul, 3 cross / dot     angle wrap only
+///     CompensateDrift() 15 mul, sin / cos course  2 atan2, 1 sqrt, 8 mul
+///     DCM_Refresh()     -                         sin / cos of 3 angles,
+///                                                 12 mul, only when needed
+/// \endcode
+/// The gains PitchRoll_Kp, PitchRoll_Ki, Yaw_Kp, Yaw_Ki set by telemetry
+/// do not apply to this filter. Pitch must stay away from +/-90 deg, where
+/// the yaw and roll rates are not defined.
+///
+//  CHANGES
+//
+//=============================================================================+
+
+#include "stdafx.h"
+
+#include "inc/hw_types.h"
+#include "math.h"
+#include "vmath.h"
+#include "fastmath.h"
+#include "vec3.h"
+#include "adcdriver.h"
+#include "gps.h"
+#include "Telemetry.h"
+#include "config.h"
+#include "DCM.h"
+#include "sensor.h"
+#include "timing.h"
+#include "Attitude.h"
+
+#if (ATTITUDE_FILTER == ATT_KALMAN)
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_STATIC
+#undef VAR_STATIC
+#endif
+#define VAR_STATIC static
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL
+
+//! Densita' spettrale del rumore del giroscopio, rollio beccheggio [rad^2/s]
+#define PITCHROLL_Q_ANGLE   0.0001f
+/// Gyro noise and the error of the Euler rates while turning
+
+//! Densita' spettrale della deriva del giroscopio, rollio beccheggio [rad^2/s^3]
+#define PITCHROLL_Q_BIAS    0.000001f
+
+//! Varianza della misura di rollio beccheggio dall'accelerometro [rad^2]
+#define PITCHROLL_R         0.5f
+/// Large, the accelerometer also measures the accelerations of the plane
+
+//! Densita' spettrale del rumore del giroscopio, imbardata [rad^2/s]
+#define YAW_Q_ANGLE         0.001f
+
+//! Densita' spettrale della deriva del giroscopio, imbardata [rad^2/s^3]
+#define YAW_Q_BIAS          0.000001f
+
+//! Varianza della misura di imbardata dalla rotta GPS [rad^2]
+#define YAW_R               0.05f
+
+//! Iterazioni dell'equazione di Riccati per il guadagno a regime
+#define KALMAN_ITERATIONS   2000
+/// 40 s at 50 Hz, the gains settle within a few hundred
+
+//! Limite inferiore di cos(pitch) nel calcolo delle velocita' angolari
+#define KALMAN_MIN_COS      0.01f
+
+/*----------------------------------- Macros ---------------------------------*/
+
+#define ToRad(x) (((x) * PI) / 180.0f)
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+typedef enum {
+    KF_ROLL,                    // roll, bias of gyro x
+    KF_PITCH,                   // pitch, bias of gyro y
+    KF_YAW,                     // yaw, bias of gyro z
+    KF_NUMBER
+} ENUM_KF_AXIS;
+
+/*----------------------------------- Types ----------------------------------*/
+
+typedef struct {                // Kalman filter of one angle
+    float fAngle;               // angle [rad]
+    float fBias;                // gyro bias [rad/s]
+    float fQAngle;              // process noise of the angle [rad^2/s]
+    float fQBias;               // process noise of the bias [rad^2/s^3]
+    float fR;                   // measurement noise [rad^2]
+    float fP[2][2];             // covariance
+    float fK[2];                // gain
+} STRUCT_KF;
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+//! Filters of roll, pitch, yaw
+VAR_STATIC STRUCT_KF s_stKF[KF_NUMBER] = {
+    { 0.0f, 0.0f, PITCHROLL_Q_ANGLE, PITCHROLL_Q_BIAS, PITCHROLL_R,
+      {{ 0.0f, 0.0f }, { 0.0f, 0.0f }}, { 0.0f, 0.0f } },
+    { 0.0f, 0.0f, PITCHROLL_Q_ANGLE, PITCHROLL_Q_BIAS, PITCHROLL_R,
+      {{ 0.0f, 0.0f }, { 0.0f, 0.0f }}, { 0.0f, 0.0f } },
+    { 0.0f, 0.0f, YAW_Q_ANGLE, YAW_Q_BIAS, YAW_R,
+      {{ 0.0f, 0.0f }, { 0.0f, 0.0f }}, { 0.0f, 0.0f } }
+};
+//! Gains of s_stKF computed
+VAR_STATIC tBoolean bGainValid = FALSE;
+//! DCM_Matrix is up to date with s_stKF
+VAR_STATIC tBoolean bMatrixValid = TRUE;
+
+//! Acceleration vector
+VAR_STATIC Vec3<float> Accel_Vector = {{ 0.0f, 0.0f, 0.0f }};
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Wrap an angle to +/-PI
+/// \return  angle [rad]
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static float
+Wrap(float fAngle)
+{
+    if (fAngle > PI) {
+        fAngle -= 2.0f * PI;
+    } else if (fAngle < -PI) {
+        fAngle += 2.0f * PI;
+    }
+    return fAngle;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Covariance prediction
+/// \return  -
+/// \remarks P = F P F' + Q dt
+///
+///----------------------------------------------------------------------------
+static void
+KF_Predict(STRUCT_KF *pstKF, float fDeltaT)
+{
+    float (*P)[2] = pstKF->fP;
+
+    P[0][0] += fDeltaT * ((fDeltaT * P[1][1]) - P[0][1] - P[1][0] + pstKF->fQAngle);
+    P[0][1] -= fDeltaT * P[1][1];
+    P[1][0] -= fDeltaT * P[1][1];
+    P[1][1] += fDeltaT * pstKF->fQBias;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Gain and covariance correction
+/// \return  -
+/// \remarks K = P H' / (H P H' + R), P = (I - K H) P
+///
+///----------------------------------------------------------------------------
+static void
+KF_Gain(STRUCT_KF *pstKF)
+{
+    float (*P)[2] = pstKF->fP;
+    float *K = pstKF->fK;
+    float S, P00, P01;
+
+    S = P[0][0] + pstKF->fR;
+    K[0] = P[0][0] / S;
+    K[1] = P[1][0] / S;
+
+    P00 = P[0][0];
+    P01 = P[0][1];
+    P[0][0] -= K[0] * P00;
+    P[0][1] -= K[0] * P01;
+    P[1][0] -= K[1] * P00;
+    P[1][1] -= K[1] * P01;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Measurement update
+/// \return  -
+/// \remarks fInnovation is measurement - angle, already wrapped for yaw
+///
+///----------------------------------------------------------------------------
+static void
+KF_Correct(STRUCT_KF *pstKF, float fInnovation)
+{
+#if (KALMAN_GAIN == KALMAN_FULL)
+    KF_Predict(pstKF, Delta_T);
+    KF_Gain(pstKF);
+#endif
+    pstKF->fAngle += pstKF->fK[0] * fInnovation;
+    pstKF->fBias += pstKF->fK[1] * fInnovation;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Initialize filters
+/// \return  -
+/// \remarks Level, facing north, no bias. With KALMAN_STEADY the gains are
+///          computed iterating prediction and correction from a null
+///          covariance, at the nominal loop interval (timing.c) rather than
+///          the measured one of the first tick; with KALMAN_FULL the
+///          covariance starts large, so that the first measurements are
+///          taken almost as they are.
+///          Called by the first MatrixUpdate().
+///
+///----------------------------------------------------------------------------
+static void
+KF_Init(void)
+{
+    STRUCT_KF *pstKF;
+    int i;
+#if (KALMAN_GAIN == KALMAN_STEADY)
+    int n;
+#endif
+
+    for (pstKF = s_stKF; pstKF < &s_stKF[KF_NUMBER]; pstKF++) {
+        pstKF->fAngle = 0.0f;
+        pstKF->fBias = 0.0f;
+        pstKF->fP[0][1] = 0.0f;
+        pstKF->fP[1][0] = 0.0f;
+#if (KALMAN_GAIN == KALMAN_STEADY)
+        pstKF->fP[0][0] = 0.0f;
+        pstKF->fP[1][1] = 0.0f;
+        for (n = 0; n < KALMAN_ITERATIONS; n++) {
+            KF_Predict(pstKF, Timing_Get()->fDeltaT);
+            KF_Gain(pstKF);
+        }
+#else
+        pstKF->fP[0][0] = PI * PI;
+        pstKF->fP[1][1] = 0.01f;
+        pstKF->fK[0] = 0.0f;
+        pstKF->fK[1] = 0.0f;
+#endif
+    }
+    for (i = 0; i < 3; i++) {
+        Omega_Vector[i] = 0.0f;
+    }
+    bGainValid = TRUE;
+    bMatrixValid = FALSE;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Bring DCM_Matrix up to date
+/// \return  -
+/// \remarks Z-Y-X rotation from the Euler angles, if they changed since the
+///          last call.
+///
+///----------------------------------------------------------------------------
+void
+DCM_Refresh(void)
+{
+    float sr, cr, sp, cp, sy, cy;
+
+    if (bMatrixValid) {
+        return;
+    }
+    bMatrixValid = TRUE;
+
+    FastSinCos(s_stKF[KF_ROLL].fAngle, &sr, &cr);
+    FastSinCos(s_stKF[KF_PITCH].fAngle, &sp, &cp);
+    FastSinCos(s_stKF[KF_YAW].fAngle, &sy, &cy);
+
+    DCM_Matrix[0][0] = cp * cy;
+    DCM_Matrix[0][1] = (sr * sp * cy) - (cr * sy);
+    DCM_Matrix[0][2] = (cr * sp * cy) + (sr * sy);
+    DCM_Matrix[1][0] = cp * sy;
+    DCM_Matrix[1][1] = (sr * sp * sy) + (cr * cy);
+    DCM_Matrix[1][2] = (cr * sp * sy) - (sr * cy);
+    DCM_Matrix[2][0] = -sp;
+    DCM_Matrix[2][1] = sr * cp;
+    DCM_Matrix[2][2] = cr * cp;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Wrap angles
+/// \return  -
+/// \remarks Keeps roll and yaw within +/-PI. The Euler angles need no
+///          normalization, the name is kept for the caller in main.c.
+///
+///----------------------------------------------------------------------------
+void
+Normalize(void)
+{
+    s_stKF[KF_ROLL].fAngle = Wrap(s_stKF[KF_ROLL].fAngle);
+    s_stKF[KF_YAW].fAngle = Wrap(s_stKF[KF_YAW].fAngle);
+    bMatrixValid = FALSE;
+    Attitude_Invalidate();
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Adjust acceleration
+/// \return  -
+/// \remarks Centrifugal correction, see DCM.cpp. Uses the body rates
+///          without bias.
+///
+///----------------------------------------------------------------------------
+void
+AccelAdjust(void)
+{
+#ifndef _WINDOWS
+    speed_3d = ((float)GPSSpeed());
+#elif (SIMULATOR == SIM_NONE)
+    speed_3d = Sim_Speed();
+#endif
+    Accel_Vector[1] += ((speed_3d * Omega_Vector[2] * 9.81f) / Sensor_Gravity);
+    Accel_Vector[2] -= ((speed_3d * Omega_Vector[1] * 9.81f) / Sensor_Gravity);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Compensate for roll / pitch / yaw drift
+/// \return  -
+/// \remarks Measurement update of the three filters: roll and pitch from
+///          the accelerometer, yaw from the course over ground.
+///
+///----------------------------------------------------------------------------
+void
+CompensateDrift(void)
+{
+    float fRoll, fPitch, fCourse;
+
+    //
+    // RollPitch correction
+    //
+    fRoll = FastAtan2(Accel_Vector[1], Accel_Vector[2]);
+    fPitch = FastAtan2(-Accel_Vector[0],
+                       FastSqrt((Accel_Vector[1] * Accel_Vector[1]) +
+                                (Accel_Vector[2] * Accel_Vector[2])));
+    KF_Correct(&s_stKF[KF_ROLL], Wrap(fRoll - s_stKF[KF_ROLL].fAngle));
+    KF_Correct(&s_stKF[KF_PITCH], fPitch - s_stKF[KF_PITCH].fAngle);
+
+    //
+    // Yaw correction (ground) from course over ground
+    //
+    fCourse = ToRad((float)GPSHeading());
+    KF_Correct(&s_stKF[KF_YAW], Wrap(Wrap(fCourse) - s_stKF[KF_YAW].fAngle));
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Predict Euler angles
+/// \return  -
+/// \remarks Euler angle rates from the body rates without bias:
+///                                                                 \code
+///     roll'  = p + (q sin(roll) + r cos(roll)) tan(pitch)
+///     pitch' = q cos(roll) - r sin(roll)
+///     yaw'   = (q sin(roll) + r cos(roll)) / cos(pitch)           \endcode
+///          If the sensor backend delivers gyro substeps (GYRO_SUBSTEPS >
+///          1) the rotation during DELTA_T is computed as in DCM.cpp and
+///          converted in the same way.
+///
+///----------------------------------------------------------------------------
+void
+MatrixUpdate(void)
+{
+    Vec3<float> Theta;
+    float sr, cr, sp, cp, tp, qr;
+    int c;
+
+    STRUCT_SENSOR_BATCH stBatch;
+    const STRUCT_SENSOR_SAMPLE *pstLast;
+    long Gyro_Samples[SENSOR_BATCH][3];
+    long Alpha[3], Beta[3];
+    float Step;
+    int n;
+
+    if (!bGainValid) {
+        KF_Init();
+    }
+
+    Sensor_Read(&stBatch);
+    pstLast = Sensor_Last();
+
+    //
+    // Accelerometer signals
+    //
+    for (c = 0; c < 3; c++) {
+        Accel_Vector[c] = Accel_Gain * pstLast->pfAccel[c];
+    }
+
+    if (stBatch.bSubsteps) {
+        //
+        // Gyro signals, every sample since last DELTA_T
+        //
+        n = Sensor_GyroSteps(&stBatch, Gyro_Samples);
+        ConingSum(Alpha, Beta, Gyro_Samples, n);
+        Step = Gyro_Gain * ((float)stBatch.ulPeriod * 1.0e-6f);
+        for (c = 0; c < 3; c++) {
+            Theta[c] = Step * ((float)Alpha[c] + (0.5f * Step * (float)Beta[c]));
+        }
+        if (n > 0) {
+            //
+            // Mean rate, held if no sample came since last DELTA_T
+            //
+            for (c = 0; c < 3; c++) {
+                Gyro_Vector[c] = (Gyro_Gain * (float)Alpha[c]) / (float)n;
+            }
+        }
+    } else {
+        //
+        // Gyro signals
+        //
+        for (c = 0; c < 3; c++) {
+            Gyro_Vector[c] = Gyro_Gain * pstLast->pfGyro[c];
+        }
+    }
+
+    //
+    // removing bias
+    //
+    for (c = 0; c < 3; c++) {
+        Omega_Vector[c] = Gyro_Vector[c] - s_stKF[c].fBias;
+    }
+
+    //
+    // adjust centrifugal acceleration.
+    //
+    AccelAdjust();
+
+    //
+    // Rotation during DELTA_T
+    //
+    if (stBatch.bSubsteps) {
+        for (c = 0; c < 3; c++) {
+            Theta[c] -= s_stKF[c].fBias * Delta_T;
+        }
+    } else {
+        Theta = Omega_Vector * Delta_T;
+    }
+
+    //
+    // Euler angles
+    //
+    FastSinCos(s_stKF[KF_ROLL].fAngle, &sr, &cr);
+    FastSinCos(s_stKF[KF_PITCH].fAngle, &sp, &cp);
+    if (cp < KALMAN_MIN_COS) {
+        cp = KALMAN_MIN_COS;
+    }
+    tp = sp / cp;
+    qr = (Theta[1] * sr) + (Theta[2] * cr);
+
+    s_stKF[KF_ROLL].fAngle += Theta[0] + (qr * tp);
+    s_stKF[KF_PITCH].fAngle += (Theta[1] * cr) - (Theta[2] * sr);
+    s_stKF[KF_YAW].fAngle += qr / cp;
+    bMatrixValid = FALSE;
+    Attitude_Invalidate();
+}
+
+#endif // ATTITUDE_FILTER == ATT_KALMAN
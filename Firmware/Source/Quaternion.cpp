@@ -0,0 +1,344 @@
+//=============================================================================+
+//
+// $RCSfile: Quaternion.cpp,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+///
+/// \brief
+/// Attitude estimation with a unit quaternion
+///
+/// \file
+/// Compiled instead of DCM.cpp / DCMFixed.cpp when ATTITUDE_FILTER is
+/// ATT_QUATERNION. The drift compensation is the same complementary filter
+/// of DCM.cpp (Mahony): roll / pitch error from the accelerometer, yaw
+/// error from the GPS course, proportional and integral gains PitchRoll_Kp,
+/// PitchRoll_Ki, Yaw_Kp, Yaw_Ki. Only the state changes: the attitude is
+/// kept as the quaternion q = (w, x, y, z) that rotates vectors from plane
+/// to earth axes, so that
+/// \code
+///                 | 1 - 2(yy + zz)    2(xy - wz)      2(xz + wy)   |
+///                 |                                                |
+///    DCM_Matrix = |   2(xy + wz)    1 - 2(xx + zz)    2(yz - wx)   |
+///                 |                                                |
+///                 |   2(xz - wy)      2(yz + wx)    1 - 2(xx + yy) |
+/// \endcode
+/// with the meaning of rows and columns explained in DCM.cpp.
+///
+/// Cost per tick compared with DCM.cpp:
+/// \code
+///                       DCM.cpp                   Quaternion.cpp
+///     MatrixUpdate()    27 mul (MatrixMultiply)   16 mul
+///     Normalize()       33 mul, 3 cross / dot     8 mul
+///     CompensateDrift() reads DCM rows 0, 2       8 mul for the same entries
+///     DCM_Refresh()     -                         18 mul, only when needed
+/// \endcode
+///
+/// DCM_Matrix is not updated by the filter: it is computed by DCM_Refresh(),
+/// that the functions reading DCM_Matrix (Aileron_Control, Elevator_Control,
+/// Heading_Control, Bank_Control, Log_DCM) call first. The conversion is
+/// done once per tick, at the first call after Normalize().
+///
+//  CHANGES
+//
+//=============================================================================+
+
+#include "stdafx.h"
+
+#include "inc/hw_types.h"
+#include "math.h"
+#include "vmath.h"
+#include "fastmath.h"
+#include "vec3.h"
+#include "adcdriver.h"
+#include "gps.h"
+#include "Telemetry.h"
+#include "config.h"
+#include "DCM.h"
+#include "sensor.h"
+#include "Attitude.h"
+
+#if (ATTITUDE_FILTER == ATT_QUATERNION)
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_STATIC
+#undef VAR_STATIC
+#endif
+#define VAR_STATIC static
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL
+
+/*----------------------------------- Macros ---------------------------------*/
+
+#define ToRad(x) (((x) * PI) / 180.0f)
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+//! Attitude quaternion w, x, y, z
+VAR_STATIC float Quaternion[4] = { 1.0f, 0.0f, 0.0f, 0.0f };
+//! DCM_Matrix is up to date with Quaternion
+VAR_STATIC tBoolean bMatrixValid = TRUE;
+
+//! Acceleration vector
+VAR_STATIC Vec3<float> Accel_Vector = {{ 0.0f, 0.0f, 0.0f }};
+//! Gyro + integral correction
+VAR_STATIC Vec3<float> Omega = {{ 0.0f, 0.0f, 0.0f }};
+//! Omega Proportional correction
+VAR_STATIC Vec3<float> Omega_P = {{ 0.0f, 0.0f, 0.0f }};
+//! Omega Integral correction
+VAR_STATIC Vec3<float> Omega_I = {{ 0.0f, 0.0f, 0.0f }};
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Bring DCM_Matrix up to date
+/// \return  -
+/// \remarks Converts the quaternion, if it changed since the last call.
+///          Quaternion is unit length after Normalize(), so the diagonal is
+///          computed as 1 - 2(..).
+///
+///----------------------------------------------------------------------------
+void
+DCM_Refresh(void)
+{
+    float w, x, y, z;
+    float xx, yy, zz, xy, xz, yz, wx, wy, wz;
+
+    if (bMatrixValid) {
+        return;
+    }
+    bMatrixValid = TRUE;
+
+    w = Quaternion[0];
+    x = Quaternion[1];
+    y = Quaternion[2];
+    z = Quaternion[3];
+
+    xx = x * x; yy = y * y; zz = z * z;
+    xy = x * y; xz = x * z; yz = y * z;
+    wx = w * x; wy = w * y; wz = w * z;
+
+    DCM_Matrix[0][0] = 1.0f - 2.0f * (yy + zz);
+    DCM_Matrix[0][1] = 2.0f * (xy - wz);
+    DCM_Matrix[0][2] = 2.0f * (xz + wy);
+    DCM_Matrix[1][0] = 2.0f * (xy + wz);
+    DCM_Matrix[1][1] = 1.0f - 2.0f * (xx + zz);
+    DCM_Matrix[1][2] = 2.0f * (yz - wx);
+    DCM_Matrix[2][0] = 2.0f * (xz - wy);
+    DCM_Matrix[2][1] = 2.0f * (yz + wx);
+    DCM_Matrix[2][2] = 1.0f - 2.0f * (xx + yy);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Normalize quaternion
+/// \return  -
+/// \remarks First order approximation of 1 / |q|, as Eq. 21 of DCM.cpp:
+///                                                                 \code
+///                   1
+///     qnormalized = - (3 - q . q) q
+///                   2                                             \endcode
+///
+///----------------------------------------------------------------------------
+void
+Normalize(void)
+{
+    float renorm;
+
+    renorm = 0.5f * (3.0f - (Quaternion[0] * Quaternion[0] +
+                             Quaternion[1] * Quaternion[1] +
+                             Quaternion[2] * Quaternion[2] +
+                             Quaternion[3] * Quaternion[3]));
+    Quaternion[0] *= renorm;
+    Quaternion[1] *= renorm;
+    Quaternion[2] *= renorm;
+    Quaternion[3] *= renorm;
+    bMatrixValid = FALSE;
+    Attitude_Invalidate();
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Adjust acceleration
+/// \return  -
+/// \remarks Centrifugal correction, see DCM.cpp
+///
+///----------------------------------------------------------------------------
+void
+AccelAdjust(void)
+{
+#ifndef _WINDOWS
+    speed_3d = ((float)GPSSpeed());
+#elif (SIMULATOR == SIM_NONE)
+    speed_3d = Sim_Speed();
+#endif
+    Accel_Vector[1] += ((speed_3d * Omega[2] * 9.81f) / Sensor_Gravity);
+    Accel_Vector[2] -= ((speed_3d * Omega[1] * 9.81f) / Sensor_Gravity);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Compensate for roll / pitch / yaw drift
+/// \return  -
+/// \remarks Same corrections of DCM.cpp. Only the DCM entries they need,
+///          row 2, [0][0] and [1][0], are computed from the quaternion.
+///
+///----------------------------------------------------------------------------
+void
+CompensateDrift(void)
+{
+    Vec3<float> Rz;
+    float R00, R10;
+    Vec3<float> errorRollPitch;
+    Vec3<float> errorYaw;
+    float errorCourse;
+    float w, x, y, z;
+    float cog, COGX, COGY;
+
+    w = Quaternion[0];
+    x = Quaternion[1];
+    y = Quaternion[2];
+    z = Quaternion[3];
+
+    //
+    // Earth Z axis in plane axes, earth X / Y components of plane X axis
+    //
+    Rz[0] = 2.0f * (x * z - w * y);
+    Rz[1] = 2.0f * (y * z + w * x);
+    Rz[2] = 1.0f - 2.0f * (x * x + y * y);
+    R00 = 1.0f - 2.0f * (y * y + z * z);
+    R10 = 2.0f * (x * y + w * z);
+
+    //
+    // RollPitch correction
+    //
+    errorRollPitch = Cross(Accel_Vector, Rz);
+    Omega_P = errorRollPitch * PitchRoll_Kp;
+    Omega_I += errorRollPitch * PitchRoll_Ki;
+
+    //
+    // Yaw correction (ground) from course over ground
+    //
+    cog = (float)GPSHeading();
+    FastSinCos(ToRad(cog), &COGY, &COGX);
+    errorCourse = (R00 * COGY) - (R10 * COGX);
+
+    //
+    // Yaw correction (aircraft), proportional and integral gain
+    //
+    errorYaw = Rz * errorCourse;
+    Omega_P += errorYaw * Yaw_Kp;
+    Omega_I += errorYaw * Yaw_Ki;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Update quaternion
+/// \return  -
+/// \remarks First order integration of dq/dt = q * (0, Omega_Vector) / 2,
+///          the quaternion counterpart of DCM = DCM + DCM * Update_Matrix.
+///          If the sensor backend delivers gyro substeps (GYRO_SUBSTEPS >
+///          1) the rotation is computed as in DCM.cpp.
+///
+///----------------------------------------------------------------------------
+void
+MatrixUpdate(void)
+{
+    float w, x, y, z;
+    float p, q, r;
+    Vec3<float> Theta;
+    int c;
+
+    STRUCT_SENSOR_BATCH stBatch;
+    const STRUCT_SENSOR_SAMPLE *pstLast;
+    long Gyro_Samples[SENSOR_BATCH][3];
+    long Alpha[3], Beta[3];
+    float Step;
+    int n;
+
+    Sensor_Read(&stBatch);
+    pstLast = Sensor_Last();
+
+    //
+    // Accelerometer signals
+    //
+    for (c = 0; c < 3; c++) {
+        Accel_Vector[c] = Accel_Gain * pstLast->pfAccel[c];
+    }
+
+    if (stBatch.bSubsteps) {
+        //
+        // Gyro signals, every sample since last DELTA_T
+        //
+        n = Sensor_GyroSteps(&stBatch, Gyro_Samples);
+        ConingSum(Alpha, Beta, Gyro_Samples, n);
+        Step = Gyro_Gain * ((float)stBatch.ulPeriod * 1.0e-6f);
+        for (c = 0; c < 3; c++) {
+            Theta[c] = Step * ((float)Alpha[c] + (0.5f * Step * (float)Beta[c]));
+        }
+        if (n > 0) {
+            //
+            // Mean rate, held if no sample came since last DELTA_T
+            //
+            for (c = 0; c < 3; c++) {
+                Gyro_Vector[c] = (Gyro_Gain * (float)Alpha[c]) / (float)n;
+            }
+        }
+    } else {
+        //
+        // Gyro signals
+        //
+        for (c = 0; c < 3; c++) {
+            Gyro_Vector[c] = Gyro_Gain * pstLast->pfGyro[c];
+        }
+    }
+
+    //
+    // adding integral and proportional
+    //
+    Omega = Gyro_Vector + Omega_I;
+    Omega_Vector = Omega + Omega_P;
+
+    //
+    // adjust centrifugal acceleration.
+    //
+    AccelAdjust();
+
+    //
+    // Rotation during DELTA_T
+    //
+    if (stBatch.bSubsteps) {
+        Theta += (Omega_I + Omega_P) * Delta_T;
+    } else {
+        Theta = Omega_Vector * Delta_T;
+    }
+    p = 0.5f * Theta[0];
+    q = 0.5f * Theta[1];
+    r = 0.5f * Theta[2];
+
+    w = Quaternion[0];
+    x = Quaternion[1];
+    y = Quaternion[2];
+    z = Quaternion[3];
+
+    Quaternion[0] = w - x * p - y * q - z * r;
+    Quaternion[1] = x + w * p + y * r - z * q;
+    Quaternion[2] = y + w * q - x * r + z * p;
+    Quaternion[3] = z + w * r + x * q - y * p;
+    bMatrixValid = FALSE;
+    Attitude_Invalidate();
+}
+
+#endif // ATTITUDE_FILTER == ATT_QUATERNION
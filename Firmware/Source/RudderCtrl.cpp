@@ -17,13 +17,14 @@
 
 #include "inc/hw_types.h"
 #include "math.h"
+#include "fastmath.h"
 #include "adcdriver.h"
 #include "DCM.h"
 #include "ppmdriver.h"
 #include "nav.h"
 #include "gps.h"
 #include "config.h"
-#include "rudderctrl.h"
+#include "RudderCtrl.h"
 
 /*--------------------------------- Definitions ------------------------------*/
 
@@ -88,8 +89,8 @@ Rudder_Control(void) {
 
     if ( 1 /* flags._.GPS_steering */) {
 
-        desired_x = -sinf( ( desired_dir * PI ) / 180.0f ) ;
-        desired_y = cosf( ( desired_dir * PI ) / 180.0f ) ;
+        FastSinCos( ( desired_dir * PI ) / 180.0f, &desired_x, &desired_y ) ;
+        desired_x = -desired_x ;
 
         actual_x = DCM_Matrix[0][1] ; // rmat[1]
         actual_y = DCM_Matrix[1][1] ; // rmat[4]
@@ -102,11 +103,11 @@ Rudder_Control(void) {
 
         // Integral part (avoid windup of integral part)
         if ((I > I_LIMIT_MIN) && (I < I_LIMIT_MAX)) {
-            I += cross_prod * DELTA_T;
+            I += cross_prod * Delta_T;
         }
 
-        // Derivative part (multiply by SAMPLES_PER_SECOND instead of dividing by DELTA_T)
-        D = (cross_prod - previous_error) * SAMPLES_PER_SECOND ;
+        // Derivative part (multiply by Sample_Rate instead of dividing by Delta_T)
+        D = (cross_prod - previous_error) * Sample_Rate ;
 
         // Add terms
         temp =  Dir_Kp * P;
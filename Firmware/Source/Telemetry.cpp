@@ -43,6 +43,10 @@
 /// \todo aggiungere parser protocollo ardupilot o mnav
 ///
 //  CHANGES fSimSOG rinominata fSimCOG
+//          trama TEL_LOAD dopo le sonde del profiler: tempo idle e busy
+//          offset del simulatore verificati contro calib.bin (calib.c)
+//          richiesta "$V" e trama TEL_VIBE dell'analizzatore di vibrazioni
+//          backend "sim" dei sensori (sensor.c)
 //
 //============================================================================*/
 
@@ -59,16 +63,25 @@
 #include "gps.h"
 #include "nav.h"
 #include "DCM.h"
-#include "Log.h"
+#include "Attitude.h"
+#include "scheduler.h"
+#include "log.h"
 #include "config.h"
 #ifndef _WINDOWS
 #include "uartdriver.h"
 #endif
-#include "aileronctrl.h"
+#include "AileronCtrl.h"
 #include "elevatorctrl.h"
-#include "rudderctrl.h"
-#include "throttlectrl.h"
-#include "telemetry.h"
+#include "RudderCtrl.h"
+#include "ThrottleCtrl.h"
+#include "Telemetry.h"
+#include "profile.h"
+#include "timebase.h"
+#include "event.h"
+#include "calib.h"
+#include "adcdriver.h"
+#include "vibe.h"
+#include "sensor.h"
 
 //------------ Definitions -------------------------------------------------
 
@@ -84,6 +97,10 @@
 
 #define TELEMETRY_DEBUG 0
 
+#define TEL_PROFILE_BINS 8          // histogram bins sent per probe
+#define SIM_VERIFY_CHARS 200        // chars before the saved offsets are checked
+#define SIM_SETTLE_CHARS 1000       // chars before the offsets are taken
+
 #if (TELEMETRY_DEBUG == 0)
 #   define Telemetry_Get_Char UART0GetChar
 #else
@@ -100,6 +117,10 @@ enum E_TELEMETRY {
     TEL_WAYPOINT,
     TEL_DEBUG_I,
     TEL_DEBUG_F,
+    TEL_ATTITUDE,
+    TEL_PROFILE,
+    TEL_LOAD,
+    TEL_VIBE,
 } wait_code;
 
 // ---- Constants and Types -------------------------------------------------
@@ -117,6 +138,9 @@ VAR_STATIC float pfSimSensorOffset[8];    /// Simulator sensor offsets
 VAR_STATIC float fSimTAS = 0.0f;          /// Simulator true air speed
 VAR_STATIC float fSimCOG = 0.0f;          /// Simulator course over ground (GPS)
 VAR_STATIC tBoolean bSimSettled = false;
+VAR_STATIC unsigned char ucProfileProbe = PROF_NUMBER + 1; /// Next probe to send,
+                                          /// PROF_NUMBER = load
+VAR_STATIC unsigned char ucVibeAxis = VIBE_AXES; /// Next vibration axis to send
 
 //
 // Used to change the polarity of the sensors
@@ -178,6 +202,13 @@ tBoolean Telemetry_Parse ( void )
                     case 'S': ucStatus++; break;    // Sensor data
                     case 'G': ucStatus = 10; break; // GPS data
                     case 'K': ucStatus = 19; break; // Gain data
+                    case 'P': ucProfileProbe = 0;   // Profiler request
+                              ucStatus = 0; break;  //
+#if (VIBE_ANALYZER == 1)
+                    case 'V': Vibe_Start((float)ADCRate()); // Vibration
+                              ucVibeAxis = 0;       // analysis request
+                              ucStatus = 0; break;  //
+#endif
                     default : ucStatus = 0; break;  //
                 }
                 break;
@@ -316,10 +347,16 @@ tBoolean Telemetry_Parse ( void )
                 break;
         }
     }
-    if (ulChCounter > 1000) {
-        Sim_SaveOffsets();
-        ulChCounter = 0;
-        bSimSettled = true;
+    if (ulChCounter > SIM_VERIFY_CHARS) {
+        if (Sim_CheckOffsets()) {               // Saved offsets still good
+            ulChCounter = 0;
+            bSimSettled = true;
+        } else if (ulChCounter > SIM_SETTLE_CHARS) {
+            Sim_SaveOffsets();
+            Calib_Save(pfSimSensorOffset);
+            ulChCounter = 0;
+            bSimSettled = true;
+        }
     }
 
     return bResult;
@@ -358,6 +395,48 @@ Telemetry_Send_Controls(void)
     UART0Send(cData, 17);
 }
 
+//----------------------------------------------------------------------------
+//
+/// \brief   Downlink attitude
+///
+/// \returns
+/// \remarks roll, pitch, heading in degrees from Attitude_Get(), copied
+///          with foreground tasks locked out, then the time of the copy
+///          in us (Timebase_Us())
+///
+//----------------------------------------------------------------------------
+void
+Telemetry_Send_Attitude(void)
+{
+    STRUCT_ATTITUDE stAttitude;
+    const STRUCT_ATTITUDE *pstAttitude = &stAttitude;
+    float *pfBuff;
+    unsigned long *pulBuff;
+    unsigned long ulTime;
+    unsigned char cData[20];
+
+    Sched_Lock();
+    ulTime = Timebase_Us();
+    stAttitude = *Attitude_Get();
+    Sched_Unlock();
+
+    cData[0] = TEL_ATTITUDE;        // wait code
+
+    pfBuff = (float *)&cData[1];    // roll
+    *pfBuff = (pstAttitude->fRoll * 180.0f) / PI;
+
+    pfBuff = (float *)&cData[5];    // pitch
+    *pfBuff = (pstAttitude->fPitch * 180.0f) / PI;
+
+    pfBuff = (float *)&cData[9];    // heading
+    *pfBuff = pstAttitude->fHeading;
+
+    pulBuff = (unsigned long *)&cData[13];  // time
+    *pulBuff = ulTime;
+
+    UART0Send(cData, 17);
+}
+
 //----------------------------------------------------------------------------
 //
 /// \brief   Downlink waypoint
@@ -389,6 +468,155 @@ Telemetry_Send_Waypoint(void)
     UART0Send(cData, 8);
 }
 
+//----------------------------------------------------------------------------
+//
+/// \brief   Downlink profiler summary
+///
+/// \returns
+/// \remarks After a "$P" request sends one probe per call, until all the
+///          probes have been sent:
+///          code, probe, first bin, count, min, max, mean, then
+///          TEL_PROFILE_BINS histogram bins from the first non empty one,
+///          saturated to 16 bits, time of the frame in us (Timebase_Us()).
+///          Probe times in CPU cycles.
+///          Then one TEL_LOAD frame: code, idle and busy time of the main
+///          loop in ms, wake ups, time of the frame in us.
+///
+//----------------------------------------------------------------------------
+void
+Telemetry_Send_Profile(void)
+{
+    STRUCT_PROFILE stProfile;
+    unsigned long *pulBuff;
+    unsigned short *pusBuff;
+    unsigned char cData[40];
+    unsigned char ucFirst, j;
+    STRUCT_EVENT_LOAD stLoad;
+
+    if (ucProfileProbe > PROF_NUMBER) {
+        return;
+    }
+
+    if (ucProfileProbe == PROF_NUMBER) {
+        Event_GetLoad(&stLoad);
+
+        cData[0] = TEL_LOAD;                // wait code
+
+        pulBuff = (unsigned long *)&cData[1];   // idle
+        *pulBuff = (unsigned long)(stLoad.ullIdle / 1000);
+
+        pulBuff = (unsigned long *)&cData[5];   // busy
+        *pulBuff = (unsigned long)(stLoad.ullBusy / 1000);
+
+        pulBuff = (unsigned long *)&cData[9];   // wake ups
+        *pulBuff = stLoad.ulWakeups;
+
+        pulBuff = (unsigned long *)&cData[13];  // time
+        *pulBuff = Timebase_Us();
+
+        UART0Send(cData, 17);
+        ucProfileProbe++;
+        return;
+    }
+
+    Sched_Lock();
+    stProfile = *Profile_Get((ENUM_PROBE)ucProfileProbe);
+    Sched_Unlock();
+
+    ucFirst = 0;                            // first non empty bin
+    while ((ucFirst < (PROFILE_BINS - TEL_PROFILE_BINS)) &&
+           (stProfile.pulHist[ucFirst] == 0)) {
+        ucFirst++;
+    }
+
+    cData[0] = TEL_PROFILE;                 // wait code
+    cData[1] = ucProfileProbe;              // probe
+    cData[2] = ucFirst;                     // first bin
+
+    pulBuff = (unsigned long *)&cData[3];   // count
+    *pulBuff = stProfile.ulCount;
+
+    pulBuff = (unsigned long *)&cData[7];   // min
+    *pulBuff = stProfile.ulMin;
+
+    pulBuff = (unsigned long *)&cData[11];  // max
+    *pulBuff = stProfile.ulMax;
+
+    pulBuff = (unsigned long *)&cData[15];  // mean
+    if (stProfile.ulCount != 0) {
+        *pulBuff = (unsigned long)(stProfile.ullSum / stProfile.ulCount);
+    } else {
+        *pulBuff = 0;
+    }
+
+    for (j = 0; j < TEL_PROFILE_BINS; j++) { // histogram
+        pusBuff = (unsigned short *)&cData[19 + (j * 2)];
+        if (stProfile.pulHist[ucFirst + j] > 0xFFFF) {
+            *pusBuff = 0xFFFF;
+        } else {
+            *pusBuff = (unsigned short)stProfile.pulHist[ucFirst + j];
+        }
+    }
+
+    pulBuff = (unsigned long *)&cData[19 + (TEL_PROFILE_BINS * 2)]; // time
+    *pulBuff = Timebase_Us();
+
+    UART0Send(cData, 23 + (TEL_PROFILE_BINS * 2));
+    ucProfileProbe++;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Downlink vibration analysis
+///
+/// \returns
+/// \remarks After a "$V" request, once the analysis is done (Vibe_Run()),
+///          sends one axis per call, in ADC channel order:
+///          code, axis, sequence rate [Hz], then VIBE_PEAKS peaks, largest
+///          first: frequency [0.1 Hz], amplitude [0.01 ADC steps] saturated
+///          to 16 bits; time of the frame in us (Timebase_Us()).
+///
+//----------------------------------------------------------------------------
+void
+Telemetry_Send_Vibe(void)
+{
+    const STRUCT_VIBE *pstVibe;
+    unsigned long *pulBuff;
+    unsigned short *pusBuff;
+    unsigned char cData[8 + (VIBE_PEAKS * 6)];
+    unsigned char j;
+    float fAmplitude;
+
+    if ((ucVibeAxis >= VIBE_AXES) || (Vibe_Status() != VIBE_DONE)) {
+        return;
+    }
+    pstVibe = Vibe_Get();
+
+    cData[0] = TEL_VIBE;                    // wait code
+    cData[1] = ucVibeAxis;                  // axis
+
+    pusBuff = (unsigned short *)&cData[2];  // sequence rate
+    *pusBuff = (unsigned short)pstVibe->fSampleHz;
+
+    for (j = 0; j < VIBE_PEAKS; j++) {      // peaks
+        pulBuff = (unsigned long *)&cData[4 + (j * 6)];
+        *pulBuff = (unsigned long)(pstVibe->pstPeak[ucVibeAxis][j].fHz * 10.0f);
+        pusBuff = (unsigned short *)&cData[8 + (j * 6)];
+        fAmplitude = pstVibe->pstPeak[ucVibeAxis][j].fAmplitude * 100.0f;
+        if (fAmplitude > 65535.0f) {
+            *pusBuff = 0xFFFF;
+        } else {
+            *pusBuff = (unsigned short)fAmplitude;
+        }
+    }
+
+    pulBuff = (unsigned long *)&cData[4 + (VIBE_PEAKS * 6)]; // time
+    *pulBuff = Timebase_Us();
+
+    UART0Send(cData, 8 + (VIBE_PEAKS * 6));
+    ucVibeAxis++;
+}
+
 ///----------------------------------------------------------------------------
 ///
 /// \brief Interface to simulator data : data settled
@@ -400,6 +628,33 @@ tBoolean
 Sim_Settled ( void ) {
     return bSimSettled;
 }
+
+///----------------------------------------------------------------------------
+///
+/// \brief Check simulator data against the saved offsets.
+/// \return true if they agree, the saved offsets are then used
+/// \remarks See Calib_Check(). Gravity subtracted from Z as in
+///          Sim_SaveOffsets().
+///
+///----------------------------------------------------------------------------
+tBoolean
+Sim_CheckOffsets ( void ) {
+
+    float pfOffset[6];
+    int j;
+
+    for (j = 0; j < 6 ; j++) {
+        pfOffset[j] = pfSimSensorData[j];
+    }
+    pfOffset[2] -= GRAVITY;
+    if (!Calib_Check(pfOffset)) {
+        return false;
+    }
+    for (j = 0; j < 6 ; j++) {
+        pfSimSensorOffset[j] = Calib_Get()->pfOffset[j];
+    }
+    return true;
+}
 #endif
 
 ///----------------------------------------------------------------------------
@@ -483,6 +738,66 @@ Sim_SaveOffsets(void) {
     pfSimSensorOffset[2] -= GRAVITY;
 }
 
+#ifndef _WINDOWS
+///----------------------------------------------------------------------------
+///
+/// \brief Sensor backend "sim": start.
+/// \return true
+/// \remarks Simulator data arrive on UART 0, already started.
+///
+///----------------------------------------------------------------------------
+static tBoolean
+Sim_SensorInit ( void ) {
+    return true;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief Sensor backend "sim": input settling.
+/// \return true when the offsets have been taken
+/// \remarks Parses the telemetry data until the simulator has settled.
+///
+///----------------------------------------------------------------------------
+static tBoolean
+Sim_SensorSettled ( void ) {
+    if (Sim_Settled()) {
+        return true;
+    }
+    Telemetry_Parse();
+    return false;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief Sensor backend "sim": samples since the last read.
+/// \return 1
+/// \remarks The last simulator data, stamped with the time of the read.
+///
+///----------------------------------------------------------------------------
+static unsigned int
+Sim_SensorRead ( STRUCT_SENSOR_BATCH *pstBatch ) {
+
+    STRUCT_SENSOR_SAMPLE *pstSample = &pstBatch->pstSample[0];
+    int j;
+
+    pstSample->ulTime = Timebase_Us();
+    for (j = 0; j < 3; j++) {
+        pstSample->pfAccel[j] = Sim_GetData(j);
+        pstSample->pfGyro[j] = Sim_GetData(j + 3);
+    }
+    pstBatch->uiSubsteps = 1;
+    return 1;
+}
+
+//
+// Sensor backend "sim", see sensor.c
+//
+const STRUCT_SENSOR_BACKEND g_stSensorSim = {
+    "sim", ACCEL_GAIN, GYRO_GAIN, GRAVITY, false,
+    Sim_SensorInit, Sim_SensorSettled, Sim_SensorRead
+};
+#endif
+
 
 #if (TELEMETRY_DEBUG == 1)
 //----------------------------------------------------------------------------
@@ -10,6 +10,8 @@
 /// \file
 ///
 //  CHANGES eliminato SIMULATION (sostituito da SIMULATOR, dove serve)
+//          Sim_CheckOffsets(): verifica degli offset salvati
+//          Telemetry_Send_Vibe(): picchi dell'analizzatore di vibrazioni
 //
 //============================================================================
 
@@ -35,10 +37,14 @@
 tBoolean Telemetry_Parse ( void );
 void Telemetry_Send_Controls ( void );
 void Telemetry_Send_Waypoint ( void );
+void Telemetry_Send_Attitude ( void );
+void Telemetry_Send_Profile ( void );
+void Telemetry_Send_Vibe ( void );
 tBoolean Sim_Settled ( void ) ;
 float Sim_Speed ( void );
 float Sim_GetData ( int n );
 void Sim_SetData ( int iIndex, float fVal );
 void Sim_SaveOffsets ( void );
+tBoolean Sim_CheckOffsets ( void );
 
 
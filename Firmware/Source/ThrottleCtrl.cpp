@@ -22,7 +22,7 @@
 #include "ppmdriver.h"
 #include "nav.h"
 #include "config.h"
-#include "throttlectrl.h"
+#include "ThrottleCtrl.h"
 
 /*--------------------------------- Definitions ------------------------------*/
 
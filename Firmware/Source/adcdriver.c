@@ -89,20 +89,35 @@
 ///                                                                     \endcode
 ///  
 //  CHANGES corretto segno accelerazione Z. aumentato tempo di assestamento
+//          evento EVENT_ADC a fine sequenza
+//          acquisizione tramite uDMA a blocchi ping-pong (ADC_CAPTURE_DMA)
+//          filtro (x + 9 y) / 10 sostituito dalle catene di filter.c
+//          offset verificati contro la calibrazione salvata (calib.c)
+//          sequenze grezze all'analizzatore di vibrazioni (vibe.c)
+//          backend "adc" dei sensori (sensor.c)
 //
 //============================================================================*/
 
 #include "inc/hw_ints.h"
 #include "inc/hw_types.h"
 #include "inc/hw_memmap.h"
+#include "inc/hw_adc.h"
 #include "driverlib/adc.h"
 #include "driverlib/gpio.h"
 #include "driverlib/timer.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/interrupt.h"
+#include "driverlib/udma.h"
 
 #include "config.h"
 #include "adcdriver.h"
+#include "timing.h"
+#include "timebase.h"
+#include "event.h"
+#include "filter.h"
+#include "calib.h"
+#include "vibe.h"
+#include "sensor.h"
 
 /*--------------------------------- Definitions ------------------------------*/
 
@@ -115,6 +130,65 @@
 #endif
 #define VAR_GLOBAL
 
+#if (GYRO_SUBSTEPS < 1) || (GYRO_SUBSTEPS > 32)
+#error GYRO_SUBSTEPS must be between 1 and 32
+#endif
+
+//! Gyro samples queued for MatrixUpdate(), two DELTA_T worth
+#define GYRO_QUEUE  (2 * GYRO_SUBSTEPS)
+
+//! ADC conversions before the sensor offsets are taken
+#define SETTLE_SAMPLES  (500 * GYRO_SUBSTEPS)
+
+//! Campioni della finestra di verifica della calibrazione salvata
+#define VERIFY_SAMPLES  (25 * GYRO_SUBSTEPS)
+/// 0.5 s at 50 Hz; the second half is averaged, after the filters settle.
+
+//! Canali convertiti in ogni sequenza
+#define ADC_CHANNELS    6
+
+#if (ADC_CAPTURE == ADC_CAPTURE_DMA)
+#if !defined(PART_LM3S9B90)
+#error ADC_CAPTURE_DMA needs the uDMA controller (LM3S9B90)
+#endif
+#if ((GYRO_SUBSTEPS * ADC_OVERSAMPLE) > 170)
+#error GYRO_SUBSTEPS * ADC_OVERSAMPLE must be up to 170 (1024 conversions per block)
+#endif
+
+//! Sequenze dell'ADC per blocco: un ciclo di controllo
+#define ADC_BLOCK       (GYRO_SUBSTEPS * ADC_OVERSAMPLE)
+
+//! Sovracampionamento hardware: 250 kSps / (6 * 2) = 20 kHz di sequenze
+#define ADC_HW_OVERSAMPLE   2
+
+//! Sequenze mediate dal primo stadio dei filtri, 2^n
+#if (ADC_OVERSAMPLE == 1)
+#  define ADC_DECIMATION    0
+#elif (ADC_OVERSAMPLE == 2)
+#  define ADC_DECIMATION    1
+#elif (ADC_OVERSAMPLE == 4)
+#  define ADC_DECIMATION    2
+#elif (ADC_OVERSAMPLE == 8)
+#  define ADC_DECIMATION    3
+#elif (ADC_OVERSAMPLE == 16)
+#  define ADC_DECIMATION    4
+#elif (ADC_OVERSAMPLE == 32)
+#  define ADC_DECIMATION    5
+#elif (ADC_OVERSAMPLE == 64)
+#  define ADC_DECIMATION    6
+#elif (ADC_OVERSAMPLE == 128)
+#  define ADC_DECIMATION    7
+#else
+#  error ADC_OVERSAMPLE must be a power of 2, up to 128
+#endif
+#else
+//! Sovracampionamento hardware: 250 kSps / (6 * 8) = 5 kHz di sequenze
+#define ADC_HW_OVERSAMPLE   8
+
+//! Nessuna decimazione: un campione per sequenza
+#define ADC_DECIMATION      0
+#endif
+
 /*----------------------------------- Macros ---------------------------------*/
 
 /*-------------------------------- Enumerations ------------------------------*/
@@ -123,6 +197,23 @@
 
 /*---------------------------------- Constants -------------------------------*/
 
+//
+// Sensor filter chains, one per group of channels, see config.h
+//
+VAR_STATIC const STRUCT_FILTER_STAGE pstAccelChain[] = {
+    { FILTER_BOXCAR,  ADC_DECIMATION,     0.0f,                 0.0f },
+    { FILTER_SHIFT,   FILTER_ACCEL_SHIFT, 0.0f,                 0.0f },
+    { FILTER_LOWPASS, 0,                  FILTER_ACCEL_LOWPASS, FILTER_Q_BUTTERWORTH },
+    { FILTER_END,     0,                  0.0f,                 0.0f }
+};
+
+VAR_STATIC const STRUCT_FILTER_STAGE pstGyroChain[] = {
+    { FILTER_BOXCAR,  ADC_DECIMATION,     0.0f,                 0.0f },
+    { FILTER_LOWPASS, 0,                  FILTER_GYRO_LOWPASS,  FILTER_Q_BUTTERWORTH },
+    { FILTER_NOTCH,   0,                  FILTER_GYRO_NOTCH,    FILTER_GYRO_NOTCH_Q },
+    { FILTER_END,     0,                  0.0f,                 0.0f }
+};
+
 /*---------------------------------- Globals ---------------------------------*/
 
 /*----------------------------------- Locals ---------------------------------*/
@@ -130,6 +221,35 @@
 unsigned int uiADCsample;               // Sample counter
 unsigned long ulSeq1DataBuffer[8];      // Sample buffer
 unsigned long ulFiltDataBuffer[8];      // Filtered data buffer
+VAR_STATIC volatile unsigned long ulSampleTime;  // Time of last sequence [us]
+VAR_STATIC unsigned long ulSequenceRate;        // Sequences per second
+
+VAR_STATIC STRUCT_FILTER_DESIGN stAccelDesign;  // accel chain coefficients
+VAR_STATIC STRUCT_FILTER_DESIGN stGyroDesign;   // gyro chain coefficients
+VAR_STATIC STRUCT_FILTER pstFilter[ADC_CHANNELS];   // chain of each channel
+
+#if (ADC_CAPTURE == ADC_CAPTURE_DMA)
+//
+// uDMA channel control table, 1024 byte aligned. Only the ADC 0 entries are
+// used.
+//
+#pragma data_alignment=1024
+VAR_STATIC tDMAControlTable pstDMATable[64];
+
+//
+// Ping-pong blocks: the uDMA fills one while ADCUpdate() reads the other.
+// Written by the uDMA, block counters by ADCS0IntHandler() only, read
+// counter and lost blocks by ADCUpdate() only. A block is rearmed as soon
+// as it completes, possibly with another length (ADCSetSubsteps()): the
+// interrupt latches the length it was captured with for ADCUpdate().
+//
+VAR_STATIC unsigned long pulBlock[2][ADC_BLOCK * ADC_CHANNELS];
+VAR_STATIC unsigned int puiBlockArmed[2];       // samples armed in each block
+VAR_STATIC unsigned int puiBlockSamples[2];     // samples in each completed block
+VAR_STATIC volatile unsigned long ulBlockDone = 0;
+VAR_STATIC unsigned long ulBlockRead = 0;
+VAR_STATIC unsigned long ulBlockLost = 0;
+#endif
 
 //
 // Used to change the polarity of the sensors
@@ -148,8 +268,43 @@ long SensorSign[] = {
 //
 long SensorOffset[6];         
 
+//
+// Verification of the cached calibration, see ADCSettled()
+//
+VAR_STATIC long plVerifySum[ADC_CHANNELS];      // sum of the window samples
+VAR_STATIC unsigned int uiVerifyCount = 0;      // samples in the sum
+VAR_STATIC unsigned int uiVerifyLast = 0;       // last sample counted
+VAR_STATIC unsigned int uiSettleStart = 0;      // uiADCsample at first call
+VAR_STATIC tBoolean bSettleStarted = false;     // first call done
+VAR_STATIC tBoolean bVerifyDone = false;        // window checked
+
+#if (GYRO_SUBSTEPS > 1)
+//
+// Gyro samples for MatrixUpdate(). Written by the ADC interrupt only,
+// read by ADCGetGyroSamples() only.
+//
+VAR_STATIC long plGyroQueue[GYRO_QUEUE][3];
+VAR_STATIC volatile unsigned int uiGyroWrite = 0;
+VAR_STATIC volatile unsigned int uiGyroRead = 0;
+VAR_STATIC unsigned long ulGyroOverflow = 0;
+VAR_STATIC unsigned int uiSubsteps = GYRO_SUBSTEPS;
+#endif
+
 /*--------------------------------- Prototypes -------------------------------*/
 
+#if (GYRO_SUBSTEPS > 1)
+static void ADCQueueGyro( void );
+#endif
+static void ADCFilter( const unsigned long *pulData );
+static void ADCSetOffsets( const float *pfOffset );
+static tBoolean ADCSensorInit( void );
+static tBoolean ADCSensorSettled( void );
+static unsigned int ADCSensorRead( STRUCT_SENSOR_BATCH *pstBatch );
+#if (ADC_CAPTURE == ADC_CAPTURE_DMA)
+static void ADCArmBlock( unsigned long ulSelect, unsigned int uiBlock );
+static void ADCReadBlock( const unsigned long *pulData, unsigned int uiSamples );
+#endif
+
 ///----------------------------------------------------------------------------
 ///
 ///  DESCRIPTION ADC initialization
@@ -171,9 +326,16 @@ ADCInit(void)
     TimerConfigure(TIMER2_BASE, TIMER_CFG_32_BIT_PER);
 
     //
-    // Trigger an ADC conversion once every x milliseconds
+    // Filter chains: accelerometers, then gyros
     //
-    TimerLoadSet(TIMER2_BASE, TIMER_A, SysCtlClockGet() / SAMPLES_PER_SECOND);
+    for (int c = 0; c < ADC_CHANNELS; c++) {
+        Filter_Init(&pstFilter[c], (c < 3) ? &stAccelDesign : &stGyroDesign);
+    }
+
+    //
+    // Trigger an ADC conversion GYRO_SUBSTEPS times per control loop
+    //
+    ADCSetRate();
     TimerControlTrigger(TIMER2_BASE, TIMER_A, true);
 
     //
@@ -196,9 +358,9 @@ ADCInit(void)
 #endif
 
     //
-    // Enable 8 x oversample
+    // Enable hardware oversample, 8 x or 2 x with ADC_OVERSAMPLE on top
     //
-    ADCHardwareOversampleConfigure(ADC_BASE, 8);
+    ADCHardwareOversampleConfigure(ADC_BASE, ADC_HW_OVERSAMPLE);
 
     //
     // ADC sample at 250KSps
@@ -215,6 +377,49 @@ ADCInit(void)
     //
     ADCSequenceConfigure(ADC_BASE, 0, ADC_TRIGGER_TIMER, 0);
 
+#if (ADC_CAPTURE == ADC_CAPTURE_DMA)
+    //
+    // sample seq steps 0 .. 5: a uDMA request every two conversions (the
+    // arbitration size must be a power of 2, with IE set on its last step)
+    //
+    ADCSequenceStepConfigure(ADC_BASE, 0, 0, ADC_CTL_CH0);
+    ADCSequenceStepConfigure(ADC_BASE, 0, 1, ADC_CTL_CH1 | ADC_CTL_IE);
+    ADCSequenceStepConfigure(ADC_BASE, 0, 2, ADC_CTL_CH2);
+    ADCSequenceStepConfigure(ADC_BASE, 0, 3, ADC_CTL_CH3 | ADC_CTL_IE);
+    ADCSequenceStepConfigure(ADC_BASE, 0, 4, ADC_CTL_CH4);
+    ADCSequenceStepConfigure(ADC_BASE, 0, 5, ADC_CTL_CH5 | ADC_CTL_IE | ADC_CTL_END);
+
+    //
+    // uDMA channel of sample sequence 0: FIFO to block, 32 bit words,
+    // ping-pong between the primary and the alternate control structure
+    //
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UDMA);
+    uDMAEnable();
+    uDMAControlBaseSet(pstDMATable);
+    uDMAChannelAttributeDisable(UDMA_CHANNEL_ADC0, UDMA_ATTR_ALTSELECT |
+                                UDMA_ATTR_USEBURST | UDMA_ATTR_REQMASK);
+    uDMAChannelAttributeEnable(UDMA_CHANNEL_ADC0, UDMA_ATTR_HIGH_PRIORITY);
+    uDMAChannelControlSet(UDMA_CHANNEL_ADC0 | UDMA_PRI_SELECT, UDMA_SIZE_32 |
+                          UDMA_SRC_INC_NONE | UDMA_DST_INC_32 | UDMA_ARB_2);
+    uDMAChannelControlSet(UDMA_CHANNEL_ADC0 | UDMA_ALT_SELECT, UDMA_SIZE_32 |
+                          UDMA_SRC_INC_NONE | UDMA_DST_INC_32 | UDMA_ARB_2);
+    ADCArmBlock(UDMA_PRI_SELECT, 0);
+    ADCArmBlock(UDMA_ALT_SELECT, 1);
+    uDMAChannelEnable(UDMA_CHANNEL_ADC0);
+
+    //
+    // Enable sample sequence 0
+    //
+    ADCSequenceEnable(ADC_BASE, 0);
+
+    //
+    // Interrupt at the end of each block only: the uDMA completion is
+    // signalled on the sequence 0 vector, the sequence interrupt stays
+    // masked.
+    //
+    ADCIntDisable(ADC_BASE, 0);
+    IntEnable(INT_ADC0);
+#else
     //
     // sample seq step 0
     //
@@ -255,6 +460,7 @@ ADCInit(void)
     //
     IntEnable(INT_ADC0);
     ADCIntEnable(ADC_BASE, 0);
+#endif
 
     //
     // Enable timer and start conversion
@@ -267,6 +473,7 @@ ADCInit(void)
     uiADCsample = 0;
 }
 
+#if (ADC_CAPTURE == ADC_CAPTURE_IRQ)
 ///----------------------------------------------------------------------------
 ///
 ///  DESCRIPTION The ADC sample sequence 1 interrupt handler.
@@ -282,6 +489,11 @@ ADCS0IntHandler(void)
     //
     ADCIntClear(ADC_BASE, 0);
 
+    //
+    // Time of the sample sequence
+    //
+    ulSampleTime = Timebase_Us();
+
     //
     // Check if overflow occurred.
     //
@@ -305,18 +517,184 @@ ADCS0IntHandler(void)
     }
 
     //
-    // Filter data from previous sample sequence
+    // Retrieve data from sample sequence
     //
-    for (int ulCnt = 0; ulCnt < 6; ulCnt++)
-    {
-        ulFiltDataBuffer[ulCnt] += (9 * ulSeq1DataBuffer[ulCnt]);
-        ulFiltDataBuffer[ulCnt] /= 10;
+    ADCSequenceDataGet(ADC_BASE, 0, ulSeq1DataBuffer);
+
+    //
+    // Filter it
+    //
+    ADCFilter(ulSeq1DataBuffer);
+
+    Event_Post(EVENT_ADC);
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Process the sequences acquired since the last call.
+/// \RETURN      -
+/// \REMARKS     Nothing to do: the interrupt handler processes each sequence.
+///
+///----------------------------------------------------------------------------
+void
+ADCUpdate(void)
+{
+}
+#else
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION The ADC sample sequence 0 interrupt handler, end of block.
+/// \RETURN      -
+/// \REMARKS     Rearms the control structure of the block just completed,
+///              the uDMA is already filling the other one, after latching
+///              the number of samples it holds.
+///
+///----------------------------------------------------------------------------
+void
+ADCS0IntHandler(void)
+{
+    ADCIntClear(ADC_BASE, 0);
+
+    if (uDMAChannelModeGet(UDMA_CHANNEL_ADC0 | UDMA_PRI_SELECT) == UDMA_MODE_STOP) {
+        puiBlockSamples[0] = puiBlockArmed[0];
+        ADCArmBlock(UDMA_PRI_SELECT, 0);
+        ulSampleTime = Timebase_Us();
+        ulBlockDone++;
+    }
+    if (uDMAChannelModeGet(UDMA_CHANNEL_ADC0 | UDMA_ALT_SELECT) == UDMA_MODE_STOP) {
+        puiBlockSamples[1] = puiBlockArmed[1];
+        ADCArmBlock(UDMA_ALT_SELECT, 1);
+        ulSampleTime = Timebase_Us();
+        ulBlockDone++;
+    }
+
+    Event_Post(EVENT_ADC);
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Process the blocks completed since the last call.
+/// \RETURN      -
+/// \REMARKS     Called by the control task before the estimator, and by
+///              ADCSettled(). A block must be read within one block time
+///              from its completion, before the uDMA writes it again: if
+///              more than one is waiting only the last one is read, the
+///              others are counted as lost.
+///
+///----------------------------------------------------------------------------
+void
+ADCUpdate(void)
+{
+    unsigned long ulDone = ulBlockDone;
+
+    if ((ulDone - ulBlockRead) > 1) {
+        ulBlockLost += ulDone - ulBlockRead - 1;
+        ulBlockRead = ulDone - 1;
+    }
+    while (ulBlockRead != ulDone) {
+        ADCReadBlock(pulBlock[ulBlockRead & 1], puiBlockSamples[ulBlockRead & 1]);
+        ulBlockRead++;
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Interface to the lost block counter.
+/// \RETURN      number of uDMA blocks overwritten before ADCUpdate() read them
+/// \REMARKS
+///
+///----------------------------------------------------------------------------
+unsigned long
+ADCBlockLost(void)
+{
+    return ulBlockLost;
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Set up the uDMA transfer of a block.
+/// \RETURN      -
+/// \REMARKS     One control loop worth of sequences, at the current number
+///              of substeps. Blocks are used in turn, primary first.
+///
+///----------------------------------------------------------------------------
+static void
+ADCArmBlock(unsigned long ulSelect, unsigned int uiBlock)
+{
+#if (GYRO_SUBSTEPS > 1)
+    puiBlockArmed[uiBlock] = uiSubsteps;
+#else
+    puiBlockArmed[uiBlock] = 1;
+#endif
+    uDMAChannelTransferSet(UDMA_CHANNEL_ADC0 | ulSelect, UDMA_MODE_PINGPONG,
+                           (void *)(ADC_BASE + ADC_O_SSFIFO0), pulBlock[uiBlock],
+                           puiBlockArmed[uiBlock] * ADC_OVERSAMPLE * ADC_CHANNELS);
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Filter and decimate a block.
+/// \RETURN      -
+/// \REMARKS     The first stage of the filters takes the mean of
+///              ADC_OVERSAMPLE sequences for each sample.
+///
+///----------------------------------------------------------------------------
+static void
+ADCReadBlock(const unsigned long *pulData, unsigned int uiSamples)
+{
+    unsigned int n;
+
+    for (n = 0; n < (uiSamples * ADC_OVERSAMPLE); n++) {
+        ADCFilter(pulData);
+        pulData += ADC_CHANNELS;
     }
 
     //
-    // Retrieve data from sample sequence
+    // Keep the last sequence, as in ADC_CAPTURE_IRQ
     //
-    ADCSequenceDataGet(ADC_BASE, 0, ulSeq1DataBuffer);
+    pulData -= ADC_CHANNELS;
+    for (n = 0; n < ADC_CHANNELS; n++) {
+        ulSeq1DataBuffer[n] = pulData[n];
+    }
+}
+#endif
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Filter a sequence.
+/// \RETURN      -
+/// \REMARKS     When the filters give a sample, updates the filtered data,
+///              queues the gyro data and counts the sample.
+///
+///----------------------------------------------------------------------------
+static void
+ADCFilter(const unsigned long *pulData)
+{
+    long lOutput;
+    tBoolean bSample = false;
+    int c;
+
+#if (VIBE_ANALYZER == 1)
+    Vibe_Put(pulData);                          // raw, at the full rate
+#endif
+
+    //
+    // All the chains decimate by the same factor: they give a sample at
+    // the same time.
+    //
+    for (c = 0; c < ADC_CHANNELS; c++) {
+        if (Filter_Run(&pstFilter[c], (long)pulData[c], &lOutput)) {
+            ulFiltDataBuffer[c] = (unsigned long)lOutput;
+            bSample = true;
+        }
+    }
+    if (!bSample) {
+        return;                                 // decimating
+    }
+
+#if (GYRO_SUBSTEPS > 1)
+    ADCQueueGyro();
+#endif
 
     //
     // Increase sample counter
@@ -324,34 +702,110 @@ ADCS0IntHandler(void)
     uiADCsample ++;
 }
 
+#if (GYRO_SUBSTEPS > 1)
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Queue the gyro data of the last sample.
+/// \RETURN      -
+/// \REMARKS     Through the gyro filters, dropped if MatrixUpdate() is late.
+///
+///----------------------------------------------------------------------------
+static void
+ADCQueueGyro(void)
+{
+    unsigned int uiNext = (uiGyroWrite + 1) % GYRO_QUEUE;
+    if (uiNext != uiGyroRead) {
+        for (int c = 0; c < 3; c++) {
+            plGyroQueue[uiGyroWrite][c] = ((long)ulFiltDataBuffer[c + 3] -
+                                           SensorOffset[c + 3]) * SensorSign[c + 3];
+        }
+        uiGyroWrite = uiNext;
+    } else {
+        ulGyroOverflow++;
+    }
+}
+#endif
+
 ///----------------------------------------------------------------------------
 ///
 ///  DESCRIPTION Wait ADC input settling and get sensor's offset
 /// \RETURN      -
 /// \REMARKS     We must consider gravity sensed by Z accelerometer by adding
 ///              or subtracting GRAVITY to its offset.
+///              If Calib_Load() found a calibration, the mean of the second
+///              half of VERIFY_SAMPLES is checked against it: if they agree
+///              the cached offsets are used, otherwise the offsets are taken
+///              after SETTLE_SAMPLES and saved with Calib_Save().
+///              Samples are counted from the first call, not from
+///              ADCInit(): the boot before it (SD card, Calib_Load()) may
+///              last longer than the verification window.
 ///
 ///----------------------------------------------------------------------------
 int
 ADCSettled(void)
 {
+    float pfOffset[ADC_CHANNELS];
+    unsigned int uiSample;
     int c;
     
+    ADCUpdate();
+    if (!bSettleStarted) {
+        bSettleStarted = true;
+        uiSettleStart = uiADCsample;
+    }
+    uiSample = uiADCsample - uiSettleStart;
+
+    //
+    // Average the verification window, one sum per call that finds new
+    // samples: each sample with ADC_CAPTURE_IRQ, the last sample of each
+    // block with ADC_CAPTURE_DMA
+    //
+    if ((uiSample != uiVerifyLast) &&
+        (uiSample > (VERIFY_SAMPLES / 2)) && (uiSample <= VERIFY_SAMPLES)) {
+        for (c = 0; c < ADC_CHANNELS; c++) {
+            plVerifySum[c] += (long)ulFiltDataBuffer[c];
+        }
+        uiVerifyCount++;
+    }
+    uiVerifyLast = uiSample;
+
+    //
+    // Check the cached calibration
+    //
+    if (!bVerifyDone && (uiSample >= VERIFY_SAMPLES) && (uiVerifyCount != 0)) {
+        bVerifyDone = true;
+        for (c = 0; c < ADC_CHANNELS; c++) {
+            pfOffset[c] = (float)plVerifySum[c] / (float)uiVerifyCount;
+        }
+        pfOffset[2] += GRAVITY;
+        if (Calib_Check(pfOffset)) {
+            ADCSetOffsets(Calib_Get()->pfOffset);
+            return 1;
+        }
+    }
+
     // 
-    // Wait some ADC conversions
+    // Wait some ADC conversions. The counter may step over SETTLE_SAMPLES
+    // (a block at a time with ADC_CAPTURE_DMA, lost blocks)
     //
-    if (uiADCsample == 500) {
+    if (uiSample >= SETTLE_SAMPLES) {
         //
         // Get offset
         // 
-        for (c = 0; c < 6; c++) {
-            SensorOffset[c] = (long)ulFiltDataBuffer[c];
+        for (c = 0; c < ADC_CHANNELS; c++) {
+            pfOffset[c] = (float)ulFiltDataBuffer[c];
         }
 
         //
         // Subtract gravity from Z axis
         // 
-        SensorOffset[2] += GRAVITY;
+        pfOffset[2] += GRAVITY;
+
+        ADCSetOffsets(pfOffset);
+        for (c = 0; c < ADC_CHANNELS; c++) {
+            pfOffset[c] = (float)SensorOffset[c];
+        }
+        Calib_Save(pfOffset);
 
         return 1;
     } else {
@@ -359,6 +813,30 @@ ADCSettled(void)
     }
 }
 
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Set sensor offsets.
+/// \RETURN      -
+/// \REMARKS     Gravity included in the Z accelerometer offset.
+///
+///----------------------------------------------------------------------------
+static void
+ADCSetOffsets(const float *pfOffset)
+{
+    int c;
+
+    for (c = 0; c < ADC_CHANNELS; c++) {
+        SensorOffset[c] = (long)pfOffset[c];
+    }
+
+#if (GYRO_SUBSTEPS > 1)
+    //
+    // Discard gyro samples queued without offset
+    //
+    uiGyroRead = uiGyroWrite;
+#endif
+}
+
 ///----------------------------------------------------------------------------
 ///
 ///  DESCRIPTION Interface to ADC sample counter.
@@ -374,13 +852,39 @@ ADCSamples(void)
 
 ///----------------------------------------------------------------------------
 ///
-///  DESCRIPTION Interface to sensor data.
-/// \RETURN      offset- and sign-corrected value of n-th sensor
-/// \REMARKS     
+///  DESCRIPTION Interface to the sequence rate.
+/// \RETURN      ADC sequences per second, before the filters
+/// \REMARKS     Set by ADCSetRate().
 ///
 ///----------------------------------------------------------------------------
-float
-ADCGetData(int n)
+unsigned long
+ADCRate(void)
+{
+    return ulSequenceRate;
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Interface to the time of the last sample sequence.
+/// \RETURN      Timebase_Us() at the end of the last sequence
+/// \REMARKS     Stamped by ADCS0IntHandler(), a few us after the conversions.
+///
+///----------------------------------------------------------------------------
+unsigned long
+ADCTime(void)
+{
+    return ulSampleTime;
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Interface to sensor data, integer.
+/// \RETURN      offset- and sign-corrected value of n-th sensor in ADC steps
+/// \REMARKS     Used by the fixed point DCM to avoid int / float conversions
+///
+///----------------------------------------------------------------------------
+long
+ADCGetSteps(int n)
 {
     long lTemp;
 
@@ -399,5 +903,220 @@ ADCGetData(int n)
             lTemp = 0;
             break;
     }
-    return (float) lTemp;
+    return lTemp;
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Interface to sensor data.
+/// \RETURN      offset- and sign-corrected value of n-th sensor
+/// \REMARKS     
+///
+///----------------------------------------------------------------------------
+float
+ADCGetData(int n)
+{
+    return (float) ADCGetSteps(n);
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Set the ADC trigger rate from the control loop timing.
+/// \RETURN      -
+/// \REMARKS     Loads Timer 2 for one trigger per substep of the control
+///              loop, ADC_OVERSAMPLE with ADC_CAPTURE_DMA, and designs the
+///              sensor filters for that rate. Call again after
+///              Timing_Init() changes the loop rate.
+///
+///----------------------------------------------------------------------------
+void
+ADCSetRate(void)
+{
+    STRUCT_FILTER_DESIGN stAccel, stGyro;
+    unsigned long ulRate = Timing_Get()->uiLoopHz;
+    tBoolean bMasked;
+
+#if (GYRO_SUBSTEPS > 1)
+    ulRate *= uiSubsteps;
+#endif
+#if (ADC_CAPTURE == ADC_CAPTURE_DMA)
+    ulRate *= ADC_OVERSAMPLE;
+#endif
+    ulSequenceRate = ulRate;
+
+    //
+    // Filters for the new rate, swapped in at once: they run in interrupt
+    // or in foreground context.
+    //
+    Filter_Design(&stAccel, pstAccelChain, (float)ulRate);
+    Filter_Design(&stGyro, pstGyroChain, (float)ulRate);
+    bMasked = IntMasterDisable();
+    stAccelDesign = stAccel;
+    stGyroDesign = stGyro;
+    if (!bMasked) {
+        IntMasterEnable();
+    }
+
+    TimerLoadSet(TIMER2_BASE, TIMER_A, SysCtlClockGet() / ulRate);
+}
+
+#if (GYRO_SUBSTEPS > 1)
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Interface to unfiltered gyro data.
+/// \RETURN      number of samples copied
+/// \REMARKS     Copies, oldest first, up to iMax gyro samples acquired since
+///              the last call, offset- and sign-corrected, in ADC steps.
+///
+///----------------------------------------------------------------------------
+int
+ADCGetGyroSamples(long plSample[][3], int iMax)
+{
+    int n = 0;
+
+    while ((uiGyroRead != uiGyroWrite) && (n < iMax)) {
+        plSample[n][0] = plGyroQueue[uiGyroRead][0];
+        plSample[n][1] = plGyroQueue[uiGyroRead][1];
+        plSample[n][2] = plGyroQueue[uiGyroRead][2];
+        uiGyroRead = (uiGyroRead + 1) % GYRO_QUEUE;
+        n++;
+    }
+    return n;
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Set the number of ADC samples per DELTA_T.
+/// \RETURN      -
+/// \REMARKS     uiValue is limited to 1 .. GYRO_SUBSTEPS. Reloads the
+///              ADC trigger timer. With ADC_CAPTURE_DMA the blocks already
+///              armed keep the previous length, and are read with it.
+///
+///----------------------------------------------------------------------------
+void
+ADCSetSubsteps(unsigned int uiValue)
+{
+    if (uiValue < 1) {
+        uiValue = 1;
+    } else if (uiValue > GYRO_SUBSTEPS) {
+        uiValue = GYRO_SUBSTEPS;
+    }
+    uiSubsteps = uiValue;
+    ADCSetRate();
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Interface to the number of ADC samples per DELTA_T.
+/// \RETURN      samples per DELTA_T
+/// \REMARKS
+///
+///----------------------------------------------------------------------------
+unsigned int
+ADCSubsteps(void)
+{
+    return uiSubsteps;
 }
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Interface to the gyro queue overflow counter.
+/// \RETURN      number of gyro samples dropped
+/// \REMARKS
+///
+///----------------------------------------------------------------------------
+unsigned long
+ADCGyroOverflow(void)
+{
+    return ulGyroOverflow;
+}
+#endif
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Sensor backend "adc": start.
+/// \RETURN      true
+/// \REMARKS     The ADC is started by ADCInit() at boot, whatever the backend.
+///
+///----------------------------------------------------------------------------
+static tBoolean
+ADCSensorInit(void)
+{
+    return true;
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Sensor backend "adc": input settling.
+/// \RETURN      true when the offsets have been taken
+/// \REMARKS     See ADCSettled().
+///
+///----------------------------------------------------------------------------
+static tBoolean
+ADCSensorSettled(void)
+{
+    return (ADCSettled() != 0);
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Sensor backend "adc": samples since the last read.
+/// \RETURN      number of samples
+/// \REMARKS     With GYRO_SUBSTEPS > 1 one sample for each queued gyro
+///              sample, see ADCGetGyroSamples(), spaced by one substep up
+///              to the last sequence; the accelerometers are the filtered
+///              values of the last sequence in all of them. Otherwise one
+///              sample, the filtered values of the last sequence.
+///
+///----------------------------------------------------------------------------
+static unsigned int
+ADCSensorRead(STRUCT_SENSOR_BATCH *pstBatch)
+{
+    STRUCT_SENSOR_SAMPLE *pstSample;
+    float pfAccel[3];
+    unsigned int n = 1, j;
+    int c;
+#if (GYRO_SUBSTEPS > 1)
+    long plSample[SENSOR_BATCH][3];
+    unsigned long ulStep;
+#endif
+
+    for (c = 0; c < 3; c++) {
+        pfAccel[c] = (float)ADCGetSteps(c);
+    }
+
+#if (GYRO_SUBSTEPS > 1)
+    n = (unsigned int)ADCGetGyroSamples(plSample, SENSOR_BATCH);
+    ulStep = 1000000UL / (Timing_Get()->uiLoopHz * uiSubsteps);
+    pstBatch->uiSubsteps = uiSubsteps;
+    pstBatch->ulPeriod = ulStep;
+#else
+    pstBatch->uiSubsteps = 1;
+#endif
+
+    for (j = 0; j < n; j++) {
+        pstSample = &pstBatch->pstSample[j];
+#if (GYRO_SUBSTEPS > 1)
+        pstSample->ulTime = ulSampleTime - ((n - 1 - j) * ulStep);
+        for (c = 0; c < 3; c++) {
+            pstSample->pfAccel[c] = pfAccel[c];
+            pstSample->pfGyro[c] = (float)plSample[j][c];
+        }
+#else
+        pstSample->ulTime = ulSampleTime;
+        for (c = 0; c < 3; c++) {
+            pstSample->pfAccel[c] = pfAccel[c];
+            pstSample->pfGyro[c] = (float)ADCGetSteps(c + 3);
+        }
+#endif
+    }
+    return n;
+}
+
+//
+// Sensor backend "adc", see sensor.c
+//
+VAR_GLOBAL const STRUCT_SENSOR_BACKEND g_stSensorAdc = {
+    "adc", ACCEL_GAIN, GYRO_GAIN, GRAVITY, true,
+    ADCSensorInit, ADCSensorSettled, ADCSensorRead
+};
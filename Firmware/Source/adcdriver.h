@@ -16,6 +16,8 @@
 /// \todo Spostare SAMPLES_PER_SECOND e DELTA_T in un file Config.h o simile
 ///
 /// CHANGES Spostate #definizioni nel file config.h
+///         ADCUpdate(): blocchi acquisiti tramite uDMA
+///         ADCRate(): frequenza delle sequenze
 //
 //============================================================================
 
@@ -39,6 +41,16 @@
 /*---------------------------------- Interface -------------------------------*/
 
 void ADCInit (void);
+void ADCUpdate (void);
+unsigned long ADCBlockLost (void);
 int ADCSettled (void);
 unsigned char ADCSamples (void);
+unsigned long ADCTime (void);
+unsigned long ADCRate (void);
 float ADCGetData (int n);
+void ADCSetRate (void);
+long ADCGetSteps (int n);
+int ADCGetGyroSamples (long plSample[][3], int iMax);
+void ADCSetSubsteps (unsigned int uiValue);
+unsigned int ADCSubsteps (void);
+unsigned long ADCGyroOverflow (void);
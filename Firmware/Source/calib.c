@@ -0,0 +1,242 @@
+//============================================================================+
+//
+// $RCSfile: calib.c,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   Sensor calibration cache
+///
+/// \file
+/// Sensor offsets and scale factors saved on the SD card (calib.bin, next
+/// to path.txt and rate.txt), so that the boot does not wait for a full
+/// calibration (Sensor_Settled(), ADCSettled(), Sim_Settled()):
+/// - Calib_Load(), after Sensor_Select(), reads the record and applies its
+///   scale factors to Accel_Gain and Gyro_Gain;
+/// - the driver averages a short window of samples and asks Calib_Check()
+///   if they agree with the cached offsets, within CALIB_ACCEL_TOL and
+///   CALIB_GYRO_TOL; if so it uses the cached offsets;
+/// - otherwise it runs the full calibration and saves the result with
+///   Calib_Save().
+///
+/// A record is discarded if its checksum is wrong, if it was saved by a
+/// different sensor backend or gravity, or if its scale factors are more
+/// than CALIB_GAIN_TOL away from the nominal ones of the backend.
+/// The analog backends ("adc", "sim") use the cache.
+///
+//  CHANGES record legato al backend dei sensori selezionato (sensor.c)
+//
+//============================================================================*/
+
+#include "inc/hw_types.h"
+
+#include "config.h"
+#include "tff.h"
+#include "DCM.h"
+#include "sensor.h"
+#include "calib.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef    VAR_STATIC
+#   undef VAR_STATIC
+#endif
+#define   VAR_STATIC static
+#ifdef    VAR_GLOBAL
+#   undef VAR_GLOBAL
+#endif
+#define   VAR_GLOBAL
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+VAR_STATIC const char szCalibName[16] = "calib.bin";    // Calibration file name
+VAR_STATIC STRUCT_CALIB stCalib;                        // Cached calibration
+VAR_STATIC tBoolean bCalibOk = false;                   // stCalib valid
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+static unsigned long Calib_Checksum( const STRUCT_CALIB *pstCalib );
+static tBoolean Calib_Near( float fValue, float fRef, float fTol );
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Read sensor calibration from SD card
+///
+/// \return  true if a valid calibration has been read
+/// \remarks Call after Log_Init(), which mounts the file system, and
+///          Sensor_Select(). Sets Accel_Gain and Gyro_Gain to the saved
+///          values.
+///
+//----------------------------------------------------------------------------
+tBoolean
+Calib_Load( void ) {
+
+    const STRUCT_SENSOR_BACKEND *pstBackend = Sensor_Get();
+    FIL stFile;
+    WORD wRead = 0;
+
+    bCalibOk = false;
+    if (pstBackend == 0) {
+        return false;
+    }
+    if (FR_OK != f_open(&stFile, szCalibName, FA_READ)) {
+        return false;
+    }
+    if (FR_OK != f_read(&stFile, &stCalib, sizeof(STRUCT_CALIB), &wRead)) {
+        wRead = 0;
+    }
+    f_close(&stFile);
+
+    if ((wRead != sizeof(STRUCT_CALIB)) ||
+        (stCalib.ulMagic != CALIB_MAGIC) ||
+        (stCalib.usVersion != CALIB_VERSION) ||
+        (stCalib.ulChecksum != Calib_Checksum(&stCalib)) ||
+        (stCalib.usSource != Sensor_Id()) ||
+        (stCalib.fGravity != Sensor_Gravity) ||
+        !Calib_Near(stCalib.fAccelGain, pstBackend->fAccelGain,
+                    pstBackend->fAccelGain * CALIB_GAIN_TOL) ||
+        !Calib_Near(stCalib.fGyroGain, pstBackend->fGyroGain,
+                    pstBackend->fGyroGain * CALIB_GAIN_TOL)) {
+        return false;
+    }
+
+    Accel_Gain = stCalib.fAccelGain;
+    Gyro_Gain = stCalib.fGyroGain;
+    bCalibOk = true;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Get cached sensor calibration
+///
+/// \return  pointer to calibration, 0 if none is valid
+/// \remarks
+///
+//----------------------------------------------------------------------------
+const STRUCT_CALIB *
+Calib_Get( void ) {
+
+    if (bCalibOk) {
+        return &stCalib;
+    } else {
+        return 0;
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Verify cached sensor calibration
+///
+/// \param   pfOffset offsets measured in the verification window [ADC
+///          steps], accel x, y, z, gyro x, y, z, gravity included in z as
+///          for a full calibration
+/// \return  true if a valid calibration is cached and agrees with pfOffset
+/// \remarks
+///
+//----------------------------------------------------------------------------
+tBoolean
+Calib_Check( const float *pfOffset ) {
+
+    float fGyroTol;
+    int c;
+
+    if (!bCalibOk) {
+        return false;
+    }
+    fGyroTol = (CALIB_GYRO_TOL * PI) / (180.0f * stCalib.fGyroGain);
+    for (c = 0; c < 6; c++) {
+        if (!Calib_Near(pfOffset[c], stCalib.pfOffset[c],
+                        (c < 3) ? CALIB_ACCEL_TOL : fGyroTol)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Save sensor calibration to SD card
+///
+/// \param   pfOffset offsets [ADC steps], accel x, y, z, gyro x, y, z,
+///          gravity included in z
+/// \remarks Saves the current Accel_Gain and Gyro_Gain as scale factors.
+///          The new calibration is cached even if it cannot be written.
+///
+//----------------------------------------------------------------------------
+void
+Calib_Save( const float *pfOffset ) {
+
+    FIL stFile;
+    WORD wWritten;
+    int c;
+
+    stCalib.ulMagic = CALIB_MAGIC;
+    stCalib.usVersion = CALIB_VERSION;
+    stCalib.usSource = Sensor_Id();
+    stCalib.fGravity = Sensor_Gravity;
+    for (c = 0; c < 6; c++) {
+        stCalib.pfOffset[c] = pfOffset[c];
+    }
+    stCalib.fAccelGain = Accel_Gain;
+    stCalib.fGyroGain = Gyro_Gain;
+    stCalib.ulChecksum = Calib_Checksum(&stCalib);
+    bCalibOk = true;
+
+    if (FR_OK == f_open(&stFile, szCalibName, FA_WRITE | FA_CREATE_ALWAYS)) {
+        f_write(&stFile, &stCalib, sizeof(STRUCT_CALIB), &wWritten);
+        f_close(&stFile);
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Checksum of a calibration record
+///
+/// \param   pstCalib calibration record
+/// \return  Fletcher-32 of the record, ulChecksum excluded
+/// \remarks
+///
+//----------------------------------------------------------------------------
+static unsigned long
+Calib_Checksum( const STRUCT_CALIB *pstCalib ) {
+
+    const unsigned short *pusData = (const unsigned short *)pstCalib;
+    unsigned int uiWords = (unsigned int)((const char *)&pstCalib->ulChecksum -
+                                          (const char *)pstCalib) / 2;
+    unsigned long ulSum1 = 0xFFFF, ulSum2 = 0xFFFF;
+
+    while (uiWords-- != 0) {
+        ulSum1 += *pusData++;
+        ulSum2 += ulSum1;
+        ulSum1 = (ulSum1 & 0xFFFF) + (ulSum1 >> 16);
+        ulSum2 = (ulSum2 & 0xFFFF) + (ulSum2 >> 16);
+    }
+    ulSum1 = (ulSum1 & 0xFFFF) + (ulSum1 >> 16);
+    ulSum2 = (ulSum2 & 0xFFFF) + (ulSum2 >> 16);
+    return (ulSum2 << 16) | ulSum1;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Compare a value with a reference
+///
+/// \return  true if fValue is within fTol of fRef
+/// \remarks
+///
+//----------------------------------------------------------------------------
+static tBoolean
+Calib_Near( float fValue, float fRef, float fTol ) {
+
+    return ((fValue - fRef) <= fTol) && ((fRef - fValue) <= fTol);
+}
@@ -0,0 +1,53 @@
+//============================================================================
+//
+// $RCSfile: calib.h,v $ (HEADER FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   Sensor calibration cache header file
+///
+/// \file
+///
+//  CHANGES usSource: backend dei sensori (sensor.c)
+//
+//============================================================================
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL extern
+
+#define CALIB_MAGIC         0x42494C43  // "CLIB"
+#define CALIB_VERSION       2           // record layout version
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*------------------------------------ Types ---------------------------------*/
+
+typedef struct {                    // calibration record, as saved on SD card
+    unsigned long ulMagic;          // CALIB_MAGIC
+    unsigned short usVersion;       // CALIB_VERSION
+    unsigned short usSource;        // sensor backend, Sensor_Id()
+    float fGravity;                 // 1 g of the backend, Sensor_Gravity
+    float pfOffset[6];              // accel x, y, z, gyro x, y, z offsets
+                                    // [ADC steps], gravity included in z
+    float fAccelGain;               // Accel_Gain [m/s/s per step]
+    float fGyroGain;                // Gyro_Gain [rad/s per step]
+    unsigned long ulChecksum;       // Fletcher-32 of the fields above
+} STRUCT_CALIB;
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*----------------------------------- Globals --------------------------------*/
+
+/*---------------------------------- Interface -------------------------------*/
+
+tBoolean Calib_Load( void );
+const STRUCT_CALIB *Calib_Get( void );
+tBoolean Calib_Check( const float *pfOffset );
+void Calib_Save( const float *pfOffset );
@@ -11,6 +11,13 @@
 ///
 // CHANGES #define HIL spostata in DCM.cpp
 //         SAMPLES_PER_SECOND differenziato per compilazione in Windows
+//         SAMPLES_PER_SECOND e DELTA_T solo valori di default, vedi timing.c
+//         acquisizione dell'ADC tramite uDMA a blocchi ping-pong
+//         catene di filtri dei sensori configurabili (filter.c)
+//         calibrazione dei sensori salvata su SD card (calib.c)
+//         analizzatore di vibrazioni (vibe.c)
+//         backend dei sensori, MPU-6050 (sensor.c, mpu6050.c)
+//         lettura del FIFO MPU-6050 in parallelo alla stima (MPU_FIFO_READ)
 //
 //============================================================================*/
 
@@ -18,16 +25,27 @@
 
 #define ADC_STEPS   1024.0f
 
-//! Frequenza di campionamento dell'ADC
+//! Frequenza di default del ciclo di controllo e del campionamento dell'ADC
 #ifdef _WINDOWS
 #  define SAMPLES_PER_SECOND  10
 #else
 #  define SAMPLES_PER_SECOND  50
 #endif
+/// The rate actually used is chosen at boot, see timing.c: code that
+/// depends on it reads Timing_Get(), Delta_T or Sample_Rate.
 
-//! Intervallo di ricalcolo della matrice DCM
+//! Intervallo di default di ricalcolo della matrice DCM
 #define DELTA_T             (1.0f / SAMPLES_PER_SECOND)
 
+//! Minima frequenza del ciclo di controllo [Hz]
+#define LOOP_RATE_MIN       50
+/// The measured interval is clamped at four loop periods (DELTA_T_MAX,
+/// main.c): 80 ms at 50 Hz, within the 125 ms that the DCM_FIXED engine
+/// holds in Delta_T (Q_DT, DCMFixed.cpp).
+
+//! Massima frequenza del ciclo di controllo [Hz]
+#define LOOP_RATE_MAX       400
+
 //! Accelerometer sensitivity [V/g]
 #define ACCEL_SENSITIVITY   0.440f
 
@@ -115,3 +133,207 @@
 #define FLIGHTGEAR  2   // Simulator Flightgear
 
 #define SIMULATOR   SIM_NONE
+
+#define DCM_FLOAT   0   // DCM computed in floating point
+#define DCM_FIXED   1   // DCM computed in fixed point (Q30 / Q24 / Q16)
+
+//! Aritmetica del calcolo DCM
+#ifndef DCM_ARITHMETIC
+#  define DCM_ARITHMETIC  DCM_FLOAT
+#endif
+/// DCM_FIXED avoids soft-float in MatrixUpdate(), CompensateDrift() and
+/// Normalize() on the FPU-less LM3S parts, see DCMFixed.cpp
+
+#define ATT_DCM         0   // Direction Cosine Matrix, see DCM.cpp
+#define ATT_QUATERNION  1   // Quaternion, see Quaternion.cpp
+#define ATT_KALMAN      2   // Euler angles, Kalman filters, see Kalman.cpp
+
+//! Stimatore di assetto
+#ifndef ATTITUDE_FILTER
+#  define ATTITUDE_FILTER ATT_DCM
+#endif
+/// ATT_QUATERNION integrates 4 numbers instead of 9 and renormalizes them
+/// with 4 multiplications; DCM_Matrix is computed by DCM_Refresh() only when
+/// a control or log function reads it. ATT_KALMAN replaces the PI drift
+/// compensation with a Kalman filter (angle + gyro bias) per Euler angle.
+/// DCM_ARITHMETIC applies to ATT_DCM only.
+
+#define KALMAN_STEADY   0   // steady state gains, computed once
+#define KALMAN_FULL     1   // covariance and gains updated every DELTA_T
+
+//! Calcolo del guadagno dei filtri di Kalman
+#ifndef KALMAN_GAIN
+#  define KALMAN_GAIN     KALMAN_STEADY
+#endif
+/// KALMAN_STEADY keeps the cost per DELTA_T fixed and low, KALMAN_FULL
+/// converges faster after start up. ATT_KALMAN only.
+
+//! Campioni del giroscopio integrati per ogni DELTA_T
+#ifndef GYRO_SUBSTEPS
+#  define GYRO_SUBSTEPS   1
+#endif
+/// With GYRO_SUBSTEPS > 1 the ADC is triggered GYRO_SUBSTEPS times per
+/// DELTA_T and MatrixUpdate() integrates every gyro sample, with coning
+/// correction, instead of the single filtered one. The number of samples
+/// per DELTA_T can be lowered at run time with ADCSetSubsteps(). Maximum 32.
+
+#define ADC_CAPTURE_IRQ 0   // one interrupt per ADC sequence
+#define ADC_CAPTURE_DMA 1   // uDMA ping-pong blocks, one interrupt per block
+
+//! Acquisizione delle sequenze dell'ADC
+#ifndef ADC_CAPTURE
+#  if defined(PART_LM3S9B90)
+#    define ADC_CAPTURE   ADC_CAPTURE_DMA
+#  else
+#    define ADC_CAPTURE   ADC_CAPTURE_IRQ
+#  endif
+#endif
+/// With ADC_CAPTURE_DMA the uDMA moves the sequences of one control loop
+/// into a block and interrupts once per block; ADCUpdate(), called by the
+/// control task, averages ADC_OVERSAMPLE sequences into each sample.
+/// The LM3S1968 has no uDMA: ADC_CAPTURE_IRQ only.
+
+//! Sequenze dell'ADC mediate in ogni campione (solo ADC_CAPTURE_DMA)
+#ifndef ADC_OVERSAMPLE
+#  if (GYRO_SUBSTEPS <= 10)
+#    define ADC_OVERSAMPLE  16
+#  else
+#    define ADC_OVERSAMPLE  4
+#  endif
+#endif
+/// The ADC is triggered ADC_OVERSAMPLE * GYRO_SUBSTEPS times per control
+/// loop, e.g. 6.4 kHz at 400 Hz. A block holds at most 1024 conversions:
+/// GYRO_SUBSTEPS * ADC_OVERSAMPLE up to 170. Power of 2: the mean is taken
+/// by the first stage of the sensor filters.
+
+//! Costante di tempo del filtro IIR degli accelerometri, 2^n campioni
+#define FILTER_ACCEL_SHIFT      1
+
+//! Frequenza di taglio del passa basso degli accelerometri [Hz]
+#define FILTER_ACCEL_LOWPASS    10.0f
+
+//! Frequenza di taglio del passa basso dei giroscopi [Hz]
+#define FILTER_GYRO_LOWPASS     0.0f
+
+//! Frequenza centrale del notch dei giroscopi [Hz]
+#define FILTER_GYRO_NOTCH       0.0f
+
+//! Fattore di qualita' del notch dei giroscopi
+#define FILTER_GYRO_NOTCH_Q     2.0f
+/// Sensor filter chains, see the tables in adcdriver.c: decimation of
+/// ADC_OVERSAMPLE sequences, then for the accelerometers a shift IIR and a
+/// Butterworth low pass, for the gyros a low pass and a notch on the
+/// vibration peak. The filters run at the gyro sample rate, loop rate times
+/// substeps; a frequency of 0, or above 0.45 times that rate, bypasses the
+/// stage. The gyros feed the attitude integration: any filtering adds lag.
+
+//! Tolleranza della verifica della calibrazione, accelerometri [passi]
+#define CALIB_ACCEL_TOL     (Sensor_Gravity / 10.0f)
+
+//! Tolleranza della verifica della calibrazione, giroscopi [deg/s]
+#define CALIB_GYRO_TOL      2.0f
+
+//! Scostamento massimo dei fattori di scala salvati dai valori nominali
+#define CALIB_GAIN_TOL      0.2f
+/// Offsets and scale factors are cached on the SD card (calib.bin, see
+/// calib.c). At boot a short window of samples is checked against them,
+/// with the aircraft level and still as for a full calibration: outside
+/// these tolerances the full calibration runs and rewrites the file.
+
+//! Fondo scala degli accelerometri MPU-6050 [g]: 2, 4, 8 o 16
+#define MPU_ACCEL_FSR       4
+
+//! Fondo scala dei giroscopi MPU-6050 [deg/s]: 250, 500, 1000 o 2000
+#define MPU_GYRO_FSR        2000
+
+//! Frequenza massima di campionamento MPU-6050 [Hz]
+#define MPU_RATE_MAX        1000
+
+//! Campioni mediati per gli offset dei giroscopi MPU-6050
+#define MPU_SETTLE_SAMPLES  200
+/// Sensor backend "mpu6050" (mpu6050.c), selected at boot by sensor.txt:
+/// the FIFO is sampled at the loop rate times GYRO_SUBSTEPS, up to
+/// MPU_RATE_MAX, and read over I2C 0 at every control loop. The gyro
+/// offsets are averaged at boot with the aircraft still; the accelerometer
+/// offsets are the factory trim of the chip.
+
+#define MPU_FIFO_BLOCKING   0   // FIFO read, then the estimator
+#define MPU_FIFO_ASYNC      1   // FIFO read by the I2C interrupt meanwhile
+
+//! Lettura del FIFO MPU-6050
+#ifndef MPU_FIFO_READ
+#  define MPU_FIFO_READ   MPU_FIFO_ASYNC
+#endif
+/// With MPU_FIFO_ASYNC each control loop takes the packets read during the
+/// previous one and starts the next read, which the I2C interrupt carries
+/// on while the estimator runs: the bus time (about 1.5 ms for 5 packets
+/// at 400 kHz) leaves the control task, the samples come one control loop
+/// later. MPU_FIFO_BLOCKING reads them at once, waiting for the bus.
+
+//! Analizzatore di vibrazioni sulle sequenze grezze dell'ADC
+#ifndef VIBE_ANALYZER
+#  define VIBE_ANALYZER   1
+#endif
+/// On request ("$V" over telemetry) VIBE_POINTS sequences are captured at
+/// the full ADC rate, before the sensor filters, and the largest spectral
+/// peaks of each channel are sent back, see vibe.c. 0 removes it.
+
+//! Sequenze della finestra di analisi, potenza di 2
+#define VIBE_POINTS     256
+
+#define VIBE_FFT_FIXED  0   // 16 bit fixed point FFT, one pair of axes per step
+#define VIBE_FFT_FLOAT  1   // float FFT, all the axes at once in SIMD lanes
+
+//! Aritmetica della FFT dell'analizzatore di vibrazioni
+#ifndef VIBE_FFT
+#  if defined(__ICCARM__)
+#    define VIBE_FFT      VIBE_FFT_FIXED
+#  else
+#    define VIBE_FFT      VIBE_FFT_FLOAT
+#  endif
+#endif
+/// The Cortex-M3 has no FPU: fixed point on target, float on the host.
+
+//! Sonde del profiler sugli stadi del tick di controllo
+#ifndef PROFILE_PROBES
+#  define PROFILE_PROBES  1
+#endif
+/// Min, max, mean and log2 histogram of the cycles spent in each stage of
+/// the control tick, sent over telemetry on request ("$P"), see profile.c.
+/// 0 removes the probes.
+
+#define SHED_NONE       0   // no load shedding
+#define SHED_LEVELS     1   // background tasks dropped by level on overload
+
+//! Politica di riduzione del carico in sovraccarico
+#ifndef SHED_POLICY
+#  if (SIMULATOR == SIM_NONE)
+#    define SHED_POLICY   SHED_LEVELS
+#  else
+#    define SHED_POLICY   SHED_NONE
+#  endif
+#endif
+/// With SHED_LEVELS the scheduler drops logging, then telemetry, then
+/// navigation while deadlines are missed, see scheduler.c. Off with the
+/// simulator, which needs telemetry to close the loop.
+
+//! Finestra di valutazione del sovraccarico [ms]
+#define SHED_WINDOW     1000
+
+//! Finestre senza errori prima di ridurre il livello di riduzione del carico
+#define SHED_RECOVERY   5
+
+//! Periodo del gruppo di assetto [ms]
+#ifndef ATTITUDE_PERIOD
+#  define ATTITUDE_PERIOD   20
+#endif
+
+//! Periodo del gruppo di guida [ms]
+#ifndef GUIDANCE_PERIOD
+#  define GUIDANCE_PERIOD   100
+#endif
+/// Rate groups of the control loop: gyro damping and servo output run at
+/// every control loop (timing.c), the roll and pitch angle terms every
+/// ATTITUDE_PERIOD, the direction PID every GUIDANCE_PERIOD. Raising the
+/// loop rate does not change the cost of the two outer groups. Both are
+/// rounded to system ticks, and should be multiples of the loop period.
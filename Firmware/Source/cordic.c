@@ -19,6 +19,9 @@
 
 /*--------------------------------- Definitions ------------------------------*/
 
+#define FINE_STEPS  22          // steps of cordic_sincos( ), cordic_atan2( )
+#define COSCALE_Q30 652032874L  // 0.607252935 in Q30, FINE_STEPS steps
+
 #ifdef VAR_STATIC
 #undef VAR_STATIC
 #endif
@@ -55,6 +58,15 @@ VAR_STATIC const long Phase_Table[15] =
        3    // 0,0034970565
 };
 
+//! atan(2^-step) in millionths of degree
+VAR_STATIC const long Phase_Table_Fine[FINE_STEPS] =
+{
+    45000000, 26565051, 14036243, 7125016, 3576334, 1789911,
+      895174,   447614,   223811,  111906,   55953,   27976,
+       13988,     6994,     3497,    1749,     874,     437,
+         219,      109,       55,      27
+};
+
 /*---------------------------------- Globals ---------------------------------*/
 
 /*----------------------------------- Locals ---------------------------------*/
@@ -168,3 +180,94 @@ void cordic_rotate( int *px, int *py, int theta )
     *px = (x * COSCALE) / 1000;         // Compensate for CORDIC enlargement
     *py = (sign * y * COSCALE) / 1000;  // 
 }
+
+//----------------------------------------------------------------------------
+//
+/// \brief   CORDIC based sine and cosine
+///
+/// \remarks theta in thousandths of degree, any value. Rotates the vector
+///          (COSCALE_Q30, 0) by theta, so that the result is already
+///          compensated for the CORDIC enlargement: *psin = sin(theta),
+///          *pcos = cos(theta) in Q30. Uses Phase_Table_Fine, the residual
+///          angle is below 0.00003.
+///
+//----------------------------------------------------------------------------
+void cordic_sincos( long theta, long *psin, long *pcos )
+{
+    int step;
+    long x = COSCALE_Q30, y = 0, xtemp;
+
+    theta %= 360000;                    // -180 <= theta <= 180
+    if (theta > 180000) {
+        theta -= 360000;
+    } else if (theta < -180000) {
+        theta += 360000;
+    }
+    if (theta > 90000) {                // start from (-1, 0)
+        theta -= 180000;
+        x = -x;
+    } else if (theta < -90000) {
+        theta += 180000;
+        x = -x;
+    }
+    theta *= 1000;                      // millionths of degree
+
+    for (step = 0; step < FINE_STEPS; step++) {
+        xtemp = x;
+        if (theta < 0) {
+            x += (y >> step);
+            y -= (xtemp >> step);
+            theta += Phase_Table_Fine[step];
+        } else {
+            x -= (y >> step);
+            y += (xtemp >> step);
+            theta -= Phase_Table_Fine[step];
+        }
+    }
+    *psin = y;
+    *pcos = x;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   CORDIC based arc tangent of Q / I
+///
+/// \remarks As cordic_atan( ) with Phase_Table_Fine: returns the phase of
+///          I + jQ in thousandths of degree, rounded. |I|, |Q| must be below
+///          2^29 so that the CORDIC enlargement does not overflow.
+///
+//----------------------------------------------------------------------------
+long cordic_atan2(long I, long Q)
+{
+  int step;
+  long tmp_I, acc_phase;
+
+  acc_phase = 0;
+
+  if (I < 0) {                          // rotate by an initial +/- 90
+    tmp_I = I;
+    if (Q > 0) {
+       I = Q;                           // -90
+       Q = -tmp_I;
+       acc_phase = 90000000;
+    } else {
+       I = -Q;                          // +90
+       Q = tmp_I;
+       acc_phase = -90000000;
+    }
+  }
+
+  for (step = 0; step < FINE_STEPS; step++) { // rotate using "1 + jK" factors
+    tmp_I = I;
+    if (Q >= 0) {                       // phase is positive: do negative rotation
+      I += (Q >> step);
+      Q -= (tmp_I >> step);
+      acc_phase += Phase_Table_Fine[step];
+    } else {                            // phase is negative: do positive rotation
+      I -= (Q >> step);
+      Q += (tmp_I >> step);
+      acc_phase -= Phase_Table_Fine[step];
+    }
+  }
+  return (acc_phase >= 0) ? ((acc_phase + 500) / 1000) : -((500 - acc_phase) / 1000);
+}
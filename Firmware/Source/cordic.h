@@ -34,3 +34,5 @@
 
 long cordic_atan(long I, long Q);
 void cordic_rotate( int *px, int *py, int theta );
+void cordic_sincos( long theta, long *psin, long *pcos );
+long cordic_atan2(long I, long Q);
@@ -36,4 +36,6 @@ VAR_GLOBAL float Pitch_Kd;
 /*---------------------------------- Interface -------------------------------*/
 
 void Elevator_Control( void );
+void Elevator_Attitude( void );
+void Elevator_Damping( void );
 float Elevator( void );
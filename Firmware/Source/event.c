@@ -0,0 +1,206 @@
+//============================================================================+
+//
+// $RCSfile: event.c,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   Main loop events
+///
+/// \file
+/// Interrupt handlers post events (EVENT_TICK, EVENT_ADC, ...) with
+/// Event_Post(); the main loop takes them with Event_Take() and, when it
+/// has nothing left to do, sleeps in Event_Wait() until the next one:
+/// - target: WFI with interrupts masked, so that an event posted between
+///   the last check and the WFI still wakes the core;
+/// - host build: the same semantics with a pthread condition variable,
+///   Event_Post() may be called from any thread.
+///
+/// Event_Wait() accounts the time spent asleep: Event_GetLoad() returns it
+/// together with the time awake, i.e. the CPU headroom of the main loop.
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include "config.h"
+
+#if defined(__ICCARM__)
+#   include <intrinsics.h>
+#   include "inc/hw_types.h"
+#   include "driverlib/interrupt.h"
+#else
+#   include <pthread.h>
+#   include "inc/hw_types.h"
+#endif
+
+#include "timebase.h"
+#include "event.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef    VAR_STATIC
+#   undef VAR_STATIC
+#endif
+#define   VAR_STATIC static
+#ifdef    VAR_GLOBAL
+#   undef VAR_GLOBAL
+#endif
+#define   VAR_GLOBAL
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+VAR_STATIC volatile unsigned long m_ulPending = 0;  // posted events
+VAR_STATIC unsigned long long m_ullStart = 0;       // time of Event_Init() [us]
+VAR_STATIC unsigned long long m_ullIdle = 0;        // time asleep [us]
+VAR_STATIC unsigned long m_ulWakeups = 0;           // number of wake ups
+#if !defined(__ICCARM__)
+VAR_STATIC pthread_mutex_t m_stMutex = PTHREAD_MUTEX_INITIALIZER;
+VAR_STATIC pthread_cond_t m_stCond = PTHREAD_COND_INITIALIZER;
+#endif
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Initialize events
+///
+/// \remarks Call after Timebase_Init(). Clears pending events and load.
+///
+//----------------------------------------------------------------------------
+void
+Event_Init( void ) {
+    m_ulPending = 0;
+    m_ullIdle = 0;
+    m_ulWakeups = 0;
+    m_ullStart = Timebase_Us64();
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Post events
+///
+/// \param   ulEvents EVENT_xxx bits
+/// \remarks Called by interrupt handlers. Events posted again before they
+///          are taken are merged.
+///
+//----------------------------------------------------------------------------
+void
+Event_Post( unsigned long ulEvents ) {
+#if defined(__ICCARM__)
+    tBoolean bMasked;
+
+    bMasked = IntMasterDisable();
+    m_ulPending |= ulEvents;
+    if (!bMasked) {
+        IntMasterEnable();
+    }
+#else
+    pthread_mutex_lock(&m_stMutex);
+    m_ulPending |= ulEvents;
+    pthread_cond_signal(&m_stCond);
+    pthread_mutex_unlock(&m_stMutex);
+#endif
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Take posted events
+///
+/// \return  EVENT_xxx bits posted since the previous call
+/// \remarks Clears the pending events.
+///
+//----------------------------------------------------------------------------
+unsigned long
+Event_Take( void ) {
+
+    unsigned long ulEvents;
+
+#if defined(__ICCARM__)
+    IntMasterDisable();
+    ulEvents = m_ulPending;
+    m_ulPending = 0;
+    IntMasterEnable();
+#else
+    pthread_mutex_lock(&m_stMutex);
+    ulEvents = m_ulPending;
+    m_ulPending = 0;
+    pthread_mutex_unlock(&m_stMutex);
+#endif
+    return ulEvents;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Sleep until an event is posted
+///
+/// \remarks Returns at once if an event is already pending. Does not take
+///          the events. Called by the main loop only.
+///
+//----------------------------------------------------------------------------
+void
+Event_Wait( void ) {
+
+    unsigned long long ullStart;
+
+#if defined(__ICCARM__)
+    IntMasterDisable();
+    while (m_ulPending == 0) {
+        ullStart = Timebase_Us64();
+        __WFI();                        // wakes on pending interrupt
+        m_ullIdle += Timebase_Us64() - ullStart;
+        m_ulWakeups++;
+        IntMasterEnable();              // serve it
+        IntMasterDisable();
+    }
+    IntMasterEnable();
+#else
+    pthread_mutex_lock(&m_stMutex);
+    while (m_ulPending == 0) {
+        ullStart = Timebase_Us64();
+        pthread_cond_wait(&m_stCond, &m_stMutex);
+        m_ullIdle += Timebase_Us64() - ullStart;
+        m_ulWakeups++;
+    }
+    pthread_mutex_unlock(&m_stMutex);
+#endif
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Get main loop load
+///
+/// \param   pstLoad pointer to load
+/// \remarks Busy time includes interrupts and foreground tasks.
+///
+//----------------------------------------------------------------------------
+void
+Event_GetLoad( STRUCT_EVENT_LOAD *pstLoad ) {
+
+    unsigned long long ullTotal;
+
+#if defined(__ICCARM__)
+    IntMasterDisable();
+#else
+    pthread_mutex_lock(&m_stMutex);
+#endif
+    ullTotal = Timebase_Us64() - m_ullStart;
+    pstLoad->ullIdle = m_ullIdle;
+    pstLoad->ulWakeups = m_ulWakeups;
+#if defined(__ICCARM__)
+    IntMasterEnable();
+#else
+    pthread_mutex_unlock(&m_stMutex);
+#endif
+    pstLoad->ullBusy = ullTotal - pstLoad->ullIdle;
+}
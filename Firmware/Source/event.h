@@ -0,0 +1,51 @@
+//============================================================================
+//
+// $RCSfile: event.h,v $ (HEADER FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   Main loop events header file
+///
+/// \file
+///
+//  CHANGES
+//
+//============================================================================
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL extern
+
+#define EVENT_TICK              0x01        // background task released by tick
+#define EVENT_ADC               0x02        // ADC sequence complete
+#define EVENT_UART0             0x04        // characters received on UART 0
+#define EVENT_UART1             0x08        // characters received on UART 1
+#define EVENT_PPM               0x10        // PPM frame complete
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*------------------------------------ Types ---------------------------------*/
+
+typedef struct {                    // main loop load since Event_Init()
+    unsigned long long ullIdle;     // time asleep in Event_Wait() [us]
+    unsigned long long ullBusy;     // time awake, interrupts included [us]
+    unsigned long ulWakeups;        // number of wake ups
+} STRUCT_EVENT_LOAD;
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*----------------------------------- Globals --------------------------------*/
+
+/*---------------------------------- Interface -------------------------------*/
+
+void Event_Init( void );
+void Event_Post( unsigned long ulEvents );
+unsigned long Event_Take( void );
+void Event_Wait( void );
+void Event_GetLoad( STRUCT_EVENT_LOAD *pstLoad );
@@ -0,0 +1,428 @@
+//============================================================================+
+//
+// $RCSfile: fastmath.c,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+//  LANGUAGE    C
+//  DESCRIPTION
+/// \file
+///             Fast trigonometry for the control loop, see fastmath.h
+///
+/// Float kernels:
+/// - sin, cos: reduction to |r| <= PI / 4 subtracting the nearest multiple
+///   of PI / 2 in three parts (Cody - Waite), then the degree 7 / 8
+///   polynomials of the Cephes sinf / cosf;
+/// - atan2: reduction to |t| <= 1 swapping the arguments, then the degree 9
+///   polynomial of Abramowitz - Stegun 4.4.49;
+/// - asin, acos: acos(x) = sqrt(1 - x) P(x) for 0 <= x <= 1, P of degree 7,
+///   Abramowitz - Stegun 4.4.46;
+/// - sqrt: 1 / sqrt(x) from the exponent bits and three Newton steps, that
+///   need no division.
+///
+/// Fixed point kernels are cordic_atan( ) and cordic_sincos( ) of cordic.c
+/// plus the integer square root by bits.
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include <stdint.h>
+
+#include "cordic.h"
+#include "fastmath.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_STATIC
+#undef VAR_STATIC
+#endif
+#define VAR_STATIC static
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL
+
+#define FM_PI           3.14159265358979f
+#define FM_PI_2         1.57079632679490f
+#define FM_2_PI         0.63661977236758f   // 2 / PI
+
+#define FM_PI_2_A       1.5703125f          // PI / 2 = A + B + C
+#define FM_PI_2_B       4.837512969970703125e-4f
+#define FM_PI_2_C       7.54978995489188216e-8f
+
+#define Q30_ONE         (1L << 30)          // 1.0 in Q30
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Sine of |r| <= PI / 4
+/// \return  sin(r)
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static float
+Sin_Kernel(float r)
+{
+    float z = r * r;
+
+    return r + (r * z * ((((-1.9515295891e-4f * z) + 8.3321608736e-3f) * z) -
+                         1.6666654611e-1f));
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Cosine of |r| <= PI / 4
+/// \return  cos(r)
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static float
+Cos_Kernel(float r)
+{
+    float z = r * r;
+
+    return (1.0f - (0.5f * z)) +
+           (z * z * ((((2.443315711809948e-5f * z) - 1.388731625493765e-3f) * z) +
+                     4.166664568298827e-2f));
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Reduce an angle to |r| <= PI / 4
+/// \return  quadrant, r = x - quadrant * PI / 2
+/// \remarks Accurate for |x| up to some thousands of radians
+///
+///----------------------------------------------------------------------------
+static int
+Reduce(float x, float *pr)
+{
+    float k;
+    int q;
+
+    k = x * FM_2_PI;
+    q = (int)((k >= 0.0f) ? (k + 0.5f) : (k - 0.5f));
+    k = (float)q;
+    *pr = ((x - (k * FM_PI_2_A)) - (k * FM_PI_2_B)) - (k * FM_PI_2_C);
+    return q;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Sine and cosine
+/// \return  -
+/// \remarks x in radians. One range reduction for both.
+///
+///----------------------------------------------------------------------------
+void
+FastSinCos(float x, float *pfSin, float *pfCos)
+{
+    float r, s, c;
+
+    switch (Reduce(x, &r) & 3) {
+        case 0:  s = Sin_Kernel(r);  c = Cos_Kernel(r);  break;
+        case 1:  s = Cos_Kernel(r);  c = -Sin_Kernel(r); break;
+        case 2:  s = -Sin_Kernel(r); c = -Cos_Kernel(r); break;
+        default: s = -Cos_Kernel(r); c = Sin_Kernel(r);  break;
+    }
+    *pfSin = s;
+    *pfCos = c;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Sine
+/// \return  sin(x)
+/// \remarks x in radians
+///
+///----------------------------------------------------------------------------
+float
+FastSin(float x)
+{
+    float r;
+
+    switch (Reduce(x, &r) & 3) {
+        case 0:  return Sin_Kernel(r);
+        case 1:  return Cos_Kernel(r);
+        case 2:  return -Sin_Kernel(r);
+        default: return -Cos_Kernel(r);
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Cosine
+/// \return  cos(x)
+/// \remarks x in radians
+///
+///----------------------------------------------------------------------------
+float
+FastCos(float x)
+{
+    float r;
+
+    switch (Reduce(x, &r) & 3) {
+        case 0:  return Cos_Kernel(r);
+        case 1:  return -Sin_Kernel(r);
+        case 2:  return -Cos_Kernel(r);
+        default: return Sin_Kernel(r);
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Arc tangent of y / x
+/// \return  angle in radians, -PI .. PI
+/// \remarks Same quadrant rules of atan2f(), 0 for x = y = 0
+///
+///----------------------------------------------------------------------------
+float
+FastAtan2(float y, float x)
+{
+    float ax = (x < 0.0f) ? -x : x;
+    float ay = (y < 0.0f) ? -y : y;
+    float t, z, a;
+
+    if ((ax == 0.0f) && (ay == 0.0f)) {
+        return 0.0f;
+    }
+    t = (ay <= ax) ? (ay / ax) : (ax / ay);
+    z = t * t;
+    a = t * (0.9998660f + (z * (-0.3302995f + (z * (0.1801410f +
+                          (z * (-0.0851330f + (z * 0.0208351f))))))));
+    if (ay > ax) {
+        a = FM_PI_2 - a;
+    }
+    if (x < 0.0f) {
+        a = FM_PI - a;
+    }
+    return (y < 0.0f) ? -a : a;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Arc cosine
+/// \return  angle in radians, 0 .. PI
+/// \remarks x is clipped to -1 .. 1
+///
+///----------------------------------------------------------------------------
+float
+FastAcos(float x)
+{
+    float ax = (x < 0.0f) ? -x : x;
+    float a;
+
+    if (ax >= 1.0f) {
+        return (x < 0.0f) ? FM_PI : 0.0f;
+    }
+    a = -0.0012624911f;
+    a = (a * ax) + 0.0066700901f;
+    a = (a * ax) - 0.0170881256f;
+    a = (a * ax) + 0.0308918810f;
+    a = (a * ax) - 0.0501743046f;
+    a = (a * ax) + 0.0889789874f;
+    a = (a * ax) - 0.2145988016f;
+    a = (a * ax) + 1.5707963050f;
+    a *= FastSqrt(1.0f - ax);
+    return (x < 0.0f) ? (FM_PI - a) : a;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Arc sine
+/// \return  angle in radians, -PI / 2 .. PI / 2
+/// \remarks x is clipped to -1 .. 1
+///
+///----------------------------------------------------------------------------
+float
+FastAsin(float x)
+{
+    return FM_PI_2 - FastAcos(x);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Square root
+/// \return  sqrt(x), 0 for x <= 0
+/// \remarks
+///
+///----------------------------------------------------------------------------
+float
+FastSqrt(float x)
+{
+    union {
+        float f;
+        uint32_t ul;
+    } u;
+    float y, h;
+
+    if (x <= 0.0f) {
+        return 0.0f;
+    }
+    u.f = x;
+    u.ul = 0x5F3759DFUL - (u.ul >> 1);
+    y = u.f;
+    h = 0.5f * x;
+    y = y * (1.5f - (h * y * y));
+    y = y * (1.5f - (h * y * y));
+    y = y * (1.5f - (h * y * y));
+    return x * y;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Smallest integer not less than x
+/// \return  ceil(x)
+/// \remarks |x| < 2^31
+///
+///----------------------------------------------------------------------------
+long
+FastCeil(float x)
+{
+    long l = (long)x;                   // truncated towards zero
+
+    if ((float)l < x) {
+        l++;
+    }
+    return l;
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Fixed point sine and cosine
+/// \return  -
+/// \remarks lAngle in thousandths of degree, *plSin, *plCos in Q30
+///
+///----------------------------------------------------------------------------
+void
+QSinCos(long lAngle, long *plSin, long *plCos)
+{
+    cordic_sincos(lAngle, plSin, plCos);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Fixed point arc tangent of y / x
+/// \return  angle in thousandths of degree, -180000 .. 180000
+/// \remarks x, y in any (same) format. They are scaled to 2^27 .. 2^28:
+///          below, the shifts of the CORDIC steps lose bits, above, the
+///          CORDIC enlargement overflows.
+///
+///----------------------------------------------------------------------------
+long
+QAtan2(long y, long x)
+{
+    unsigned long ulMax;
+
+    ulMax = (unsigned long)((x < 0) ? -x : x) | (unsigned long)((y < 0) ? -y : y);
+    if (ulMax == 0) {
+        return 0;
+    }
+    while (ulMax >= (1UL << 28)) {
+        ulMax >>= 1;
+        x /= 2;
+        y /= 2;
+    }
+    while (ulMax < (1UL << 27)) {
+        ulMax <<= 1;
+        x *= 2;
+        y *= 2;
+    }
+    return cordic_atan2(x, y);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Fixed point arc sine
+/// \return  angle in thousandths of degree, -90000 .. 90000
+/// \remarks lValue in Q30, clipped to -1 .. 1. asin(x) = atan2(x, sqrt(1 - xx))
+///          with 1 - xx = (1 - x)(1 + x) computed in Q60, so that the
+///          cosine keeps 30 bits also close to +/-90 deg.
+///
+///----------------------------------------------------------------------------
+long
+QAsin(long lValue)
+{
+    uint64_t ullSquare, ullRoot, ullBit;
+
+    if (lValue >= Q30_ONE) {
+        return 90000;
+    } else if (lValue <= -Q30_ONE) {
+        return -90000;
+    }
+    ullSquare = (uint64_t)(Q30_ONE - lValue) * (uint64_t)(Q30_ONE + lValue);
+
+    //
+    // Square root by bits, Q60 -> Q30
+    //
+    ullRoot = 0;
+    ullBit = 1ULL << 60;
+    while (ullBit > ullSquare) {
+        ullBit >>= 2;
+    }
+    while (ullBit != 0) {
+        if (ullSquare >= ullRoot + ullBit) {
+            ullSquare -= ullRoot + ullBit;
+            ullRoot = (ullRoot >> 1) + ullBit;
+        } else {
+            ullRoot >>= 1;
+        }
+        ullBit >>= 2;
+    }
+    return QAtan2(lValue, (long)ullRoot);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Fixed point arc cosine
+/// \return  angle in thousandths of degree, 0 .. 180000
+/// \remarks lValue in Q30, clipped to -1 .. 1
+///
+///----------------------------------------------------------------------------
+long
+QAcos(long lValue)
+{
+    return 90000 - QAsin(lValue);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Integer square root
+/// \return  floor(sqrt(ulValue))
+/// \remarks One bit of the result per step, 16 steps. The square root of
+///          a Q30 value is Q15.
+///
+///----------------------------------------------------------------------------
+unsigned long
+QSqrt(unsigned long ulValue)
+{
+    unsigned long ulRoot = 0, ulBit = 1UL << 30;
+
+    while (ulBit > ulValue) {
+        ulBit >>= 2;
+    }
+    while (ulBit != 0) {
+        if (ulValue >= ulRoot + ulBit) {
+            ulValue -= ulRoot + ulBit;
+            ulRoot = (ulRoot >> 1) + ulBit;
+        } else {
+            ulRoot >>= 1;
+        }
+        ulBit >>= 2;
+    }
+    return ulRoot;
+}
@@ -0,0 +1,73 @@
+//============================================================================
+//
+// $RCSfile: fastmath.h,v $ (HEADER FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+//  LANGUAGE    C
+//  DESCRIPTION
+/// \file
+///             Fast trigonometry for the control loop
+///
+/// Replaces the libm functions called every DELTA_T. The LM3S has no FPU:
+/// sinf(), acosf(), atan2f() ... are soft-float with full range reduction
+/// and errno handling, each one dozens of soft-float operations. Two sets of functions:
+///
+/// - float, angles in radians: polynomial kernels after range reduction,
+///   a few soft-float multiplications each;
+/// - fixed point, angles in thousandths of degree as cordic_atan( ), values
+///   in Q30: the CORDIC kernels of cordic.c, 22 steps of shifts and adds,
+///   no float operation.
+///
+/// Max absolute error, measured on the host against double precision libm
+/// (make fastmath):
+/// \code
+///     FastSin, FastCos, FastSinCos    |x| <= 1000     1.2e-7
+///     FastAtan2                                       1.2e-5 rad
+///     FastAsin, FastAcos                              5.0e-7 rad
+///     FastSqrt                                        1.5e-7 relative
+///     FastCeil                                        exact for |x| < 2^31
+///     QSinCos                                         6.0e-7
+///     QAtan2                                          5.5e-4 deg
+///     QAsin, QAcos                                    5.5e-4 deg
+///     QSqrt                                           floor(sqrt(x))
+/// \endcode
+///
+//  CHANGES
+//
+//============================================================================
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL extern
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*---------------------------------- Interface -------------------------------*/
+
+float FastSin(float x);
+float FastCos(float x);
+void FastSinCos(float x, float *pfSin, float *pfCos);
+float FastAtan2(float y, float x);
+float FastAsin(float x);
+float FastAcos(float x);
+float FastSqrt(float x);
+long FastCeil(float x);
+
+void QSinCos(long lAngle, long *plSin, long *plCos);
+long QAtan2(long y, long x);
+long QAsin(long lValue);
+long QAcos(long lValue);
+unsigned long QSqrt(unsigned long ulValue);
@@ -0,0 +1,259 @@
+//============================================================================+
+//
+// $RCSfile: filter.c,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   Fixed point filter chains
+///
+/// \file
+/// Chains of up to FILTER_STAGES_MAX stages, configured by a table of
+/// STRUCT_FILTER_STAGE ended by FILTER_END:
+/// - FILTER_BOXCAR: decimator, the mean of 2^ucShift inputs (first order
+///   CIC), one output every 2^ucShift inputs; the following stages run at
+///   the decimated rate;
+/// - FILTER_SHIFT: first order IIR, y += (x - y) >> ucShift;
+/// - FILTER_LOWPASS, FILTER_NOTCH: second order sections (biquads, direct
+///   form I), designed for fHz and fQ at the rate of the stage.
+///
+/// Filter_Design() turns a table into coefficients for a sample rate, once
+/// for all the channels that share the table; Filter_Run() runs one channel.
+///
+/// Filter_Run() uses no division and no float: samples are Q8 (FILTER_FRAC)
+/// in 32 bits, biquad coefficients Q28 (FILTER_COEF_FRAC) with a 64 bit
+/// accumulator (SMULL / SMLAL on the Cortex-M3). Inputs up to 2^21 in
+/// magnitude. The biquads carry the rounding remainder of each output into
+/// the next one (first order error feedback): without it a low pass at
+/// fHz / fSampleHz = 1e-3 would amplify the rounding error by 1 / (1 + a1
+/// + a2), about 10^5, into an offset of hundreds of steps. The design
+/// rounds the coefficients so that the DC gain of each biquad is exactly
+/// 1: a steady input comes out unchanged, sensor offsets taken through the
+/// chain are not biased.
+///
+/// Outputs within 1 ADC step of the same chains in double precision, down
+/// to fHz / fSampleHz = 4e-4 (make filter).
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include "inc/hw_types.h"
+
+#include "config.h"
+#include "fastmath.h"
+#include "filter.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef    VAR_STATIC
+#   undef VAR_STATIC
+#endif
+#define   VAR_STATIC static
+#ifdef    VAR_GLOBAL
+#   undef VAR_GLOBAL
+#endif
+#define   VAR_GLOBAL
+
+//! Frequenza massima di un biquad rispetto alla frequenza di campionamento
+#define FILTER_HZ_MAX   0.45f
+
+/*----------------------------------- Macros ---------------------------------*/
+
+//
+// Double to Q28, rounded
+//
+#define FILTER_Q28(d)   ((long)(((d) * (double)(1L << FILTER_COEF_FRAC)) + \
+                                (((d) >= 0.0) ? 0.5 : -0.5)))
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+static void Filter_Biquad( STRUCT_FILTER_COEF *pstCoef,
+                           const STRUCT_FILTER_STAGE *pstStage, float fSampleHz );
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Design a filter chain
+///
+/// \param   pstDesign pointer to design
+/// \param   pstTable pointer to stages, ended by FILTER_END
+/// \param   fSampleHz input sample rate [Hz]
+/// \remarks Biquads with fHz <= 0, or above 0.45 times the rate of the
+///          stage, are left out. Extra stages beyond FILTER_STAGES_MAX are
+///          ignored. Uses float and double: call at start up or when the
+///          rate changes, not at every sample.
+///
+//----------------------------------------------------------------------------
+void
+Filter_Design( STRUCT_FILTER_DESIGN *pstDesign,
+               const STRUCT_FILTER_STAGE *pstTable, float fSampleHz ) {
+
+    STRUCT_FILTER_COEF *pstCoef;
+    unsigned char n = 0;
+
+    for (; (pstTable->eType != FILTER_END) && (n < FILTER_STAGES_MAX); pstTable++) {
+        pstCoef = &pstDesign->pstCoef[n];
+        pstCoef->eType = pstTable->eType;
+        pstCoef->ucShift = pstTable->ucShift;
+        switch (pstTable->eType) {
+            case FILTER_BOXCAR:
+                fSampleHz /= (float)(1L << pstTable->ucShift);
+                n++;
+                break;
+
+            case FILTER_SHIFT:
+                n++;
+                break;
+
+            case FILTER_LOWPASS:
+            case FILTER_NOTCH:
+                if ((pstTable->fHz > 0.0f) &&
+                    (pstTable->fHz < (FILTER_HZ_MAX * fSampleHz))) {
+                    Filter_Biquad(pstCoef, pstTable, fSampleHz);
+                    n++;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+    pstDesign->ucStages = n;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Initialize the filter chain of a channel
+///
+/// \param   pstFilter pointer to filter
+/// \param   pstDesign pointer to design, shared with other channels
+/// \remarks Clears the state: the output starts from zero.
+///
+//----------------------------------------------------------------------------
+void
+Filter_Init( STRUCT_FILTER *pstFilter, const STRUCT_FILTER_DESIGN *pstDesign ) {
+
+    long *plData;
+
+    pstFilter->pstDesign = pstDesign;
+    plData = (long *)&pstFilter->pstState[0];
+    while (plData < (long *)&pstFilter->pstState[FILTER_STAGES_MAX]) {
+        *plData++ = 0;
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Run a filter chain
+///
+/// \param   pstFilter pointer to filter
+/// \param   lInput input sample
+/// \param   plOutput output sample, same unit as the input, rounded
+/// \return  true if an output is available, false if a decimator is still
+///          summing its inputs
+/// \remarks
+///
+//----------------------------------------------------------------------------
+tBoolean
+Filter_Run( STRUCT_FILTER *pstFilter, long lInput, long *plOutput ) {
+
+    const STRUCT_FILTER_COEF *pstCoef = pstFilter->pstDesign->pstCoef;
+    STRUCT_FILTER_STATE *pstState = pstFilter->pstState;
+    unsigned char n = pstFilter->pstDesign->ucStages;
+    long long llAcc;
+    long x = lInput << FILTER_FRAC;
+
+    for (; n != 0; n--, pstCoef++, pstState++) {
+        switch (pstCoef->eType) {
+            case FILTER_BOXCAR:
+                pstState->lAcc += x;
+                if (++pstState->ucCount < (1U << pstCoef->ucShift)) {
+                    return false;
+                }
+                x = pstState->lAcc >> pstCoef->ucShift;
+                pstState->lAcc = 0;
+                pstState->ucCount = 0;
+                break;
+
+            case FILTER_SHIFT:
+                pstState->lAcc += (x - pstState->lAcc) >> pstCoef->ucShift;
+                x = pstState->lAcc;
+                break;
+
+            default:                            // biquad
+                llAcc = ((long long)pstCoef->plB[0] * x) +
+                        ((long long)pstCoef->plB[1] * pstState->plX[0]) +
+                        ((long long)pstCoef->plB[2] * pstState->plX[1]) -
+                        ((long long)pstCoef->plA[0] * pstState->plY[0]) -
+                        ((long long)pstCoef->plA[1] * pstState->plY[1]) +
+                        pstState->lAcc;
+                pstState->plX[1] = pstState->plX[0];
+                pstState->plX[0] = x;
+                x = (long)(llAcc >> FILTER_COEF_FRAC);
+                pstState->lAcc = (long)(llAcc - ((long long)x << FILTER_COEF_FRAC));
+                pstState->plY[1] = pstState->plY[0];
+                pstState->plY[0] = x;
+                break;
+        }
+    }
+
+    *plOutput = (x + (1L << (FILTER_FRAC - 1))) >> FILTER_FRAC;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Design a biquad
+///
+/// \param   pstCoef pointer to coefficients
+/// \param   pstStage pointer to stage, FILTER_LOWPASS or FILTER_NOTCH
+/// \param   fSampleHz sample rate of the stage [Hz]
+/// \remarks Bilinear transform, coefficients of the Audio EQ Cookbook.
+///          1 - cos(w0) is computed as 2 sin^2(w0 / 2), and the rest in
+///          double: float would leave the poles tens of LSB off, a gain
+///          error of a few percent at low fHz / fSampleHz. The numerator
+///          is then rebuilt from the rounded denominator for unit DC gain,
+///          after moving a2 by at most 3 LSB so that the division is
+///          exact:
+///          - low pass: b0 = b2 = (1 + a1 + a2) / 4, b1 = 2 b0;
+///          - notch: b0 = b2 = (1 + a2) / 2, b1 = a1.
+///
+//----------------------------------------------------------------------------
+static void
+Filter_Biquad( STRUCT_FILTER_COEF *pstCoef,
+               const STRUCT_FILTER_STAGE *pstStage, float fSampleHz ) {
+
+    float fSinHalf, fCosHalf;
+    double dSin, dCos, dAlpha, dA0;
+    long lOne = 1L << FILTER_COEF_FRAC;
+
+    FastSinCos((PI * pstStage->fHz) / fSampleHz, &fSinHalf, &fCosHalf);
+    dSin = 2.0 * (double)fSinHalf * (double)fCosHalf;
+    dCos = 1.0 - (2.0 * (double)fSinHalf * (double)fSinHalf);
+    dAlpha = dSin / (2.0 * (double)pstStage->fQ);
+    dA0 = 1.0 + dAlpha;
+
+    pstCoef->plA[0] = -FILTER_Q28((2.0 * dCos) / dA0);
+    pstCoef->plA[1] = FILTER_Q28((1.0 - dAlpha) / dA0);
+
+    if (pstStage->eType == FILTER_LOWPASS) {
+        pstCoef->plA[1] -= (lOne + pstCoef->plA[0] + pstCoef->plA[1]) & 3;
+        pstCoef->plB[0] = (lOne + pstCoef->plA[0] + pstCoef->plA[1]) >> 2;
+        pstCoef->plB[1] = 2 * pstCoef->plB[0];
+    } else {
+        pstCoef->plA[1] -= (lOne + pstCoef->plA[1]) & 1;
+        pstCoef->plB[0] = (lOne + pstCoef->plA[1]) >> 1;
+        pstCoef->plB[1] = pstCoef->plA[0];
+    }
+    pstCoef->plB[2] = pstCoef->plB[0];
+}
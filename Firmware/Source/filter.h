@@ -0,0 +1,85 @@
+//============================================================================
+//
+// $RCSfile: filter.h,v $ (HEADER FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   Fixed point filter chains header file
+///
+/// \file
+///
+//  CHANGES
+//
+//============================================================================
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL extern
+
+#define FILTER_STAGES_MAX   4           // Max number of stages in a chain
+#define FILTER_FRAC         8           // Fractional bits of the samples
+#define FILTER_COEF_FRAC    28          // Fractional bits of the coefficients
+#define FILTER_Q_BUTTERWORTH    0.7071f // Quality factor, maximally flat
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+typedef enum {          // stage type
+    FILTER_END,         // end of table
+    FILTER_BOXCAR,      // mean of 2^ucShift inputs, one output every 2^ucShift,
+                        // ucShift up to 7
+    FILTER_SHIFT,       // first order IIR, y += (x - y) / 2^ucShift
+    FILTER_LOWPASS,     // second order low pass, fHz = cutoff
+    FILTER_NOTCH        // second order notch, fHz = center
+} ENUM_FILTER;
+
+/*------------------------------------ Types ---------------------------------*/
+
+typedef struct {                    // stage, as configured in a table
+    ENUM_FILTER eType;              // stage type
+    unsigned char ucShift;          // FILTER_BOXCAR, FILTER_SHIFT
+    float fHz;                      // FILTER_LOWPASS, FILTER_NOTCH [Hz],
+                                    // 0 = stage bypassed
+    float fQ;                       // FILTER_LOWPASS, FILTER_NOTCH
+} STRUCT_FILTER_STAGE;
+
+typedef struct {                    // stage, as designed for a sample rate
+    ENUM_FILTER eType;              // stage type, FILTER_END if bypassed
+    unsigned char ucShift;          // FILTER_BOXCAR, FILTER_SHIFT
+    long plB[3];                    // biquad numerator, Q28
+    long plA[2];                    // biquad denominator a1, a2, Q28
+} STRUCT_FILTER_COEF;
+
+typedef struct {                    // chain design, shared by its channels
+    unsigned char ucStages;         // number of stages
+    STRUCT_FILTER_COEF pstCoef[FILTER_STAGES_MAX];
+} STRUCT_FILTER_DESIGN;
+
+typedef struct {                    // state of a stage
+    long lAcc;                      // boxcar sum, IIR output, biquad
+                                    // rounding remainder
+    unsigned char ucCount;          // boxcar inputs summed
+    long plX[2];                    // biquad inputs x[n-1], x[n-2]
+    long plY[2];                    // biquad outputs y[n-1], y[n-2]
+} STRUCT_FILTER_STATE;
+
+typedef struct {                    // filter chain of a channel
+    const STRUCT_FILTER_DESIGN *pstDesign;
+    STRUCT_FILTER_STATE pstState[FILTER_STAGES_MAX];
+} STRUCT_FILTER;
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*----------------------------------- Globals --------------------------------*/
+
+/*---------------------------------- Interface -------------------------------*/
+
+void Filter_Design( STRUCT_FILTER_DESIGN *pstDesign,
+                    const STRUCT_FILTER_STAGE *pstTable, float fSampleHz );
+void Filter_Init( STRUCT_FILTER *pstFilter, const STRUCT_FILTER_DESIGN *pstDesign );
+tBoolean Filter_Run( STRUCT_FILTER *pstFilter, long lInput, long *plOutput );
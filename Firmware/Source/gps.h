@@ -10,6 +10,7 @@
 /// \file
 ///             GPS manager header file
 //  CHANGES     navigazione e gestione waypoints spostata in nav.c
+//              GPSPending()
 //
 //============================================================================
 
@@ -43,7 +44,9 @@ VAR_GLOBAL unsigned char Gps_Status;    //
 
 void GPSInit ( void );
 tBoolean GPSFix ( void );
+unsigned long GPSTime ( void );
 tBoolean GPSParse( void );
+tBoolean GPSPending ( void );
 tBoolean GPSPosition ( void );
 int GPSHeading ( void );
 int GPSNorth ( void );
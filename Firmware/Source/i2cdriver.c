@@ -0,0 +1,541 @@
+//============================================================================+
+//
+// $RCSfile: i2cdriver.c,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   I2C driver
+///
+/// \file
+/// I2C 0 master, 400 kHz, on PB2 (SCL) and PB3 (SDA), for the MPU-6050
+/// (mpu6050.c). Register access with the slave address + register address
+/// convention of the InvenSense driver (inv_mpu.c): return 0 on success,
+/// -1 on error.
+///
+/// Transfers are queued, up to I2C_QUEUE, and advanced byte by byte by the
+/// I2C 0 interrupt (I2CIntHandler()), so that the processor is free while
+/// the bus is busy:
+/// - I2CWriteAsync() and I2CReadAsync() queue a transfer and return at
+///   once; its callback is called in interrupt context at the end, and may
+///   queue the next transfer;
+/// - I2CWrite() and I2CRead() queue a transfer and wait for its end, as
+///   the InvenSense driver wants them; not from interrupts;
+/// - a transfer lasting over I2C_TIMEOUT us per byte is aborted by
+///   I2CPending(), called by the blocking functions and by the users of
+///   the asynchronous ones; the next one starts once the stop has freed
+///   the bus;
+/// - data shared with the callbacks is accessed between I2CLock() and
+///   I2CUnlock(), which mask the I2C 0 interrupt.
+///
+/// The host build has a stand-in bus with the same interface
+/// (Firmware/Host/i2cbus.cpp).
+///
+//  CHANGES trasferimenti asincroni in coda, avanzati dall'interrupt
+//
+//============================================================================*/
+
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/gpio.h"
+#include "driverlib/i2c.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "timebase.h"
+#include "i2cdriver.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_STATIC
+#undef VAR_STATIC
+#endif
+#define VAR_STATIC  static
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL
+
+#define I2C_TIMEOUT     1000    // Max time of one byte [us]
+#define I2C_BUSY        1       // Result of a transfer not ended yet
+#define I2C_PRIORITY    0x40    // Interrupt priority, above PendSV
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+typedef enum {                  // Transfer state, at the next interrupt
+    I2C_IDLE,                   // no transfer
+    I2C_REG,                    // register address sent (read)
+    I2C_TX,                     // data byte sent (write)
+    I2C_RX,                     // data byte received (read)
+    I2C_LAST,                   // last byte sent (write)
+    I2C_STOP,                   // stop after an error or a timeout sent
+    I2C_CALLBACK                // transfer ended, callback running
+} ENUM_I2C_STATE;
+
+/*----------------------------------- Types ----------------------------------*/
+
+typedef struct {                // Queued transfer
+    unsigned char ucSlave;      // 7 bit slave address
+    unsigned char ucReg;        // first register
+    unsigned char ucLength;     // data bytes
+    tBoolean bRead;             // read, else write
+    unsigned char *pucData;     // data
+    I2C_DONE pfnDone;           // callback, 0 if none
+    void *pvArg;                // callback argument
+} STRUCT_I2C_XFER;
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+VAR_STATIC unsigned long s_ulErrors = 0;    // Failed transfers
+VAR_STATIC STRUCT_I2C_XFER s_pstQueue[I2C_QUEUE];   // Transfers, head first
+VAR_STATIC volatile unsigned char s_ucHead = 0;     // Transfer on the bus
+VAR_STATIC volatile unsigned char s_ucTail = 0;     // Next free entry
+VAR_STATIC volatile ENUM_I2C_STATE s_eState = I2C_IDLE; // Bus state
+VAR_STATIC unsigned char s_ucIndex;         // Data bytes transferred
+VAR_STATIC unsigned long s_ulStart;         // Start of the transfer [us]
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+static void I2CMasterSetup( void );
+static int I2CQueue( const STRUCT_I2C_XFER *pstXfer );
+static void I2CStart( void );
+static void I2CEnd( int iResult );
+static void I2CBlockingDone( int iResult, void *pvArg );
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION I2C initialization
+/// \RETURN      -
+/// \REMARKS     I2C 0 master, 400 kHz, interrupt enabled: its priority is
+///              above that of the tasks that wait for a transfer (PendSV,
+///              see scheduler.c), below the tick and the sensors.
+///
+///----------------------------------------------------------------------------
+void
+I2CInit(void)
+{
+    //
+    // Enable I2C 0 and GPIO port B
+    //
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_I2C0);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
+
+    //
+    // Select pin's alternate function
+    //
+#if defined(PART_LM3S9B90)
+    GPIOPinConfigure(GPIO_PB2_I2C0SCL);
+    GPIOPinConfigure(GPIO_PB3_I2C0SDA);
+#endif
+
+    //
+    // Set GPIO B2, B3 as I2C 0 pins
+    //
+    GPIOPinTypeI2C(GPIO_PORTB_BASE, GPIO_PIN_2 | GPIO_PIN_3);
+
+    I2CMasterSetup();
+    IntPrioritySet(INT_I2C0, I2C_PRIORITY);
+    IntEnable(INT_I2C0);
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Write registers
+/// \RETURN      0 on success, -1 on error
+/// \REMARKS     Writes ucLength bytes from register ucReg on, 7 bit slave
+///              address. Waits for the transfers queued before.
+///
+///----------------------------------------------------------------------------
+int
+I2CWrite(unsigned char ucSlave, unsigned char ucReg,
+         unsigned char ucLength, const unsigned char *pucData)
+{
+    volatile int iResult = I2C_BUSY;
+
+    if (I2CWriteAsync(ucSlave, ucReg, ucLength, pucData,
+                      I2CBlockingDone, (void *)&iResult) != 0) {
+        return -1;
+    }
+    while (iResult == I2C_BUSY) {
+        I2CPending();
+    }
+    return iResult;
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Read registers
+/// \RETURN      0 on success, -1 on error
+/// \REMARKS     Reads ucLength bytes from register ucReg on, with a repeated
+///              start after the register address, 7 bit slave address.
+///              Waits for the transfers queued before.
+///
+///----------------------------------------------------------------------------
+int
+I2CRead(unsigned char ucSlave, unsigned char ucReg,
+        unsigned char ucLength, unsigned char *pucData)
+{
+    volatile int iResult = I2C_BUSY;
+
+    if (ucLength == 0) {
+        return 0;
+    }
+    if (I2CReadAsync(ucSlave, ucReg, ucLength, pucData,
+                     I2CBlockingDone, (void *)&iResult) != 0) {
+        return -1;
+    }
+    while (iResult == I2C_BUSY) {
+        I2CPending();
+    }
+    return iResult;
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Queue a register write
+/// \RETURN      0 if queued, -1 if the queue is full
+/// \REMARKS     As I2CWrite(); pucData must stay valid until pfnDone(),
+///              which is called in interrupt context (pfnDone may be 0).
+///
+///----------------------------------------------------------------------------
+int
+I2CWriteAsync(unsigned char ucSlave, unsigned char ucReg,
+              unsigned char ucLength, const unsigned char *pucData,
+              I2C_DONE pfnDone, void *pvArg)
+{
+    STRUCT_I2C_XFER stXfer;
+
+    stXfer.ucSlave = ucSlave;
+    stXfer.ucReg = ucReg;
+    stXfer.ucLength = ucLength;
+    stXfer.bRead = false;
+    stXfer.pucData = (unsigned char *)pucData;
+    stXfer.pfnDone = pfnDone;
+    stXfer.pvArg = pvArg;
+    return I2CQueue(&stXfer);
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Queue a register read
+/// \RETURN      0 if queued, -1 if the queue is full or ucLength is 0
+/// \REMARKS     As I2CRead(); pucData is written until pfnDone(), which is
+///              called in interrupt context (pfnDone may be 0).
+///
+///----------------------------------------------------------------------------
+int
+I2CReadAsync(unsigned char ucSlave, unsigned char ucReg,
+             unsigned char ucLength, unsigned char *pucData,
+             I2C_DONE pfnDone, void *pvArg)
+{
+    STRUCT_I2C_XFER stXfer;
+
+    if (ucLength == 0) {
+        return -1;
+    }
+    stXfer.ucSlave = ucSlave;
+    stXfer.ucReg = ucReg;
+    stXfer.ucLength = ucLength;
+    stXfer.bRead = true;
+    stXfer.pucData = pucData;
+    stXfer.pfnDone = pfnDone;
+    stXfer.pvArg = pvArg;
+    return I2CQueue(&stXfer);
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Transfers not ended yet
+/// \RETURN      number of queued transfers, the one on the bus included
+/// \REMARKS     Aborts the transfer on the bus if it has lasted over
+///              I2C_TIMEOUT us per byte with a stop: its callback is called
+///              at the end of the stop, before the next transfer starts. If
+///              the stop does not end either, the master is reset.
+///
+///----------------------------------------------------------------------------
+unsigned char
+I2CPending(void)
+{
+    tBoolean bMasked;
+    unsigned char ucPending;
+
+    bMasked = IntMasterDisable();
+    if ((s_eState != I2C_IDLE) && (s_eState != I2C_CALLBACK) &&
+        ((Timebase_Us() - s_ulStart) >
+         (I2C_TIMEOUT * (s_pstQueue[s_ucHead].ucLength + 2UL)))) {
+        if (s_eState != I2C_STOP) {
+            //
+            // Stop the transfer, it ends at the interrupt of the stop
+            //
+            I2CMasterControl(I2C0_MASTER_BASE, I2C_MASTER_CMD_BURST_SEND_ERROR_STOP);
+            s_eState = I2C_STOP;
+            s_ulStart = Timebase_Us();
+        } else {
+            //
+            // Stop without interrupt, or bus held by a slave
+            //
+            if (I2CMasterBusy(I2C0_MASTER_BASE)) {
+                SysCtlPeripheralReset(SYSCTL_PERIPH_I2C0);
+                I2CMasterSetup();
+            }
+            I2CEnd(-1);
+        }
+    }
+    ucPending = (unsigned char)((s_ucTail - s_ucHead) & (I2C_QUEUE - 1));
+    if (!bMasked) {
+        IntMasterEnable();
+    }
+    return ucPending;
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Enter a section shared with the transfer callbacks
+/// \RETURN      -
+/// \REMARKS     Masks the I2C 0 interrupt, short sections only.
+///
+///----------------------------------------------------------------------------
+void
+I2CLock(void)
+{
+    IntDisable(INT_I2C0);
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Leave a section shared with the transfer callbacks
+/// \RETURN      -
+/// \REMARKS
+///
+///----------------------------------------------------------------------------
+void
+I2CUnlock(void)
+{
+    IntEnable(INT_I2C0);
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION I2C 0 master interrupt
+/// \RETURN      -
+/// \REMARKS     End of a byte: checks the bus errors (no acknowledge, lost
+///              arbitration), then issues the next command of the transfer
+///              on the bus, or ends it.
+///
+///----------------------------------------------------------------------------
+void
+I2CIntHandler(void)
+{
+    STRUCT_I2C_XFER *pstXfer = &s_pstQueue[s_ucHead];
+    tBoolean bError;
+
+    I2CMasterIntClear(I2C0_MASTER_BASE);
+    bError = (I2CMasterErr(I2C0_MASTER_BASE) != I2C_MASTER_ERR_NONE);
+
+    switch (s_eState) {
+
+    case I2C_REG:
+        if (bError) {
+            I2CMasterControl(I2C0_MASTER_BASE, I2C_MASTER_CMD_BURST_SEND_ERROR_STOP);
+            s_eState = I2C_STOP;
+            break;
+        }
+        I2CMasterSlaveAddrSet(I2C0_MASTER_BASE, pstXfer->ucSlave, true);
+        I2CMasterControl(I2C0_MASTER_BASE, (pstXfer->ucLength == 1) ?
+                         I2C_MASTER_CMD_SINGLE_RECEIVE :
+                         I2C_MASTER_CMD_BURST_RECEIVE_START);
+        s_eState = I2C_RX;
+        break;
+
+    case I2C_TX:
+        if (bError) {
+            I2CMasterControl(I2C0_MASTER_BASE, I2C_MASTER_CMD_BURST_SEND_ERROR_STOP);
+            s_eState = I2C_STOP;
+            break;
+        }
+        I2CMasterDataPut(I2C0_MASTER_BASE, pstXfer->pucData[s_ucIndex]);
+        s_ucIndex++;
+        if (s_ucIndex == pstXfer->ucLength) {
+            I2CMasterControl(I2C0_MASTER_BASE, I2C_MASTER_CMD_BURST_SEND_FINISH);
+            s_eState = I2C_LAST;
+        } else {
+            I2CMasterControl(I2C0_MASTER_BASE, I2C_MASTER_CMD_BURST_SEND_CONT);
+        }
+        break;
+
+    case I2C_RX:
+        if (bError) {
+            if (pstXfer->ucLength == 1) {
+                I2CEnd(-1);
+            } else {
+                I2CMasterControl(I2C0_MASTER_BASE,
+                                 I2C_MASTER_CMD_BURST_RECEIVE_ERROR_STOP);
+                s_eState = I2C_STOP;
+            }
+            break;
+        }
+        pstXfer->pucData[s_ucIndex] =
+            (unsigned char)I2CMasterDataGet(I2C0_MASTER_BASE);
+        s_ucIndex++;
+        if (s_ucIndex == pstXfer->ucLength) {
+            I2CEnd(0);
+        } else {
+            I2CMasterControl(I2C0_MASTER_BASE,
+                             (s_ucIndex + 1 == pstXfer->ucLength) ?
+                             I2C_MASTER_CMD_BURST_RECEIVE_FINISH :
+                             I2C_MASTER_CMD_BURST_RECEIVE_CONT);
+        }
+        break;
+
+    case I2C_LAST:
+        I2CEnd(bError ? -1 : 0);
+        break;
+
+    case I2C_STOP:
+        if (I2CMasterBusy(I2C0_MASTER_BASE)) {
+            break;                      // late byte, the stop is still on
+        }
+        I2CEnd(-1);
+        break;
+
+    default:
+        //
+        // No transfer on the bus
+        //
+        break;
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Interface to the error counter.
+/// \RETURN      number of failed transfers
+/// \REMARKS
+///
+///----------------------------------------------------------------------------
+unsigned long
+I2CErrors(void)
+{
+    return s_ulErrors;
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Set up the I2C 0 master
+/// \RETURN      -
+/// \REMARKS     Fast mode, interrupt at the end of every byte. At start up
+///              and after a reset of the peripheral.
+///
+///----------------------------------------------------------------------------
+static void
+I2CMasterSetup(void)
+{
+    I2CMasterInitExpClk(I2C0_MASTER_BASE, SysCtlClockGet(), true);
+    I2CMasterIntClear(I2C0_MASTER_BASE);
+    I2CMasterIntEnable(I2C0_MASTER_BASE);
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Queue a transfer
+/// \RETURN      0 if queued, -1 if the queue is full
+/// \REMARKS     Starts it if the bus is idle. From tasks and callbacks.
+///
+///----------------------------------------------------------------------------
+static int
+I2CQueue(const STRUCT_I2C_XFER *pstXfer)
+{
+    tBoolean bMasked;
+    int iResult = -1;
+
+    bMasked = IntMasterDisable();
+    if (((s_ucTail + 1) & (I2C_QUEUE - 1)) != s_ucHead) {
+        s_pstQueue[s_ucTail] = *pstXfer;
+        s_ucTail = (s_ucTail + 1) & (I2C_QUEUE - 1);
+        if (s_eState == I2C_IDLE) {
+            I2CStart();
+        }
+        iResult = 0;
+    }
+    if (!bMasked) {
+        IntMasterEnable();
+    }
+    return iResult;
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Start the transfer at the head of the queue
+/// \RETURN      -
+/// \REMARKS     Slave address and register address, with interrupts
+///              disabled or from the interrupt.
+///
+///----------------------------------------------------------------------------
+static void
+I2CStart(void)
+{
+    const STRUCT_I2C_XFER *pstXfer = &s_pstQueue[s_ucHead];
+
+    s_ucIndex = 0;
+    s_ulStart = Timebase_Us();
+    I2CMasterIntClear(I2C0_MASTER_BASE);
+    I2CMasterSlaveAddrSet(I2C0_MASTER_BASE, pstXfer->ucSlave, false);
+    I2CMasterDataPut(I2C0_MASTER_BASE, pstXfer->ucReg);
+    if (pstXfer->bRead) {
+        I2CMasterControl(I2C0_MASTER_BASE, I2C_MASTER_CMD_BURST_SEND_START);
+        s_eState = I2C_REG;
+    } else if (pstXfer->ucLength == 0) {
+        I2CMasterControl(I2C0_MASTER_BASE, I2C_MASTER_CMD_SINGLE_SEND);
+        s_eState = I2C_LAST;
+    } else {
+        I2CMasterControl(I2C0_MASTER_BASE, I2C_MASTER_CMD_BURST_SEND_START);
+        s_eState = I2C_TX;
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION End the transfer at the head of the queue
+/// \RETURN      -
+/// \REMARKS     Calls its callback, then starts the next transfer, queued
+///              before or by the callback itself.
+///
+///----------------------------------------------------------------------------
+static void
+I2CEnd(int iResult)
+{
+    STRUCT_I2C_XFER stXfer = s_pstQueue[s_ucHead];
+
+    if (iResult != 0) {
+        s_ulErrors++;
+    }
+    s_ucHead = (s_ucHead + 1) & (I2C_QUEUE - 1);
+    s_eState = I2C_CALLBACK;
+    if (stXfer.pfnDone != 0) {
+        stXfer.pfnDone(iResult, stXfer.pvArg);
+    }
+    if (s_ucHead != s_ucTail) {
+        I2CStart();
+    } else {
+        s_eState = I2C_IDLE;
+    }
+}
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Callback of the blocking transfers
+/// \RETURN      -
+/// \REMARKS     pvArg points to the result the caller waits on.
+///
+///----------------------------------------------------------------------------
+static void
+I2CBlockingDone(int iResult, void *pvArg)
+{
+    *(volatile int *)pvArg = iResult;
+}
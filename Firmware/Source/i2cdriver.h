@@ -0,0 +1,54 @@
+//============================================================================
+//
+// $RCSfile: i2cdriver.h,v $ (HEADER FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   I2C driver header file
+///
+/// \file
+///
+//  CHANGES trasferimenti asincroni in coda, avanzati dall'interrupt
+//
+//============================================================================
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL extern
+
+#define I2C_QUEUE       8       // Max transfers queued, power of 2
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*------------------------------------ Types ---------------------------------*/
+
+typedef void (*I2C_DONE)(int iResult, void *pvArg); // end of transfer,
+                                    // iResult 0 on success, -1 on error
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*----------------------------------- Globals --------------------------------*/
+
+/*---------------------------------- Interface -------------------------------*/
+
+void I2CInit( void );
+int I2CWrite( unsigned char ucSlave, unsigned char ucReg,
+              unsigned char ucLength, const unsigned char *pucData );
+int I2CRead( unsigned char ucSlave, unsigned char ucReg,
+             unsigned char ucLength, unsigned char *pucData );
+int I2CWriteAsync( unsigned char ucSlave, unsigned char ucReg,
+                   unsigned char ucLength, const unsigned char *pucData,
+                   I2C_DONE pfnDone, void *pvArg );
+int I2CReadAsync( unsigned char ucSlave, unsigned char ucReg,
+                  unsigned char ucLength, unsigned char *pucData,
+                  I2C_DONE pfnDone, void *pvArg );
+unsigned char I2CPending( void );
+void I2CLock( void );
+void I2CUnlock( void );
+unsigned long I2CErrors( void );
@@ -11,10 +11,13 @@
 ///
 //  CHANGES funzione Log_DCM(): resa non sospensiva, semplificato il formato
 //          per l'invio della matrice DCM
+//          tempo in us (Timebase_Us()) in coda ai record '^' e '*'
+//          record '^' dal backend dei sensori, funzione Log_ReadSensor()
 //
 //============================================================================*/
 
 #include "math.h"
+#include "fastmath.h"
 
 #include "inc/hw_ints.h"
 #include "inc/hw_types.h"
@@ -25,10 +28,13 @@
 #include "driverlib/sysctl.h"
 #include "driverlib/interrupt.h"
 
-#include "adcdriver.h"
 #include "tff.h"
+#include "config.h"
 #include "DCM.h"
+#include "sensor.h"
 #include "tick.h"
+#include "scheduler.h"
+#include "timebase.h"
 #include "uartdriver.h"
 #include "ppmdriver.h"
 #include "log.h"
@@ -65,6 +71,8 @@
 
 VAR_STATIC unsigned char szString[LOG_STRING_SIZE];
 VAR_STATIC const char szFileName[16] = "log.txt";   // File name
+VAR_STATIC const char szRateName[16] = "rate.txt";  // Loop rate file name
+VAR_STATIC const char szSensorName[16] = "sensor.txt"; // Sensor backend file name
 VAR_STATIC FATFS stFat;                             // FAT
 VAR_STATIC FIL stFile;                              // File object
 VAR_STATIC char pcBuffer[FILE_BUFFER_LENGTH];       // File data buffer
@@ -96,6 +104,98 @@ Log_Init( void ) {
     }
 }
 
+//----------------------------------------------------------------------------
+//
+/// \brief   Put a time stamp to log file
+///
+/// \param   ulTime time [us], from Timebase_Us()
+/// \remarks Writes a space and 8 hex digits, to be appended to a record.
+///
+//----------------------------------------------------------------------------
+void
+Log_Stamp( unsigned long ulTime ) {
+
+    char sString[5];
+    int j;
+
+    Log_PutChar(' ');
+    Int2Hex((long)(ulTime >> 16), sString);
+    for (j = 0; j < 4; j++) {
+        Log_PutChar(sString[j]);
+    }
+    Int2Hex((long)(ulTime & 0xFFFF), sString);
+    for (j = 0; j < 4; j++) {
+        Log_PutChar(sString[j]);
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Read control loop rate from SD card
+///
+/// \return  loop rate [Hz], 0 if the file is missing or empty
+/// \remarks Call after Log_Init(). rate.txt holds the rate in decimal
+///          digits (e.g. "200"); reading stops at the first non digit.
+///
+//----------------------------------------------------------------------------
+unsigned int
+Log_ReadRate( void ) {
+
+    FIL stRate;
+    WORD wRead;
+    char pcRate[8];
+    unsigned int uiRate = 0;
+    WORD w;
+
+    if (FR_OK != f_open(&stRate, szRateName, FA_READ)) {
+        return 0;
+    }
+    if (FR_OK == f_read(&stRate, pcRate, sizeof(pcRate), &wRead)) {
+        for (w = 0; (w < wRead) && (pcRate[w] >= '0') && (pcRate[w] <= '9'); w++) {
+            uiRate = (uiRate * 10) + (pcRate[w] - '0');
+        }
+    }
+    f_close(&stRate);
+    return uiRate;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Read sensor backend name from SD card
+///
+/// \param   pcName buffer for the name
+/// \param   ucLength size of the buffer, terminator included
+/// \return  pcName, 0 if the file is missing or empty
+/// \remarks Call after Log_Init(). sensor.txt holds the backend name (e.g.
+///          "mpu6050"); reading stops at the first non alphanumeric
+///          character. See Sensor_Select().
+///
+//----------------------------------------------------------------------------
+const char *
+Log_ReadSensor( char *pcName, unsigned char ucLength ) {
+
+    FIL stSensor;
+    WORD wRead = 0;
+    WORD w;
+
+    if (FR_OK != f_open(&stSensor, szSensorName, FA_READ)) {
+        return 0;
+    }
+    if (FR_OK != f_read(&stSensor, pcName, ucLength - 1, &wRead)) {
+        wRead = 0;
+    }
+    f_close(&stSensor);
+    for (w = 0; w < wRead; w++) {
+        if (!(((pcName[w] >= '0') && (pcName[w] <= '9')) ||
+              ((pcName[w] >= 'a') && (pcName[w] <= 'z')) ||
+              ((pcName[w] >= 'A') && (pcName[w] <= 'Z')))) {
+            break;
+        }
+    }
+    pcName[w] = '\0';
+    return (w == 0) ? 0 : pcName;
+}
+
 //----------------------------------------------------------------------------
 //
 /// \brief   Put characters to log file
@@ -131,11 +231,11 @@ Log_PutChar( char c ) {
 /// \brief   Log DCM matrix
 ///
 /// \return  -
-/// \remarks DCM to Euler angles conversion :
-///
-///             pitch = -asin(DCM_Matrix[2][0])
-///             roll = atan2(DCM_Matrix[2][1],DCM_Matrix[2][2])
-///             yaw = atan2(DCM_Matrix[1][0],DCM_Matrix[0][0])
+/// \remarks Logs the matrix, not the Euler angles: the conversion is the
+///          one of Attitude_Get(), done off line (see Host/replay.cpp).
+///          The matrix is copied with foreground tasks locked out, so that
+///          a record never mixes two estimator updates.
+///          The record ends with the time of the copy, see Log_Stamp().
 ///
 ///----------------------------------------------------------------------------
 void
@@ -143,19 +243,32 @@ Log_DCM(void)
 {
     char sString[5];
     int iRow, iCol, j;                      // Indexes of DCM entries
-    long lEntry;                            // DCM entry
+    float fMatrix[3][3];                    // DCM matrix
+    long lEntry[3][3];                      // DCM entries
+    unsigned long ulTime;                   // Time of the copy
+
+    Sched_Lock();
+    ulTime = Timebase_Us();
+    DCM_Refresh();                          // Update DCM matrix
+    DCM_GetMatrix(fMatrix);
+    Sched_Unlock();
+    for (iCol = 0; iCol < 3; iCol++) {
+      for (iRow = 0; iRow < 3; iRow++) {
+          lEntry[iCol][iRow] = FastCeil(fMatrix[iCol][iRow] * 32767.0f);
+      }
+    }
 
     Log_PutChar('*');                       // Header for DCM data
     for (iCol = 0; iCol < 3; iCol++) {      // Convert DCM matrix to hex
       for (iRow = 0; iRow < 3; iRow++) {
           Log_PutChar(' ');                 // Space before entries
-          lEntry = (long)ceil(DCM_Matrix[iCol][iRow] * 32767.0f);
-          Int2Hex(lEntry, sString);         // Convert DCM entry to hex
+          Int2Hex(lEntry[iCol][iRow], sString); // Convert DCM entry to hex
           for (j = 0; j < 4; j++) {         // Log DCM entry
              Log_PutChar(sString[j]);
           }
       }
     }
+    Log_Stamp(ulTime);                      // Time of the copy
     Log_PutChar('\n');                      // Terminate log string
 }
 /*
@@ -180,6 +293,11 @@ Log_DCM(void)
 ///             4   omega y
 ///             5   omega z
 ///
+///          in steps of the selected sensor backend, rounded to the
+///          nearest, last sample read by the estimators (Sensor_Last()),
+///          followed by its time, see Log_Stamp(). The sample is copied
+///          with the scheduler locked, as the control task rewrites it.
+///
 ///----------------------------------------------------------------------------
 void
 Log_Sensors(void)
@@ -187,16 +305,25 @@ Log_Sensors(void)
     char sString[5];
     int iIndex, j;                          // Index of sensor
     long lSensor;                           // Sensor value
+    float fSensor;                          // Sensor value [steps]
+    STRUCT_SENSOR_SAMPLE stLast;            // Last sample
+
+    Sched_Lock();
+    stLast = *Sensor_Last();
+    Sched_Unlock();
 
     Log_PutChar('^');                       // Header for sensor data
     for (iIndex = 0; iIndex < 6; iIndex++) {
       Log_PutChar(' ');                     // Space before sensors
-      lSensor = (long)ceil(ADCGetData(iIndex));
+      fSensor = (iIndex < 3) ? stLast.pfAccel[iIndex] :
+                               stLast.pfGyro[iIndex - 3];
+      lSensor = (long)((fSensor < 0.0f) ? (fSensor - 0.5f) : (fSensor + 0.5f));
       Int2Hex(lSensor, sString);            // Convert sensor to hex
       for (j = 0; j < 4; j++) {             // Log sensor data
          Log_PutChar(sString[j]);
       }
     }
+    Log_Stamp(stLast.ulTime);               // Time of the samples
     Log_PutChar('\n');                      // Terminate log string
 }
 
@@ -8,6 +8,7 @@
 //  LANGUAGE C
 /// \brief   Log manager header file
 //  CHANGES  Aggiunta funzione Log_PutChar
+//           Aggiunta funzione Log_ReadSensor
 //
 //============================================================================
 
@@ -31,6 +32,9 @@
 /*---------------------------------- Interface -------------------------------*/
 
 void Log_Init ( void );
+unsigned int Log_ReadRate ( void );
+const char *Log_ReadSensor ( char *pcName, unsigned char ucLength );
+void Log_Stamp ( unsigned long ulTime );
 void Log_Sensors ( void );
 void Log_DCM ( void );
 void Log_PPM ( void );
@@ -10,6 +10,13 @@
 /// \file
 ///
 //  CHANGES Simulation.h sostituito da Telemetry.h
+//          superloop a polling dei flag sostituito dallo scheduler (scheduler.c)
+//          frequenza del ciclo di controllo scelta all'avvio (timing.c)
+//          ciclo principale in WFI fino al prossimo evento (event.c)
+//          blocchi dell'ADC letti dal task di controllo (ADCUpdate)
+//          calibrazione dei sensori letta da SD card, verificata all'avvio
+//          task di analisi delle vibrazioni (vibe.c)
+//          backend dei sensori scelto all'avvio da SD card (sensor.c)
 //
 //============================================================================*/
 
@@ -30,13 +37,21 @@
 #include "gps.h"
 #include "nav.h"
 #include "tick.h"
+#include "scheduler.h"
+#include "timing.h"
+#include "timebase.h"
+#include "event.h"
+#include "profile.h"
+#include "calib.h"
+#include "vibe.h"
+#include "sensor.h"
 #include "diskio.h"
 #include "adcdriver.h"
 #include "ppmdriver.h"
 #include "uartdriver.h"
-#include "telemetry.h"
+#include "Telemetry.h"
 #include "servodriver.h"
-#include "aileronctrl.h"
+#include "AileronCtrl.h"
 #include "elevatorctrl.h"
 
 /*--------------------------------- Definitions ------------------------------*/
@@ -66,8 +81,29 @@
 
 /*----------------------------------- Macros ---------------------------------*/
 
+//! Limiti dell'intervallo di integrazione misurato
+#define DELTA_T_MIN     (0.5f * Timing_Get()->fDeltaT)
+#define DELTA_T_MAX     (4.0f * Timing_Get()->fDeltaT)
+
+//! Limiti dell'intervallo misurato del gruppo di guida
+#define GUIDANCE_DT_MIN (0.5e-3f * GUIDANCE_PERIOD)
+#define GUIDANCE_DT_MAX (4.0e-3f * GUIDANCE_PERIOD)
+
 /*-------------------------------- Enumerations ------------------------------*/
 
+typedef enum {          // tasks, same order as g_pstTasks[]
+    TASK_DISK,
+    TASK_CONTROL,
+    TASK_ATTITUDE,
+    TASK_GUIDANCE,
+    TASK_LOG,
+    TASK_TELEMETRY,
+    TASK_LOG_DCM,
+    TASK_DOWNLINK,
+    TASK_VIBE,
+    TASK_NAVIGATION
+} ENUM_TASK;
+
 /*----------------------------------- Types ----------------------------------*/
 
 /*---------------------------------- Constants -------------------------------*/
@@ -78,6 +114,57 @@
 
 /*--------------------------------- Prototypes -------------------------------*/
 
+static void Task_Disk( void );
+static void Task_Control( void );
+static void Task_Attitude( void );
+static void Task_Guidance( void );
+static void Task_Log( void );
+static void Task_Telemetry( void );
+static void Task_LogDCM( void );
+static void Task_Downlink( void );
+static void Task_Vibe( void );
+static void Task_Navigation( void );
+
+//
+// Task table, rate monotonic priorities: the shorter the period, the higher
+// the priority. Periods in ms or SCHED_LOOP (control loop rate, timing.c),
+// budgets and deadlines in us, deadline 0 = end of period. Period 0: released
+// by the events, UART input for navigation.
+// Shed levels: 1 logging, 2 telemetry, 3 navigation.
+// Control rate groups: control (inner: estimator, damping, servos), attitude
+// and guidance, see config.h. On the ticks where they coincide the inner
+// group runs first, with the outputs of the previous outer runs.
+//
+static const STRUCT_TASK g_pstTasks[] = {
+//    task             name          period           prio mode             shed budget deadline events
+    { Task_Disk,       "disk",       10,              0,   SCHED_FOREGROUND, 0,   100,       0, 0 },
+    { Task_Control,    "control",    SCHED_LOOP,      1,   SCHED_FOREGROUND, 0,  5000,       0, 0 },
+    { Task_Attitude,   "attitude",   ATTITUDE_PERIOD, 2,   SCHED_FOREGROUND, 0,  1000,       0, 0 },
+    { Task_Guidance,   "guidance",   GUIDANCE_PERIOD, 3,   SCHED_FOREGROUND, 0,  1000,       0, 0 },
+    { Task_Log,        "log",        SCHED_LOOP,      4,   SCHED_BACKGROUND, 1,  2000,       0, 0 },
+    { Task_Telemetry,  "telemetry",  SCHED_LOOP,      5,   SCHED_BACKGROUND, 2,  2000,       0, 0 },
+    { Task_LogDCM,     "log dcm",    160,             6,   SCHED_BACKGROUND, 1,  5000,       0, 0 },
+    { Task_Downlink,   "downlink",   160,             7,   SCHED_BACKGROUND, 2,  2000,       0, 0 },
+    { Task_Vibe,       "vibration",  160,             8,   SCHED_BACKGROUND, 2,  5000,       0, 0 },
+    { Task_Navigation, "navigation", 0,               9,   SCHED_BACKGROUND, 3, 10000,       0, EVENT_UART0 | EVENT_UART1 }
+};
+
+//
+// Sensor backends, the first is the default: sensor.txt on the SD card
+// selects another one, see sensor.c
+//
+static const STRUCT_SENSOR_BACKEND * const g_ppstSensors[] = {
+#if (SIMULATOR == SIM_NONE)
+    &g_stSensorAdc,
+    &g_stSensorMpu,
+    &g_stSensorSim
+#else
+    &g_stSensorSim,
+    &g_stSensorAdc,
+    &g_stSensorMpu
+#endif
+};
+
 #ifdef DEBUG
 ///----------------------------------------------------------------------------
 ///
@@ -117,6 +204,8 @@ __error__(char *pcFilename, unsigned long ulLine)
 int
 main(void)
 {
+    char szSensor[16];      // Sensor backend name, from sensor.txt
+
     //
     // Set the clocking source.
     //
@@ -158,10 +247,13 @@ main(void)
     //
     // Initialize drivers
     //
+    Timebase_Init();        // Microsecond timebase (Timer 1)
+    Event_Init();           // Main loop events
+    Vibe_Init();            // Vibration analyzer, before the ADC feeds it
     UARTInit();             // UART 0, 1
     ADCInit();              // Sensors (ADC)
     ServoInit();            // Servos (PWM)
-    PPMInit();              // PPM input (Timer 1)
+    PPMInit();              // PPM input (Timer 1, shared with the timebase)
     TickInit();             // Push buttons and disktimerproc (System tick)
     GPSInit();              // GPS
 
@@ -177,16 +269,26 @@ main(void)
     Log_Init();                   // Logging
 
     //
-    // Wait for sensor input settling
+    // Select the control loop rate, then retune the system tick and the ADC
+    // trigger that were started at the default rate.
     //
-#if (SIMULATOR == SIM_NONE)
-    while (ADCSettled() == false) {
-    }
-#else
-    while (Sim_Settled() == false) {
-      Telemetry_Parse();
+    Timing_Init(Log_ReadRate());
+    TickSetRate();
+    ADCSetRate();
+
+    //
+    // Select the sensor backend, whose sample rate may follow the loop rate
+    //
+    Sensor_Init(g_ppstSensors, sizeof(g_ppstSensors) / sizeof(g_ppstSensors[0]));
+    Sensor_Select(Log_ReadSensor(szSensor, sizeof(szSensor)));
+    Calib_Load();                 // Sensor calibration saved on SD card
+
+    //
+    // Wait for sensor input settling: a short check of the saved
+    // calibration, a full calibration if it fails
+    //
+    while (Sensor_Settled() == false) {
     }
-#endif
 
     //
     // Throw away any button presses that may have occurred so far.
@@ -194,59 +296,203 @@ main(void)
     HWREGBITW(&g_ulFlags, FLAG_BUTTON_PRESS) = 0;
 
     //
-    // Loop forever.
+    // Start releasing tasks.
+    //
+    Profile_Init();
+    Sched_Init(g_pstTasks, sizeof(g_pstTasks) / sizeof(STRUCT_TASK));
+
+    //
+    // Loop forever: background tasks, sleeping when none is ready.
+    // Foreground tasks preempt them.
     //
     while ( 1 ) {
+        Sched_Run();
+    }
+}
 
-        //
-        // Wait until a 10 ms Tick has occurred.
-        //
-        if (HWREGBITW(&g_ulFlags, FLAG_CLOCK_TICK_10)) {
-            HWREGBITW(&g_ulFlags, FLAG_CLOCK_TICK_10) = 0;  // Clear the 10 ms Tick flag.
-            disk_timerproc();                               // Call the FatFs tick timer.
-        }
+///----------------------------------------------------------------------------
+///
+/// \brief   Task: FatFs tick timer, every 10 ms
+/// \return  -
+/// \remarks foreground
+///
+///----------------------------------------------------------------------------
+static void
+Task_Disk(void)
+{
+    disk_timerproc();                               // Call the FatFs tick timer.
+}
 
-        //
-        // Wait until a 20 ms Tick has occurred.
-        //
-        if (HWREGBITW(&g_ulFlags, FLAG_CLOCK_TICK_20)) {
-            HWREGBITW(&g_ulFlags, FLAG_CLOCK_TICK_20) = 0;  // Clear the 20 ms Tick flag.
-            LED_TOGGLE();                                   // Toggle green LED.
-            Logic();                                        // Update logic and I/O.
-                                                            // Actual IMU and AHRS computation.
-            MatrixUpdate();       //
-            CompensateDrift();    //
-            Normalize();          //
-            Aileron_Control();                              // Aileron control
-            Elevator_Control();                             // Elevator control
-            Log_Sensors();                                  // Log sensor data
-            Telemetry_Send_Controls();                      // Update simulator controls
-            ServoUpdate();                                  // Update servo deflections
-        }
+///----------------------------------------------------------------------------
+///
+/// \brief   Task: attitude estimation and inner control group, every
+///          control loop
+/// \return  -
+/// \remarks foreground. The estimator integrates over the time measured
+///          since the previous run, not over the nominal period: a late or
+///          lost tick does not corrupt the integration. Gyro substeps are
+///          weighted by their own sample period instead, see DCM.cpp.
+///
+///----------------------------------------------------------------------------
+static void
+Task_Control(void)
+{
+    float fDeltaT;
 
-        //
-        // Wait until a 160 ms Tick has occurred.
-        //
-        if (HWREGBITW(&g_ulFlags, FLAG_CLOCK_TICK_160)) {
-            HWREGBITW(&g_ulFlags, FLAG_CLOCK_TICK_160) = 0; // Clear the 20 ms Tick flag.
-            Log_DCM();                                      // Log aircraft attitude
-        }
+    fDeltaT = (float)Sched_GetStats(TASK_CONTROL)->ulInterval * 1.0e-6f;
+    if (fDeltaT < DELTA_T_MIN) {
+        fDeltaT = DELTA_T_MIN;
+    } else if (fDeltaT > DELTA_T_MAX) {
+        fDeltaT = DELTA_T_MAX;
+    }
+    Delta_T = fDeltaT;
+    Sample_Rate = 1.0f / fDeltaT;
+
+    LED_TOGGLE();                                   // Toggle green LED.
+    PROFILE(PROF_ADC, ADCUpdate());                 // Read the ADC blocks.
+    PROFILE(PROF_LOGIC, Logic());                   // Update logic and I/O.
+                                                    // Actual IMU and AHRS computation.
+    PROFILE(PROF_MATRIX_UPDATE, MatrixUpdate());
+    PROFILE(PROF_COMPENSATE_DRIFT, CompensateDrift());
+    PROFILE(PROF_NORMALIZE, Normalize());
+    PROFILE(PROF_AILERON, Aileron_Damping());       // Roll rate damping
+    PROFILE(PROF_ELEVATOR, Elevator_Damping());     // Pitch rate damping
+    PROFILE(PROF_SERVO_UPDATE, ServoUpdate());      // Update servo deflections
+}
 
-        //
-        // Navigation
-        //
+///----------------------------------------------------------------------------
+///
+/// \brief   Task: attitude control group, every ATTITUDE_PERIOD
+/// \return  -
+/// \remarks foreground
+///
+///----------------------------------------------------------------------------
+static void
+Task_Attitude(void)
+{
+    PROFILE(PROF_ATTITUDE, (Aileron_Attitude(), Elevator_Attitude()));
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Task: guidance control group, every GUIDANCE_PERIOD
+/// \return  -
+/// \remarks foreground. The direction PID integrates over the time measured
+///          since the previous run of this task.
+///
+///----------------------------------------------------------------------------
+static void
+Task_Guidance(void)
+{
+    float fDeltaT;
+
+    fDeltaT = (float)Sched_GetStats(TASK_GUIDANCE)->ulInterval * 1.0e-6f;
+    if (fDeltaT < GUIDANCE_DT_MIN) {
+        fDeltaT = GUIDANCE_DT_MIN;
+    } else if (fDeltaT > GUIDANCE_DT_MAX) {
+        fDeltaT = GUIDANCE_DT_MAX;
+    }
+
+    PROFILE(PROF_GUIDANCE, Aileron_Guidance(fDeltaT, 1.0f / fDeltaT));
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Task: sensor log, every control loop
+/// \return  -
+/// \remarks background: SD card writes do not delay the control task.
+///
+///----------------------------------------------------------------------------
+static void
+Task_Log(void)
+{
+    PROFILE(PROF_LOG_SENSORS, Log_Sensors());       // Log sensor data
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Task: simulator controls and profiler, every control loop
+/// \return  -
+/// \remarks background
+///
+///----------------------------------------------------------------------------
+static void
+Task_Telemetry(void)
+{
+    PROFILE(PROF_TELEMETRY_CONTROLS, Telemetry_Send_Controls()); // Update simulator controls
+    Telemetry_Send_Profile();                       // Profiler summary, on request
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Task: attitude log, every 160 ms
+/// \return  -
+/// \remarks background
+///
+///----------------------------------------------------------------------------
+static void
+Task_LogDCM(void)
+{
+    Log_DCM();                                      // Log aircraft attitude
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Task: attitude downlink, every 160 ms
+/// \return  -
+/// \remarks background
+///
+///----------------------------------------------------------------------------
+static void
+Task_Downlink(void)
+{
+    Telemetry_Send_Attitude();                      // Downlink aircraft attitude
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Task: vibration analysis, every 160 ms
+/// \return  -
+/// \remarks background: one step of the analysis, then the result axis by
+///          axis, after a "$V" request.
+///
+///----------------------------------------------------------------------------
+static void
+Task_Vibe(void)
+{
+#if (VIBE_ANALYZER == 1)
+    PROFILE(PROF_VIBE, Vibe_Run());                 // Spectra of the capture
+    Telemetry_Send_Vibe();                          // Peaks, on request
+#endif
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Task: navigation, on UART input
+/// \return  -
+/// \remarks background, lowest priority. Parses all the received
+///          characters: the task is released again only by new ones.
+///
+///----------------------------------------------------------------------------
+static void
+Task_Navigation(void)
+{
 #if (SIMULATOR == SIM_NONE)
-        if (GPSParse()) {               // Parse GPS sentence
-            Navigate();                 // Compute direction
+    tBoolean bGps;
+
+    do {
+        PROFILE(PROF_GPS, bGps = GPSParse());
+        if (bGps) {                 // Parse GPS sentence
+            Navigate();             // Compute direction
             Telemetry_Send_Waypoint();  // Update waypoint number
         }
-        Telemetry_Parse();              // Parse telemetry data
+    } while (GPSPending());
+    Telemetry_Parse();              // Parse telemetry data
 #else
-        if (Telemetry_Parse()) {        // Parse telemetry data
-            Navigate();                 // Compute direction
-            Telemetry_Send_Waypoint();  // Update waypoint number
-        }
-#endif
+    if (Telemetry_Parse()) {        // Parse telemetry data
+        Navigate();                 // Compute direction
+        Telemetry_Send_Waypoint();  // Update waypoint number
     }
+#endif
 }
 
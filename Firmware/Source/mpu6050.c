@@ -0,0 +1,392 @@
+//============================================================================+
+//
+// $RCSfile: mpu6050.c,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   MPU-6050 sensor backend
+///
+/// \file
+/// Sensor backend "mpu6050" (sensor.c) on the InvenSense driver
+/// (imu_invensense_6050_repo/inv_mpu.c), over I2C 0 (i2cdriver.c):
+/// - gyros and accelerometers in the FIFO, MPU_GYRO_FSR and MPU_ACCEL_FSR
+///   full scale, sampled at the loop rate times GYRO_SUBSTEPS, up to
+///   MPU_RATE_MAX; the driver sets the digital low pass at half that rate;
+/// - every read empties the FIFO, up to SENSOR_BATCH packets, with
+///   mpu_read_fifo_batch(): one FIFO count read, then the packets in I2C
+///   bursts; the driver stamps them back from the time of the count read,
+///   one sample period apart, the packets left in the FIFO included;
+/// - with MPU_FIFO_ASYNC the same transfers are queued by
+///   mpu_read_fifo_stream_async() and run by the I2C interrupt while the
+///   estimator computes: each read takes the packets of the one started
+///   by the previous control loop, decoded by mpu_decode_fifo(), and starts
+///   the next;
+/// - the gyro offsets are the mean of MPU_SETTLE_SAMPLES at boot, the
+///   accelerometer offsets are the factory trim of the chip.
+///
+/// The chip axes are assumed aligned with those of the analog sensors
+/// (adcdriver.c), Z accelerometer positive when level: change psMpuSign
+/// for other mountings.
+///
+//  CHANGES lettura del FIFO a blocchi (mpu_read_fifo_batch)
+//          lettura del FIFO in parallelo alla stima (MPU_FIFO_ASYNC)
+//
+//============================================================================*/
+
+#include "inc/hw_types.h"
+
+#include "config.h"
+#include "timing.h"
+#include "timebase.h"
+#include "i2cdriver.h"
+#include "inv_mpu.h"
+#include "sensor.h"
+#include "mpu6050.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef    VAR_STATIC
+#   undef VAR_STATIC
+#endif
+#define   VAR_STATIC static
+#ifdef    VAR_GLOBAL
+#   undef VAR_GLOBAL
+#endif
+#define   VAR_GLOBAL
+
+#define MPU_SENSORS     (INV_XYZ_GYRO | INV_XYZ_ACCEL)  // sensors in the FIFO
+#define MPU_RATE_MIN    4                               // min sample rate [Hz]
+#define MPU_PACKET      12                              // bytes per packet
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+/*---------------------------------- Constants -------------------------------*/
+
+//
+// Used to change the polarity of the sensors
+//
+VAR_STATIC const short psMpuSign[6] = {
+    1, // accel X
+    1, // accel Y
+    1, // accel Z
+    1, // gyro X / roll
+    1, // gyro Y / pitch
+    1  // gyro Z / yaw
+};
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+VAR_STATIC float pfGyroOffset[3];           // Gyro offsets [steps]
+VAR_STATIC long plGyroSum[3];               // Sum of the settling samples
+VAR_STATIC unsigned int uiSettle = 0;       // Settling samples taken
+VAR_STATIC unsigned int uiSubsteps = 1;     // Samples per control loop
+VAR_STATIC unsigned long ulPeriod;          // Sample period [us]
+VAR_STATIC struct mpu_fifo_sample_s pstFifo[SENSOR_BATCH];  // FIFO packets
+#if (MPU_FIFO_READ == MPU_FIFO_ASYNC)
+VAR_STATIC unsigned short usPacket = MPU_PACKET;    // Bytes per packet
+VAR_STATIC unsigned char pucFifoData[SENSOR_BATCH * MPU_PACKET]; // Raw packets
+VAR_STATIC tBoolean bFifoBusy = false;      // Read started, not taken yet
+VAR_STATIC volatile tBoolean bFifoDone = false; // Read ended, in interrupt
+VAR_STATIC int iFifoResult;                 // Result of the read
+VAR_STATIC unsigned short usFifoCount;      // Packets read
+VAR_STATIC unsigned short usFifoMore;       // Packets left in the FIFO
+VAR_STATIC unsigned long ulFifoTime;        // Time of the FIFO count [us]
+#endif
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+static tBoolean Mpu_SensorInit( void );
+static tBoolean Mpu_SensorSettled( void );
+static unsigned int Mpu_SensorRead( STRUCT_SENSOR_BATCH *pstBatch );
+#if (MPU_FIFO_READ == MPU_FIFO_ASYNC)
+static unsigned short Mpu_FifoTake( void );
+static void Mpu_FifoDone( int iResult, unsigned short usCount,
+                          unsigned short usMore, unsigned long ulTime );
+#endif
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Wait
+///
+/// \param   ulMs time [ms]
+/// \return  0
+/// \remarks Busy wait, delay_ms() of the InvenSense driver.
+///
+//----------------------------------------------------------------------------
+int
+Mpu_DelayMs( unsigned long ulMs ) {
+
+    unsigned long ulStart = Timebase_Us();
+
+    while ((Timebase_Us() - ulStart) < (ulMs * 1000UL)) {
+    }
+    return 0;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Time
+///
+/// \param   pulMs time since boot [ms]
+/// \return  0
+/// \remarks get_ms() of the InvenSense driver.
+///
+//----------------------------------------------------------------------------
+int
+Mpu_GetMs( unsigned long *pulMs ) {
+
+    *pulMs = (unsigned long)(Timebase_Us64() / 1000ULL);
+    return 0;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Time
+///
+/// \param   pulUs time, Timebase_Us() [us]
+/// \return  0
+/// \remarks get_us() of the InvenSense driver, FIFO packet time stamps.
+///
+//----------------------------------------------------------------------------
+int
+Mpu_GetUs( unsigned long *pulUs ) {
+
+    *pulUs = Timebase_Us();
+    return 0;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Sensor backend "mpu6050": start
+///
+/// \return  true if the chip answers and is configured
+/// \remarks Call after Timing_Init(): the sample rate follows the loop rate.
+///
+//----------------------------------------------------------------------------
+static tBoolean
+Mpu_SensorInit( void ) {
+
+    unsigned int uiLoopHz = Timing_Get()->uiLoopHz;
+    unsigned int uiRate = uiLoopHz * GYRO_SUBSTEPS;
+    unsigned short usRate;
+
+    if (uiRate > MPU_RATE_MAX) {
+        uiRate = MPU_RATE_MAX;
+    } else if (uiRate < MPU_RATE_MIN) {
+        uiRate = MPU_RATE_MIN;
+    }
+
+    I2CInit();
+    if ((mpu_init(0) != 0) ||
+        (mpu_set_sensors(MPU_SENSORS) != 0) ||
+        (mpu_set_gyro_fsr(MPU_GYRO_FSR) != 0) ||
+        (mpu_set_accel_fsr(MPU_ACCEL_FSR) != 0) ||
+        (mpu_set_sample_rate((unsigned short)uiRate) != 0) ||
+        (mpu_configure_fifo(MPU_SENSORS) != 0) ||
+        (mpu_get_sample_rate(&usRate) != 0) || (usRate == 0)) {
+        return false;
+    }
+#if (MPU_FIFO_READ == MPU_FIFO_ASYNC)
+    if ((mpu_get_fifo_packet_size(&usPacket) != 0) ||
+        (usPacket > MPU_PACKET)) {
+        return false;
+    }
+#endif
+
+    //
+    // Rate actually set, 1 kHz / integer divider
+    //
+    uiSubsteps = usRate / uiLoopHz;
+    if (uiSubsteps < 1) {
+        uiSubsteps = 1;
+    } else if (uiSubsteps > GYRO_SUBSTEPS) {
+        uiSubsteps = GYRO_SUBSTEPS;
+    }
+    ulPeriod = 1000000UL / usRate;
+    uiSettle = 0;
+    plGyroSum[0] = plGyroSum[1] = plGyroSum[2] = 0;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Sensor backend "mpu6050": input settling
+///
+/// \return  true when the gyro offsets have been taken
+/// \remarks Averages MPU_SETTLE_SAMPLES packets, aircraft still.
+///
+//----------------------------------------------------------------------------
+static tBoolean
+Mpu_SensorSettled( void ) {
+
+    unsigned short usCount, usMore;
+    unsigned char ucSensors;
+    unsigned int n;
+    int c;
+
+    if (uiSettle >= MPU_SETTLE_SAMPLES) {
+        return true;
+    }
+    mpu_read_fifo_batch(pstFifo, SENSOR_BATCH, &usCount, &ucSensors, &usMore);
+    if (ucSensors != MPU_SENSORS) {
+        return false;
+    }
+    for (n = 0; (n < usCount) && (uiSettle < MPU_SETTLE_SAMPLES); n++) {
+        for (c = 0; c < 3; c++) {
+            plGyroSum[c] += pstFifo[n].gyro[c];
+        }
+        uiSettle++;
+    }
+    if (uiSettle < MPU_SETTLE_SAMPLES) {
+        return false;
+    }
+    for (c = 0; c < 3; c++) {
+        pfGyroOffset[c] = (float)plGyroSum[c] / (float)MPU_SETTLE_SAMPLES;
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Sensor backend "mpu6050": samples since the last read
+///
+/// \param   pstBatch samples, oldest first
+/// \return  number of samples
+/// \remarks On FIFO overflow the driver resets the FIFO and no samples are
+///          returned; on a bus error, those read before it. With
+///          MPU_FIFO_ASYNC, the samples of the read started by the previous
+///          call, none if it has not ended yet.
+///
+//----------------------------------------------------------------------------
+static unsigned int
+Mpu_SensorRead( STRUCT_SENSOR_BATCH *pstBatch ) {
+
+    STRUCT_SENSOR_SAMPLE *pstSample;
+    unsigned short usCount;
+    unsigned int n;
+    int c;
+#if (MPU_FIFO_READ != MPU_FIFO_ASYNC)
+    unsigned short usMore;
+    unsigned char ucSensors;
+#endif
+
+#if (MPU_FIFO_READ == MPU_FIFO_ASYNC)
+    usCount = Mpu_FifoTake();
+    if (!bFifoBusy) {
+        bFifoBusy = (mpu_read_fifo_stream_async(usPacket, SENSOR_BATCH,
+                                                pucFifoData,
+                                                Mpu_FifoDone) == 0);
+    }
+#else
+    mpu_read_fifo_batch(pstFifo, SENSOR_BATCH, &usCount, &ucSensors, &usMore);
+    if (ucSensors != MPU_SENSORS) {
+        usCount = 0;
+    }
+#endif
+    for (n = 0; n < usCount; n++) {
+        pstSample = &pstBatch->pstSample[n];
+        pstSample->ulTime = pstFifo[n].timestamp;
+        for (c = 0; c < 3; c++) {
+            pstSample->pfAccel[c] = (float)(pstFifo[n].accel[c] * psMpuSign[c]);
+            pstSample->pfGyro[c] = ((float)pstFifo[n].gyro[c] - pfGyroOffset[c]) *
+                                   (float)psMpuSign[c + 3];
+        }
+    }
+    pstBatch->uiSubsteps = uiSubsteps;
+    pstBatch->ulPeriod = ulPeriod;
+    return n;
+}
+
+#if (MPU_FIFO_READ == MPU_FIFO_ASYNC)
+//----------------------------------------------------------------------------
+//
+/// \brief   Take the packets of the last asynchronous FIFO read
+///
+/// \return  number of packets decoded in pstFifo, 0 if the read has not
+///          ended yet
+/// \remarks Resets the FIFO after an overflow or a bus error, out of the
+///          interrupt.
+///
+//----------------------------------------------------------------------------
+static unsigned short
+Mpu_FifoTake( void ) {
+
+    tBoolean bDone;
+    int iResult = 0;
+    unsigned short usCount = 0, usMore = 0;
+    unsigned long ulTime = 0;
+    unsigned char ucSensors;
+
+    if (!bFifoBusy) {
+        return 0;
+    }
+    I2CLock();
+    bDone = bFifoDone;
+    if (bDone) {
+        iResult = iFifoResult;
+        usCount = usFifoCount;
+        usMore = usFifoMore;
+        ulTime = ulFifoTime;
+        bFifoDone = false;
+    }
+    I2CUnlock();
+
+    if (!bDone) {
+        I2CPending();                           // aborts a stuck transfer
+        return 0;
+    }
+    bFifoBusy = false;
+    if (iResult != 0) {
+        mpu_reset_fifo();
+        if (iResult == -2) {
+            return 0;
+        }
+    }
+    mpu_decode_fifo(pucFifoData, usCount, usMore, ulTime, pstFifo, &ucSensors);
+    if (ucSensors != MPU_SENSORS) {
+        return 0;
+    }
+    return usCount;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   End of an asynchronous FIFO read
+///
+/// \param   iResult 0, -1 on a bus error, -2 on FIFO overflow
+/// \param   usCount packets read
+/// \param   usMore packets left in the FIFO
+/// \param   ulTime time of the FIFO count read, Timebase_Us() [us]
+/// \remarks Interrupt context, see mpu_read_fifo_stream_async().
+///
+//----------------------------------------------------------------------------
+static void
+Mpu_FifoDone( int iResult, unsigned short usCount, unsigned short usMore,
+              unsigned long ulTime ) {
+
+    iFifoResult = iResult;
+    usFifoCount = usCount;
+    usFifoMore = usMore;
+    ulFifoTime = ulTime;
+    bFifoDone = true;
+}
+#endif
+
+//
+// Sensor backend "mpu6050", see sensor.c
+//
+VAR_GLOBAL const STRUCT_SENSOR_BACKEND g_stSensorMpu = {
+    "mpu6050",
+    (9.81f * MPU_ACCEL_FSR) / 32768.0f,
+    (MPU_GYRO_FSR * PI) / (32768.0f * 180.0f),
+    32768.0f / MPU_ACCEL_FSR,
+    true,
+    Mpu_SensorInit, Mpu_SensorSettled, Mpu_SensorRead
+};
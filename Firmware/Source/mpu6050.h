@@ -0,0 +1,39 @@
+//============================================================================
+//
+// $RCSfile: mpu6050.h,v $ (HEADER FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   MPU-6050 sensor backend header file
+///
+/// \file
+/// Also the system layer of the InvenSense driver (inv_mpu.c, built with
+/// EMPL_TARGET_LM3S): I2C in i2cdriver.h, time here.
+///
+//  CHANGES Mpu_GetUs(): tempi del FIFO letto a blocchi
+//
+//============================================================================
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL extern
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*------------------------------------ Types ---------------------------------*/
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*----------------------------------- Globals --------------------------------*/
+
+/*---------------------------------- Interface -------------------------------*/
+
+int Mpu_DelayMs( unsigned long ulMs );
+int Mpu_GetMs( unsigned long *pulMs );
+int Mpu_GetUs( unsigned long *pulUs );
@@ -27,8 +27,9 @@
 #include "stdafx.h"
 
 #include "math.h"
+#include "fastmath.h"
 #include "inc/hw_types.h"
-#include "telemetry.h"
+#include "Telemetry.h"
 #include "config.h"
 #include "gps.h"
 #ifndef _WINDOWS
@@ -282,13 +283,13 @@ Navigate( void ) {
     //
     dlon = (fDestLon - fCurrLon);
     dlat = (fDestLat - fCurrLat);
-    Bearing = 90 - (int)((atan2f(dlat, dlon) * 180.0f) / PI);
+    Bearing = 90 - (int)((FastAtan2(dlat, dlon) * 180.0f) / PI);
     if (Bearing < 0) Bearing = Bearing + 360;
 
     //
     // compute distance to destination
     //
-    temp = (sqrtf((dlat * dlat) + (dlon * dlon)) * 111113.7f);
+    temp = (FastSqrt((dlat * dlat) + (dlon * dlon)) * 111113.7f);
     Distance = (unsigned int)temp;
 
     //
@@ -10,6 +10,8 @@
 /// \file
 ///
 //  CHANGES Eliminato lampeggio LED nell'interrupt PPM per debug
+//          Timer 1 avviato da Timebase_Init(), tempo dell'impulso di sincronismo
+//          evento EVENT_PPM a fine trama
 //
 //============================================================================*/
 
@@ -26,6 +28,8 @@
 #include "driverlib/sysctl.h"
 #include "driverlib/interrupt.h"
 
+#include "timebase.h"
+#include "event.h"
 #include "ppmdriver.h"
 
 /*--------------------------------- Definitions ------------------------------*/
@@ -68,6 +72,7 @@ VAR_STATIC unsigned long ulCaptureTime;
 VAR_STATIC unsigned long ulLastCapture;
 VAR_STATIC unsigned long ulPulseLength;
 VAR_STATIC signed char cOverflowCount;
+VAR_STATIC unsigned long ulFrameTime;   // Time of last sync pulse [us]
 
 /*--------------------------------- Prototypes -------------------------------*/
 
@@ -111,6 +116,8 @@ PPMCaptureIntHandler(void) {
         case RC_CHANNELS :                                  // LAST RC CHANNEL
             if (( ulPulseLength >= PPM_SYNC_MIN ) &&        // sync pulse detected 
                 ( ulPulseLength <= PPM_SYNC_MAX )) {        // 
+                ulFrameTime = Timebase_Us();                // frame complete
+                Event_Post(EVENT_PPM);
                 ucPulseIndex++;                             // still synchronized 
             } else {                                        // wrong pulse detected 
                 ucPulseIndex = UNSYNC;                      // wait for next sync pulse
@@ -149,30 +156,8 @@ PPMInit(void)
     ucPulseIndex = UNSYNC;
 
     //
-    // Enable Timer 1
+    // Timer 1, free running at the CPU clock, is started by Timebase_Init()
     //
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER1); 
-        
-    //
-    // Halt timer 1
-    //
-    TimerDisable(TIMER1_BASE, TIMER_A);
-
-    //
-    // Initialize Timer 1 
-    //
-    TimerConfigure(TIMER1_BASE, TIMER_CFG_32_BIT_PER |  // one 32 bit timer
-                                TIMER_TAMR_TACDIR);     // timer A counts up
-
-    //
-    // Configure maximum timer period: 0xFFFFFFFF / 50 MHz = 85 s
-    //
-    TimerLoadSet(TIMER1_BASE, TIMER_A, 0xFFFFFFFF);
-
-    //
-    // Start timer 1
-    //
-    TimerEnable(TIMER1_BASE, TIMER_A);
 
     //
     // Disable interrupt on GPIO pin.
@@ -239,3 +224,16 @@ PPMSignalStatus( void ) {
         return PPM_SIGNAL_OK;           // radio signal is OK
     }
 }
+
+//----------------------------------------------------------------------------
+//
+//  DESCRIPTION Returns time of the last complete PPM frame.
+///
+/// \return    Timebase_Us() at the sync pulse that closed the frame
+/// \remarks   -
+///
+///----------------------------------------------------------------------------
+unsigned long
+PPMFrameTime( void ) {
+    return ulFrameTime;
+}
@@ -46,4 +46,5 @@
 void PPMInit( void );
 unsigned long PPMGetChannel( unsigned char ucChannel );
 unsigned char PPMSignalStatus( void );
+unsigned long PPMFrameTime( void );
 
@@ -0,0 +1,206 @@
+//============================================================================+
+//
+// $RCSfile: profile.c,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   Control tick profiler
+///
+/// \file
+/// Min, max, mean and log2 histogram of the time spent in each probe.
+/// Time unit:
+/// - target: CPU cycles, from the DWT cycle counter (20 ns @50 MHz);
+/// - host build: nanoseconds, from clock_gettime(CLOCK_MONOTONIC).
+///
+/// Probes in background tasks include the time spent in foreground tasks
+/// that preempted them; the scheduler statistics (scheduler.c) do not.
+/// A probe costs two counter reads and one Profile_Add(), a few tens of
+/// cycles.
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include "config.h"
+
+#if defined(__ICCARM__)
+#   include <intrinsics.h>
+#   include "inc/hw_types.h"
+#else
+#   include <time.h>
+#endif
+
+#include "profile.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef    VAR_STATIC
+#   undef VAR_STATIC
+#endif
+#define   VAR_STATIC static
+#ifdef    VAR_GLOBAL
+#   undef VAR_GLOBAL
+#endif
+#define   VAR_GLOBAL
+
+#define DEMCR                   0xE000EDFC  // Debug exception and monitor control
+#define DEMCR_TRCENA            0x01000000  // Enable DWT
+#define DWT_CTRL                0xE0001000  // DWT control
+#define DWT_CTRL_CYCCNTENA      0x00000001  // Enable cycle counter
+#define DWT_CYCCNT              0xE0001004  // DWT cycle counter
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+/*---------------------------------- Constants -------------------------------*/
+
+VAR_STATIC const char * const s_pszProbe[PROF_NUMBER] = {
+    "Logic",
+    "MatrixUpdate",
+    "CompensateDrift",
+    "Normalize",
+    "Aileron",
+    "Elevator",
+    "Attitude group",
+    "Guidance group",
+    "ServoUpdate",
+    "Log_Sensors",
+    "Telemetry_Controls",
+    "GPSParse",
+    "ADCUpdate",
+    "Vibe_Run"
+};
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+VAR_STATIC STRUCT_PROFILE s_pstProfile[PROF_NUMBER];
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Initialize profiler
+///
+/// \remarks Starts the DWT cycle counter on target, clears statistics.
+///
+//----------------------------------------------------------------------------
+void
+Profile_Init( void ) {
+#if defined(__ICCARM__)
+    HWREG(DEMCR) |= DEMCR_TRCENA;
+    HWREG(DWT_CYCCNT) = 0;
+    HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+#endif
+    Profile_Clear();
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Read time
+///
+/// \return  cycles on target, ns on host, wraps around
+/// \remarks
+///
+//----------------------------------------------------------------------------
+unsigned long
+Profile_Time( void ) {
+#if defined(__ICCARM__)
+    return HWREG(DWT_CYCCNT);
+#else
+    struct timespec stTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &stTime);
+    return (unsigned long)stTime.tv_sec * 1000000000UL + (unsigned long)stTime.tv_nsec;
+#endif
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Add a sample to a probe
+///
+/// \param   eProbe probe
+/// \param   ulTime time spent in the probe
+/// \remarks
+///
+//----------------------------------------------------------------------------
+void
+Profile_Add( ENUM_PROBE eProbe, unsigned long ulTime ) {
+
+    STRUCT_PROFILE *pstProfile = &s_pstProfile[eProbe];
+    unsigned long ulBin = 0;
+
+    if (ulTime != 0) {
+#if defined(__ICCARM__)
+        ulBin = 31 - __CLZ(ulTime);
+#else
+        ulBin = (sizeof(unsigned long) * 8 - 1) - __builtin_clzl(ulTime);
+#endif
+        if (ulBin >= PROFILE_BINS) {
+            ulBin = PROFILE_BINS - 1;
+        }
+    }
+    pstProfile->pulHist[ulBin]++;
+
+    if ((pstProfile->ulCount == 0) || (ulTime < pstProfile->ulMin)) {
+        pstProfile->ulMin = ulTime;
+    }
+    if (ulTime > pstProfile->ulMax) {
+        pstProfile->ulMax = ulTime;
+    }
+    pstProfile->ullSum += ulTime;
+    pstProfile->ulCount++;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Get probe statistics
+///
+/// \param   eProbe probe
+/// \return  pointer to statistics
+/// \remarks
+///
+//----------------------------------------------------------------------------
+const STRUCT_PROFILE *
+Profile_Get( ENUM_PROBE eProbe ) {
+    return &s_pstProfile[eProbe];
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Get probe name
+///
+/// \param   eProbe probe
+/// \return  name of the profiled function
+/// \remarks
+///
+//----------------------------------------------------------------------------
+const char *
+Profile_Name( ENUM_PROBE eProbe ) {
+    return s_pszProbe[eProbe];
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Clear statistics of all probes
+///
+/// \remarks
+///
+//----------------------------------------------------------------------------
+void
+Profile_Clear( void ) {
+
+    unsigned long i, *pulData;
+
+    for (i = 0; i < PROF_NUMBER; i++) {
+        pulData = (unsigned long *)&s_pstProfile[i];
+        while (pulData < (unsigned long *)&s_pstProfile[i + 1]) {
+            *pulData++ = 0;
+        }
+    }
+}
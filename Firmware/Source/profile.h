@@ -0,0 +1,84 @@
+//============================================================================
+//
+// $RCSfile: profile.h,v $ (HEADER FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   Control tick profiler header file
+///
+/// \file
+/// Probes around the stages of the control tick:
+/// \code
+///     PROFILE(PROF_MATRIX_UPDATE, MatrixUpdate());
+/// \endcode
+/// With PROFILE_PROBES == 0 (config.h) the macro is the bare call.
+///
+//  CHANGES
+//
+//============================================================================
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL extern
+
+#define PROFILE_BINS            24          // log2 histogram bins
+
+/*----------------------------------- Macros ---------------------------------*/
+
+#if (PROFILE_PROBES == 1)
+#   define PROFILE(probe, call) \
+    do { \
+        unsigned long ulProfileStart = Profile_Time(); \
+        call; \
+        Profile_Add((probe), Profile_Time() - ulProfileStart); \
+    } while (0)
+#else
+#   define PROFILE(probe, call) call
+#endif
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+typedef enum {                  // probes
+    PROF_LOGIC,                 // Logic()
+    PROF_MATRIX_UPDATE,         // MatrixUpdate()
+    PROF_COMPENSATE_DRIFT,      // CompensateDrift()
+    PROF_NORMALIZE,             // Normalize()
+    PROF_AILERON,               // Aileron_Control() or Aileron_Damping()
+    PROF_ELEVATOR,              // Elevator_Control() or Elevator_Damping()
+    PROF_ATTITUDE,              // attitude rate group
+    PROF_GUIDANCE,              // guidance rate group
+    PROF_SERVO_UPDATE,          // ServoUpdate()
+    PROF_LOG_SENSORS,           // Log_Sensors()
+    PROF_TELEMETRY_CONTROLS,    // Telemetry_Send_Controls()
+    PROF_GPS,                   // GPSParse()
+    PROF_ADC,                   // ADCUpdate()
+    PROF_VIBE,                  // Vibe_Run()
+    PROF_NUMBER
+} ENUM_PROBE;
+
+/*------------------------------------ Types ---------------------------------*/
+
+typedef struct {                        // probe statistics
+    unsigned long ulCount;              // number of samples
+    unsigned long ulMin;                // min time
+    unsigned long ulMax;                // max time
+    unsigned long long ullSum;          // sum of times, for the mean
+    unsigned long pulHist[PROFILE_BINS];// bin n: 2^n <= time < 2^(n + 1)
+} STRUCT_PROFILE;
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*----------------------------------- Globals --------------------------------*/
+
+/*---------------------------------- Interface -------------------------------*/
+
+void Profile_Init( void );
+unsigned long Profile_Time( void );
+void Profile_Add( ENUM_PROBE eProbe, unsigned long ulTime );
+const STRUCT_PROFILE *Profile_Get( ENUM_PROBE eProbe );
+const char *Profile_Name( ENUM_PROBE eProbe );
+void Profile_Clear( void );
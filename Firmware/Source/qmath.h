@@ -0,0 +1,127 @@
+//============================================================================
+//
+// $RCSfile: qmath.h,v $ (HEADER FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief Fixed point vector algebra
+///
+/// \file
+/// Fixed point counterpart of vmath.cpp. Values are 32 bit signed integers
+/// with an implicit binary point: a Qn value x represents x / 2^n.
+/// Products are computed on 64 bits (one SMULL on Cortex-M3) and rounded to
+/// nearest. Unless stated otherwise the second operand is Q30, so that the
+/// result keeps the format of the first operand.
+///
+/// The functions are inline so that the compiler can unroll the 3 element
+/// loops, as the call overhead would exceed the arithmetic.
+///
+//  CHANGES
+//
+//============================================================================
+
+#ifndef __QMATH_H__
+#define __QMATH_H__
+
+#include <stdint.h>
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#define Q30_ONE     (1L << 30)          ///< 1.0 in Q30
+
+/*----------------------------------- Macros ---------------------------------*/
+
+//! Convert a float constant to Qn
+#define FLOAT2Q(x, n)   ((int32_t)((x) * (float)(1LL << (n)) + (((x) >= 0.0f) ? 0.5f : -0.5f)))
+
+//! Convert a Qn value to float
+#define Q2FLOAT(x, n)   ((float)(x) * (1.0f / (float)(1LL << (n))))
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*---------------------------------- Interface -------------------------------*/
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Multiply two fixed point values
+/// \return  (a * b) / 2^shift, rounded
+/// \remarks
+///
+///----------------------------------------------------------------------------
+static inline int32_t
+QMul(int32_t a, int32_t b, int shift)
+{
+    return (int32_t)((((int64_t)a * b) + (1LL << (shift - 1))) >> shift);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Dot product
+/// \return  a . b in the format of a (b is Q30)
+/// \remarks Products are summed on 64 bits before rounding
+///
+///----------------------------------------------------------------------------
+static inline int32_t
+QVectorDotProduct(const int32_t a[3], const int32_t b[3])
+{
+    int64_t sum;
+
+    sum  = (int64_t)a[0] * b[0];
+    sum += (int64_t)a[1] * b[1];
+    sum += (int64_t)a[2] * b[2];
+    return (int32_t)((sum + (1LL << 29)) >> 30);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Cross product
+/// \return  -
+/// \remarks r = a /\ b in the format of a (b is Q30). r must not alias a, b
+///
+///----------------------------------------------------------------------------
+static inline void
+QVectorCrossProduct(int32_t r[3], const int32_t a[3], const int32_t b[3])
+{
+    r[0] = (int32_t)(((int64_t)a[1] * b[2] - (int64_t)a[2] * b[1] + (1LL << 29)) >> 30);
+    r[1] = (int32_t)(((int64_t)a[2] * b[0] - (int64_t)a[0] * b[2] + (1LL << 29)) >> 30);
+    r[2] = (int32_t)(((int64_t)a[0] * b[1] - (int64_t)a[1] * b[0] + (1LL << 29)) >> 30);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Multiply the vector by a scalar
+/// \return  -
+/// \remarks r = (v * s) / 2^shift
+///
+///----------------------------------------------------------------------------
+static inline void
+QVectorScale(int32_t r[3], const int32_t v[3], int32_t s, int shift)
+{
+    r[0] = QMul(v[0], s, shift);
+    r[1] = QMul(v[1], s, shift);
+    r[2] = QMul(v[2], s, shift);
+}
+
+///----------------------------------------------------------------------------
+///
+/// \brief   Add two vectors
+/// \return  -
+/// \remarks a, b and r have the same format
+///
+///----------------------------------------------------------------------------
+static inline void
+QVectorAdd(int32_t r[3], const int32_t a[3], const int32_t b[3])
+{
+    r[0] = a[0] + b[0];
+    r[1] = a[1] + b[1];
+    r[2] = a[2] + b[2];
+}
+
+#endif // __QMATH_H__
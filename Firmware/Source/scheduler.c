@@ -0,0 +1,504 @@
+//============================================================================+
+//
+// $RCSfile: scheduler.c,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   Rate monotonic task scheduler
+///
+/// \file
+/// Static task table with period, priority, budget and deadline of each task.
+/// Periods are given in milliseconds, or as SCHED_LOOP for the tasks that
+/// follow the control loop rate, and converted to system ticks by
+/// Sched_Init() with the timing chosen at boot (timing.c).
+/// Two levels of execution:
+/// - foreground tasks (estimator, servo output) run from the PendSV
+///   exception, at the lowest interrupt priority: they preempt background
+///   tasks as soon as they are released by the system tick;
+/// - background tasks (logging, telemetry, navigation) run from the main
+///   loop through Sched_Run(), one at a time, when no foreground task is
+///   ready.
+///
+/// Background tasks with usPeriod = 0 are released by events (event.c)
+/// instead of the tick: UART input, ADC sequence, PPM frame. Events posted
+/// again before the task runs are merged into one release. When no
+/// background task is ready the main loop sleeps in Event_Wait() until an
+/// interrupt posts an event; Sched_Tick() posts EVENT_TICK when it releases
+/// a periodic background task.
+///
+/// Inside each level the ready task with the highest priority runs first.
+/// Tasks in the same level do not preempt each other.
+///
+/// Times are measured with the SysTick counter, at CPU clock resolution, and
+/// kept in microseconds in a STRUCT_TASK_STATS for each task:
+/// - release jitter: start time - release time;
+/// - execution time: end time - start time, less the time spent in
+///   foreground tasks for background ones;
+/// - response time: end time - release time, compared with the deadline.
+///
+/// Load shedding (SHED_POLICY == SHED_LEVELS, config.h): every SHED_WINDOW
+/// ms, if a task that is not shed has missed a deadline or skipped a
+/// release, the shed level goes up by one; after SHED_RECOVERY windows
+/// without faults it goes down by one. Tasks with 0 < ucShed <= shed level
+/// are not released. The table in main.c drops logging first, then
+/// telemetry, then navigation; foreground tasks are never shed.
+///
+/// Background tasks that share data with foreground ones must read it
+/// between Sched_Lock() and Sched_Unlock().
+///
+/// Both levels use the same stack: its size must allow for the deepest
+/// background call chain plus the deepest foreground one.
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include "inc/hw_ints.h"
+#include "inc/hw_types.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/systick.h"
+#include "driverlib/interrupt.h"
+
+#include "config.h"
+#include "scheduler.h"
+#include "timing.h"
+#include "event.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef    VAR_STATIC
+#   undef VAR_STATIC
+#endif
+#define   VAR_STATIC static
+#ifdef    VAR_GLOBAL
+#   undef VAR_GLOBAL
+#endif
+#define   VAR_GLOBAL
+
+//! Priorita' di PendSV: la piu' bassa, 3 bit di priorita' su LM3S
+#define SCHED_PENDSV_PRIORITY   0xE0
+
+/*----------------------------------- Macros ---------------------------------*/
+
+//
+// Task dropped by load shedding
+//
+#define SCHED_IS_SHED(i)    ((m_pstTable[i].ucShed != 0) && \
+                             (m_pstTable[i].ucShed <= m_ucShedLevel))
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+VAR_STATIC const STRUCT_TASK *m_pstTable;               // task table
+VAR_STATIC unsigned char m_ucTasks = 0;                 // number of tasks
+VAR_STATIC STRUCT_TASK_STATS m_stStats[SCHED_MAX_TASKS];// task statistics
+VAR_STATIC unsigned long m_ulRelease[SCHED_MAX_TASKS];  // release time [cycles]
+VAR_STATIC unsigned short m_usTicks[SCHED_MAX_TASKS];   // period [ticks]
+VAR_STATIC unsigned long m_ulDeadline[SCHED_MAX_TASKS]; // deadline [us]
+VAR_STATIC volatile unsigned long m_ulReady = 0;        // one bit per ready task
+VAR_STATIC volatile unsigned long m_ulTicks = 0;        // system ticks
+VAR_STATIC volatile unsigned long m_ulForeground = 0;   // cycles in foreground
+VAR_STATIC unsigned long m_ulPeriod = 1;                // cycles per tick
+VAR_STATIC unsigned long m_ulCyclesUs = 1;              // cycles per us
+VAR_STATIC unsigned long m_ulStart[SCHED_MAX_TASKS];    // last start [cycles]
+VAR_STATIC volatile unsigned long m_ulFaults = 0;       // faults in window
+VAR_STATIC unsigned long m_ulShedWindow = 1;            // shed window [ticks]
+VAR_STATIC unsigned char m_ucShedLevel = 0;             // shed level
+VAR_STATIC unsigned char m_ucShedMax = 0;               // highest shed level
+VAR_STATIC unsigned char m_ucClean = 0;                 // windows without faults
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+static unsigned char Sched_Dispatch( ENUM_SCHED_MODE eMode );
+static void Sched_Execute( unsigned char ucTask );
+#if (SHED_POLICY == SHED_LEVELS)
+static void Sched_Shed( void );
+#endif
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Initialize scheduler
+///
+/// \param   pstTable pointer to task table
+/// \param   ucTasks number of tasks, up to SCHED_MAX_TASKS
+/// \remarks Call after Timing_Init() and TickInit(): the tick period is
+///          read from SysTick.
+///          Tasks with usPeriod = 0 must be background tasks, released by
+///          ulEvents.
+///
+//----------------------------------------------------------------------------
+void
+Sched_Init( const STRUCT_TASK *pstTable, unsigned char ucTasks ) {
+
+    unsigned char i;
+
+    if (ucTasks > SCHED_MAX_TASKS) {
+        ucTasks = SCHED_MAX_TASKS;
+    }
+    m_pstTable = pstTable;
+    m_ulPeriod = SysTickPeriodGet();
+    m_ulCyclesUs = SysCtlClockGet() / 1000000;
+    Sched_ClearStats();
+    m_ulReady = 0;
+    m_ucShedLevel = 0;
+    m_ucShedMax = 0;
+    m_ulShedWindow = Timing_Ticks(SHED_WINDOW);
+    for (i = 0; i < ucTasks; i++) {
+        if (pstTable[i].usPeriod == 0) {
+            m_usTicks[i] = 0;
+        } else if (pstTable[i].usPeriod == SCHED_LOOP) {
+            m_usTicks[i] = Timing_Get()->uiTicksPerLoop;
+        } else {
+            m_usTicks[i] = Timing_Ticks(pstTable[i].usPeriod);
+        }
+        if ((pstTable[i].ulDeadline == 0) && (m_usTicks[i] != 0)) {
+            m_ulDeadline[i] = (m_usTicks[i] * 1000000UL) /
+                              Timing_Get()->uiTickHz;
+        } else {
+            m_ulDeadline[i] = pstTable[i].ulDeadline;
+        }
+        if (pstTable[i].ucShed > m_ucShedMax) {
+            m_ucShedMax = pstTable[i].ucShed;
+        }
+    }
+    m_ucTasks = ucTasks;
+
+    //
+    // PendSV at the lowest priority: preempted by any interrupt, preempts
+    // the main loop only.
+    //
+    IntPrioritySet(FAULT_PENDSV, SCHED_PENDSV_PRIORITY);
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Release periodic tasks
+///
+/// \remarks Called by SysTickIntHandler() at every tick.
+///          A task still ready from the previous release is not released
+///          again: the release is counted as skipped. A task dropped by
+///          load shedding is not released: the release is counted as shed.
+///
+//----------------------------------------------------------------------------
+void
+Sched_Tick( void ) {
+
+    unsigned char i;
+    unsigned long ulNow;
+    tBoolean bForeground = false;
+    tBoolean bBackground = false;
+
+    m_ulTicks++;
+    ulNow = m_ulTicks * m_ulPeriod;
+
+    for (i = 0; i < m_ucTasks; i++) {
+        if ((m_usTicks[i] != 0) && ((m_ulTicks % m_usTicks[i]) == 0)) {
+            m_stStats[i].ulReleases++;
+            if (SCHED_IS_SHED(i)) {
+                m_stStats[i].ulShed++;
+                continue;
+            }
+            if (HWREGBITW(&m_ulReady, i)) {
+                m_stStats[i].ulSkipped++;
+                m_ulFaults++;
+            } else {
+                m_ulRelease[i] = ulNow;
+                HWREGBITW(&m_ulReady, i) = 1;
+            }
+            if (m_pstTable[i].eMode == SCHED_FOREGROUND) {
+                bForeground = true;
+            } else {
+                bBackground = true;
+            }
+        }
+    }
+
+#if (SHED_POLICY == SHED_LEVELS)
+    if ((m_ulTicks % m_ulShedWindow) == 0) {
+        Sched_Shed();
+    }
+#endif
+
+    if (bForeground) {
+        IntPendSet(FAULT_PENDSV);
+    }
+    if (bBackground) {
+        Event_Post(EVENT_TICK);
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Run one background task
+///
+/// \remarks Called by the main loop. Releases the tasks with usPeriod = 0
+///          whose events were posted and that are not shed, then runs the
+///          ready background task with the highest priority. If none is
+///          ready, sleeps until the next event.
+///
+//----------------------------------------------------------------------------
+void
+Sched_Run( void ) {
+
+    unsigned char i;
+    unsigned long ulNow = Sched_Now();
+    unsigned long ulEvents = Event_Take();
+
+    for (i = 0; i < m_ucTasks; i++) {
+        if ((m_usTicks[i] == 0) && ((m_pstTable[i].ulEvents & ulEvents) != 0) &&
+            !HWREGBITW(&m_ulReady, i) && !SCHED_IS_SHED(i)) {
+            m_stStats[i].ulReleases++;
+            m_ulRelease[i] = ulNow;
+            HWREGBITW(&m_ulReady, i) = 1;
+        }
+    }
+
+    i = Sched_Dispatch(SCHED_BACKGROUND);
+    if (i != SCHED_NONE) {
+        Sched_Execute(i);
+    } else {
+        Event_Wait();
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   PendSV handler: run foreground tasks
+///
+/// \remarks Runs the ready foreground tasks in priority order, until none
+///          is ready.
+///
+//----------------------------------------------------------------------------
+void
+SchedPendSVHandler( void ) {
+
+    unsigned char i;
+    unsigned long ulStart = Sched_Now();
+
+    while ((i = Sched_Dispatch(SCHED_FOREGROUND)) != SCHED_NONE) {
+        Sched_Execute(i);
+    }
+    m_ulForeground += Sched_Now() - ulStart;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Prevent foreground tasks from running
+///
+/// \remarks Masks PendSV only, other interrupts are still served. Keep the
+///          locked section short: it delays the foreground tasks. Does not
+///          nest.
+///
+//----------------------------------------------------------------------------
+void
+Sched_Lock( void ) {
+    IntPriorityMaskSet(SCHED_PENDSV_PRIORITY);
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Allow foreground tasks to run
+///
+/// \remarks A foreground task released while locked runs here.
+///
+//----------------------------------------------------------------------------
+void
+Sched_Unlock( void ) {
+    IntPriorityMaskSet(0);
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Time
+///
+/// \return  time [CPU cycles], wraps around every 2^32 cycles
+/// \remarks Tick count plus SysTick counter. Not for use at the SysTick
+///          interrupt priority, where the tick count may lag the counter.
+///
+//----------------------------------------------------------------------------
+unsigned long
+Sched_Now( void ) {
+
+    unsigned long ulTicks, ulCount;
+
+    do {
+        ulTicks = m_ulTicks;
+        ulCount = SysTickValueGet();
+    } while (ulTicks != m_ulTicks);
+
+    return (ulTicks * m_ulPeriod) + (m_ulPeriod - 1 - ulCount);
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Get task statistics
+///
+/// \param   ucTask index of the task in the table
+/// \return  pointer to statistics, NULL if the index is out of range
+/// \remarks
+///
+//----------------------------------------------------------------------------
+const STRUCT_TASK_STATS *
+Sched_GetStats( unsigned char ucTask ) {
+
+    if (ucTask >= m_ucTasks) {
+        return (const STRUCT_TASK_STATS *)0;
+    }
+    return &m_stStats[ucTask];
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Get shed level
+///
+/// \return  0 = no task shed, up to the highest ucShed of the table
+/// \remarks
+///
+//----------------------------------------------------------------------------
+unsigned char
+Sched_ShedLevel( void ) {
+    return m_ucShedLevel;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Clear statistics of all tasks
+///
+/// \remarks
+///
+//----------------------------------------------------------------------------
+void
+Sched_ClearStats( void ) {
+
+    unsigned char i;
+    unsigned long *pulData;
+    tBoolean bMasked;
+
+    bMasked = IntMasterDisable();
+    for (i = 0; i < SCHED_MAX_TASKS; i++) {
+        pulData = (unsigned long *)&m_stStats[i];
+        while (pulData < (unsigned long *)&m_stStats[i + 1]) {
+            *pulData++ = 0;
+        }
+    }
+    if (!bMasked) {
+        IntMasterEnable();
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Find the ready task with the highest priority
+///
+/// \param   eMode foreground or background
+/// \return  index of the task, SCHED_NONE if no task is ready
+/// \remarks
+///
+//----------------------------------------------------------------------------
+static unsigned char
+Sched_Dispatch( ENUM_SCHED_MODE eMode ) {
+
+    unsigned char i, ucTask = SCHED_NONE;
+
+    for (i = 0; i < m_ucTasks; i++) {
+        if (HWREGBITW(&m_ulReady, i) && (m_pstTable[i].eMode == eMode)) {
+            if ((ucTask == SCHED_NONE) ||
+                (m_pstTable[i].ucPriority < m_pstTable[ucTask].ucPriority)) {
+                ucTask = i;
+            }
+        }
+    }
+    return ucTask;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Run a task and update its statistics
+///
+/// \param   ucTask index of the task
+/// \remarks The ready bit is cleared before running the task, so that a
+///          release during the run is not lost.
+///
+//----------------------------------------------------------------------------
+static void
+Sched_Execute( unsigned char ucTask ) {
+
+    const STRUCT_TASK *pstTask = &m_pstTable[ucTask];
+    STRUCT_TASK_STATS *pstStats = &m_stStats[ucTask];
+    unsigned long ulRelease, ulStart, ulEnd, ulForeground;
+    unsigned long ulJitter, ulExec, ulResponse;
+
+    ulRelease = m_ulRelease[ucTask];            // read before clearing
+    HWREGBITW(&m_ulReady, ucTask) = 0;
+
+    ulForeground = m_ulForeground;
+    ulStart = Sched_Now();
+    if (pstStats->ulRuns == 0) {
+        pstStats->ulInterval = (m_usTicks[ucTask] * m_ulPeriod) / m_ulCyclesUs;
+    } else {
+        pstStats->ulInterval = (ulStart - m_ulStart[ucTask]) / m_ulCyclesUs;
+    }
+    m_ulStart[ucTask] = ulStart;
+    pstTask->pfnTask();
+    ulEnd = Sched_Now();
+    ulForeground = m_ulForeground - ulForeground;
+
+    ulJitter = (ulStart - ulRelease) / m_ulCyclesUs;
+    ulExec = (ulEnd - ulStart - ulForeground) / m_ulCyclesUs;
+    ulResponse = (ulEnd - ulRelease) / m_ulCyclesUs;
+
+    pstStats->ulRuns++;
+    pstStats->ulJitter = ulJitter;
+    if (ulJitter > pstStats->ulJitterMax) {
+        pstStats->ulJitterMax = ulJitter;
+    }
+    pstStats->ulExec = ulExec;
+    if (ulExec > pstStats->ulExecMax) {
+        pstStats->ulExecMax = ulExec;
+    }
+    if (ulResponse > pstStats->ulResponseMax) {
+        pstStats->ulResponseMax = ulResponse;
+    }
+    if ((pstTask->ulBudget != 0) && (ulExec > pstTask->ulBudget)) {
+        pstStats->ulOverruns++;
+    }
+    if ((m_ulDeadline[ucTask] != 0) && (ulResponse > m_ulDeadline[ucTask])) {
+        pstStats->ulMisses++;
+        m_ulFaults++;
+    }
+}
+
+#if (SHED_POLICY == SHED_LEVELS)
+//----------------------------------------------------------------------------
+//
+/// \brief   Update shed level
+///
+/// \remarks Called by Sched_Tick() at the end of each SHED_WINDOW.
+///
+//----------------------------------------------------------------------------
+static void
+Sched_Shed( void ) {
+
+    if (m_ulFaults != 0) {
+        if (m_ucShedLevel < m_ucShedMax) {
+            m_ucShedLevel++;
+        }
+        m_ucClean = 0;
+    } else if (m_ucShedLevel > 0) {
+        m_ucClean++;
+        if (m_ucClean >= SHED_RECOVERY) {
+            m_ucShedLevel--;
+            m_ucClean = 0;
+        }
+    }
+    m_ulFaults = 0;
+}
+#endif
@@ -0,0 +1,83 @@
+//============================================================================
+//
+// $RCSfile: scheduler.h,v $ (HEADER FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   Rate monotonic task scheduler header file
+///
+/// \file
+///
+//  CHANGES
+//
+//============================================================================
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL extern
+
+#define SCHED_MAX_TASKS         12          // Max number of tasks in the table
+#define SCHED_NONE              0xFF        // No task ready
+#define SCHED_LOOP              0xFFFF      // Period of the control loop
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+typedef enum {          // task mode
+    SCHED_FOREGROUND,   // run from PendSV, preempts background tasks
+    SCHED_BACKGROUND    // run from Sched_Run(), deferred to foreground tasks
+} ENUM_SCHED_MODE;
+
+/*------------------------------------ Types ---------------------------------*/
+
+typedef struct {                    // task table entry
+    void (*pfnTask)(void);          // task function
+    const char *pcName;             // task name
+    unsigned short usPeriod;        // period [ms], SCHED_LOOP = control loop,
+                                    // 0 = released by ulEvents
+    unsigned char ucPriority;       // priority, 0 = highest
+    ENUM_SCHED_MODE eMode;          // foreground or background
+    unsigned char ucShed;           // shed level that drops the task, 0 = never
+    unsigned long ulBudget;         // max execution time [us]
+    unsigned long ulDeadline;       // max response time from release [us],
+                                    // 0 = end of period
+    unsigned long ulEvents;         // EVENT_xxx that release the task, with
+                                    // usPeriod = 0 only
+} STRUCT_TASK;
+
+typedef struct {                    // task statistics
+    unsigned long ulReleases;       // number of releases
+    unsigned long ulRuns;           // number of completed runs
+    unsigned long ulMisses;         // response time > deadline
+    unsigned long ulSkipped;        // released again before running
+    unsigned long ulOverruns;       // execution time > budget
+    unsigned long ulShed;           // releases dropped by load shedding
+    unsigned long ulInterval;       // time since the previous start [us]
+    unsigned long ulJitter;         // last release jitter [us]
+    unsigned long ulJitterMax;      // max release jitter [us]
+    unsigned long ulExec;           // last execution time [us]
+    unsigned long ulExecMax;        // max execution time [us]
+    unsigned long ulResponseMax;    // max response time [us]
+} STRUCT_TASK_STATS;
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*----------------------------------- Globals --------------------------------*/
+
+/*---------------------------------- Interface -------------------------------*/
+
+void Sched_Init( const STRUCT_TASK *pstTable, unsigned char ucTasks );
+void Sched_Tick( void );
+void Sched_Run( void );
+void Sched_Lock( void );
+void Sched_Unlock( void );
+unsigned long Sched_Now( void );
+const STRUCT_TASK_STATS *Sched_GetStats( unsigned char ucTask );
+unsigned char Sched_ShedLevel( void );
+void Sched_ClearStats( void );
+void SchedPendSVHandler( void );
@@ -0,0 +1,275 @@
+//============================================================================+
+//
+// $RCSfile: sensor.c,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   Sensor backends
+///
+/// \file
+/// Single source of the accelerometer and gyro samples read by the attitude
+/// estimators (MatrixUpdate(), DCM_GetInput()) and by the sensor log. A
+/// backend delivers timestamped 6-axis samples, offset and sign corrected,
+/// in its own steps, in batches: every sample acquired since the last read.
+/// Backends:
+/// - "adc": analog sensors on the LM3S ADC (adcdriver.c);
+/// - "mpu6050": MPU-6050 FIFO, InvenSense driver (mpu6050.c);
+/// - "sim": simulator data received by Telemetry_Parse() (Telemetry.cpp);
+/// - "replay": logged samples fed by the host tools (hostdriver.cpp).
+///
+/// main.c passes the backends of the build to Sensor_Init(), then selects
+/// one at boot by the name in sensor.txt on the SD card (Log_ReadSensor()),
+/// without recompiling; if it is missing or does not start, the first of
+/// the table that starts is used. Selecting a backend sets Accel_Gain,
+/// Gyro_Gain and Sensor_Gravity to its scale factors: the estimators keep
+/// working in steps, with the gains they already tune.
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include <string.h>
+
+#include "inc/hw_types.h"
+
+#include "config.h"
+#include "DCM.h"
+#include "sensor.h"
+#include "timing.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef    VAR_STATIC
+#   undef VAR_STATIC
+#endif
+#define   VAR_STATIC static
+#ifdef    VAR_GLOBAL
+#   undef VAR_GLOBAL
+#endif
+#define   VAR_GLOBAL
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+VAR_GLOBAL float Sensor_Gravity = GRAVITY;              // 1 g [steps]
+
+/*----------------------------------- Locals ---------------------------------*/
+
+VAR_STATIC const STRUCT_SENSOR_BACKEND * const *m_ppstTable = 0;  // Backends
+VAR_STATIC unsigned char m_ucBackends = 0;              // Backends in table
+VAR_STATIC unsigned char m_ucSelected = SENSOR_MAX;     // Selected backend
+VAR_STATIC STRUCT_SENSOR_SAMPLE m_stLast;               // Last sample read
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+static tBoolean Sensor_Start( unsigned char ucBackend );
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Initialize sensor backends
+///
+/// \param   ppstTable backends of the build, the first is the default
+/// \param   ucBackends number of backends, at most SENSOR_MAX
+/// \remarks No backend is selected until Sensor_Select().
+///
+//----------------------------------------------------------------------------
+void
+Sensor_Init( const STRUCT_SENSOR_BACKEND * const *ppstTable,
+             unsigned char ucBackends ) {
+
+    if (ucBackends > SENSOR_MAX) {
+        ucBackends = SENSOR_MAX;
+    }
+    m_ppstTable = ppstTable;
+    m_ucBackends = ucBackends;
+    m_ucSelected = SENSOR_MAX;
+    memset(&m_stLast, 0, sizeof(m_stLast));
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Select sensor backend
+///
+/// \param   pcName backend name, 0 for the default
+/// \return  true if the named backend has started
+/// \remarks If the named backend is missing or fails to start, the first
+///          of the table that starts is selected. Sets Accel_Gain,
+///          Gyro_Gain and Sensor_Gravity.
+///
+//----------------------------------------------------------------------------
+tBoolean
+Sensor_Select( const char *pcName ) {
+
+    unsigned char i;
+
+    if (pcName != 0) {
+        for (i = 0; i < m_ucBackends; i++) {
+            if (strcmp(m_ppstTable[i]->pcName, pcName) == 0) {
+                if (Sensor_Start(i)) {
+                    return true;
+                }
+                break;
+            }
+        }
+    }
+    for (i = 0; i < m_ucBackends; i++) {
+        if (Sensor_Start(i)) {
+            break;
+        }
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Get selected sensor backend
+///
+/// \return  pointer to backend, 0 if none is selected
+/// \remarks
+///
+//----------------------------------------------------------------------------
+const STRUCT_SENSOR_BACKEND *
+Sensor_Get( void ) {
+
+    if (m_ucSelected < m_ucBackends) {
+        return m_ppstTable[m_ucSelected];
+    } else {
+        return 0;
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Get index of selected sensor backend
+///
+/// \return  index in the table given to Sensor_Init(), SENSOR_MAX if none
+/// \remarks Saved with the sensor calibration, see Calib_Save().
+///
+//----------------------------------------------------------------------------
+unsigned char
+Sensor_Id( void ) {
+
+    return m_ucSelected;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Wait sensor input settling
+///
+/// \return  true when the offsets have been taken
+/// \remarks Call until true, after Sensor_Select().
+///
+//----------------------------------------------------------------------------
+tBoolean
+Sensor_Settled( void ) {
+
+    if (m_ucSelected >= m_ucBackends) {
+        return false;
+    }
+    return m_ppstTable[m_ucSelected]->pfnSettled();
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Read sensor samples
+///
+/// \param   pstBatch samples acquired since the last read, oldest first
+/// \return  number of samples, may be 0
+/// \remarks The last one is kept for Sensor_Last(). bSubsteps is set only
+///          with GYRO_SUBSTEPS > 1: otherwise the estimators use the last
+///          sample.
+///
+//----------------------------------------------------------------------------
+unsigned int
+Sensor_Read( STRUCT_SENSOR_BATCH *pstBatch ) {
+
+    const STRUCT_SENSOR_BACKEND *pstBackend = Sensor_Get();
+
+    pstBatch->uiCount = 0;
+    pstBatch->uiSubsteps = 1;
+    pstBatch->ulPeriod = 1000000UL / Timing_Get()->uiLoopHz;
+    pstBatch->bSubsteps = false;
+    if (pstBackend != 0) {
+        pstBatch->uiCount = pstBackend->pfnRead(pstBatch);
+        pstBatch->bSubsteps = (GYRO_SUBSTEPS > 1) && pstBackend->bSubsteps;
+    }
+    if (pstBatch->uiCount != 0) {
+        m_stLast = pstBatch->pstSample[pstBatch->uiCount - 1];
+    }
+    return pstBatch->uiCount;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Get last sensor sample
+///
+/// \return  pointer to the last sample read by Sensor_Read()
+/// \remarks Held when a read returns no samples.
+///
+//----------------------------------------------------------------------------
+const STRUCT_SENSOR_SAMPLE *
+Sensor_Last( void ) {
+
+    return &m_stLast;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Gyro samples of a batch, integer
+///
+/// \param   pstBatch samples
+/// \param   plSample gyro x, y, z of each sample [steps], as ConingSum()
+///          wants them
+/// \return  number of samples
+/// \remarks For backends with bSubsteps. Rounded to the nearest step: the
+///          "mpu6050" samples have the fractional gyro offset subtracted,
+///          and truncation would bias them toward zero.
+///
+//----------------------------------------------------------------------------
+int
+Sensor_GyroSteps( const STRUCT_SENSOR_BATCH *pstBatch, long plSample[][3] ) {
+
+    unsigned int n;
+    int c;
+    float f;
+
+    for (n = 0; n < pstBatch->uiCount; n++) {
+        for (c = 0; c < 3; c++) {
+            f = pstBatch->pstSample[n].pfGyro[c];
+            plSample[n][c] = (long)((f < 0.0f) ? (f - 0.5f) : (f + 0.5f));
+        }
+    }
+    return (int)pstBatch->uiCount;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Start a sensor backend
+///
+/// \param   ucBackend index in the table
+/// \return  true if the backend has started and is now selected
+/// \remarks
+///
+//----------------------------------------------------------------------------
+static tBoolean
+Sensor_Start( unsigned char ucBackend ) {
+
+    const STRUCT_SENSOR_BACKEND *pstBackend = m_ppstTable[ucBackend];
+
+    if (!pstBackend->pfnInit()) {
+        return false;
+    }
+    m_ucSelected = ucBackend;
+    Accel_Gain = pstBackend->fAccelGain;
+    Gyro_Gain = pstBackend->fGyroGain;
+    Sensor_Gravity = pstBackend->fGravity;
+    return true;
+}
@@ -0,0 +1,80 @@
+//============================================================================
+//
+// $RCSfile: sensor.h,v $ (HEADER FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   Sensor backends header file
+///
+/// \file
+///
+//  CHANGES
+//
+//============================================================================
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL extern
+
+#define SENSOR_BATCH        (2 * GYRO_SUBSTEPS) // max samples per read
+#define SENSOR_MAX          4                   // max backends in the table
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*------------------------------------ Types ---------------------------------*/
+
+typedef struct {                    // 6-axis sample
+    unsigned long ulTime;           // acquisition time, Timebase_Us() [us]
+    float pfAccel[3];               // accel x, y, z [steps]
+    float pfGyro[3];                // gyro x, y, z [steps]
+} STRUCT_SENSOR_SAMPLE;
+
+typedef struct {                    // samples acquired since the last read
+    unsigned int uiCount;           // samples in pstSample, oldest first
+    unsigned int uiSubsteps;        // nominal samples per control loop
+    unsigned long ulPeriod;         // sample period [us]
+    tBoolean bSubsteps;             // gyro samples to be integrated with
+                                    // coning, see STRUCT_SENSOR_BACKEND
+    STRUCT_SENSOR_SAMPLE pstSample[SENSOR_BATCH];
+} STRUCT_SENSOR_BATCH;
+
+typedef struct {                    // sensor backend
+    const char *pcName;             // name, as in sensor.txt
+    float fAccelGain;               // accel scale factor [m/s/s per step]
+    float fGyroGain;                // gyro scale factor [rad/s per step]
+    float fGravity;                 // 1 g [accel steps]
+    tBoolean bSubsteps;             // gyro samples to be integrated with
+                                    // coning (GYRO_SUBSTEPS > 1)
+    tBoolean (*pfnInit)(void);      // start, false if the sensor is missing
+    tBoolean (*pfnSettled)(void);   // offsets taken, called until true
+    unsigned int (*pfnRead)(STRUCT_SENSOR_BATCH *pstBatch); // new samples
+} STRUCT_SENSOR_BACKEND;
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*----------------------------------- Globals --------------------------------*/
+
+VAR_GLOBAL float Sensor_Gravity;    // 1 g of the selected backend [steps]
+
+extern const STRUCT_SENSOR_BACKEND g_stSensorAdc;      // adcdriver.c
+extern const STRUCT_SENSOR_BACKEND g_stSensorMpu;      // mpu6050.c
+extern const STRUCT_SENSOR_BACKEND g_stSensorSim;      // Telemetry.cpp
+extern const STRUCT_SENSOR_BACKEND g_stSensorReplay;   // hostdriver.cpp
+
+/*---------------------------------- Interface -------------------------------*/
+
+void Sensor_Init( const STRUCT_SENSOR_BACKEND * const *ppstTable,
+                  unsigned char ucBackends );
+tBoolean Sensor_Select( const char *pcName );
+const STRUCT_SENSOR_BACKEND *Sensor_Get( void );
+unsigned char Sensor_Id( void );
+tBoolean Sensor_Settled( void );
+unsigned int Sensor_Read( STRUCT_SENSOR_BATCH *pstBatch );
+const STRUCT_SENSOR_SAMPLE *Sensor_Last( void );
+int Sensor_GyroSteps( const STRUCT_SENSOR_BATCH *pstBatch, long plSample[][3] );
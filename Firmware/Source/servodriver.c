@@ -14,6 +14,7 @@
 //============================================================================*/
 
 #include "math.h"
+#include "fastmath.h"
 #include "inc/lm3s9b90.h"
 #include "inc/hw_ints.h"
 #include "inc/hw_types.h"
@@ -24,7 +25,7 @@
 #include "driverlib/interrupt.h"
 
 #include "AileronCtrl.h"
-#include "ElevatorCtrl.h"
+#include "elevatorctrl.h"
 #include "RudderCtrl.h"
 #include "ppmdriver.h"
 #include "servodriver.h"
@@ -256,7 +257,7 @@ ServoUpdate(void) {
 #if defined(PART_LM3S9B90)
 
     long lPosition;
-    lPosition = (long)ceil(Elevator() * fElevatorGain);
+    lPosition = FastCeil(Elevator() * fElevatorGain);
     lPosition += SERVO_NEUTRAL;
     if (lPosition < SERVO_MIN) { lPosition = SERVO_MIN; }
     if (lPosition > SERVO_MAX) { lPosition = SERVO_MAX; }
@@ -269,7 +270,7 @@ ServoUpdate(void) {
     lPositionA = (ulFrequency * lPosition) / 1000;
     IntMasterEnable();
     
-    lPosition = (long)ceil(Ailerons() * fAileronGain);
+    lPosition = FastCeil(Ailerons() * fAileronGain);
     lPosition += SERVO_NEUTRAL;
     if (lPosition < SERVO_MIN) { lPosition = SERVO_MIN; }
     if (lPosition > SERVO_MAX) { lPosition = SERVO_MAX; }
@@ -282,7 +283,7 @@ ServoUpdate(void) {
     lPositionB = (ulFrequency * lPosition) / 1000;
     IntMasterEnable();
 /*
-    lPosition = (long)ceil(Rudder() * fRudderGain);
+    lPosition = FastCeil(Rudder() * fRudderGain);
     lPosition += SERVO_NEUTRAL;
     if (lPosition < SERVO_MIN) { lPosition = SERVO_MIN; }
     if (lPosition > SERVO_MAX) { lPosition = SERVO_MAX; }
@@ -38,8 +38,10 @@ static void IntDefaultHandler( void );
 //*****************************************************************************
 extern void UART0IntHandler( void );
 extern void ADCS0IntHandler( void );
+extern void I2CIntHandler( void );
 extern void UART1IntHandler( void );
 extern void SysTickIntHandler( void );
+extern void SchedPendSVHandler( void );
 extern void PPMCaptureIntHandler( void );
 extern void ServoIntHandlerA( void );
 extern void ServoIntHandlerB( void );
@@ -95,7 +97,7 @@ __root const uVectorEntry __vector_table[] @ ".intvec" =
     IntDefaultHandler,                      // SVCall handler
     IntDefaultHandler,                      // Debug monitor handler
     0,                                      // Reserved
-    IntDefaultHandler,                      // The PendSV handler
+    SchedPendSVHandler,                     // The PendSV handler
     SysTickIntHandler,                      // The SysTick handler
     IntDefaultHandler,                      // GPIO Port A
     IntDefaultHandler,                      // GPIO Port B
@@ -105,7 +107,7 @@ __root const uVectorEntry __vector_table[] @ ".intvec" =
     UART0IntHandler,                        // UART0 Rx and Tx
     UART1IntHandler,                        // UART1 Rx and Tx
     IntDefaultHandler,                      // SSI0 Rx and Tx
-    IntDefaultHandler,                      // I2C0 Master and Slave
+    I2CIntHandler,                          // I2C0 Master and Slave
     IntDefaultHandler,                      // PWM Fault
     IntDefaultHandler,                      // PWM Generator 0
     IntDefaultHandler,                      // PWM Generator 1
@@ -9,6 +9,7 @@
 //
 //  CHANGES  accorciata routine di interrupt tick: spostata lettura pulsanti
 //           nella funzione Logic().
+//           rilascio dei task spostato nello scheduler, Sched_Tick().
 //
 //============================================================================*/
 
@@ -22,6 +23,8 @@
 #include "driverlib/interrupt.h"
 
 #include "diskio.h"
+#include "scheduler.h"
+#include "timing.h"
 
 #include "tick.h"
 
@@ -71,8 +74,6 @@ VAR_STATIC unsigned char g_ucSwitches = 0x1f;
 VAR_STATIC unsigned char g_ucSwitchClockA = 0;
 VAR_STATIC unsigned char g_ucSwitchClockB = 0;
 
-VAR_STATIC unsigned long g_ulTickCount = 0;
-
 /*--------------------------------- Prototypes -------------------------------*/
 
 
@@ -85,10 +86,7 @@ VAR_STATIC unsigned long g_ulTickCount = 0;
 //----------------------------------------------------------------------------
 void
 TickInit(void) {
-    //
-    // Configure SysTick for a 100Hz interrupt
-    //
-    SysTickPeriodSet(SysCtlClockGet() / 100);
+    TickSetRate();
     SysTickEnable();
     SysTickIntEnable();
 
@@ -118,39 +116,31 @@ TickInit(void) {
 #endif
 }
 
+//----------------------------------------------------------------------------
+//
+/// \brief   Sets the SysTick period from the control loop timing.
+///
+/// \remarks Called by TickInit() and again after Timing_Init() if the loop
+///          rate is changed at boot.
+///
+//----------------------------------------------------------------------------
+void
+TickSetRate(void) {
+    SysTickPeriodSet(SysCtlClockGet() / Timing_Get()->uiTickHz);
+}
+
 //----------------------------------------------------------------------------
 //
 /// \brief   Handles the SysTick timeout interrupt.
 ///
-/// \remarks Duration ~3 us @50 MHz
+/// \remarks Releases the periodic tasks of the scheduler, the foreground
+///          ones run from PendSV as soon as this handler returns.
 ///
 //----------------------------------------------------------------------------
 void
 SysTickIntHandler(void) {
 
-    //
-    // Indicate that a 10 ms tick has occurred.
-    //
-    HWREGBITW(&g_ulFlags, FLAG_CLOCK_TICK_10) = 1;
-
-    if ((g_ulTickCount % 2) == 0) {
-        //
-        // Indicate that a 20 ms tick has occurred.
-        //
-        HWREGBITW(&g_ulFlags, FLAG_CLOCK_TICK_20) = 1;
-    }
-
-    if ((g_ulTickCount % 16) == 0) {
-        //
-        // Indicate that a 160 ms tick has occurred.
-        //
-        HWREGBITW(&g_ulFlags, FLAG_CLOCK_TICK_160) = 1;
-    }
-
-    //
-    // Increment the tick count.
-    //
-    g_ulTickCount++;
+    Sched_Tick();
 }
 
 //----------------------------------------------------------------------------
@@ -48,4 +48,5 @@ VAR_GLOBAL unsigned long g_ulFlags;
 /*---------------------------------- Interface -------------------------------*/
 
 void TickInit( void );
+void TickSetRate( void );
 void Logic( void );
@@ -0,0 +1,162 @@
+//============================================================================+
+//
+// $RCSfile: timebase.c,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   Microsecond timebase
+///
+/// \file
+/// Single time reference for all drivers, in microseconds since
+/// Timebase_Init():
+/// - Timebase_Us(): 32 bit, wraps every 71 minutes, for intervals and for
+///   the stamps of ADC sequences, GPS sentences, PPM frames, log records
+///   and telemetry frames;
+/// - Timebase_Us64(): 64 bit, does not wrap.
+///
+/// Time source:
+/// - target: Timer 1, free running 32 bit up counter at the CPU clock, also
+///   read by the PPM capture interrupt. The counter wraps every 85 s at
+///   50 MHz: the 64 bit count is brought up to date at every call, so the
+///   timebase must be read at least once every 85 s (the ADC interrupt
+///   does it at every sample);
+/// - host build: clock_gettime(CLOCK_MONOTONIC).
+///
+/// Callable from any interrupt and from the main loop: the update runs with
+/// interrupts disabled, a few tens of cycles.
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include "config.h"
+
+#if defined(__ICCARM__)
+#   include "inc/hw_types.h"
+#   include "inc/hw_memmap.h"
+#   include "driverlib/sysctl.h"
+#   include "driverlib/timer.h"
+#   include "driverlib/interrupt.h"
+#else
+#   include <time.h>
+#endif
+
+#include "timebase.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef    VAR_STATIC
+#   undef VAR_STATIC
+#endif
+#define   VAR_STATIC static
+#ifdef    VAR_GLOBAL
+#   undef VAR_GLOBAL
+#endif
+#define   VAR_GLOBAL
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+#if defined(__ICCARM__)
+VAR_STATIC unsigned long s_ulCyclesUs = 1;          // CPU cycles per us
+VAR_STATIC unsigned long s_ulLast = 0;              // counter at last update
+VAR_STATIC unsigned long long s_ullUs = 0;          // us at last update
+#else
+VAR_STATIC struct timespec s_stStart;               // time at Timebase_Init()
+#endif
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Initialize timebase
+///
+/// \remarks Starts Timer 1. Call before PPMInit() and ADCInit().
+///
+//----------------------------------------------------------------------------
+void
+Timebase_Init( void ) {
+#if defined(__ICCARM__)
+    s_ulCyclesUs = SysCtlClockGet() / 1000000;
+
+    //
+    // Enable Timer 1
+    //
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER1);
+    TimerDisable(TIMER1_BASE, TIMER_A);
+
+    //
+    // One 32 bit timer, timer A counts up
+    //
+    TimerConfigure(TIMER1_BASE, TIMER_CFG_32_BIT_PER | TIMER_TAMR_TACDIR);
+
+    //
+    // Configure maximum timer period: 0xFFFFFFFF / 50 MHz = 85 s
+    //
+    TimerLoadSet(TIMER1_BASE, TIMER_A, 0xFFFFFFFF);
+    TimerEnable(TIMER1_BASE, TIMER_A);
+
+    s_ulLast = TimerValueGet(TIMER1_BASE, TIMER_A);
+    s_ullUs = 0;
+#else
+    clock_gettime(CLOCK_MONOTONIC, &s_stStart);
+#endif
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Get time
+///
+/// \return  time since Timebase_Init() [us], 64 bit
+/// \remarks Only whole microseconds are taken from the counter: the
+///          remainder is kept for the next call.
+///
+//----------------------------------------------------------------------------
+unsigned long long
+Timebase_Us64( void ) {
+#if defined(__ICCARM__)
+    tBoolean bMasked;
+    unsigned long ulUs;
+    unsigned long long ullUs;
+
+    bMasked = IntMasterDisable();
+    ulUs = (TimerValueGet(TIMER1_BASE, TIMER_A) - s_ulLast) / s_ulCyclesUs;
+    s_ulLast += ulUs * s_ulCyclesUs;
+    s_ullUs += ulUs;
+    ullUs = s_ullUs;
+    if (!bMasked) {
+        IntMasterEnable();
+    }
+    return ullUs;
+#else
+    struct timespec stTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &stTime);
+    return ((unsigned long long)(stTime.tv_sec - s_stStart.tv_sec) * 1000000ULL) +
+           (unsigned long long)((stTime.tv_nsec - s_stStart.tv_nsec) / 1000);
+#endif
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Get time
+///
+/// \return  time since Timebase_Init() [us], 32 bit
+/// \remarks Wraps every 71 minutes: differences of two times are correct
+///          in unsigned arithmetic up to that interval.
+///
+//----------------------------------------------------------------------------
+unsigned long
+Timebase_Us( void ) {
+    return (unsigned long)Timebase_Us64();
+}
@@ -0,0 +1,139 @@
+//============================================================================+
+//
+// $RCSfile: timing.c,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   Control loop timing
+///
+/// \file
+/// Single source of the control loop rate, chosen at boot (rate.txt on the
+/// SD card, see Log_ReadRate(); SAMPLES_PER_SECOND if missing):
+/// - ADC trigger (ADCInit, ADCSetSubsteps): uiLoopHz * substeps;
+/// - system tick (TickInit): uiTickHz, the loop rate but at least 100 Hz,
+///   so that the 10 ms FatFs timer is a whole number of ticks;
+/// - task periods (Sched_Init): converted from ms with Timing_Ticks();
+/// - DCM integration and PID derivative: Delta_T and Sample_Rate (DCM.h),
+///   set here to the nominal values and then measured by the control task.
+///
+/// Valid rates divide 100 Hz or are multiples of it, from LOOP_RATE_MIN up
+/// to LOOP_RATE_MAX: 50, 100, 200, 300, 400 Hz.
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include "inc/hw_types.h"
+
+#include "config.h"
+#include "DCM.h"
+#include "timing.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef    VAR_STATIC
+#   undef VAR_STATIC
+#endif
+#define   VAR_STATIC static
+#ifdef    VAR_GLOBAL
+#   undef VAR_GLOBAL
+#endif
+#define   VAR_GLOBAL
+
+//! Frequenza minima del tick di sistema [Hz]
+#define TICK_RATE_MIN       100
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+VAR_STATIC STRUCT_TIMING s_stTiming = {
+    SAMPLES_PER_SECOND,
+    TICK_RATE_MIN,
+    TICK_RATE_MIN / SAMPLES_PER_SECOND,
+    DELTA_T
+};
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Set control loop rate
+///
+/// \param   uiLoopHz loop rate [Hz]
+/// \return  true if the rate is valid, false if SAMPLES_PER_SECOND is used
+/// \remarks Sets Delta_T and Sample_Rate to the nominal values. The
+///          system tick and the ADC trigger keep the default rate until
+///          TickSetRate() and ADCSetRate() are called after it; call it
+///          before Sched_Init() and Sensor_Select().
+///
+//----------------------------------------------------------------------------
+tBoolean
+Timing_Init( unsigned int uiLoopHz ) {
+
+    tBoolean bValid;
+
+    bValid = (uiLoopHz >= LOOP_RATE_MIN) && (uiLoopHz <= LOOP_RATE_MAX) &&
+             (((TICK_RATE_MIN % uiLoopHz) == 0) ||
+              ((uiLoopHz % TICK_RATE_MIN) == 0));
+    if (!bValid) {
+        uiLoopHz = SAMPLES_PER_SECOND;
+    }
+
+    s_stTiming.uiLoopHz = uiLoopHz;
+    if (uiLoopHz < TICK_RATE_MIN) {
+        s_stTiming.uiTickHz = TICK_RATE_MIN;
+    } else {
+        s_stTiming.uiTickHz = uiLoopHz;
+    }
+    s_stTiming.uiTicksPerLoop = s_stTiming.uiTickHz / uiLoopHz;
+    s_stTiming.fDeltaT = 1.0f / (float)uiLoopHz;
+
+    Delta_T = s_stTiming.fDeltaT;
+    Sample_Rate = (float)uiLoopHz;
+
+    return bValid;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Get control loop timing
+///
+/// \return  pointer to timing
+/// \remarks
+///
+//----------------------------------------------------------------------------
+const STRUCT_TIMING *
+Timing_Get( void ) {
+    return &s_stTiming;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Convert a time to system ticks
+///
+/// \param   uiMilliseconds time [ms]
+/// \return  system ticks, at least 1
+/// \remarks
+///
+//----------------------------------------------------------------------------
+unsigned int
+Timing_Ticks( unsigned int uiMilliseconds ) {
+
+    unsigned int uiTicks;
+
+    uiTicks = (uiMilliseconds * s_stTiming.uiTickHz) / 1000;
+    if (uiTicks == 0) {
+        uiTicks = 1;
+    }
+    return uiTicks;
+}
@@ -0,0 +1,44 @@
+//============================================================================
+//
+// $RCSfile: timing.h,v $ (HEADER FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   Control loop timing header file
+///
+/// \file
+///
+//  CHANGES
+//
+//============================================================================
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL extern
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*------------------------------------ Types ---------------------------------*/
+
+typedef struct {                    // control loop timing
+    unsigned int uiLoopHz;          // control loop rate [Hz]
+    unsigned int uiTickHz;          // system tick rate [Hz]
+    unsigned int uiTicksPerLoop;    // system ticks per control loop
+    float fDeltaT;                  // nominal integration interval [s]
+} STRUCT_TIMING;
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*----------------------------------- Globals --------------------------------*/
+
+/*---------------------------------- Interface -------------------------------*/
+
+tBoolean Timing_Init( unsigned int uiLoopHz );
+const STRUCT_TIMING *Timing_Get( void );
+unsigned int Timing_Ticks( unsigned int uiMilliseconds );
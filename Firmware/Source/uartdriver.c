@@ -10,6 +10,8 @@
 /// \file
 ///
 //  CHANGES Baud rate della UART 1 ridotto a 4800 per invio tramite radio
+//          tempo di inizio delle sentenze NMEA sulla UART 1
+//          eventi EVENT_UART0 e EVENT_UART1 alla ricezione di caratteri
 //
 //============================================================================*/
 
@@ -21,6 +23,8 @@
 #include "driverlib/interrupt.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/uart.h"
+#include "timebase.h"
+#include "event.h"
 #include "uartdriver.h"
 
 /*--------------------------------- Definitions ------------------------------*/
@@ -34,6 +38,8 @@
 #endif
 #define VAR_GLOBAL
 
+#define UART1_CHAR_US   2083    // Character time at 4800 baud, 8-N-1 [us]
+
 /*----------------------------------- Macros ---------------------------------*/
 
 /*-------------------------------- Enumerations ------------------------------*/
@@ -52,6 +58,7 @@ VAR_STATIC unsigned char s_pucBuffer0[256]; //
 VAR_STATIC unsigned char s_ucBuffWrite1;    // 
 VAR_STATIC unsigned char s_ucBuffRead1;     // 
 VAR_STATIC unsigned char s_pucBuffer1[256]; // 
+VAR_STATIC volatile unsigned long s_ulSentence1;  // Time of last '$' [us]
 
 /*--------------------------------- Prototypes -------------------------------*/
 
@@ -244,6 +251,10 @@ UART0IntHandler(void)
         s_pucBuffer0[s_ucBuffWrite0] = UARTCharGetNonBlocking(UART0_BASE);
         s_ucBuffWrite0++;
     }
+
+    if (s_ucBuffWrite0 != s_ucBuffRead0) {
+        Event_Post(EVENT_UART0);
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -257,6 +268,7 @@ void
 UART1IntHandler( void )
 {
     unsigned long ulStatus;
+    long lAfter = -1;                           // Characters after '$'
 
     //
     // Get the interrrupt status.
@@ -277,8 +289,25 @@ UART1IntHandler( void )
         // Read the next character from the UART and write it to the buffer
         //
         s_pucBuffer1[s_ucBuffWrite1] = UARTCharGetNonBlocking(UART1_BASE);
+        if (s_pucBuffer1[s_ucBuffWrite1] == '$') {
+            lAfter = 0;                         // Start of NMEA sentence
+        } else if (lAfter >= 0) {
+            lAfter++;
+        }
         s_ucBuffWrite1++;
     }
+
+    //
+    // The last character has just been received: the '$' was received
+    // one character time earlier for each character after it.
+    //
+    if (lAfter >= 0) {
+        s_ulSentence1 = Timebase_Us() - ((unsigned long)lAfter * UART1_CHAR_US);
+    }
+
+    if (s_ucBuffWrite1 != s_ucBuffRead1) {
+        Event_Post(EVENT_UART1);
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -305,6 +334,36 @@ UART1GetChar ( char *ch )
    }
 }
 
+//----------------------------------------------------------------------------
+//
+/// \brief   check uart 1 buffer
+///
+/// \returns true if characters are waiting in the buffer
+/// \remarks 
+///          
+///
+//----------------------------------------------------------------------------
+tBoolean 
+UART1Pending ( void )
+{
+   return (s_ucBuffWrite1 != s_ucBuffRead1);
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   get the start time of the last sentence on uart 1
+///
+/// \returns Timebase_Us() when the last '$' was received
+/// \remarks Taken when the receive FIFO is emptied, less one character time
+///          for each character received after the '$'.
+///
+//----------------------------------------------------------------------------
+unsigned long
+UART1SentenceTime ( void )
+{
+   return s_ulSentence1;
+}
+
 //----------------------------------------------------------------------------
 //
 /// \brief   get a character from uart 0 buffer
@@ -36,5 +36,7 @@ void UARTInit(void);
 void UART0Send(const unsigned char *pucBuffer, unsigned long ulCount);
 void UART1Send(const unsigned char *pucBuffer, unsigned long ulCount);
 tBoolean UART1GetChar ( char *ch );
+tBoolean UART1Pending ( void );
+unsigned long UART1SentenceTime ( void );
 tBoolean UART0GetChar ( char *ch );
 
@@ -0,0 +1,238 @@
+//============================================================================
+//
+// $RCSfile: vec3.h,v $ (HEADER FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief Typed 3D vector and matrix algebra
+///
+/// \file
+/// Header only counterpart of vmath.cpp. The types are plain aggregates, so
+/// they have the memory layout of the float[3] / float[3][3] arrays they
+/// replace, can be brace-initialized and indexed as before:
+/// \code
+///     Vec3<T>     vector
+///     Mat3<T>     3x3 matrix, stored by rows
+///     Skew3<T>    skew symmetric matrix [w]x, stored as the vector w
+///     Rot3<T>     rotation matrix (DCM), stored by rows
+/// \endcode
+/// All functions are inline with fixed trip counts, so that the compiler
+/// unrolls them and keeps the elements in registers. The structure of the
+/// operands is used instead of the dense product:
+/// - Mat3 * Skew3 is computed row by row as row /\ w: 18 multiplications
+///   instead of 27 and no additions of zero;
+/// - the inverse of a Rot3 is its transpose.
+///
+/// Operations are carried out in the same order as vmath.cpp, so replacing
+/// VectorDotProduct(), MatrixMultiply() etc. does not change the results.
+///
+//  CHANGES
+//
+//============================================================================
+
+#ifndef __VEC3_H__
+#define __VEC3_H__
+
+/*--------------------------------- Definitions ------------------------------*/
+
+//
+// Relaxed constexpr needs C++14, older compilers get plain inline functions
+//
+#if defined(__cplusplus) && (__cplusplus >= 201402L)
+#  define VEC3_CONSTEXPR constexpr
+#else
+#  define VEC3_CONSTEXPR
+#endif
+
+/*----------------------------------- Types ----------------------------------*/
+
+//! 3D vector
+template <typename T> struct Vec3 {
+    T v[3];
+    VEC3_CONSTEXPR T &operator[](int i) { return v[i]; }
+    VEC3_CONSTEXPR const T &operator[](int i) const { return v[i]; }
+};
+
+//! 3x3 matrix, by rows
+template <typename T> struct Mat3 {
+    Vec3<T> r[3];
+    VEC3_CONSTEXPR Vec3<T> &operator[](int i) { return r[i]; }
+    VEC3_CONSTEXPR const Vec3<T> &operator[](int i) const { return r[i]; }
+};
+
+//! Skew symmetric matrix [w]x, such that [w]x v = w /\ v
+template <typename T> struct Skew3 {
+    Vec3<T> w;
+};
+
+//! Rotation matrix, by rows
+template <typename T> struct Rot3 {
+    Vec3<T> r[3];
+    VEC3_CONSTEXPR Vec3<T> &operator[](int i) { return r[i]; }
+    VEC3_CONSTEXPR const Vec3<T> &operator[](int i) const { return r[i]; }
+};
+
+/*---------------------------------- Interface -------------------------------*/
+
+//----------------------------------------------------------------------------
+// Vec3
+//----------------------------------------------------------------------------
+
+template <typename T> inline VEC3_CONSTEXPR Vec3<T>
+operator+(const Vec3<T> &a, const Vec3<T> &b)
+{
+    Vec3<T> r = {{ a[0] + b[0], a[1] + b[1], a[2] + b[2] }};
+    return r;
+}
+
+template <typename T> inline VEC3_CONSTEXPR Vec3<T>
+operator-(const Vec3<T> &a, const Vec3<T> &b)
+{
+    Vec3<T> r = {{ a[0] - b[0], a[1] - b[1], a[2] - b[2] }};
+    return r;
+}
+
+template <typename T> inline VEC3_CONSTEXPR Vec3<T>
+operator-(const Vec3<T> &a)
+{
+    Vec3<T> r = {{ -a[0], -a[1], -a[2] }};
+    return r;
+}
+
+//! Vector times scalar, as VectorScale()
+template <typename T> inline VEC3_CONSTEXPR Vec3<T>
+operator*(const Vec3<T> &a, T s)
+{
+    Vec3<T> r = {{ a[0] * s, a[1] * s, a[2] * s }};
+    return r;
+}
+
+template <typename T> inline VEC3_CONSTEXPR Vec3<T> &
+operator+=(Vec3<T> &a, const Vec3<T> &b)
+{
+    a[0] += b[0];
+    a[1] += b[1];
+    a[2] += b[2];
+    return a;
+}
+
+//! Dot product, as VectorDotProduct()
+template <typename T> inline VEC3_CONSTEXPR T
+Dot(const Vec3<T> &a, const Vec3<T> &b)
+{
+    return (a[0] * b[0]) + (a[1] * b[1]) + (a[2] * b[2]);
+}
+
+//! Cross product a /\ b, as VectorCrossProduct()
+template <typename T> inline VEC3_CONSTEXPR Vec3<T>
+Cross(const Vec3<T> &a, const Vec3<T> &b)
+{
+    Vec3<T> r = {{ (a[1] * b[2]) - (a[2] * b[1]),
+                   (a[2] * b[0]) - (a[0] * b[2]),
+                   (a[0] * b[1]) - (a[1] * b[0]) }};
+    return r;
+}
+
+//----------------------------------------------------------------------------
+// Mat3
+//----------------------------------------------------------------------------
+
+//! Dense product, as MatrixMultiply()
+template <typename T> inline VEC3_CONSTEXPR Mat3<T>
+operator*(const Mat3<T> &a, const Mat3<T> &b)
+{
+    Mat3<T> r = {};
+
+    for (int x = 0; x < 3; x++) {
+        for (int y = 0; y < 3; y++) {
+            r[x][y] = (a[x][0] * b[0][y]) + (a[x][1] * b[1][y]) + (a[x][2] * b[2][y]);
+        }
+    }
+    return r;
+}
+
+template <typename T> inline VEC3_CONSTEXPR Vec3<T>
+operator*(const Mat3<T> &a, const Vec3<T> &v)
+{
+    Vec3<T> r = {{ Dot(a[0], v), Dot(a[1], v), Dot(a[2], v) }};
+    return r;
+}
+
+template <typename T> inline VEC3_CONSTEXPR Mat3<T>
+Transpose(const Mat3<T> &a)
+{
+    Mat3<T> r = {{ {{ a[0][0], a[1][0], a[2][0] }},
+                   {{ a[0][1], a[1][1], a[2][1] }},
+                   {{ a[0][2], a[1][2], a[2][2] }} }};
+    return r;
+}
+
+//----------------------------------------------------------------------------
+// Skew3
+//----------------------------------------------------------------------------
+
+//! [w]x v = w /\ v
+template <typename T> inline VEC3_CONSTEXPR Vec3<T>
+operator*(const Skew3<T> &s, const Vec3<T> &v)
+{
+    return Cross(s.w, v);
+}
+
+//! a [w]x: each row of a crossed with w, the zero diagonal is skipped
+template <typename T> inline VEC3_CONSTEXPR Mat3<T>
+operator*(const Mat3<T> &a, const Skew3<T> &s)
+{
+    Mat3<T> r = {{ Cross(a[0], s.w), Cross(a[1], s.w), Cross(a[2], s.w) }};
+    return r;
+}
+
+//----------------------------------------------------------------------------
+// Rot3
+//----------------------------------------------------------------------------
+
+//! Rotation matrix as a generic matrix
+template <typename T> inline VEC3_CONSTEXPR Mat3<T>
+ToMat3(const Rot3<T> &a)
+{
+    Mat3<T> r = {{ a[0], a[1], a[2] }};
+    return r;
+}
+
+//! Inverse of a rotation is its transpose
+template <typename T> inline VEC3_CONSTEXPR Rot3<T>
+Inverse(const Rot3<T> &a)
+{
+    Rot3<T> r = {{ {{ a[0][0], a[1][0], a[2][0] }},
+                   {{ a[0][1], a[1][1], a[2][1] }},
+                   {{ a[0][2], a[1][2], a[2][2] }} }};
+    return r;
+}
+
+//! Rotate v
+template <typename T> inline VEC3_CONSTEXPR Vec3<T>
+operator*(const Rot3<T> &a, const Vec3<T> &v)
+{
+    Vec3<T> r = {{ Dot(a[0], v), Dot(a[1], v), Dot(a[2], v) }};
+    return r;
+}
+
+//! Rate of change of the rotation for angular rate w: a [w]x
+template <typename T> inline VEC3_CONSTEXPR Mat3<T>
+operator*(const Rot3<T> &a, const Skew3<T> &s)
+{
+    Mat3<T> r = {{ Cross(a[0], s.w), Cross(a[1], s.w), Cross(a[2], s.w) }};
+    return r;
+}
+
+//! First order update: a + d is orthonormal again only after Normalize()
+template <typename T> inline VEC3_CONSTEXPR Rot3<T> &
+operator+=(Rot3<T> &a, const Mat3<T> &d)
+{
+    a[0] += d[0];
+    a[1] += d[1];
+    a[2] += d[2];
+    return a;
+}
+
+#endif // __VEC3_H__
@@ -0,0 +1,470 @@
+//============================================================================+
+//
+// $RCSfile: vibe.c,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   Vibration analyzer
+///
+/// \file
+/// Spectrum of the raw ADC sequences, to see the airframe vibration that the
+/// sensor filters (adcdriver.c) remove:
+/// - Vibe_Start() arms a capture of VIBE_POINTS sequences;
+/// - the ADC driver hands every sequence to Vibe_Put(), before filtering, at
+///   the full ADC rate (loop rate * substeps * ADC_OVERSAMPLE);
+/// - Vibe_Run(), from a background task, removes the mean of each axis,
+///   applies a Hann window, takes the FFT and finds the VIBE_PEAKS largest
+///   local maxima of the power spectrum;
+/// - Vibe_Get() returns frequency and amplitude of the peaks. Both are
+///   interpolated from the three bins around each maximum, exact for a
+///   single sinusoid with the Hann window:
+///   d = 2 (|X[k+1]| - |X[k-1]|) / (|X[k-1]| + 2 |X[k]| + |X[k+1]|),
+///   f = (k + d) fs / N, A = 4 |X[k]| / (N H(d)),
+///   H(d) = sinc(d) / (1 - d^2).
+///
+/// FFT arithmetic, see VIBE_FFT in config.h:
+/// - VIBE_FFT_FIXED: radix 2 on 32 bit integers with Q15 twiddles, halved
+///   at each stage but the first. Two real axes per complex FFT (one in the
+///   real part, one in the imaginary part), split afterwards: one pair per
+///   call of Vibe_Run(). Input scaled by 2^VIBE_FRAC, 1/8 step of amplitude
+///   per LSB of the output;
+/// - VIBE_FFT_FLOAT: the same radix 2 in float, on a GCC vector type with
+///   one axis per lane, all the axes in one call.
+///
+/// Bins 0 and 1 hold the residual of the mean and are not searched.
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include "inc/hw_types.h"
+
+#include "config.h"
+#include "fastmath.h"
+#include "vibe.h"
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef    VAR_STATIC
+#   undef VAR_STATIC
+#endif
+#define   VAR_STATIC static
+#ifdef    VAR_GLOBAL
+#   undef VAR_GLOBAL
+#endif
+#define   VAR_GLOBAL
+
+#if (VIBE_POINTS < 16) || (VIBE_POINTS > 1024) || \
+    ((VIBE_POINTS & (VIBE_POINTS - 1)) != 0)
+#error VIBE_POINTS must be a power of 2 between 16 and 1024
+#endif
+
+#define VIBE_BINS       ((VIBE_POINTS / 2) + 1)    // bins of a real spectrum
+#define VIBE_FIRST_BIN  2                           // first bin searched
+
+#if (VIBE_FFT == VIBE_FFT_FIXED)
+//! Bit frazionari dei campioni in ingresso alla FFT
+#define VIBE_FRAC       4
+/// 10 bit steps * 2^4 < 2^14, |re + j im| < 2^14.5, 2^15.5 after the first
+/// stage: with the twiddles in Q15 a butterfly product stays below 2^31.
+#define VIBE_STEPS      (VIBE_AXES / 2)             // Vibe_Run() calls
+#else
+#define VIBE_LANES      8                           // lanes of a pack
+#define VIBE_STEPS      1                           // Vibe_Run() calls
+#endif
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+/*----------------------------------- Types ----------------------------------*/
+
+#if (VIBE_FFT == VIBE_FFT_FLOAT)
+typedef float VIBE_PACK __attribute__((vector_size(VIBE_LANES * sizeof(float))));
+#endif
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*---------------------------------- Globals ---------------------------------*/
+
+/*----------------------------------- Locals ---------------------------------*/
+
+VAR_STATIC unsigned short pusCapture[VIBE_POINTS][VIBE_AXES];  // raw sequences
+VAR_STATIC volatile unsigned int uiCaptured = 0;    // sequences captured
+VAR_STATIC volatile ENUM_VIBE_STATUS eStatus = VIBE_IDLE;
+VAR_STATIC unsigned char ucStep;                    // next Vibe_Run() step
+VAR_STATIC STRUCT_VIBE stVibe;                      // result
+VAR_STATIC float pfPower[VIBE_BINS];                // spectrum of one axis,
+                                                    // amplitude^2 [steps^2]
+#if (VIBE_FFT == VIBE_FFT_FIXED)
+VAR_STATIC short psCos[VIBE_POINTS / 2];            // twiddles, Q15
+VAR_STATIC short psSin[VIBE_POINTS / 2];
+VAR_STATIC short psWindow[VIBE_POINTS];             // Hann window, Q15
+VAR_STATIC long plRe[VIBE_POINTS];                  // FFT of a pair of axes
+VAR_STATIC long plIm[VIBE_POINTS];
+#else
+VAR_STATIC float pfCos[VIBE_POINTS / 2];            // twiddles
+VAR_STATIC float pfSin[VIBE_POINTS / 2];
+VAR_STATIC float pfWindow[VIBE_POINTS];             // Hann window
+VAR_STATIC VIBE_PACK pvRe[VIBE_POINTS];             // FFT, one axis per lane
+VAR_STATIC VIBE_PACK pvIm[VIBE_POINTS];
+#endif
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+static unsigned int Vibe_Reverse( unsigned int uiIndex );
+static void Vibe_Fft( unsigned char ucStep );
+static void Vibe_Peaks( int iAxis );
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Initialize vibration analyzer
+///
+/// \remarks Computes twiddles and window.
+///
+//----------------------------------------------------------------------------
+void
+Vibe_Init( void ) {
+
+    float fSin, fCos;
+    unsigned int n;
+
+    for (n = 0; n < VIBE_POINTS; n++) {
+        FastSinCos((2.0f * PI * (float)n) / (float)VIBE_POINTS, &fSin, &fCos);
+#if (VIBE_FFT == VIBE_FFT_FIXED)
+        if (n < (VIBE_POINTS / 2)) {
+            psCos[n] = (short)FastCeil((fCos * 32767.0f) - 0.5f);
+            psSin[n] = (short)FastCeil((fSin * 32767.0f) - 0.5f);
+        }
+        psWindow[n] = (short)FastCeil(((0.5f - (0.5f * fCos)) * 32767.0f) - 0.5f);
+#else
+        if (n < (VIBE_POINTS / 2)) {
+            pfCos[n] = fCos;
+            pfSin[n] = fSin;
+        }
+        pfWindow[n] = 0.5f - (0.5f * fCos);
+#endif
+    }
+    eStatus = VIBE_IDLE;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Start a capture
+///
+/// \param   fSampleHz sequence rate [Hz]
+/// \remarks Discards any capture or result in progress.
+///
+//----------------------------------------------------------------------------
+void
+Vibe_Start( float fSampleHz ) {
+
+    eStatus = VIBE_IDLE;                        // stop Vibe_Put() first
+    uiCaptured = 0;
+    ucStep = 0;
+    stVibe.fSampleHz = fSampleHz;
+    eStatus = VIBE_CAPTURE;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Capture a sequence
+///
+/// \param   pulSequence VIBE_AXES conversions, in ADC channel order
+/// \remarks Called by the ADC driver for every sequence, also from interrupt
+///          context. Returns at once if no capture is in progress.
+///
+//----------------------------------------------------------------------------
+void
+Vibe_Put( const unsigned long *pulSequence ) {
+
+    unsigned int n;
+    int c;
+
+    if (eStatus != VIBE_CAPTURE) {
+        return;
+    }
+    n = uiCaptured;
+    for (c = 0; c < VIBE_AXES; c++) {
+        pusCapture[n][c] = (unsigned short)pulSequence[c];
+    }
+    uiCaptured = ++n;
+    if (n == VIBE_POINTS) {
+        eStatus = VIBE_ANALYSE;
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Analyse the capture
+///
+/// \return  status after the call
+/// \remarks Background. One step per call: a pair of axes with
+///          VIBE_FFT_FIXED, all the axes with VIBE_FFT_FLOAT.
+///
+//----------------------------------------------------------------------------
+ENUM_VIBE_STATUS
+Vibe_Run( void ) {
+
+    if (eStatus == VIBE_ANALYSE) {
+        Vibe_Fft(ucStep);
+        if (++ucStep == VIBE_STEPS) {
+            eStatus = VIBE_DONE;
+        }
+    }
+    return eStatus;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Get analyzer status
+///
+/// \return  status
+/// \remarks
+///
+//----------------------------------------------------------------------------
+ENUM_VIBE_STATUS
+Vibe_Status( void ) {
+    return eStatus;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Get analysis result
+///
+/// \return  pointer to the result, valid when the status is VIBE_DONE
+/// \remarks
+///
+//----------------------------------------------------------------------------
+const STRUCT_VIBE *
+Vibe_Get( void ) {
+    return &stVibe;
+}
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Bit reversed index
+///
+/// \param   uiIndex index, 0 to VIBE_POINTS - 1
+/// \return  uiIndex with its log2(VIBE_POINTS) bits reversed
+/// \remarks
+///
+//----------------------------------------------------------------------------
+static unsigned int
+Vibe_Reverse( unsigned int uiIndex ) {
+
+    unsigned int uiBit, uiReverse = 0;
+
+    for (uiBit = VIBE_POINTS >> 1; uiBit != 0; uiBit >>= 1) {
+        uiReverse = (uiReverse << 1) | (uiIndex & 1);
+        uiIndex >>= 1;
+    }
+    return uiReverse;
+}
+
+#if (VIBE_FFT == VIBE_FFT_FIXED)
+//----------------------------------------------------------------------------
+//
+/// \brief   Spectra of a pair of axes, fixed point
+///
+/// \param   ucStep pair, axes 2 * ucStep (real part) and 2 * ucStep + 1
+///          (imaginary part)
+/// \remarks Z = A + jB: A[k] = (Z[k] + Z*[N - k]) / 2,
+///          B[k] = (Z[k] - Z*[N - k]) / 2j.
+///
+//----------------------------------------------------------------------------
+static void
+Vibe_Fft( unsigned char ucStep ) {
+
+    int iA = 2 * ucStep, iB = iA + 1;
+    long lMeanA = 0, lMeanB = 0;
+    long lAr, lAi, lTr, lTi, lC, lS;
+    unsigned int n, j, k, uiHalf, uiStride;
+    unsigned char ucShift;
+
+    //
+    // Mean, then windowed samples in bit reversed order
+    //
+    for (n = 0; n < VIBE_POINTS; n++) {
+        lMeanA += pusCapture[n][iA];
+        lMeanB += pusCapture[n][iB];
+    }
+    lMeanA = (lMeanA + (VIBE_POINTS / 2)) / VIBE_POINTS;
+    lMeanB = (lMeanB + (VIBE_POINTS / 2)) / VIBE_POINTS;
+    for (n = 0; n < VIBE_POINTS; n++) {
+        k = Vibe_Reverse(n);
+        plRe[k] = (((long)pusCapture[n][iA] - lMeanA) * psWindow[n]) >> (15 - VIBE_FRAC);
+        plIm[k] = (((long)pusCapture[n][iB] - lMeanB) * psWindow[n]) >> (15 - VIBE_FRAC);
+    }
+
+    //
+    // Radix 2 decimation in time, W = cos - j sin. Halved at each stage
+    // but the first one: the output is 2/N of the FFT
+    //
+    for (uiHalf = 1, uiStride = VIBE_POINTS / 2; uiHalf < VIBE_POINTS;
+         uiHalf <<= 1, uiStride >>= 1) {
+        ucShift = (uiHalf == 1) ? 0 : 1;
+        for (j = 0; j < uiHalf; j++) {
+            lC = psCos[j * uiStride];
+            lS = psSin[j * uiStride];
+            for (n = j; n < VIBE_POINTS; n += 2 * uiHalf) {
+                k = n + uiHalf;
+                lTr = ((plRe[k] * lC) + (plIm[k] * lS) + 0x4000) >> 15;
+                lTi = ((plIm[k] * lC) - (plRe[k] * lS) + 0x4000) >> 15;
+                lAr = plRe[n];
+                lAi = plIm[n];
+                plRe[n] = (lAr + lTr) >> ucShift;
+                plIm[n] = (lAi + lTi) >> ucShift;
+                plRe[k] = (lAr - lTr) >> ucShift;
+                plIm[k] = (lAi - lTi) >> ucShift;
+            }
+        }
+    }
+
+    //
+    // Split the two axes: |X|^2 / 2^(2 VIBE_FRAC) is the amplitude^2 of a
+    // sinusoid centered on the bin
+    //
+    for (k = 0; k < VIBE_BINS; k++) {
+        j = (VIBE_POINTS - k) & (VIBE_POINTS - 1);
+        lTr = plRe[k] + plRe[j];
+        lTi = plIm[k] - plIm[j];
+        pfPower[k] = (((float)lTr * (float)lTr) + ((float)lTi * (float)lTi)) *
+                     (1.0f / (float)(1L << (2 * VIBE_FRAC)));
+    }
+    Vibe_Peaks(iA);
+    for (k = 0; k < VIBE_BINS; k++) {
+        j = (VIBE_POINTS - k) & (VIBE_POINTS - 1);
+        lTr = plIm[k] + plIm[j];
+        lTi = plRe[j] - plRe[k];
+        pfPower[k] = (((float)lTr * (float)lTr) + ((float)lTi * (float)lTi)) *
+                     (1.0f / (float)(1L << (2 * VIBE_FRAC)));
+    }
+    Vibe_Peaks(iB);
+}
+#else
+//----------------------------------------------------------------------------
+//
+/// \brief   Spectra of all the axes, float
+///
+/// \param   ucStep unused, one step
+/// \remarks One axis per lane of VIBE_PACK, lanes above VIBE_AXES unused.
+///
+//----------------------------------------------------------------------------
+static void
+Vibe_Fft( unsigned char ucStep ) {
+
+    VIBE_PACK vMean = { 0 }, vZero = { 0 }, vAr, vAi, vTr, vTi;
+    float fC, fS;
+    unsigned int n, j, k, uiHalf, uiStride;
+    int c;
+
+    //
+    // Mean, then windowed samples in bit reversed order
+    //
+    for (n = 0; n < VIBE_POINTS; n++) {
+        for (c = 0; c < VIBE_AXES; c++) {
+            vMean[c] += (float)pusCapture[n][c];
+        }
+    }
+    vMean = vMean / (float)VIBE_POINTS;
+    for (n = 0; n < VIBE_POINTS; n++) {
+        k = Vibe_Reverse(n);
+        pvRe[k] = vZero;
+        for (c = 0; c < VIBE_AXES; c++) {
+            pvRe[k][c] = (float)pusCapture[n][c];
+        }
+        pvRe[k] = (pvRe[k] - vMean) * pfWindow[n];
+        pvIm[k] = vZero;
+    }
+
+    //
+    // Radix 2 decimation in time: W = cos - j sin
+    //
+    for (uiHalf = 1, uiStride = VIBE_POINTS / 2; uiHalf < VIBE_POINTS;
+         uiHalf <<= 1, uiStride >>= 1) {
+        for (j = 0; j < uiHalf; j++) {
+            fC = pfCos[j * uiStride];
+            fS = pfSin[j * uiStride];
+            for (n = j; n < VIBE_POINTS; n += 2 * uiHalf) {
+                k = n + uiHalf;
+                vTr = (pvRe[k] * fC) + (pvIm[k] * fS);
+                vTi = (pvIm[k] * fC) - (pvRe[k] * fS);
+                vAr = pvRe[n];
+                vAi = pvIm[n];
+                pvRe[n] = vAr + vTr;
+                pvIm[n] = vAi + vTi;
+                pvRe[k] = vAr - vTr;
+                pvIm[k] = vAi - vTi;
+            }
+        }
+    }
+
+    //
+    // |X|^2 * 16 / N^2 is the amplitude^2 of a sinusoid centered on the bin
+    //
+    for (c = 0; c < VIBE_AXES; c++) {
+        for (k = 0; k < VIBE_BINS; k++) {
+            pfPower[k] = ((pvRe[k][c] * pvRe[k][c]) + (pvIm[k][c] * pvIm[k][c])) *
+                         (16.0f / ((float)VIBE_POINTS * (float)VIBE_POINTS));
+        }
+        Vibe_Peaks(c);
+    }
+}
+#endif
+
+//----------------------------------------------------------------------------
+//
+/// \brief   Find the peaks of an axis
+///
+/// \param   iAxis axis, pfPower holds its spectrum
+/// \remarks Local maxima of the power, largest first, interpolated.
+///
+//----------------------------------------------------------------------------
+static void
+Vibe_Peaks( int iAxis ) {
+
+    unsigned int puiBin[VIBE_PEAKS];
+    unsigned int k;
+    float fLeft, fMid, fRight, fDelta, fSin, fCos, fGain;
+    int p, q, iFound = 0;
+
+    for (k = VIBE_FIRST_BIN; k < (VIBE_BINS - 1); k++) {
+        if ((pfPower[k] > pfPower[k - 1]) && (pfPower[k] >= pfPower[k + 1])) {
+            for (p = iFound; (p > 0) && (pfPower[k] > pfPower[puiBin[p - 1]]); p--) {
+            }
+            if (p < VIBE_PEAKS) {               // insert at p
+                if (iFound < VIBE_PEAKS) {
+                    iFound++;
+                }
+                for (q = iFound - 1; q > p; q--) {
+                    puiBin[q] = puiBin[q - 1];
+                }
+                puiBin[p] = k;
+            }
+        }
+    }
+
+    for (p = 0; p < VIBE_PEAKS; p++) {
+        if (p >= iFound) {
+            stVibe.pstPeak[iAxis][p].fHz = 0.0f;
+            stVibe.pstPeak[iAxis][p].fAmplitude = 0.0f;
+            continue;
+        }
+        k = puiBin[p];
+        fLeft = FastSqrt(pfPower[k - 1]);
+        fMid = FastSqrt(pfPower[k]);
+        fRight = FastSqrt(pfPower[k + 1]);
+        fDelta = (2.0f * (fRight - fLeft)) / (fLeft + (2.0f * fMid) + fRight);
+        if ((fDelta > -1.0e-4f) && (fDelta < 1.0e-4f)) {
+            fGain = 1.0f;
+        } else {
+            FastSinCos(PI * fDelta, &fSin, &fCos);
+            fGain = fSin / (PI * fDelta * (1.0f - (fDelta * fDelta)));
+        }
+        stVibe.pstPeak[iAxis][p].fHz = (((float)k + fDelta) * stVibe.fSampleHz) /
+                                       (float)VIBE_POINTS;
+        stVibe.pstPeak[iAxis][p].fAmplitude = fMid / fGain;
+    }
+}
@@ -0,0 +1,60 @@
+//============================================================================
+//
+// $RCSfile: vibe.h,v $ (HEADER FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   Vibration analyzer header file
+///
+/// \file
+///
+//  CHANGES
+//
+//============================================================================
+
+/*--------------------------------- Definitions ------------------------------*/
+
+#ifdef VAR_GLOBAL
+#undef VAR_GLOBAL
+#endif
+#define VAR_GLOBAL extern
+
+#define VIBE_AXES           6           // ADC channels analysed
+#define VIBE_PEAKS          3           // peaks reported per axis
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/*-------------------------------- Enumerations ------------------------------*/
+
+typedef enum {          // analyzer status
+    VIBE_IDLE,          // no capture requested
+    VIBE_CAPTURE,       // capturing sequences, Vibe_Put()
+    VIBE_ANALYSE,       // capture complete, spectra in progress, Vibe_Run()
+    VIBE_DONE           // peaks available, Vibe_Get()
+} ENUM_VIBE_STATUS;
+
+/*------------------------------------ Types ---------------------------------*/
+
+typedef struct {                    // spectral peak
+    float fHz;                      // frequency [Hz], 0 = no peak
+    float fAmplitude;               // amplitude of the sinusoid [ADC steps]
+} STRUCT_VIBE_PEAK;
+
+typedef struct {                    // analysis of a capture
+    float fSampleHz;                // sequence rate of the capture [Hz]
+    STRUCT_VIBE_PEAK pstPeak[VIBE_AXES][VIBE_PEAKS];   // largest first
+} STRUCT_VIBE;
+
+/*---------------------------------- Constants -------------------------------*/
+
+/*----------------------------------- Globals --------------------------------*/
+
+/*---------------------------------- Interface -------------------------------*/
+
+void Vibe_Init( void );
+void Vibe_Start( float fSampleHz );
+void Vibe_Put( const unsigned long *pulSequence );
+ENUM_VIBE_STATUS Vibe_Run( void );
+ENUM_VIBE_STATUS Vibe_Status( void );
+const STRUCT_VIBE *Vibe_Get( void );
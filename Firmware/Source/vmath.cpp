@@ -136,3 +136,46 @@ MatrixMultiply(float fMatrixA[3][3], float fMatrixB[3][3], float fMatrixR[3][3])
     }
 }
 
+
+///----------------------------------------------------------------------------
+///
+///  DESCRIPTION Sum of gyro increments with coning term.
+/// \RETURN      -
+/// \REMARKS     For n gyro samples d[0] .. d[n-1], in ADC steps:
+///                                                                 \code
+///              alpha = d[0] + ... + d[n-1]
+///
+///                       n-1
+///              beta  =  sum  (d[0] + ... + d[i-1]) /\ d[i]
+///                       i=1                                       \endcode
+///
+///              With s = rate per step * sample interval, the rotation
+///              vector over the n samples is s * alpha + s * s * beta / 2.
+///              beta is the coning term: it is zero when the rotation axis
+///              does not change within the samples. Integer arithmetic, so
+///              that it costs 6 integer multiplications per sample; with
+///              samples up to +/-1023 steps beta does not overflow for n up
+///              to 32.
+///
+///----------------------------------------------------------------------------
+void
+ConingSum(long plAlpha[3], long plBeta[3], long plSample[][3], int n)
+{
+    int i, c;
+
+    for ( c = 0; c < 3; c++ )
+    {
+        plAlpha[c] = 0;
+        plBeta[c] = 0;
+    }
+    for ( i = 0; i < n; i++ )
+    {
+        plBeta[0] += (plAlpha[1] * plSample[i][2]) - (plAlpha[2] * plSample[i][1]);
+        plBeta[1] += (plAlpha[2] * plSample[i][0]) - (plAlpha[0] * plSample[i][2]);
+        plBeta[2] += (plAlpha[0] * plSample[i][1]) - (plAlpha[1] * plSample[i][0]);
+        for ( c = 0; c < 3; c++ )
+        {
+            plAlpha[c] += plSample[i][c];
+        }
+    }
+}
@@ -41,3 +41,4 @@ void VectorScale(float fScaledV[3],float fVector[3], float fScale);
 void VectorAdd(float fSumV[3], float fVectorA[3], float fVectorB[3]);
 void MatrixMultiply(float fMatrixA[3][3], float fMatrixB[3][3], float fMatrixR[3][3]);
 
+void ConingSum(long plAlpha[3], long plBeta[3], long plSample[][3], int n);
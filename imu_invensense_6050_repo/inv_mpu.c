@@ -31,6 +31,12 @@
  *      unsigned char length, unsigned char *data)
  * delay_ms(unsigned long num_ms)
  * get_ms(unsigned long *count)
+ * get_us(unsigned long *count) (optional, mpu_read_fifo_batch, else get_ms)
+ * i2c_read_async(unsigned char slave_addr, unsigned char reg_addr,
+ *      unsigned char length, unsigned char *data,
+ *      void (*done)(int result, void *arg), void *arg)
+ *      (optional, mpu_read_fifo_stream_async: queue the read, return 0 at
+ *      once, call done at its end)
  * reg_int_cb(void (*cb)(void), unsigned char port, unsigned char pin)
  * labs(long x)
  * fabsf(float x)
@@ -115,6 +121,27 @@ static inline int reg_int_cb(struct int_param_s *int_param)
 /* UC3 is a 32-bit processor, so abs and labs are equivalent. */
 #define labs        abs
 #define fabs(x)     (((x)>0)?(x):-(x))
+#elif defined EMPL_TARGET_LM3S
+/* LM3S firmware (Firmware/Source): I2C 0 master with queued transfers,
+ * microsecond timebase. The FIFO is polled by the control task, no
+ * interrupt from the chip.
+ */
+#include "i2cdriver.h"
+#include "mpu6050.h"
+#define i2c_write   I2CWrite
+#define i2c_read    I2CRead
+#define i2c_read_async  I2CReadAsync
+#define delay_ms    Mpu_DelayMs
+#define get_ms      Mpu_GetMs
+#define get_us      Mpu_GetUs
+static inline int reg_int_cb(struct int_param_s *int_param)
+{
+    return 0;
+}
+#define log_i(...)     do {} while (0)
+#define log_e(...)     do {} while (0)
+#define fabs        fabsf
+#define min(a,b) ((a<b)?a:b)
 #else
 #error  Gyro driver is missing the system layer implementations.
 #endif
@@ -619,6 +646,8 @@ static struct gyro_state_s st = {
 #endif
 
 #define MAX_PACKET_LENGTH (12)
+/* Longest FIFO read, the length argument of i2c_read is a byte. */
+#define MAX_FIFO_BURST (255)
 #ifdef MPU6500
 #define HWST_MAX_PACKET_LENGTH (512)
 #endif
@@ -1801,6 +1830,190 @@ int mpu_read_fifo(short *gyro, short *accel, unsigned long *timestamp,
     return 0;
 }
 
+/* Bytes per packet of the FIFO configured by mpu_configure_fifo. */
+static unsigned char fifo_packet_size(void)
+{
+    unsigned char packet_size = 0;
+
+    if (st.chip_cfg.fifo_enable & INV_X_GYRO)
+        packet_size += 2;
+    if (st.chip_cfg.fifo_enable & INV_Y_GYRO)
+        packet_size += 2;
+    if (st.chip_cfg.fifo_enable & INV_Z_GYRO)
+        packet_size += 2;
+    if (st.chip_cfg.fifo_enable & INV_XYZ_ACCEL)
+        packet_size += 6;
+    return packet_size;
+}
+
+/* Decode packets number first to first + n - 1 of a read, the newest of
+ * the FIFO, number newest, stamped at now.
+ */
+static void decode_fifo_packets(const unsigned char *data,
+    unsigned short first, unsigned short n, unsigned short newest,
+    unsigned long now, struct mpu_fifo_sample_s *samples)
+{
+    unsigned long period;
+    unsigned short ii, index;
+
+    period = st.chip_cfg.sample_rate ? 1000000UL / st.chip_cfg.sample_rate : 0;
+    for (ii = 0, index = 0; ii < n; ii++) {
+        struct mpu_fifo_sample_s *sample = &samples[first + ii];
+        sample->timestamp = now -
+            (unsigned long)(newest - (first + ii)) * period;
+        if (st.chip_cfg.fifo_enable & INV_XYZ_ACCEL) {
+            sample->accel[0] = (data[index+0] << 8) | data[index+1];
+            sample->accel[1] = (data[index+2] << 8) | data[index+3];
+            sample->accel[2] = (data[index+4] << 8) | data[index+5];
+            index += 6;
+        }
+        if (st.chip_cfg.fifo_enable & INV_X_GYRO) {
+            sample->gyro[0] = (data[index+0] << 8) | data[index+1];
+            index += 2;
+        }
+        if (st.chip_cfg.fifo_enable & INV_Y_GYRO) {
+            sample->gyro[1] = (data[index+0] << 8) | data[index+1];
+            index += 2;
+        }
+        if (st.chip_cfg.fifo_enable & INV_Z_GYRO) {
+            sample->gyro[2] = (data[index+0] << 8) | data[index+1];
+            index += 2;
+        }
+    }
+}
+
+/**
+ *  @brief      Get all the packets in the FIFO.
+ *  Same data as a loop of mpu_read_fifo, with one FIFO count read and the
+ *  packets read in bursts of up to MAX_FIFO_BURST bytes, instead of two
+ *  transactions per packet.
+ *  \n Timestamps are reconstructed from the sample rate: the newest packet
+ *  in the FIFO is stamped with the time of the count read, every older one
+ *  a sample period before. They are in microseconds, from get_us if the
+ *  platform provides it, else from get_ms.
+ *  \n If the FIFO holds more than @e max_samples packets, the oldest are
+ *  read and @e more is the number left.
+ *  @param[out] samples     Packets read, oldest first.
+ *  @param[in]  max_samples Size of @e samples.
+ *  @param[out] count       Number of packets read.
+ *  @param[out] sensors     Mask of sensors in each packet.
+ *  @param[out] more        Number of remaining packets.
+ *  @return     0 if successful, -2 if the FIFO has overflowed and has been
+ *  reset. On a bus error the FIFO is reset too and the first @e count
+ *  packets are valid.
+ */
+int mpu_read_fifo_batch(struct mpu_fifo_sample_s *samples,
+    unsigned short max_samples, unsigned short *count,
+    unsigned char *sensors, unsigned short *more)
+{
+    unsigned char data[MAX_FIFO_BURST];
+    unsigned char packet_size, burst;
+    unsigned short fifo_count, packets, jj;
+    unsigned long now;
+
+    count[0] = 0;
+    more[0] = 0;
+    sensors[0] = 0;
+    if (st.chip_cfg.dmp_on)
+        return -1;
+    if (!st.chip_cfg.sensors)
+        return -1;
+    if (!st.chip_cfg.fifo_enable)
+        return -1;
+
+    packet_size = fifo_packet_size();
+
+    if (i2c_read(st.hw->addr, st.reg->fifo_count_h, 2, data))
+        return -1;
+    fifo_count = (data[0] << 8) | data[1];
+    if (fifo_count < packet_size)
+        return 0;
+    if (fifo_count > (st.hw->max_fifo >> 1)) {
+        /* FIFO is 50% full, better check overflow bit. */
+        if (i2c_read(st.hw->addr, st.reg->int_status, 1, data))
+            return -1;
+        if (data[0] & BIT_FIFO_OVERFLOW) {
+            mpu_reset_fifo();
+            return -2;
+        }
+    }
+#ifdef get_us
+    get_us(&now);
+#else
+    get_ms(&now);
+    now *= 1000UL;
+#endif
+
+    packets = fifo_count / packet_size;
+    if (packets > max_samples) {
+        more[0] = packets - max_samples;
+        packets = max_samples;
+    }
+    if (st.chip_cfg.fifo_enable & INV_XYZ_ACCEL)
+        sensors[0] |= INV_XYZ_ACCEL;
+    sensors[0] |= st.chip_cfg.fifo_enable & INV_XYZ_GYRO;
+
+    for (jj = 0; jj < packets; jj += burst) {
+        burst = MAX_FIFO_BURST / packet_size;
+        if (burst > packets - jj)
+            burst = (unsigned char)(packets - jj);
+        if (i2c_read(st.hw->addr, st.reg->fifo_r_w, burst * packet_size, data)) {
+            /* Packets are lost, the stream is out of step: start over. */
+            mpu_reset_fifo();
+            count[0] = jj;
+            more[0] = 0;
+            return -1;
+        }
+        decode_fifo_packets(data, jj, burst, more[0] + packets - 1, now,
+            samples);
+    }
+    count[0] = packets;
+    return 0;
+}
+
+/**
+ *  @brief      Get the length of the FIFO packets.
+ *  Packets configured by mpu_configure_fifo, as read by mpu_read_fifo_batch.
+ *  @param[out] length  Bytes per packet.
+ *  @return     0 if successful.
+ */
+int mpu_get_fifo_packet_size(unsigned short *length)
+{
+    length[0] = 0;
+    if (st.chip_cfg.dmp_on || !st.chip_cfg.fifo_enable)
+        return -1;
+    length[0] = fifo_packet_size();
+    return 0;
+}
+
+/**
+ *  @brief      Decode FIFO packets read by mpu_read_fifo_stream_async.
+ *  Same samples and timestamps as mpu_read_fifo_batch, from the values
+ *  passed to the callback of the read.
+ *  @param[in]  data        Packets, back to back.
+ *  @param[in]  count       Number of packets.
+ *  @param[in]  more        Number of packets left in the FIFO.
+ *  @param[in]  timestamp   Time of the FIFO count read, microseconds.
+ *  @param[out] samples     Packets decoded, oldest first.
+ *  @param[out] sensors     Mask of sensors in each packet.
+ *  @return     0 if successful.
+ */
+int mpu_decode_fifo(const unsigned char *data, unsigned short count,
+    unsigned short more, unsigned long timestamp,
+    struct mpu_fifo_sample_s *samples, unsigned char *sensors)
+{
+    sensors[0] = 0;
+    if (st.chip_cfg.dmp_on || !st.chip_cfg.fifo_enable)
+        return -1;
+    if (st.chip_cfg.fifo_enable & INV_XYZ_ACCEL)
+        sensors[0] |= INV_XYZ_ACCEL;
+    sensors[0] |= st.chip_cfg.fifo_enable & INV_XYZ_GYRO;
+    if (count)
+        decode_fifo_packets(data, 0, count, more + count - 1, timestamp,
+            samples);
+    return 0;
+}
+
 /**
  *  @brief      Get one unparsed packet from the FIFO.
  *  This function should be used if the packet is to be parsed elsewhere.
@@ -1841,6 +2054,219 @@ int mpu_read_fifo_stream(unsigned short length, unsigned char *data,
     return 0;
 }
 
+/**
+ *  @brief      Get all the unparsed packets in the FIFO.
+ *  As mpu_read_fifo_stream, for all the packets: one FIFO count read, then
+ *  the packets in bursts of up to MAX_FIFO_BURST bytes.
+ *  \n If the FIFO holds more than @e max_packets packets, the oldest are
+ *  read and @e more is the number left.
+ *  @param[in]  length      Length of one FIFO packet.
+ *  @param[in]  max_packets Packets that fit in @e data.
+ *  @param[out] data        FIFO packets, back to back.
+ *  @param[out] count       Number of packets read.
+ *  @param[out] more        Number of remaining packets.
+ *  @return     0 if successful, -2 if the FIFO has overflowed and has been
+ *  reset. On a bus error the FIFO is reset too and the first @e count
+ *  packets are valid.
+ */
+int mpu_read_fifo_stream_batch(unsigned short length,
+    unsigned short max_packets, unsigned char *data, unsigned short *count,
+    unsigned short *more)
+{
+    unsigned char tmp[2];
+    unsigned short fifo_count, packets, burst, jj;
+
+    count[0] = 0;
+    more[0] = 0;
+    if (!st.chip_cfg.dmp_on)
+        return -1;
+    if (!st.chip_cfg.sensors)
+        return -1;
+    if (!length || (length > MAX_FIFO_BURST))
+        return -1;
+
+    if (i2c_read(st.hw->addr, st.reg->fifo_count_h, 2, tmp))
+        return -1;
+    fifo_count = (tmp[0] << 8) | tmp[1];
+    if (fifo_count < length)
+        return 0;
+    if (fifo_count > (st.hw->max_fifo >> 1)) {
+        /* FIFO is 50% full, better check overflow bit. */
+        if (i2c_read(st.hw->addr, st.reg->int_status, 1, tmp))
+            return -1;
+        if (tmp[0] & BIT_FIFO_OVERFLOW) {
+            mpu_reset_fifo();
+            return -2;
+        }
+    }
+
+    packets = fifo_count / length;
+    if (packets > max_packets) {
+        more[0] = packets - max_packets;
+        packets = max_packets;
+    }
+    for (jj = 0; jj < packets; jj += burst) {
+        burst = MAX_FIFO_BURST / length;
+        if (burst > packets - jj)
+            burst = packets - jj;
+        if (i2c_read(st.hw->addr, st.reg->fifo_r_w,
+                (unsigned char)(burst * length), data + jj * length)) {
+            mpu_reset_fifo();
+            count[0] = jj;
+            more[0] = 0;
+            return -1;
+        }
+    }
+    count[0] = packets;
+    return 0;
+}
+
+#ifdef i2c_read_async
+/* State of mpu_read_fifo_stream_async, advanced by the end of each read. */
+enum fifo_async_stage_e {
+    FIFO_ASYNC_COUNT,
+    FIFO_ASYNC_STATUS,
+    FIFO_ASYNC_DATA
+};
+
+static struct {
+    volatile unsigned char busy;
+    unsigned char stage;
+    unsigned char tmp[2];
+    unsigned char burst;
+    unsigned short length;
+    unsigned short max_packets;
+    unsigned short packets;
+    unsigned short next;
+    unsigned short more;
+    unsigned long timestamp;
+    unsigned char *data;
+    mpu_fifo_done_t done;
+} fifo_async;
+
+static void fifo_async_end(int result)
+{
+    mpu_fifo_done_t done = fifo_async.done;
+
+    fifo_async.busy = 0;
+    done(result, fifo_async.next, result ? 0 : fifo_async.more,
+        fifo_async.timestamp);
+}
+
+static void fifo_async_step(int result, void *arg)
+{
+    unsigned short fifo_count, burst;
+
+    (void)arg;
+    if (result) {
+        fifo_async_end(-1);
+        return;
+    }
+    switch (fifo_async.stage) {
+    case FIFO_ASYNC_COUNT:
+#ifdef get_us
+        get_us(&fifo_async.timestamp);
+#else
+        get_ms(&fifo_async.timestamp);
+        fifo_async.timestamp *= 1000UL;
+#endif
+        fifo_count = (fifo_async.tmp[0] << 8) | fifo_async.tmp[1];
+        fifo_async.packets = fifo_count / fifo_async.length;
+        if (fifo_async.packets > fifo_async.max_packets) {
+            fifo_async.more = fifo_async.packets - fifo_async.max_packets;
+            fifo_async.packets = fifo_async.max_packets;
+        }
+        if (fifo_count > (st.hw->max_fifo >> 1)) {
+            /* FIFO is 50% full, better check overflow bit. */
+            fifo_async.stage = FIFO_ASYNC_STATUS;
+            if (i2c_read_async(st.hw->addr, st.reg->int_status, 1,
+                    fifo_async.tmp, fifo_async_step, 0))
+                fifo_async_end(-1);
+            return;
+        }
+        break;
+    case FIFO_ASYNC_STATUS:
+        if (fifo_async.tmp[0] & BIT_FIFO_OVERFLOW) {
+            fifo_async_end(-2);
+            return;
+        }
+        break;
+    default:
+        fifo_async.next += fifo_async.burst;
+        break;
+    }
+
+    if (fifo_async.next == fifo_async.packets) {
+        fifo_async_end(0);
+        return;
+    }
+    burst = MAX_FIFO_BURST / fifo_async.length;
+    if (burst > fifo_async.packets - fifo_async.next)
+        burst = fifo_async.packets - fifo_async.next;
+    fifo_async.burst = (unsigned char)burst;
+    fifo_async.stage = FIFO_ASYNC_DATA;
+    if (i2c_read_async(st.hw->addr, st.reg->fifo_r_w,
+            (unsigned char)(burst * fifo_async.length),
+            fifo_async.data + fifo_async.next * fifo_async.length,
+            fifo_async_step, 0))
+        fifo_async_end(-1);
+}
+
+/**
+ *  @brief      Start reading all the unparsed packets in the FIFO.
+ *  As mpu_read_fifo_stream_batch, without waiting: the FIFO count read,
+ *  the overflow check and the bursts of packets are queued one after the
+ *  other by the end of the previous one, on i2c_read_async, and @e done is
+ *  called at the end, in the context of i2c_read_async callbacks
+ *  (interrupt on the target). Packets are those of the DMP, or of
+ *  mpu_configure_fifo (see mpu_get_fifo_packet_size, mpu_decode_fifo).
+ *  \n The FIFO is not reset on errors, since that takes blocking reads:
+ *  on overflow (-2) or on a bus error (-1, the first @e count packets are
+ *  valid) the caller resets it with mpu_reset_fifo, out of the callback.
+ *  \n @e data must stay valid until @e done.
+ *  @param[in]  length      Length of one FIFO packet.
+ *  @param[in]  max_packets Packets that fit in @e data.
+ *  @param[out] data        FIFO packets, back to back.
+ *  @param[in]  done        End of the read.
+ *  @return     0 if the read has started, -1 if another one is running.
+ */
+int mpu_read_fifo_stream_async(unsigned short length,
+    unsigned short max_packets, unsigned char *data, mpu_fifo_done_t done)
+{
+    if (fifo_async.busy)
+        return -1;
+    if (!st.chip_cfg.dmp_on && !st.chip_cfg.fifo_enable)
+        return -1;
+    if (!st.chip_cfg.sensors)
+        return -1;
+    if (!length || (length > MAX_FIFO_BURST) || !max_packets || !done)
+        return -1;
+
+    fifo_async.busy = 1;
+    fifo_async.stage = FIFO_ASYNC_COUNT;
+    fifo_async.length = length;
+    fifo_async.max_packets = max_packets;
+    fifo_async.packets = 0;
+    fifo_async.next = 0;
+    fifo_async.more = 0;
+    fifo_async.timestamp = 0;
+    fifo_async.data = data;
+    fifo_async.done = done;
+    if (i2c_read_async(st.hw->addr, st.reg->fifo_count_h, 2, fifo_async.tmp,
+            fifo_async_step, 0)) {
+        fifo_async.busy = 0;
+        return -1;
+    }
+    return 0;
+}
+#else
+int mpu_read_fifo_stream_async(unsigned short length,
+    unsigned short max_packets, unsigned char *data, mpu_fifo_done_t done)
+{
+    return -1;
+}
+#endif
+
 /**
  *  @brief      Set device to bypass mode.
  *  @param[in]  bypass_on   1 to enable bypass mode.
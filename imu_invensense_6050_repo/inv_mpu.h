@@ -38,11 +38,25 @@ struct int_param_s {
     unsigned long pin;
     void (*cb)(volatile void*);
     void *arg;
-#elif defined EMPL_TARGET_STM32F4
+#elif defined EMPL_TARGET_STM32F4 || defined EMPL_TARGET_LM3S
     void (*cb)(void);
 #endif
 };
 
+/* One FIFO packet decoded by mpu_read_fifo_batch or mpu_decode_fifo. */
+struct mpu_fifo_sample_s {
+    unsigned long timestamp;    /* Microseconds, see get_us. */
+    short gyro[3];              /* Hardware units. */
+    short accel[3];             /* Hardware units. */
+};
+
+/* End of mpu_read_fifo_stream_async, in interrupt context: result 0, -1 on
+ * a bus error, -2 on FIFO overflow; count packets read, more left in the
+ * FIFO; timestamp of the FIFO count read, microseconds.
+ */
+typedef void (*mpu_fifo_done_t)(int result, unsigned short count,
+    unsigned short more, unsigned long timestamp);
+
 #define MPU_INT_STATUS_DATA_READY       (0x0001)
 #define MPU_INT_STATUS_DMP              (0x0002)
 #define MPU_INT_STATUS_PLL_READY        (0x0004)
@@ -115,6 +129,18 @@ int mpu_read_fifo(short *gyro, short *accel, unsigned long *timestamp,
     unsigned char *sensors, unsigned char *more);
 int mpu_read_fifo_stream(unsigned short length, unsigned char *data,
     unsigned char *more);
+int mpu_read_fifo_stream_batch(unsigned short length,
+    unsigned short max_packets, unsigned char *data, unsigned short *count,
+    unsigned short *more);
+int mpu_read_fifo_batch(struct mpu_fifo_sample_s *samples,
+    unsigned short max_samples, unsigned short *count,
+    unsigned char *sensors, unsigned short *more);
+int mpu_read_fifo_stream_async(unsigned short length,
+    unsigned short max_packets, unsigned char *data, mpu_fifo_done_t done);
+int mpu_get_fifo_packet_size(unsigned short *length);
+int mpu_decode_fifo(const unsigned char *data, unsigned short count,
+    unsigned short more, unsigned long timestamp,
+    struct mpu_fifo_sample_s *samples, unsigned char *sensors);
 int mpu_reset_fifo(void);
 
 int mpu_write_mem(unsigned short mem_addr, unsigned short length,
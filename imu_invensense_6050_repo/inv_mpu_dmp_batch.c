@@ -0,0 +1,308 @@
+//============================================================================+
+//
+// $RCSfile: inv_mpu_dmp_batch.c,v $ (SOURCE FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   DMP packet batch decoder
+///
+/// \file
+/// dmp_read_fifo() parses one packet per call, testing the feature mask for
+/// every field and assembling every big endian word byte by byte. Here the
+/// field offsets are computed once, when the features change
+/// (dmp_layout_from_mask(), called by dmp_enable_feature()), and a batch of
+/// packets read in one FIFO burst is decoded in one pass into one array
+/// per component:
+/// - dmp_decode_batch_scalar(): one 32 bit load per word, unaligned, then
+///   a byte reverse (REV, REV16 on the Cortex-M3); the target decoder;
+/// - dmp_decode_batch(): on hosts with SSE2 four packets at a time, byte
+///   swaps and the transpose to structure of arrays in SIMD registers
+///   (PSHUFB with SSSE3), the scalar decoder for the rest; elsewhere the
+///   scalar decoder.
+///
+/// Gestures (tap, orientation) are left to the caller, at offset gesture.
+/// dmpbench (Firmware/Host) checks both against a byte by byte decoder and
+/// measures their throughput.
+///
+//  CHANGES
+//
+//============================================================================*/
+
+#include <string.h>
+#include "inv_mpu.h"
+#include "inv_mpu_dmp_motion_driver.h"
+#include "inv_mpu_dmp_batch.h"
+
+#if defined __SSE2__
+#include <emmintrin.h>
+#endif
+#if defined __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+/*--------------------------------- Definitions ------------------------------*/
+
+/*----------------------------------- Macros ---------------------------------*/
+
+/* Big endian loads: a word load and a byte reverse where the core has
+ * one, the bytes one at a time otherwise.
+ */
+#if defined __ICCARM__
+#include <intrinsics.h>
+#define load_be32(p)    ((int32_t)__REV(*(__packed const uint32_t *)(p)))
+#define load_be16x2(p)  (__REV16(*(__packed const uint32_t *)(p)))
+#define load_be16(p)    ((int16_t)__REVSH(*(__packed const uint16_t *)(p)))
+#elif defined __GNUC__ && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+static inline uint32_t load_u32(const unsigned char *p)
+{
+    uint32_t w;
+    memcpy(&w, p, 4);
+    return w;
+}
+static inline uint16_t load_u16(const unsigned char *p)
+{
+    uint16_t w;
+    memcpy(&w, p, 2);
+    return w;
+}
+static inline uint32_t rev16(uint32_t w)
+{
+    return ((w & 0x00FF00FFUL) << 8) | ((w >> 8) & 0x00FF00FFUL);
+}
+#define load_be32(p)    ((int32_t)__builtin_bswap32(load_u32(p)))
+#define load_be16x2(p)  (rev16(load_u32(p)))
+#define load_be16(p)    ((int16_t)__builtin_bswap16(load_u16(p)))
+#else
+#define load_be32(p)    ((int32_t)(((uint32_t)(p)[0] << 24) | \
+                         ((uint32_t)(p)[1] << 16) | \
+                         ((uint32_t)(p)[2] << 8) | (p)[3]))
+#define load_be16x2(p)  (((uint32_t)(p)[2] << 24) | ((uint32_t)(p)[3] << 16) | \
+                         ((uint32_t)(p)[0] << 8) | (p)[1])
+#define load_be16(p)    ((int16_t)(((p)[0] << 8) | (p)[1]))
+#endif
+
+/*--------------------------------- Prototypes -------------------------------*/
+
+static void decode_quats(const unsigned char *data, unsigned char length,
+    unsigned short first, unsigned short packets, int32_t *const *out);
+static void decode_shorts(const unsigned char *data, unsigned char length,
+    unsigned short first, unsigned short packets, int16_t *const *out);
+
+/**
+ *  @brief      Packet layout of a feature mask.
+ *  Same field order as dmp_read_fifo: quaternion, accel, gyro, gesture.
+ *  @param[in]  mask    DMP_FEATURE_xxx mask, see dmp_enable_feature.
+ *  @param[out] layout  Field offsets, packet length and sensors.
+ */
+void dmp_layout_from_mask(unsigned short mask, struct dmp_layout_s *layout)
+{
+    unsigned char offset = 0;
+
+    layout->quat = DMP_LAYOUT_NONE;
+    layout->accel = DMP_LAYOUT_NONE;
+    layout->gyro = DMP_LAYOUT_NONE;
+    layout->gesture = DMP_LAYOUT_NONE;
+    layout->sensors = 0;
+
+    if (mask & (DMP_FEATURE_LP_QUAT | DMP_FEATURE_6X_LP_QUAT)) {
+        layout->quat = offset;
+        layout->sensors |= INV_WXYZ_QUAT;
+        offset += 16;
+    }
+    if (mask & DMP_FEATURE_SEND_RAW_ACCEL) {
+        layout->accel = offset;
+        layout->sensors |= INV_XYZ_ACCEL;
+        offset += 6;
+    }
+    if (mask & (DMP_FEATURE_SEND_RAW_GYRO | DMP_FEATURE_SEND_CAL_GYRO)) {
+        layout->gyro = offset;
+        layout->sensors |= INV_XYZ_GYRO;
+        offset += 6;
+    }
+    if (mask & (DMP_FEATURE_TAP | DMP_FEATURE_ANDROID_ORIENT)) {
+        layout->gesture = offset;
+        offset += 4;
+    }
+    layout->length = offset;
+}
+
+/**
+ *  @brief      Decode packets, word loads.
+ *  @param[in]  layout  Packet layout.
+ *  @param[in]  data    Packets, back to back, as read from the FIFO.
+ *  @param[in]  packets Number of packets.
+ *  @param[out] batch   Decoded packets.
+ */
+void dmp_decode_batch_scalar(const struct dmp_layout_s *layout,
+    const unsigned char *data, unsigned short packets,
+    const struct dmp_batch_s *batch)
+{
+    if ((layout->quat != DMP_LAYOUT_NONE) && batch->quat[0])
+        decode_quats(data + layout->quat, layout->length, 0, packets,
+            batch->quat);
+    if ((layout->accel != DMP_LAYOUT_NONE) && batch->accel[0])
+        decode_shorts(data + layout->accel, layout->length, 0, packets,
+            batch->accel);
+    if ((layout->gyro != DMP_LAYOUT_NONE) && batch->gyro[0])
+        decode_shorts(data + layout->gyro, layout->length, 0, packets,
+            batch->gyro);
+}
+
+#if defined __SSE2__
+/* Byte reverse of each 16 bit lane. */
+static inline __m128i bswap16x8(__m128i v)
+{
+#if defined __SSSE3__
+    return _mm_shuffle_epi8(v, _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6,
+        9, 8, 11, 10, 13, 12, 15, 14));
+#else
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+#endif
+}
+
+/* Byte reverse of each 32 bit lane. */
+static inline __m128i bswap32x4(__m128i v)
+{
+#if defined __SSSE3__
+    return _mm_shuffle_epi8(v, _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+        11, 10, 9, 8, 15, 14, 13, 12));
+#else
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    return bswap16x8(v);
+#endif
+}
+
+/* Three big endian shorts of four packets to three arrays. */
+static inline void store_shorts4(const unsigned char *p, unsigned char length,
+    int16_t *const *out, unsigned short n)
+{
+    __m128i a0 = _mm_loadl_epi64((const __m128i *)(p));
+    __m128i a1 = _mm_loadl_epi64((const __m128i *)(p + length));
+    __m128i a2 = _mm_loadl_epi64((const __m128i *)(p + 2 * length));
+    __m128i a3 = _mm_loadl_epi64((const __m128i *)(p + 3 * length));
+    __m128i u0 = _mm_unpacklo_epi16(a0, a1);    /* x0 x1 y0 y1 z0 z1 */
+    __m128i u1 = _mm_unpacklo_epi16(a2, a3);    /* x2 x3 y2 y3 z2 z3 */
+    __m128i xy = bswap16x8(_mm_unpacklo_epi32(u0, u1));
+    __m128i z = bswap16x8(_mm_unpackhi_epi32(u0, u1));
+
+    _mm_storel_epi64((__m128i *)(out[0] + n), xy);
+    _mm_storel_epi64((__m128i *)(out[1] + n), _mm_unpackhi_epi64(xy, xy));
+    _mm_storel_epi64((__m128i *)(out[2] + n), z);
+}
+#endif
+
+/**
+ *  @brief      Decode packets.
+ *  Same results as dmp_decode_batch_scalar, SIMD where available.
+ *  @param[in]  layout  Packet layout.
+ *  @param[in]  data    Packets, back to back, as read from the FIFO.
+ *  @param[in]  packets Number of packets.
+ *  @param[out] batch   Decoded packets.
+ */
+void dmp_decode_batch(const struct dmp_layout_s *layout,
+    const unsigned char *data, unsigned short packets,
+    const struct dmp_batch_s *batch)
+{
+#if defined __SSE2__
+    const unsigned char length = layout->length;
+    const unsigned long total = (unsigned long)packets * length;
+    const int quat = (layout->quat != DMP_LAYOUT_NONE) && batch->quat[0];
+    const int accel = (layout->accel != DMP_LAYOUT_NONE) && batch->accel[0];
+    const int gyro = (layout->gyro != DMP_LAYOUT_NONE) && batch->gyro[0];
+    unsigned long end = 0;
+    unsigned short n = 0;
+
+    /* Bytes read from the start of a packet: shorts are read 8 at a time,
+     * the last groups may not reach past the data.
+     */
+    if (quat)
+        end = layout->quat + 16;
+    if (accel && (layout->accel + 8UL > end))
+        end = layout->accel + 8UL;
+    if (gyro && (layout->gyro + 8UL > end))
+        end = layout->gyro + 8UL;
+
+    for (; (n + 4 <= packets) &&
+        ((unsigned long)(n + 3) * length + end <= total); n += 4) {
+        const unsigned char *p = data + (unsigned long)n * length;
+        if (quat) {
+            const unsigned char *q = p + layout->quat;
+            __m128i q0 = bswap32x4(_mm_loadu_si128((const __m128i *)(q)));
+            __m128i q1 = bswap32x4(_mm_loadu_si128((const __m128i *)(q + length)));
+            __m128i q2 = bswap32x4(_mm_loadu_si128((const __m128i *)(q + 2 * length)));
+            __m128i q3 = bswap32x4(_mm_loadu_si128((const __m128i *)(q + 3 * length)));
+            __m128i t0 = _mm_unpacklo_epi32(q0, q1);    /* w0 w1 x0 x1 */
+            __m128i t1 = _mm_unpacklo_epi32(q2, q3);    /* w2 w3 x2 x3 */
+            __m128i t2 = _mm_unpackhi_epi32(q0, q1);    /* y0 y1 z0 z1 */
+            __m128i t3 = _mm_unpackhi_epi32(q2, q3);    /* y2 y3 z2 z3 */
+            _mm_storeu_si128((__m128i *)(batch->quat[0] + n), _mm_unpacklo_epi64(t0, t1));
+            _mm_storeu_si128((__m128i *)(batch->quat[1] + n), _mm_unpackhi_epi64(t0, t1));
+            _mm_storeu_si128((__m128i *)(batch->quat[2] + n), _mm_unpacklo_epi64(t2, t3));
+            _mm_storeu_si128((__m128i *)(batch->quat[3] + n), _mm_unpackhi_epi64(t2, t3));
+        }
+        if (accel)
+            store_shorts4(p + layout->accel, length, batch->accel, n);
+        if (gyro)
+            store_shorts4(p + layout->gyro, length, batch->gyro, n);
+    }
+
+    /* The rest, one packet at a time. */
+    if (quat)
+        decode_quats(data + layout->quat, length, n, packets, batch->quat);
+    if (accel)
+        decode_shorts(data + layout->accel, length, n, packets, batch->accel);
+    if (gyro)
+        decode_shorts(data + layout->gyro, length, n, packets, batch->gyro);
+#else
+    dmp_decode_batch_scalar(layout, data, packets, batch);
+#endif
+}
+
+/**
+ *  @brief      Decode a big endian quaternion per packet.
+ *  @param[in]  data    Quaternion of packet 0.
+ *  @param[in]  length  Packet length.
+ *  @param[in]  first   First packet to decode.
+ *  @param[in]  packets Packets in data.
+ *  @param[out] out     w, x, y, z arrays.
+ */
+static void decode_quats(const unsigned char *data, unsigned char length,
+    unsigned short first, unsigned short packets, int32_t *const *out)
+{
+    const unsigned char *p = data + (unsigned long)first * length;
+    int32_t *w = out[0], *x = out[1], *y = out[2], *z = out[3];
+    unsigned short n;
+
+    for (n = first; n < packets; n++, p += length) {
+        w[n] = load_be32(p);
+        x[n] = load_be32(p + 4);
+        y[n] = load_be32(p + 8);
+        z[n] = load_be32(p + 12);
+    }
+}
+
+/**
+ *  @brief      Decode three big endian shorts per packet.
+ *  @param[in]  data    First short of packet 0.
+ *  @param[in]  length  Packet length.
+ *  @param[in]  first   First packet to decode.
+ *  @param[in]  packets Packets in data.
+ *  @param[out] out     x, y, z arrays.
+ */
+static void decode_shorts(const unsigned char *data, unsigned char length,
+    unsigned short first, unsigned short packets, int16_t *const *out)
+{
+    const unsigned char *p = data + (unsigned long)first * length;
+    int16_t *x = out[0], *y = out[1], *z = out[2];
+    unsigned short n;
+    uint32_t xy;
+
+    for (n = first; n < packets; n++, p += length) {
+        xy = load_be16x2(p);
+        x[n] = (int16_t)(xy & 0xFFFF);
+        y[n] = (int16_t)(xy >> 16);
+        z[n] = load_be16(p + 4);
+    }
+}
@@ -0,0 +1,54 @@
+//============================================================================
+//
+// $RCSfile: inv_mpu_dmp_batch.h,v $ (HEADER FILE)
+// $Revision: 1.1 $
+// $Date: 2026/10/18 10:00:00 $
+// $Author$
+//
+/// \brief   DMP packet batch decoder header file
+///
+/// \file
+/// Packet layout of the DMP FIFO, computed once per feature mask, and a
+/// decoder of N packets into structure of arrays buffers. No I2C here:
+/// the decoder builds on the host too (Firmware/Host/dmpbench.cpp).
+///
+//  CHANGES
+//
+//============================================================================
+
+#ifndef _INV_MPU_DMP_BATCH_H_
+#define _INV_MPU_DMP_BATCH_H_
+
+#include <stdint.h>
+
+#define DMP_LAYOUT_NONE     (0xFF)  /* Field not in the packet. */
+#define DMP_PACKET_MAX      (32)    /* Longest DMP packet, bytes. */
+
+/* Packet layout, from the DMP_FEATURE_xxx mask. */
+struct dmp_layout_s {
+    unsigned char length;           /* Bytes per packet. */
+    unsigned char quat;             /* Offset of each field, bytes, or */
+    unsigned char accel;            /* DMP_LAYOUT_NONE. */
+    unsigned char gyro;
+    unsigned char gesture;
+    short sensors;                  /* INV_xxx mask of every packet. */
+};
+
+/* Decoded packets, structure of arrays: element n of each array is packet
+ * n. Arrays of fields not in the layout, or set to 0, are not written.
+ */
+struct dmp_batch_s {
+    int32_t *quat[4];               /* w, x, y, z, q30. */
+    int16_t *accel[3];              /* x, y, z, hardware units. */
+    int16_t *gyro[3];               /* x, y, z, hardware units. */
+};
+
+void dmp_layout_from_mask(unsigned short mask, struct dmp_layout_s *layout);
+void dmp_decode_batch(const struct dmp_layout_s *layout,
+    const unsigned char *data, unsigned short packets,
+    const struct dmp_batch_s *batch);
+void dmp_decode_batch_scalar(const struct dmp_layout_s *layout,
+    const unsigned char *data, unsigned short packets,
+    const struct dmp_batch_s *batch);
+
+#endif  /* #ifndef _INV_MPU_DMP_BATCH_H_ */
@@ -21,6 +21,7 @@
 #include <math.h>
 #include "inv_mpu.h"
 #include "inv_mpu_dmp_motion_driver.h"
+#include "inv_mpu_dmp_batch.h"
 #include "dmpKey.h"
 #include "dmpmap.h"
 
@@ -71,6 +72,18 @@
 #define log_i       MPL_LOGI
 #define log_e       MPL_LOGE
 
+#elif defined EMPL_TARGET_LM3S
+/* LM3S firmware (Firmware/Source), see inv_mpu.c. */
+#include <intrinsics.h>
+#include "i2cdriver.h"
+#include "mpu6050.h"
+#define i2c_write   I2CWrite
+#define i2c_read    I2CRead
+#define delay_ms    Mpu_DelayMs
+#define get_ms      Mpu_GetMs
+#define log_i(...)     do {} while (0)
+#define log_e(...)     do {} while (0)
+
 #else
 #error  Gyro driver is missing the system layer implementations.
 #endif
@@ -491,6 +504,7 @@ struct dmp_s {
     unsigned short feature_mask;
     unsigned short fifo_rate;
     unsigned char packet_length;
+    struct dmp_layout_s layout;
 };
 
 static struct dmp_s dmp = {
@@ -499,7 +513,15 @@ static struct dmp_s dmp = {
     .orient = 0,
     .feature_mask = 0,
     .fifo_rate = 0,
-    .packet_length = 0
+    .packet_length = 0,
+    .layout = {
+        .length = 0,
+        .quat = DMP_LAYOUT_NONE,
+        .accel = DMP_LAYOUT_NONE,
+        .gyro = DMP_LAYOUT_NONE,
+        .gesture = DMP_LAYOUT_NONE,
+        .sensors = 0
+    }
 };
 
 /**
@@ -1095,15 +1117,9 @@ int dmp_enable_feature(unsigned short mask)
     dmp.feature_mask = mask | DMP_FEATURE_PEDOMETER;
     mpu_reset_fifo();
 
-    dmp.packet_length = 0;
-    if (mask & DMP_FEATURE_SEND_RAW_ACCEL)
-        dmp.packet_length += 6;
-    if (mask & DMP_FEATURE_SEND_ANY_GYRO)
-        dmp.packet_length += 6;
-    if (mask & (DMP_FEATURE_LP_QUAT | DMP_FEATURE_6X_LP_QUAT))
-        dmp.packet_length += 16;
-    if (mask & (DMP_FEATURE_TAP | DMP_FEATURE_ANDROID_ORIENT))
-        dmp.packet_length += 4;
+    /* Packet layout, used by every read until the features change. */
+    dmp_layout_from_mask(mask, &dmp.layout);
+    dmp.packet_length = dmp.layout.length;
 
     return 0;
 }
@@ -1268,8 +1284,8 @@ int dmp_read_fifo(short *gyro, short *accel, long *quat,
     unsigned char fifo_data[MAX_PACKET_LENGTH];
     unsigned char ii = 0;
 
-    /* TODO: sensors[0] only changes when dmp_enable_feature is called. We can
-     * cache this value and save some cycles.
+    /* sensors[0] only changes when dmp_enable_feature is called: it is
+     * cached in dmp.layout, set once the packet has been checked.
      */
     sensors[0] = 0;
 
@@ -1313,36 +1329,104 @@ int dmp_read_fifo(short *gyro, short *accel, long *quat,
             sensors[0] = 0;
             return -1;
         }
-        sensors[0] |= INV_WXYZ_QUAT;
 #endif
     }
 
-    if (dmp.feature_mask & DMP_FEATURE_SEND_RAW_ACCEL) {
+    if (dmp.layout.accel != DMP_LAYOUT_NONE) {
+        ii = dmp.layout.accel;
         accel[0] = ((short)fifo_data[ii+0] << 8) | fifo_data[ii+1];
         accel[1] = ((short)fifo_data[ii+2] << 8) | fifo_data[ii+3];
         accel[2] = ((short)fifo_data[ii+4] << 8) | fifo_data[ii+5];
-        ii += 6;
-        sensors[0] |= INV_XYZ_ACCEL;
     }
 
-    if (dmp.feature_mask & DMP_FEATURE_SEND_ANY_GYRO) {
+    if (dmp.layout.gyro != DMP_LAYOUT_NONE) {
+        ii = dmp.layout.gyro;
         gyro[0] = ((short)fifo_data[ii+0] << 8) | fifo_data[ii+1];
         gyro[1] = ((short)fifo_data[ii+2] << 8) | fifo_data[ii+3];
         gyro[2] = ((short)fifo_data[ii+4] << 8) | fifo_data[ii+5];
-        ii += 6;
-        sensors[0] |= INV_XYZ_GYRO;
     }
 
     /* Gesture data is at the end of the DMP packet. Parse it and call
      * the gesture callbacks (if registered).
      */
-    if (dmp.feature_mask & (DMP_FEATURE_TAP | DMP_FEATURE_ANDROID_ORIENT))
-        decode_gesture(fifo_data + ii);
+    if (dmp.layout.gesture != DMP_LAYOUT_NONE)
+        decode_gesture(fifo_data + dmp.layout.gesture);
 
+    sensors[0] = dmp.layout.sensors;
     get_ms(timestamp);
     return 0;
 }
 
+/**
+ *  @brief      Get all the packets in the FIFO.
+ *  Reads them in I2C bursts (mpu_read_fifo_stream_batch) and decodes them
+ *  in one pass (dmp_decode_batch) with the layout cached by
+ *  dmp_enable_feature. Gesture callbacks are executed packet by packet.
+ *  \n If the FIFO holds more than @e max_packets packets, the oldest are
+ *  read and @e more is the number left.
+ *  @param[out] batch       Decoded packets, arrays of @e max_packets.
+ *  @param[in]  max_packets Packets that fit in @e batch and @e data.
+ *  @param[out] data        Raw packets, @e max_packets * DMP_PACKET_MAX
+ *  bytes.
+ *  @param[out] timestamp   Timestamp of the read in milliseconds.
+ *  @param[out] sensors     Mask of sensors in each packet.
+ *  @param[out] count       Number of packets read.
+ *  @param[out] more        Number of remaining packets.
+ *  @return     0 if successful.
+ */
+int dmp_read_fifo_batch(const struct dmp_batch_s *batch,
+    unsigned short max_packets, unsigned char *data,
+    unsigned long *timestamp, short *sensors, unsigned short *count,
+    unsigned short *more)
+{
+    unsigned short n;
+
+    sensors[0] = 0;
+    count[0] = 0;
+    if (!dmp.layout.length)
+        return -1;
+    if (mpu_read_fifo_stream_batch(dmp.layout.length, max_packets, data,
+            count, more))
+        return -1;
+    get_ms(timestamp);
+    if (!count[0])
+        return 0;
+
+    dmp_decode_batch(&dmp.layout, data, count[0], batch);
+
+#ifdef FIFO_CORRUPTION_CHECK
+    /* As dmp_read_fifo: a misaligned read shows as a quaternion that is not
+     * normalized. Packets up to the first bad one are kept.
+     */
+    if ((dmp.layout.quat != DMP_LAYOUT_NONE) && batch->quat[0]) {
+        for (n = 0; n < count[0]; n++) {
+            long quat_q14[4], quat_mag_sq;
+            quat_q14[0] = batch->quat[0][n] >> 16;
+            quat_q14[1] = batch->quat[1][n] >> 16;
+            quat_q14[2] = batch->quat[2][n] >> 16;
+            quat_q14[3] = batch->quat[3][n] >> 16;
+            quat_mag_sq = quat_q14[0] * quat_q14[0] +
+                quat_q14[1] * quat_q14[1] + quat_q14[2] * quat_q14[2] +
+                quat_q14[3] * quat_q14[3];
+            if ((quat_mag_sq < QUAT_MAG_SQ_MIN) ||
+                (quat_mag_sq > QUAT_MAG_SQ_MAX)) {
+                mpu_reset_fifo();
+                count[0] = n;
+                more[0] = 0;
+                break;
+            }
+        }
+    }
+#endif
+
+    if (dmp.layout.gesture != DMP_LAYOUT_NONE) {
+        for (n = 0; n < count[0]; n++)
+            decode_gesture(data + n * dmp.layout.length + dmp.layout.gesture);
+    }
+    sensors[0] = dmp.layout.sensors;
+    return 0;
+}
+
 /**
  *  @brief      Register a function to be executed on a tap event.
  *  The tap direction is represented by one of the following:
@@ -92,6 +92,11 @@ int dmp_enable_gyro_cal(unsigned char enable);
  */
 int dmp_read_fifo(short *gyro, short *accel, long *quat,
     unsigned long *timestamp, short *sensors, unsigned char *more);
+struct dmp_batch_s;
+int dmp_read_fifo_batch(const struct dmp_batch_s *batch,
+    unsigned short max_packets, unsigned char *data,
+    unsigned long *timestamp, short *sensors, unsigned short *count,
+    unsigned short *more);
 
 #endif  /* #ifndef _INV_MPU_DMP_MOTION_DRIVER_H_ */
 